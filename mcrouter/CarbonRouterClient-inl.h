@@ -10,6 +10,7 @@
 #include "mcrouter/CarbonRouterInstance.h"
 #include "mcrouter/ForEachPossibleClient.h"
 #include "mcrouter/ProxyRequestContextTyped.h"
+#include "mcrouter/lib/NumaTopology.h"
 #include "mcrouter/lib/RouteHandleTraverser.h"
 
 namespace facebook {
@@ -90,10 +91,12 @@ template <class Request, class F>
 bool CarbonRouterClient<RouterInfo>::send(
     const Request& req,
     F&& callback,
-    folly::StringPiece ipAddr) {
-  auto makePreq = [this, ipAddr, &req, &callback](bool inBatch) mutable {
+    folly::StringPiece ipAddr,
+    folly::StringPiece tenant) {
+  auto makePreq = [this, ipAddr, tenant, &req, &callback](
+                      bool inBatch) mutable {
     return makeProxyRequestContext(
-        req, std::forward<F>(callback), ipAddr, inBatch);
+        req, std::forward<F>(callback), ipAddr, tenant, inBatch);
   };
 
   auto cancelRemaining = [&req, &callback]() {
@@ -219,6 +222,15 @@ CarbonRouterClient<RouterInfo>::findAffinitizedProxyIdx(
     config.second.proxyRoute().traverse(req, t);
   }
 
+  if (proxies_[proxyIdx_]->getRouterOptions().numa_placement) {
+    // Stay on the NUMA node of this client's own proxy.
+    const auto& topology = NumaTopology::get();
+    auto range = topology.threadsOfNode(
+        topology.nodeForThread(proxyIdx_, proxies_.size()), proxies_.size());
+    if (range.second > range.first) {
+      return range.first + hash % (range.second - range.first);
+    }
+  }
   return hash % proxies_.size();
 }
 
@@ -246,7 +258,11 @@ bool CarbonRouterClient<RouterInfo>::send(
 
   auto makeNextPreq = [this, ipAddr, &callback, &begin](bool inBatch) {
     auto proxyRequestContext = makeProxyRequestContext(
-        detail::unwrapRequest(*begin), callback, ipAddr, inBatch);
+        detail::unwrapRequest(*begin),
+        callback,
+        ipAddr,
+        folly::StringPiece(),
+        inBatch);
     ++begin;
     return proxyRequestContext;
   };
@@ -334,6 +350,7 @@ CarbonRouterClient<RouterInfo>::makeProxyRequestContext(
     const Request& req,
     CallbackFunc&& callback,
     folly::StringPiece ipAddr,
+    folly::StringPiece tenant,
     bool inBatch) {
   Proxy<RouterInfo>* proxy = proxies_[proxyIdx_];
   if (mode_ == ThreadMode::AffinitizedRemoteThread) {
@@ -361,6 +378,16 @@ CarbonRouterClient<RouterInfo>::makeProxyRequestContext(
   if (!ipAddr.empty()) {
     proxyRequestContext->setUserIpAddress(ipAddr);
   }
+  if (!tenant.empty()) {
+    proxyRequestContext->setTenant(tenant);
+  }
+  auto timeout = req.timeoutMs() != 0
+      ? std::chrono::milliseconds(req.timeoutMs())
+      : requestTimeout_;
+  if (timeout.count() > 0) {
+    proxyRequestContext->setDeadline(
+        std::chrono::steady_clock::now() + timeout);
+  }
   return proxyRequestContext;
 }
 
@@ -7,6 +7,8 @@
 
 #pragma once
 
+#include <chrono>
+
 #include <folly/IntrusiveList.h>
 #include <folly/Range.h>
 
@@ -92,6 +94,11 @@ class CarbonRouterClient : public CarbonRouterClientBase {
    *                  called, but may be delayed, until all sub-requests are
    *                  processed.
    *                  The callback must be copyable.
+   * @param ipAddr    The ip address of the caller (can be empty).
+   * @param tenant    The client the request is accounted to when the proxy
+   *                  shares its capacity fairly between clients
+   *                  (can be empty). Not copied: must stay valid until the
+   *                  callback is called.
    *
    * @return true iff the request was scheduled to be sent / was sent,
    *         false if some error happened (e.g. RouterInstance was destroyed).
@@ -103,7 +110,8 @@ class CarbonRouterClient : public CarbonRouterClientBase {
   bool send(
       const Request& req,
       F&& callback,
-      folly::StringPiece ipAddr = folly::StringPiece());
+      folly::StringPiece ipAddr = folly::StringPiece(),
+      folly::StringPiece tenant = folly::StringPiece());
 
   /**
    * Multi requests version of send.
@@ -139,6 +147,16 @@ class CarbonRouterClient : public CarbonRouterClientBase {
     proxyIdx_ = proxyIdx;
   }
 
+  /**
+   * Sets the end-to-end time budget for requests sent through this client
+   * that don't carry one already (e.g. from the caret header). Requests are
+   * dropped once their budget is spent, and downstream timeouts never exceed
+   * what is left of it. Zero (the default) means no deadline.
+   */
+  void setRequestTimeout(std::chrono::milliseconds timeout) {
+    requestTimeout_ = timeout;
+  }
+
   CarbonRouterClient(const CarbonRouterClient<RouterInfo>&) = delete;
   CarbonRouterClient(CarbonRouterClient<RouterInfo>&&) noexcept = delete;
   CarbonRouterClient& operator=(const CarbonRouterClient<RouterInfo>&) = delete;
@@ -158,6 +176,8 @@ class CarbonRouterClient : public CarbonRouterClientBase {
   // Only used for multi-request send() calls.
   std::vector<bool> proxiesToNotify_;
 
+  std::chrono::milliseconds requestTimeout_{0};
+
   CacheClientStats stats_;
 
   /**
@@ -223,6 +243,7 @@ class CarbonRouterClient : public CarbonRouterClientBase {
    * @param callback    The callback function to be called once the reply
    *                    is received.
    * @param ipAddr      The ip address of the caller (can be empty).
+   * @param tenant      The client the request is accounted to (can be empty).
    * @param inBatch     Whether or not the given request is part of a batch
    *                    of requests.
    *
@@ -234,6 +255,7 @@ class CarbonRouterClient : public CarbonRouterClientBase {
       const Request& req,
       CallbackFunc&& callback,
       folly::StringPiece ipAddr,
+      folly::StringPiece tenant,
       bool inBatch);
 
   bool shouldDelayNotification(size_t batchSize) const;
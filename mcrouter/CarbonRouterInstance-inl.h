@@ -26,7 +26,11 @@
 #include "mcrouter/ProxyThread.h"
 #include "mcrouter/RuntimeVarsData.h"
 #include "mcrouter/ServiceInfo.h"
+#include "mcrouter/StatsShmExporter.h"
 #include "mcrouter/ThreadUtil.h"
+#include "mcrouter/lib/AuxiliaryCPUThreadPool.h"
+#include "mcrouter/lib/debug/FifoManager.h"
+#include "mcrouter/lib/network/TlsSessionCache.h"
 #include "mcrouter/stats.h"
 
 namespace facebook {
@@ -188,6 +192,16 @@ CarbonRouterInstance<RouterInfo>::spinUp(
     const std::vector<folly::EventBase*>& evbs) {
   CHECK(evbs.empty() || evbs.size() == opts_.num_proxies);
 
+  setTlsSessionCacheCapacity(opts_.ssl_session_cache_capacity);
+  if (auto auxPool = AuxiliaryCPUThreadPoolSingleton::try_get_fast()) {
+    auxPool->setMaxQueueDepth(opts_.auxiliary_cpu_pool_max_queue_depth);
+  }
+  if (!opts_.debug_fifo_root.empty()) {
+    if (auto fifoManager = FifoManager::getInstance()) {
+      fifoManager->setRingCapacity(opts_.debug_fifo_ring_size);
+    }
+  }
+
   // Must init compression before creating proxies.
   if (opts_.enable_compression) {
     initCompression(*this);
@@ -232,8 +246,28 @@ CarbonRouterInstance<RouterInfo>::spinUp(
       }
 
       try {
-        proxies_.emplace_back(
-            Proxy<RouterInfo>::createProxy(*this, *proxyEvbs_[i], i));
+        if (opts_.numa_placement && evbs.empty()) {
+          // Allocate the proxy from its own (pinned) thread, so that its
+          // memory is local to its NUMA node.
+          Proxy<RouterInfo>* proxy = nullptr;
+          std::exception_ptr error;
+          proxyThreads_.back()->getEventBase().runInEventBaseThreadAndWait(
+              [&] {
+                try {
+                  proxy =
+                      Proxy<RouterInfo>::createProxy(*this, *proxyEvbs_[i], i);
+                } catch (...) {
+                  error = std::current_exception();
+                }
+              });
+          if (error) {
+            std::rethrow_exception(error);
+          }
+          proxies_.emplace_back(proxy);
+        } else {
+          proxies_.emplace_back(
+              Proxy<RouterInfo>::createProxy(*this, *proxyEvbs_[i], i));
+        }
       } catch (...) {
         return folly::makeUnexpected(folly::sformat(
             "Failed to create proxy: {}",
@@ -351,6 +385,7 @@ void CarbonRouterInstance<RouterInfo>::spawnAuxiliaryThreads() {
   startObservingRuntimeVarsFile();
   registerOnUpdateCallbackForRxmits();
   registerForStatsUpdates();
+  registerForFiberStacksRelease();
   spawnStatLoggerThread();
 }
 
@@ -398,6 +433,9 @@ template <class RouterInfo>
 void CarbonRouterInstance<RouterInfo>::spawnStatLoggerThread() {
   mcrouterLogger_ = createMcrouterLogger(*this);
   mcrouterLogger_->start();
+
+  statsShmExporter_ = std::make_unique<StatsShmExporter>(*this);
+  statsShmExporter_->start();
 }
 
 template <class RouterInfo>
@@ -409,10 +447,14 @@ void CarbonRouterInstance<RouterInfo>::joinAuxiliaryThreads() noexcept {
   }
 
   deregisterForStatsUpdates();
+  deregisterForFiberStacksRelease();
 
   if (mcrouterLogger_) {
     mcrouterLogger_->stop();
   }
+  if (statsShmExporter_) {
+    statsShmExporter_->stop();
+  }
 
   runtimeVarsObserverHandle_.reset();
 }
@@ -33,6 +33,7 @@ class McrouterManager;
 }
 
 class ProxyThread;
+class StatsShmExporter;
 
 /**
  * A single mcrouter instance.  A mcrouter instance has a single config,
@@ -160,6 +161,11 @@ class CarbonRouterInstance
    */
   std::unique_ptr<McrouterLogger> mcrouterLogger_;
 
+  /**
+   * Publishes mcrouter stats to opts->stats_shm_path every second
+   */
+  std::unique_ptr<StatsShmExporter> statsShmExporter_;
+
   std::atomic<bool> shutdownStarted_{false};
 
   FileObserverHandle runtimeVarsObserverHandle_;
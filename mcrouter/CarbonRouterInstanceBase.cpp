@@ -17,6 +17,7 @@
 #include "mcrouter/AsyncWriter.h"
 #include "mcrouter/ProxyBase.h"
 #include "mcrouter/lib/CompressionCodecManager.h"
+#include "mcrouter/lib/NumaTopology.h"
 #include "mcrouter/lib/fbi/cpp/util.h"
 #include "mcrouter/stats.h"
 
@@ -63,6 +64,15 @@ std::string statsUpdateFunctionName(folly::StringPiece routerName) {
       "carbon-stats-update-fn-", routerName, "-", uniqueId.fetch_add(1));
 }
 
+std::string fiberStacksReleaseFunctionName(folly::StringPiece routerName) {
+  static std::atomic<uint64_t> uniqueId(0);
+  return folly::to<std::string>(
+      "carbon-fiber-stacks-release-fn-",
+      routerName,
+      "-",
+      uniqueId.fetch_add(1));
+}
+
 McrouterOptions finalizeOpts(McrouterOptions&& opts) {
   facebook::memcache::mcrouter::finalizeOptions(opts);
   return std::move(opts);
@@ -76,7 +86,9 @@ CarbonRouterInstanceBase::CarbonRouterInstanceBase(McrouterOptions inputOptions)
       configApi_(createConfigApi(opts_)),
       rtVarsData_(std::make_shared<ObservableRuntimeVars>()),
       leaseTokenMap_(globalFunctionScheduler.try_get()),
-      statsUpdateFunctionHandle_(statsUpdateFunctionName(opts_.router_name)) {
+      statsUpdateFunctionHandle_(statsUpdateFunctionName(opts_.router_name)),
+      fiberStacksReleaseFunctionHandle_(
+          fiberStacksReleaseFunctionName(opts_.router_name)) {
   if (auto statsLogger = statsLogWriter()) {
     if (opts_.stats_async_queue_length) {
       statsLogger->increaseMaxQueueSize(opts_.stats_async_queue_length);
@@ -142,6 +154,18 @@ CarbonRouterInstanceBase::getStartupOpts() const {
 size_t CarbonRouterInstanceBase::nextProxyIndex() {
   std::lock_guard<std::mutex> guard(nextProxyMutex_);
   assert(nextProxy_ < opts().num_proxies);
+  if (opts().numa_placement) {
+    const auto& topology = NumaTopology::get();
+    if (auto node = topology.currentNode()) {
+      for (size_t i = 0; i < opts().num_proxies; ++i) {
+        size_t idx = (nextProxy_ + i) % opts().num_proxies;
+        if (topology.nodeForThread(idx, opts().num_proxies) == *node) {
+          nextProxy_ = (idx + 1) % opts().num_proxies;
+          return idx;
+        }
+      }
+    }
+  }
   size_t res = nextProxy_;
   nextProxy_ = (nextProxy_ + 1) % opts().num_proxies;
   return res;
@@ -166,6 +190,40 @@ void CarbonRouterInstanceBase::deregisterForStatsUpdates() {
   }
 }
 
+void CarbonRouterInstanceBase::registerForFiberStacksRelease() {
+  if (!opts_.num_proxies || opts_.fibers_pool_resize_period_ms == 0 ||
+      !getProxyBase(0)->fiberStackTiers().enabled()) {
+    return;
+  }
+  if (auto scheduler = functionScheduler()) {
+    scheduler->addFunction(
+        [this]() { releaseFiberStacks(); },
+        std::chrono::milliseconds(opts_.fibers_pool_resize_period_ms),
+        fiberStacksReleaseFunctionHandle_);
+  }
+}
+
+void CarbonRouterInstanceBase::deregisterForFiberStacksRelease() {
+  if (auto scheduler = functionScheduler()) {
+    scheduler->cancelFunctionAndWait(fiberStacksReleaseFunctionHandle_);
+  }
+}
+
+void CarbonRouterInstanceBase::releaseFiberStacks() {
+  // Racy reads, like other stats of proxies.
+  size_t fibersPoolSize = 0;
+  for (size_t i = 0; i < opts_.num_proxies; ++i) {
+    getProxyBase(i)->fiberStackTiers().forEachTier(
+        [&fibersPoolSize](folly::fibers::FiberManager& fm) {
+          fibersPoolSize += fm.fibersPoolSize();
+        });
+  }
+  if (fibersPoolSize < lastFibersPoolSize_) {
+    FiberStackTiers::releaseFreeMemory();
+  }
+  lastFibersPoolSize_ = fibersPoolSize;
+}
+
 void CarbonRouterInstanceBase::updateStats() {
   const int BIN_NUM =
       (MOVING_AVERAGE_WINDOW_SIZE_IN_SECOND /
@@ -188,6 +188,8 @@ class CarbonRouterInstanceBase {
 
   /**
    * Bump and return the index of the next proxy to be used by clients.
+   * With numa_placement, proxies on the NUMA node of the calling thread are
+   * preferred.
    */
   size_t nextProxyIndex();
 
@@ -213,6 +215,15 @@ class CarbonRouterInstanceBase {
    */
   void deregisterForStatsUpdates();
 
+  /**
+   * Register this instance for giving the memory of fiber stacks freed by
+   * fiber pool resizing back to the system. No-op unless fiber stack tiers
+   * are enabled.
+   */
+  void registerForFiberStacksRelease();
+
+  void deregisterForFiberStacksRelease();
+
   const McrouterOptions opts_;
   const pid_t pid_;
   const std::unique_ptr<ConfigApi> configApi_;
@@ -265,10 +276,19 @@ class CarbonRouterInstanceBase {
   // Name of the stats update function registered with the function scheduler.
   const std::string statsUpdateFunctionHandle_;
 
+  // Name of the fiber stacks release function registered with the function
+  // scheduler.
+  const std::string fiberStacksReleaseFunctionHandle_;
+  // Size of the free fiber pools of all proxies, last time it was checked.
+  size_t lastFibersPoolSize_{0};
+
   std::vector<std::string> statsEnabledPools_;
 
   // Aggregates stats for all associated proxies. Should be called periodically.
   void updateStats();
+
+  // Releases fiber stack memory if fiber pools shrank since last call.
+  void releaseFiberStacks();
 };
 
 } // namespace mcrouter
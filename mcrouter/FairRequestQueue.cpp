@@ -0,0 +1,120 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include "FairRequestQueue.h"
+
+#include <algorithm>
+#include <cassert>
+
+namespace facebook {
+namespace memcache {
+namespace mcrouter {
+
+constexpr size_t FairRequestQueue::kDefaultMaxTenants;
+constexpr folly::StringPiece FairRequestQueue::kOverflowTenant;
+
+FairRequestQueue::FairRequestQueue(
+    std::unordered_map<std::string, size_t> weights,
+    size_t maxTenants)
+    : weights_(std::move(weights)),
+      maxTenants_(std::max<size_t>(maxTenants, 1)) {}
+
+FairRequestQueue::Tenant& FairRequestQueue::getTenant(
+    folly::StringPiece name) {
+  auto it = tenants_.find(name);
+  if (it != tenants_.end()) {
+    return *it->second;
+  }
+  if (tenants_.size() >= maxTenants_) {
+    if (idle_.empty()) {
+      auto overflowIt = tenants_.find(kOverflowTenant);
+      if (overflowIt != tenants_.end()) {
+        return *overflowIt->second;
+      }
+      return addTenant(kOverflowTenant, 1);
+    }
+    // Forget the tenant idle for the longest time (and its stats).
+    auto& evicted = idle_.front();
+    idle_.pop_front();
+    tenants_.erase(tenants_.find(evicted.name));
+  }
+  auto weightIt = weights_.find(name.str());
+  auto weight = weightIt != weights_.end() ? weightIt->second : 1;
+  return addTenant(name, std::max<size_t>(weight, 1));
+}
+
+FairRequestQueue::Tenant& FairRequestQueue::addTenant(
+    folly::StringPiece name,
+    size_t weight) {
+  auto tenant = std::make_unique<Tenant>(name.str(), weight);
+  auto& ref = *tenant;
+  tenants_.emplace(ref.name, std::move(tenant));
+  return ref;
+}
+
+void FairRequestQueue::push(
+    folly::StringPiece tenantName,
+    std::unique_ptr<FairRequestQueueEntry> entry,
+    int64_t nowUs) {
+  auto& tenant = getTenant(tenantName);
+  if (tenant.entries.empty()) {
+    if (tenant.hook.is_linked()) {
+      idle_.erase(idle_.iterator_to(tenant));
+    }
+    active_.push_back(tenant);
+  }
+  entry->pushedAtUs_ = nowUs;
+  tenant.entries.pushBack(std::move(entry));
+  ++tenant.depth;
+  ++size_;
+}
+
+std::unique_ptr<FairRequestQueueEntry> FairRequestQueue::pop(int64_t nowUs) {
+  assert(!active_.empty());
+  auto& tenant = active_.front();
+  if (tenant.deficit == 0) {
+    tenant.deficit = tenant.weight;
+  }
+
+  auto entry = tenant.entries.popFront();
+  --tenant.deficit;
+  --tenant.depth;
+  --size_;
+
+  const auto waitUs = std::max<int64_t>(nowUs - entry->pushedAtUs_, 0);
+  ++tenant.dequeued;
+  tenant.totalWaitUs += waitUs;
+  tenant.maxWaitUs = std::max(tenant.maxWaitUs, waitUs);
+
+  if (tenant.entries.empty()) {
+    // An idle tenant doesn't keep its unused quantum.
+    tenant.deficit = 0;
+    active_.pop_front();
+    idle_.push_back(tenant);
+  } else if (tenant.deficit == 0) {
+    active_.pop_front();
+    active_.push_back(tenant);
+  }
+  return entry;
+}
+
+folly::dynamic FairRequestQueue::dumpTenantStats() const {
+  folly::dynamic result = folly::dynamic::object;
+  for (const auto& it : tenants_) {
+    const auto& tenant = *it.second;
+    result[tenant.name] = folly::dynamic::object("weight", tenant.weight)(
+        "depth", tenant.depth)("dequeued", tenant.dequeued)(
+        "avg_wait_us",
+        tenant.dequeued == 0 ? 0 : tenant.totalWaitUs / tenant.dequeued)(
+        "max_wait_us", tenant.maxWaitUs);
+  }
+  return result;
+}
+
+} // namespace mcrouter
+} // namespace memcache
+} // namespace facebook
@@ -0,0 +1,141 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+#include <folly/IntrusiveList.h>
+#include <folly/Range.h>
+#include <folly/dynamic.h>
+
+#include "mcrouter/lib/network/UniqueIntrusiveList.h"
+
+namespace facebook {
+namespace memcache {
+namespace mcrouter {
+
+/**
+ * Base class of anything that can be put into a FairRequestQueue.
+ */
+class FairRequestQueueEntry {
+ public:
+  virtual ~FairRequestQueueEntry() = default;
+
+ private:
+  UniqueIntrusiveListHook hook_;
+  int64_t pushedAtUs_{0};
+
+  friend class FairRequestQueue;
+};
+
+/**
+ * Queue of requests waiting for the proxy to have capacity, shared fairly
+ * between tenants (clients identified by connection, TLS common name, etc.).
+ *
+ * Every tenant has its own FIFO queue, and the tenants with waiting requests
+ * are served with deficit round-robin: each turn a tenant can dequeue up to
+ * `weight` requests before the next tenant gets its turn. A tenant sending a
+ * burst of requests thus only delays the others by `weight` requests instead
+ * of the whole burst. With a single tenant, this is a plain FIFO.
+ *
+ * Push and pop are O(1). Tenants are remembered (with their stats) after their
+ * queue drained, up to maxTenants: past that, a new tenant replaces the one
+ * idle for the longest time, and only when all of them have waiting requests
+ * do requests of new tenants share a single overflow tenant.
+ *
+ * Not thread-safe.
+ */
+class FairRequestQueue {
+ public:
+  static constexpr size_t kDefaultMaxTenants = 1024;
+  static constexpr folly::StringPiece kOverflowTenant{"__overflow__"};
+
+  /**
+   * @param weights     Weight (>= 1) of each tenant, the others have weight 1.
+   * @param maxTenants  Max number of tenants tracked individually, idle ones
+   *                    included.
+   */
+  explicit FairRequestQueue(
+      std::unordered_map<std::string, size_t> weights = {},
+      size_t maxTenants = kDefaultMaxTenants);
+
+  FairRequestQueue(const FairRequestQueue&) = delete;
+  FairRequestQueue& operator=(const FairRequestQueue&) = delete;
+
+  /**
+   * Appends the entry to the queue of the given tenant.
+   */
+  void push(
+      folly::StringPiece tenant,
+      std::unique_ptr<FairRequestQueueEntry> entry,
+      int64_t nowUs);
+
+  /**
+   * Removes the next entry, as chosen by deficit round-robin.
+   * Queue must not be empty.
+   */
+  std::unique_ptr<FairRequestQueueEntry> pop(int64_t nowUs);
+
+  bool empty() const {
+    return size_ == 0;
+  }
+
+  size_t size() const {
+    return size_;
+  }
+
+  /**
+   * @return  Object of tenant name -> {weight, depth, dequeued,
+   *          avg_wait_us, max_wait_us}.
+   */
+  folly::dynamic dumpTenantStats() const;
+
+ private:
+  using EntryList = UniqueIntrusiveList<
+      FairRequestQueueEntry,
+      &FairRequestQueueEntry::hook_>;
+
+  struct Tenant {
+    Tenant(std::string n, size_t w) : name(std::move(n)), weight(w) {}
+
+    const std::string name;
+    EntryList entries;
+    // In active_ while the tenant has waiting requests, in idle_ otherwise.
+    folly::IntrusiveListHook hook;
+    const size_t weight;
+    // Number of requests this tenant can still dequeue in its current turn.
+    size_t deficit{0};
+
+    size_t depth{0};
+    uint64_t dequeued{0};
+    uint64_t totalWaitUs{0};
+    int64_t maxWaitUs{0};
+  };
+
+  const std::unordered_map<std::string, size_t> weights_;
+  const size_t maxTenants_;
+
+  // Keyed on the tenants' own names, so that lookups don't copy the name.
+  std::unordered_map<folly::StringPiece, std::unique_ptr<Tenant>> tenants_;
+  // Tenants with waiting requests, in round-robin order.
+  folly::IntrusiveList<Tenant, &Tenant::hook> active_;
+  // Tenants without waiting requests, least recently used first.
+  folly::IntrusiveList<Tenant, &Tenant::hook> idle_;
+  size_t size_{0};
+
+  Tenant& getTenant(folly::StringPiece name);
+  Tenant& addTenant(folly::StringPiece name, size_t weight);
+};
+
+} // namespace mcrouter
+} // namespace memcache
+} // namespace facebook
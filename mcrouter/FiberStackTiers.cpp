@@ -0,0 +1,208 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include "FiberStackTiers.h"
+
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
+
+#include <algorithm>
+#include <utility>
+
+#include <folly/fibers/EventBaseLoopController.h>
+#include <folly/io/async/VirtualEventBase.h>
+
+namespace facebook {
+namespace memcache {
+namespace mcrouter {
+
+namespace {
+
+// Probes are rare and short lived: no need to keep many free fibers around.
+constexpr size_t kProbeMaxFibersPoolSize = 4;
+
+size_t clampTierStackSize(size_t stackSize) {
+  return stackSize == 0
+      ? 0
+      : std::max(stackSize, FiberStackTiers::kMinTierStackSize);
+}
+
+} // anonymous namespace
+
+constexpr size_t FiberStackTiers::kNumTiers;
+constexpr size_t FiberStackTiers::kMaxTypeId;
+constexpr size_t FiberStackTiers::kMinProbes;
+constexpr size_t FiberStackTiers::kStackHeadroom;
+constexpr size_t FiberStackTiers::kTierStackLimitPercent;
+constexpr size_t FiberStackTiers::kMinTierStackSize;
+
+FiberStackTiers::FiberStackTiers(
+    folly::fibers::FiberManager& large,
+    const folly::fibers::FiberManager::Options& options,
+    size_t smallStackSize,
+    size_t mediumStackSize,
+    size_t probeEvery,
+    FiberManagerFactory makeFiberManager)
+    : large_(large),
+      enabled_(
+          (smallStackSize != 0 &&
+           clampTierStackSize(smallStackSize) < options.stackSize) ||
+          (mediumStackSize != 0 &&
+           clampTierStackSize(mediumStackSize) < options.stackSize)),
+      probeEvery_(std::max<size_t>(probeEvery, 1)),
+      options_(options),
+      stackSizes_{{clampTierStackSize(smallStackSize),
+                   clampTierStackSize(mediumStackSize),
+                   options.stackSize}},
+      makeFiberManager_(std::move(makeFiberManager)) {
+  tiers_[kLarge] = &large_;
+  if (!enabled_) {
+    return;
+  }
+
+  for (int tier = kMedium; tier >= kSmall; --tier) {
+    // Tiers must be smaller than the next one to be of any use.
+    if (stackSizes_[tier] == 0 || stackSizes_[tier] >= stackSizes_[tier + 1]) {
+      stackSizes_[tier] = stackSizes_[tier + 1];
+      tiers_[tier] = tiers_[tier + 1];
+      continue;
+    }
+    auto tierOptions = options_;
+    tierOptions.stackSize = stackSizes_[tier];
+    tierOptions.recordStackEvery = probeEvery_;
+    tierOptions.guardPagesPerStack =
+        std::max<size_t>(tierOptions.guardPagesPerStack, 1);
+    owned_[tier] = makeFiberManager_(tierOptions);
+    tiers_[tier] = owned_[tier].get();
+  }
+
+  types_.resize(kMaxTypeId);
+  for (auto& type : types_) {
+    type.probeCountdown = probeEvery_;
+  }
+}
+
+FiberStackTiers::~FiberStackTiers() = default;
+
+void FiberStackTiers::attachEventBase(folly::VirtualEventBase& evb) {
+  evb_ = &evb;
+  for (auto& fm : owned_) {
+    if (fm) {
+      attach(*fm);
+    }
+  }
+}
+
+void FiberStackTiers::attach(folly::fibers::FiberManager& fm) {
+  dynamic_cast<folly::fibers::EventBaseLoopController&>(fm.loopController())
+      .attachEventBase(*evb_);
+}
+
+folly::fibers::FiberManager& FiberStackTiers::probe(TypeState& type) {
+  type.probeCountdown = probeEvery_;
+  if (!type.probe) {
+    auto probeOptions = options_;
+    probeOptions.recordStackEvery = 1;
+    probeOptions.maxFibersPoolSize = kProbeMaxFibersPoolSize;
+    type.probe = makeFiberManager_(probeOptions);
+    if (evb_) {
+      attach(*type.probe);
+    }
+    probes_.push_back(type.probe.get());
+    releaseDrainedProbes();
+  } else if (++type.probes >= kMinProbes) {
+    // Stack usage is recorded when a fiber finishes: the watermark covers
+    // the previous probes.
+    type.tier = pickTier(type.probe->stackHighWatermark());
+  }
+  retireOverflowingTiers();
+  return *type.probe;
+}
+
+void FiberStackTiers::reset() {
+  resetPending_.store(false, std::memory_order_relaxed);
+  for (auto& type : types_) {
+    type.tier = kLarge;
+    type.probeCountdown = probeEvery_;
+    type.probes = 0;
+    // The watermark of a FiberManager can't be cleared: the type gets a new
+    // probe, the old one is destroyed once its fibers are done.
+    if (type.probe) {
+      drainingProbes_.push_back(std::move(type.probe));
+    }
+  }
+  releaseDrainedProbes();
+}
+
+void FiberStackTiers::releaseDrainedProbes() {
+  auto it = drainingProbes_.begin();
+  while (it != drainingProbes_.end()) {
+    if ((*it)->hasTasks()) {
+      ++it;
+      continue;
+    }
+    probes_.erase(std::find(probes_.begin(), probes_.end(), it->get()));
+    it = drainingProbes_.erase(it);
+  }
+}
+
+void FiberStackTiers::retireOverflowingTiers() {
+  for (size_t tier = kSmall; tier < kLarge; ++tier) {
+    if (!owned_[tier] || retired_[tier] ||
+        owned_[tier]->stackHighWatermark() * 100 <=
+            stackSizes_[tier] * kTierStackLimitPercent) {
+      continue;
+    }
+    retired_[tier] = true;
+    for (auto& type : types_) {
+      // Types only leave the large tier after being probed.
+      if (type.tier == tier) {
+        type.tier = pickTier(type.probe->stackHighWatermark());
+      }
+    }
+  }
+}
+
+FiberStackTiers::Tier FiberStackTiers::pickTier(
+    size_t stackHighWatermark) const {
+  for (size_t tier = kSmall; tier < kLarge; ++tier) {
+    if (owned_[tier] && !retired_[tier] &&
+        stackHighWatermark * kStackHeadroom <= stackSizes_[tier]) {
+      return static_cast<Tier>(tier);
+    }
+  }
+  return kLarge;
+}
+
+size_t FiberStackTiers::runQueueSize() const {
+  size_t size = large_.runQueueSize();
+  if (!enabled_) {
+    return size;
+  }
+  for (const auto& fm : owned_) {
+    if (fm) {
+      size += fm->runQueueSize();
+    }
+  }
+  for (auto fm : probes_) {
+    size += fm->runQueueSize();
+  }
+  return size;
+}
+
+void FiberStackTiers::releaseFreeMemory() {
+#ifdef __GLIBC__
+  // Gives whole free pages of all malloc arenas back with
+  // madvise(MADV_DONTNEED).
+  ::malloc_trim(0);
+#endif
+}
+
+} // namespace mcrouter
+} // namespace memcache
+} // namespace facebook
@@ -0,0 +1,219 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include <folly/fibers/FiberManager.h>
+
+namespace folly {
+class VirtualEventBase;
+} // namespace folly
+
+namespace facebook {
+namespace memcache {
+namespace mcrouter {
+
+/**
+ * Runs requests of a proxy on fibers with small, medium or large stacks,
+ * depending on how much stack their request type was observed to use.
+ *
+ * The large tier is the proxy's main FiberManager (fibers_stack_size). The
+ * small and medium tiers are extra FiberManagers on the same event base,
+ * enabled by setting fibers_small_stack_size/fibers_medium_stack_size.
+ *
+ * Every request type starts on the large tier. One request of every
+ * fibers_stack_tier_probe_every of each type runs on a FiberManager of its
+ * own (large stacks, stack usage recorded for every fiber), whose high
+ * watermark is the deepest stack seen for the type, including the fibers
+ * it spawned (e.g. shadow requests). After kMinProbes probes, the type moves
+ * to the smallest tier with at least kStackHeadroom times that much stack.
+ * High watermarks never go down, so from then on types only move to larger
+ * tiers.
+ *
+ * Probes can miss the deepest requests of a type, so the small and medium
+ * tiers also record the stack used by one fiber out of probeEvery. Once a
+ * tier's watermark exceeds kTierStackLimitPercent of its stack, the tier is
+ * retired: the types on it move to larger tiers, and no type is moved to it
+ * anymore. Fibers of the small and medium tiers always have guard pages,
+ * whatever the options of the large tier, so that a request overflowing
+ * its stack crashes instead of corrupting memory. Only a limited number of
+ * stacks get guard pages in folly, so the small and medium stacks are also
+ * never smaller than kMinTierStackSize.
+ *
+ * A new config can make routes deeper: when it is swapped in, every type
+ * goes back to the large tier and is probed again from scratch.
+ *
+ * Not thread-safe, except for requestReset() and the stats accessors (racy
+ * reads, like other proxy stats).
+ */
+class FiberStackTiers {
+ public:
+  enum Tier : uint8_t {
+    kSmall = 0,
+    kMedium = 1,
+    kLarge = 2,
+  };
+  static constexpr size_t kNumTiers = 3;
+
+  // Types with larger ids always use the large tier.
+  static constexpr size_t kMaxTypeId = 256;
+  static constexpr size_t kMinProbes = 16;
+  static constexpr size_t kStackHeadroom = 2;
+  static constexpr size_t kTierStackLimitPercent = 75;
+  // Smaller small and medium stack sizes are raised to this.
+  static constexpr size_t kMinTierStackSize = 16 * 1024;
+
+  using FiberManagerFactory =
+      std::function<std::unique_ptr<folly::fibers::FiberManager>(
+          const folly::fibers::FiberManager::Options&)>;
+
+  /**
+   * @param large            FiberManager of the large tier.
+   * @param options          Options of the large tier, other tiers only
+   *                         differ by stack size.
+   * @param smallStackSize   Stack size of the small tier, 0 to disable it.
+   * @param mediumStackSize  Stack size of the medium tier, 0 to disable it.
+   * @param probeEvery       Probe one request out of probeEvery per type.
+   * @param makeFiberManager Creates a FiberManager with an (unattached)
+   *                         EventBaseLoopController and the proxy's fiber
+   *                         locals.
+   */
+  FiberStackTiers(
+      folly::fibers::FiberManager& large,
+      const folly::fibers::FiberManager::Options& options,
+      size_t smallStackSize,
+      size_t mediumStackSize,
+      size_t probeEvery,
+      FiberManagerFactory makeFiberManager);
+
+  FiberStackTiers(const FiberStackTiers&) = delete;
+  FiberStackTiers& operator=(const FiberStackTiers&) = delete;
+
+  ~FiberStackTiers();
+
+  bool enabled() const {
+    return enabled_;
+  }
+
+  /**
+   * Attaches the FiberManagers of the small and medium tiers, and the ones
+   * created later, to the event base of the proxy. The large tier is
+   * attached by the proxy.
+   */
+  void attachEventBase(folly::VirtualEventBase& evb);
+
+  /**
+   * @return  FiberManager to run a request of the given type on.
+   */
+  folly::fibers::FiberManager& fiberManagerFor(size_t typeId) {
+    if (!enabled_ || typeId >= types_.size()) {
+      return large_;
+    }
+    if (resetPending_.load(std::memory_order_acquire)) {
+      reset();
+    }
+    auto& type = types_[typeId];
+    if (--type.probeCountdown == 0) {
+      return probe(type);
+    }
+    return *tiers_[type.tier];
+  }
+
+  /**
+   * Moves every type back to the large tier and forgets the stack usage
+   * probed so far, before the next request is run. Can be called from any
+   * thread; must be called before a new config becomes visible to the
+   * proxy.
+   */
+  void requestReset() {
+    resetPending_.store(true, std::memory_order_release);
+  }
+
+  /**
+   * @return  Tier of the given request type.
+   */
+  Tier tierFor(size_t typeId) const {
+    return enabled_ && typeId < types_.size() ? types_[typeId].tier : kLarge;
+  }
+
+  /**
+   * @return  Number of tasks ready to run, on all FiberManagers.
+   */
+  size_t runQueueSize() const;
+
+  /**
+   * Calls f on the FiberManager of every enabled tier (but not the probes).
+   */
+  template <class F>
+  void forEachTier(F&& f) const {
+    f(large_);
+    for (const auto& fm : owned_) {
+      if (fm) {
+        f(*fm);
+      }
+    }
+  }
+
+  /**
+   * Returns the memory of freed fiber stacks (and other free heap pages)
+   * to the system.
+   */
+  static void releaseFreeMemory();
+
+ private:
+  struct TypeState {
+    Tier tier{kLarge};
+    size_t probeCountdown{0};
+    size_t probes{0};
+    std::unique_ptr<folly::fibers::FiberManager> probe;
+  };
+
+  folly::fibers::FiberManager& large_;
+  const bool enabled_;
+  const size_t probeEvery_;
+  folly::fibers::FiberManager::Options options_;
+  std::array<size_t, kNumTiers> stackSizes_;
+  FiberManagerFactory makeFiberManager_;
+  folly::VirtualEventBase* evb_{nullptr};
+
+  std::array<std::unique_ptr<folly::fibers::FiberManager>, kLarge> owned_;
+  // Disabled tiers point to the next larger one.
+  std::array<folly::fibers::FiberManager*, kNumTiers> tiers_;
+
+  std::vector<TypeState> types_;
+  // Probes of all types, and the ones still running fibers after a reset.
+  std::vector<folly::fibers::FiberManager*> probes_;
+  std::vector<std::unique_ptr<folly::fibers::FiberManager>> drainingProbes_;
+  std::atomic<bool> resetPending_{false};
+
+  // Tiers whose watermark got too close to their stack size.
+  std::array<bool, kLarge> retired_{};
+
+  folly::fibers::FiberManager& probe(TypeState& type);
+
+  Tier pickTier(size_t stackHighWatermark) const;
+
+  void retireOverflowingTiers();
+
+  void reset();
+
+  void releaseDrainedProbes();
+
+  void attach(folly::fibers::FiberManager& fm);
+};
+
+} // namespace mcrouter
+} // namespace memcache
+} // namespace facebook
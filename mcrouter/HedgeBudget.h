@@ -0,0 +1,67 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <algorithm>
+
+namespace facebook {
+namespace memcache {
+namespace mcrouter {
+
+/**
+ * Caps the number of hedged requests (speculative copies of slow requests
+ * sent by FailoverRoute to the next destination) to a fraction of all
+ * requests that could have been hedged.
+ *
+ * Every request eligible for hedging earns `ratio` tokens, up to `burst`,
+ * and every hedge spends one token. Counting requests instead of time keeps
+ * the extra load a fixed fraction of the traffic, whatever the request rate.
+ *
+ * Shared by all routes of a proxy. Not thread-safe.
+ */
+class HedgeBudget {
+ public:
+  static constexpr double kDefaultBurst = 100;
+
+  /**
+   * @param ratio  Max fraction of eligible requests that can be hedged,
+   *               in [0, 1].
+   * @param burst  Max number of hedges that can be sent back to back.
+   */
+  explicit HedgeBudget(double ratio, double burst = kDefaultBurst)
+      : ratio_(std::min(std::max(ratio, 0.0), 1.0)),
+        burst_(std::max(burst, 1.0)),
+        tokens_(ratio_ > 0 ? burst_ : 0) {}
+
+  /**
+   * Must be called for every request that is eligible for hedging.
+   */
+  void onRequest() {
+    tokens_ = std::min(tokens_ + ratio_, burst_);
+  }
+
+  /**
+   * @return true if a hedge can be sent now (and accounts for it).
+   */
+  bool tryConsume() {
+    if (tokens_ < 1.0) {
+      return false;
+    }
+    tokens_ -= 1.0;
+    return true;
+  }
+
+ private:
+  const double ratio_;
+  const double burst_;
+  double tokens_;
+};
+
+} // namespace mcrouter
+} // namespace memcache
+} // namespace facebook
@@ -0,0 +1,228 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include "KeyPrefixStats.h"
+
+#include <algorithm>
+#include <cstring>
+#include <map>
+#include <thread>
+#include <utility>
+
+#include <folly/hash/Hash.h>
+#include <folly/lang/Bits.h>
+
+#include "mcrouter/lib/fbi/hash.h"
+
+namespace facebook {
+namespace memcache {
+namespace mcrouter {
+
+namespace {
+
+// Records between two decays, per slot.
+constexpr uint64_t kDecayPeriodPerSlot = 4096;
+
+} // anonymous namespace
+
+constexpr size_t KeyPrefixStats::kWays;
+constexpr size_t KeyPrefixStats::kMaxPrefixSize;
+constexpr size_t KeyPrefixStats::kMaxPoolNameSize;
+
+KeyPrefixStats::Counters& KeyPrefixStats::Counters::operator+=(
+    const Counters& other) {
+  requests += other.requests;
+  bytesOut += other.bytesOut;
+  bytesIn += other.bytesIn;
+  errors += other.errors;
+  totalDurationUs += other.totalDurationUs;
+  return *this;
+}
+
+KeyPrefixStats::KeyPrefixStats(size_t capacity, char delimiter, size_t depth)
+    : delimiter_(delimiter),
+      depth_(depth),
+      bucketMask_(
+          folly::nextPowTwo(std::max<size_t>(capacity, kWays) / kWays) - 1),
+      decayPeriod_((bucketMask_ + 1) * kWays * kDecayPeriodPerSlot),
+      recordsUntilDecay_(decayPeriod_),
+      hashes_((bucketMask_ + 1) * kWays, 0),
+      slots_((bucketMask_ + 1) * kWays) {}
+
+folly::StringPiece KeyPrefixStats::extractPrefix(folly::StringPiece key) const {
+  size_t size = 0;
+  if (delimiter_ == '\0') {
+    size = std::min(key.size(), depth_);
+  } else {
+    const char* begin = key.data();
+    const char* end = key.end();
+    for (size_t i = 0; i < depth_ && begin < end; ++i) {
+      auto pos = static_cast<const char*>(
+          std::memchr(begin, delimiter_, end - begin));
+      if (pos == nullptr) {
+        break;
+      }
+      size = pos - key.data();
+      begin = pos + 1;
+    }
+  }
+  return key.subpiece(0, std::min(size, kMaxPrefixSize));
+}
+
+void KeyPrefixStats::record(
+    folly::StringPiece poolName,
+    folly::StringPiece key,
+    uint64_t bytesOut,
+    uint64_t bytesIn,
+    bool error,
+    uint64_t durationUs) {
+  const auto prefix = extractPrefix(key);
+  poolName = poolName.subpiece(0, kMaxPoolNameSize);
+  // Pool names come from routes, a proxy typically sends to a few pools.
+  if (poolName != lastPoolName_) {
+    lastPoolName_.assign(poolName.data(), poolName.size());
+    lastPoolNameHash_ = murmur_hash_64A(poolName.data(), poolName.size(), 0);
+  }
+  // murmur_hash_64A only takes a 32 bit seed: combine the two hashes instead
+  // to keep all 64 bits of the pool name's. 0 marks empty slots.
+  const uint64_t hash = folly::hash::hash_128_to_64(
+                            lastPoolNameHash_,
+                            murmur_hash_64A(prefix.data(), prefix.size(), 0)) |
+      1;
+
+  bool found = false;
+  const size_t index = find(hash, found);
+  auto& slot = slots_[index];
+  // Readers retry while the version is odd, or if it changed meanwhile.
+  const auto version = slot.version.load(std::memory_order_relaxed);
+  slot.version.store(version + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+
+  if (!found) {
+    // Space-Saving: the new prefix may have had up to the evicted weight.
+    hashes_[index] = hash;
+    slot.maxUndercount = slot.weight;
+    slot.counters = Counters();
+    slot.prefixSize = prefix.size();
+    slot.poolNameSize = poolName.size();
+    std::memcpy(slot.prefix, prefix.data(), prefix.size());
+    std::memcpy(slot.poolName, poolName.data(), poolName.size());
+  }
+  ++slot.weight;
+  ++slot.counters.requests;
+  slot.counters.bytesOut += bytesOut;
+  slot.counters.bytesIn += bytesIn;
+  slot.counters.errors += error ? 1 : 0;
+  slot.counters.totalDurationUs += durationUs;
+  slot.version.store(version + 2, std::memory_order_release);
+
+  if (--recordsUntilDecay_ == 0) {
+    decay();
+  }
+}
+
+size_t KeyPrefixStats::find(uint64_t hash, bool& found) const {
+  const size_t first = ((hash >> 32) & bucketMask_) * kWays;
+  const uint64_t* hashes = hashes_.data() + first;
+  // Prefixes are only compared by hash: with 64 bits, collisions between
+  // the few prefixes sharing a bucket are negligible.
+  for (size_t i = 0; i < kWays; ++i) {
+    if (hashes[i] == hash) {
+      found = true;
+      return first + i;
+    }
+  }
+
+  size_t victim = 0;
+  for (size_t i = 1; i < kWays; ++i) {
+    if (slots_[first + i].weight < slots_[first + victim].weight) {
+      victim = i;
+    }
+  }
+  found = false;
+  return first + victim;
+}
+
+void KeyPrefixStats::decay() {
+  for (auto& slot : slots_) {
+    slot.weight /= 2;
+  }
+  recordsUntilDecay_ = decayPeriod_;
+}
+
+std::vector<KeyPrefixStats::Entry> KeyPrefixStats::getEntries() const {
+  std::vector<Entry> entries;
+  for (size_t i = 0; i < slots_.size(); ++i) {
+    const auto& slot = slots_[i];
+    Entry entry;
+    bool empty = true;
+    while (true) {
+      const auto version = slot.version.load(std::memory_order_acquire);
+      if (version & 1) {
+        // Updates are a handful of stores.
+        std::this_thread::yield();
+        continue;
+      }
+      empty = hashes_[i] == 0;
+      if (!empty) {
+        // Sizes may be torn until the version is checked, they are clamped
+        // to stay within the slot.
+        entry.prefix.assign(
+            slot.prefix, std::min<size_t>(slot.prefixSize, kMaxPrefixSize));
+        entry.poolName.assign(
+            slot.poolName,
+            std::min<size_t>(slot.poolNameSize, kMaxPoolNameSize));
+        entry.counters = slot.counters;
+        entry.maxUndercount = slot.maxUndercount;
+      }
+      std::atomic_thread_fence(std::memory_order_acquire);
+      if (slot.version.load(std::memory_order_relaxed) == version) {
+        break;
+      }
+    }
+    if (!empty) {
+      entries.push_back(std::move(entry));
+    }
+  }
+  return entries;
+}
+
+std::vector<KeyPrefixStats::Entry> KeyPrefixStats::merge(
+    const std::vector<std::vector<Entry>>& entries,
+    size_t maxEntries) {
+  std::map<std::pair<std::string, std::string>, Entry> merged;
+  for (const auto& proxyEntries : entries) {
+    for (const auto& entry : proxyEntries) {
+      auto it = merged.emplace(
+          std::make_pair(entry.poolName, entry.prefix), Entry());
+      auto& mergedEntry = it.first->second;
+      if (it.second) {
+        mergedEntry.poolName = entry.poolName;
+        mergedEntry.prefix = entry.prefix;
+      }
+      mergedEntry.counters += entry.counters;
+      mergedEntry.maxUndercount += entry.maxUndercount;
+    }
+  }
+
+  std::vector<Entry> result;
+  result.reserve(merged.size());
+  for (auto& it : merged) {
+    result.push_back(std::move(it.second));
+  }
+  std::sort(result.begin(), result.end(), [](const Entry& a, const Entry& b) {
+    return a.counters.requests > b.counters.requests;
+  });
+  if (result.size() > maxEntries) {
+    result.resize(maxEntries);
+  }
+  return result;
+}
+
+} // mcrouter
+} // memcache
+} // facebook
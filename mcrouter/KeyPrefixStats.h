@@ -0,0 +1,154 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <folly/Range.h>
+
+namespace facebook {
+namespace memcache {
+namespace mcrouter {
+
+/**
+ * Per (pool, key prefix) traffic accounting, with bounded memory.
+ *
+ * The prefix of a key is made of its first `depth` components separated by
+ * `delimiter` (without the trailing delimiter), or of its first `depth`
+ * bytes if there is no delimiter. Keys with fewer delimiters keep the
+ * components before their last delimiter, i.e. keys without a delimiter at
+ * all get an empty prefix.
+ *
+ * Prefixes are tracked in a set associative table of heavy hitters: a
+ * (pool, prefix) is identified by a 64 bit hash, that picks a bucket of
+ * kWays slots, and a new prefix replaces the least requested prefix of its
+ * bucket (Space-Saving). Counters of a prefix are exact since it got its
+ * slot; maxUndercount estimates the requests it had before. Weights used
+ * for eviction are halved periodically, so that prefixes that stopped
+ * getting traffic eventually make room.
+ *
+ * Recording is a hash and a scan of a single bucket. record() must always
+ * be called from the same thread: every proxy has its own instance.
+ * getEntries() may be called from any thread, every slot is guarded by a
+ * sequence lock, and snapshots of all instances are merged at stats time.
+ */
+class KeyPrefixStats {
+ public:
+  static constexpr size_t kWays = 8;
+  // Longer prefixes and pool names are truncated.
+  static constexpr size_t kMaxPrefixSize = 64;
+  static constexpr size_t kMaxPoolNameSize = 64;
+
+  struct Counters {
+    uint64_t requests{0};
+    // Sent to the destination.
+    uint64_t bytesOut{0};
+    // Received from the destination.
+    uint64_t bytesIn{0};
+    uint64_t errors{0};
+    uint64_t totalDurationUs{0};
+
+    Counters& operator+=(const Counters& other);
+  };
+
+  struct Entry {
+    std::string poolName;
+    std::string prefix;
+    Counters counters;
+    // Estimated max number of requests missed before the prefix got its
+    // slot.
+    uint64_t maxUndercount{0};
+  };
+
+  /**
+   * @param capacity   Max number of prefixes tracked, rounded up to a power
+   *                   of two multiple of kWays.
+   * @param delimiter  Component delimiter, '\0' for none.
+   * @param depth      Number of components (or bytes) in a prefix.
+   */
+  KeyPrefixStats(size_t capacity, char delimiter, size_t depth);
+
+  KeyPrefixStats(const KeyPrefixStats&) = delete;
+  KeyPrefixStats& operator=(const KeyPrefixStats&) = delete;
+
+  folly::StringPiece extractPrefix(folly::StringPiece key) const;
+
+  void record(
+      folly::StringPiece poolName,
+      folly::StringPiece key,
+      uint64_t bytesOut,
+      uint64_t bytesIn,
+      bool error,
+      uint64_t durationUs);
+
+  size_t capacity() const {
+    return slots_.size();
+  }
+
+  /**
+   * Copies every prefix tracked. Safe to call from another thread than the
+   * one recording: each entry is a consistent snapshot of its slot, although
+   * different slots may be copied at different times.
+   */
+  std::vector<Entry> getEntries() const;
+
+  /**
+   * Merges the entries of several instances, summing up the counters of
+   * the same (pool, prefix), and keeps the maxEntries most requested.
+   */
+  static std::vector<Entry> merge(
+      const std::vector<std::vector<Entry>>& entries,
+      size_t maxEntries);
+
+ private:
+  struct Slot {
+    // Odd while the recording thread updates the slot (or its hash).
+    std::atomic<uint32_t> version{0};
+    // Only accessed by the recording thread.
+    uint64_t weight{0};
+    uint64_t maxUndercount{0};
+    Counters counters;
+    uint8_t prefixSize{0};
+    uint8_t poolNameSize{0};
+    char prefix[kMaxPrefixSize];
+    char poolName[kMaxPoolNameSize];
+  };
+
+  const char delimiter_;
+  const size_t depth_;
+  const size_t bucketMask_;
+  // Weights are halved every decayPeriod_ records.
+  const uint64_t decayPeriod_;
+  uint64_t recordsUntilDecay_;
+
+  // Hash of the pool name last recorded, keyed by its contents: the
+  // address of a pool name may be reused by another one after a reconfigure.
+  std::string lastPoolName_;
+  uint64_t lastPoolNameHash_{0};
+
+  // kWays hashes per bucket, packed so a lookup touches a single cache line.
+  // 0 means empty slot.
+  std::vector<uint64_t> hashes_;
+  std::vector<Slot> slots_;
+
+  /**
+   * @return  Index of the slot of the given hash, or of the slot to evict for
+   *          it if there is none (in which case `found` is false).
+   */
+  size_t find(uint64_t hash, bool& found) const;
+
+  void decay();
+};
+
+} // mcrouter
+} // memcache
+} // facebook
@@ -61,6 +61,7 @@ class fiber_local {
     bool failoverTag{false};
     bool failoverDisabled{false};
     int32_t selectedIndex{-1};
+    int32_t routeProfileFrame{-1};
   };
 
  public:
@@ -202,6 +203,26 @@ class fiber_local {
     return folly::fibers::local<McrouterFiberContext>().failoverDisabled;
   }
 
+  /**
+   * Set the RouteProfileTrace frame of the route handle being executed by
+   * current fiber (thread, if we're not on fiber), -1 for none
+   */
+  static void setRouteProfileFrame(int32_t frame) {
+    folly::fibers::local<McrouterFiberContext>().routeProfileFrame = frame;
+  }
+
+  static int32_t getRouteProfileFrame() {
+    return folly::fibers::local<McrouterFiberContext>().routeProfileFrame;
+  }
+
+  /**
+   * Identifies current fiber (thread, if we're not on fiber) among the ones
+   * running at the same time: the address of its locals.
+   */
+  static const void* getContextId() {
+    return &folly::fibers::local<McrouterFiberContext>();
+  }
+
   static void setServerLoad(ServerLoad load) {
     folly::fibers::local<McrouterFiberContext>().load = load;
   }
@@ -206,9 +206,7 @@ void McrouterLogger::log() {
     loggedStartupOptions_ = true;
   }
 
-  std::vector<stat_t> stats(num_stats);
-  prepare_stats(router_, stats.data());
-  append_pool_stats(router_, stats);
+  const auto stats = prepare_aggregated_stats(router_);
 
   folly::dynamic requestStats(folly::dynamic::object());
   for (size_t i = 0; i < router_.opts().num_proxies; ++i) {
@@ -219,19 +217,6 @@ void McrouterLogger::log() {
     }
   }
 
-  for (int i = 0; i < num_stats; ++i) {
-    if (stats[i].group & rate_stats) {
-      stats[i].type = stat_double;
-      stats[i].data.dbl = stats_aggregate_rate_value(router_, i);
-    } else if (stats[i].group & max_stats) {
-      stats[i].type = stat_uint64;
-      stats[i].data.uint64 = stats_aggregate_max_value(router_, i);
-    } else if (stats[i].group & max_max_stats) {
-      stats[i].type = stat_uint64;
-      stats[i].data.uint64 = stats_aggregate_max_max_value(router_, i);
-    }
-  }
-
   write_stats_to_disk(router_.opts(), stats, requestStats);
   write_config_sources_info_to_disk(router_);
 
@@ -5,6 +5,9 @@
  * LICENSE file in the root directory of this source tree.
  */
 
+#include <unordered_map>
+
+#include <folly/Conv.h>
 #include <folly/Range.h>
 #include <folly/fibers/EventBaseLoopController.h>
 
@@ -69,6 +72,11 @@ void Proxy<RouterInfo>::WaitingRequest<Request>::process(
     }
   }
 
+  if (ctx_->deadlineExpired()) {
+    proxy->replyDeadlineExpired(*ctx_);
+    return;
+  }
+
   proxy->processRequest(req_, std::move(ctx_));
 }
 
@@ -81,13 +89,45 @@ Proxy<RouterInfo>::addRouteTask(
     std::shared_ptr<ProxyRequestContextTyped<RouterInfo, Request>> sharedCtx) {
   requestStats_.template bump<Request>(carbon::RouterStatTypes::Incoming);
 
+  if (auto profiler = routeProfiler()) {
+    if (profiler->shouldSample()) {
+      sharedCtx->startRouteProfile();
+    }
+  }
+
+  // Profiled requests go through the whole tree, to record all of it.
+  typename RouterInfo::RouteHandleIf* directTarget = nullptr;
+  if (getRouterOptions().direct_routing && !sharedCtx->routeProfileTrace()) {
+    directTarget = sharedCtx->proxyRoute().directTarget(req);
+    if (directTarget) {
+      stats().increment(direct_routed_requests_count_stat);
+      // Only the destination is left to route to: when it can be sent to
+      // without blocking, the request doesn't need a fiber at all.
+      auto& proute = sharedCtx->proxyRoute();
+      auto* ctx = sharedCtx.get();
+      if (proute.routeDirectAsync(
+              *directTarget,
+              req,
+              sharedCtx,
+              [ctx](ReplyT<Request>&& reply) {
+                ctx->sendReply(std::move(reply));
+              })) {
+        stats().increment(direct_routed_inline_requests_count_stat);
+        return;
+      }
+    }
+  }
+
   auto funcCtx = sharedCtx;
 
-  fiberManager().addTaskFinally(
-      [&req, ctx = std::move(funcCtx)]() mutable {
+  fiberStackTiers().fiberManagerFor(Request::typeId).addTaskFinally(
+      [&req, directTarget, ctx = std::move(funcCtx)]() mutable {
         try {
           auto& proute = ctx->proxyRoute();
           fiber_local<RouterInfo>::setSharedCtx(std::move(ctx));
+          if (directTarget) {
+            return proute.routeDirect(*directTarget, req);
+          }
           return proute.route(req);
         } catch (const std::exception& e) {
           auto err = folly::sformat(
@@ -134,6 +174,16 @@ void Proxy<RouterInfo>::routeHandlesProcessRequest(
   addRouteTask(req, std::move(sharedCtx));
 }
 
+template <class RouterInfo>
+template <class Request>
+void Proxy<RouterInfo>::replyDeadlineExpired(
+    ProxyRequestContextTyped<RouterInfo, Request>& ctx) {
+  stats().increment(request_deadline_expired_stat);
+  ReplyT<Request> reply(carbon::Result::TIMEOUT);
+  carbon::setMessageIfPresent(reply, "Request deadline exceeded");
+  ctx.sendReply(std::move(reply));
+}
+
 template <class RouterInfo>
 template <class Request>
 void Proxy<RouterInfo>::processRequest(
@@ -155,6 +205,10 @@ template <class Request>
 void Proxy<RouterInfo>::dispatchRequest(
     const Request& req,
     std::unique_ptr<ProxyRequestContextTyped<RouterInfo, Request>> ctx) {
+  if (ctx->deadlineExpired()) {
+    replyDeadlineExpired(*ctx);
+    return;
+  }
   if (rateLimited(ctx->priority(), req)) {
     if (getRouterOptions().proxy_max_throttled_requests > 0 &&
         numRequestsWaiting_ >=
@@ -162,7 +216,10 @@ void Proxy<RouterInfo>::dispatchRequest(
       ctx->sendReply(carbon::Result::BUSY);
       return;
     }
-    auto& queue = waitingRequests_[static_cast<int>(ctx->priority())];
+    auto& queue = *waitingRequests_[static_cast<int>(ctx->priority())];
+    auto tenant = getRouterOptions().proxy_fair_queuing
+        ? ctx->tenant()
+        : folly::StringPiece();
     auto w = std::make_unique<WaitingRequest<Request>>(req, std::move(ctx));
     // Only enable timeout on waitingRequests_ queue when queue throttling is
     // enabled
@@ -171,7 +228,7 @@ void Proxy<RouterInfo>::dispatchRequest(
         getRouterOptions().waiting_request_timeout_ms > 0) {
       w->setTimePushedOnQueue(nowUs());
     }
-    queue.pushBack(std::move(w));
+    queue.push(tenant, std::move(w), nowUs());
     ++numRequestsWaiting_;
     stats().increment(proxy_reqs_waiting_stat);
   } else {
@@ -184,7 +241,7 @@ Proxy<RouterInfo>::Proxy(
     CarbonRouterInstanceBase& rtr,
     size_t id,
     folly::VirtualEventBase& evb)
-    : ProxyBase(rtr, id, evb, RouterInfo()) {
+    : ProxyBase(rtr, id, evb, RouterInfo()), createdAtUs_(nowUs()) {
   messageQueue_ = std::make_unique<MessageQueue<ProxyMessage>>(
       router().opts().client_queue_size,
       [this](ProxyMessage&& message) {
@@ -195,7 +252,7 @@ Proxy<RouterInfo>::Proxy(
       &nowUs,
       [this]() { stats().incrementSafe(client_queue_notifications_stat); },
       [this, noFlushLoops = 0](bool last) mutable {
-        bool haveTasks = fiberManager().runQueueSize() != 0;
+        bool haveTasks = fiberStackTiers().runQueueSize() != 0;
         if (!last) {
           // If we have tasks in fiber manager, or we have pending flushes, then
           // we can guarantee that we won't block event loop.
@@ -211,6 +268,20 @@ Proxy<RouterInfo>::Proxy(
         }
         return false;
       });
+
+  std::unordered_map<std::string, size_t> weights;
+  for (const auto& it : router().opts().proxy_fair_queue_weights) {
+    auto weight = folly::tryTo<size_t>(it.second);
+    if (weight.hasValue() && *weight > 0) {
+      weights.emplace(it.first, *weight);
+    } else {
+      LOG(ERROR) << "Invalid proxy-fair-queue-weights weight for '"
+                 << it.first << "': " << it.second;
+    }
+  }
+  for (auto& queue : waitingRequests_) {
+    queue = std::make_unique<FairRequestQueue>(weights);
+  }
 }
 
 template <class RouterInfo>
@@ -227,6 +298,7 @@ Proxy<RouterInfo>* Proxy<RouterInfo>::createProxy(
     dynamic_cast<folly::fibers::EventBaseLoopController&>(
         proxyPtr->fiberManager().loopController())
         .attachEventBase(eventBase);
+    proxyPtr->fiberStackTiers().attachEventBase(eventBase);
 
     std::chrono::milliseconds connectionResetInterval{
         proxyPtr->router().opts().reset_inactive_connection_interval};
@@ -363,25 +435,79 @@ void Proxy<RouterInfo>::routeHandlesProcessRequest(
 
 template <class RouterInfo>
 void Proxy<RouterInfo>::pump() {
+  if (numWarmUpsInProgress_ > 0) {
+    return;
+  }
+  const auto maxInflight = router().opts().proxy_max_inflight_requests;
   auto numPriorities = static_cast<int>(ProxyRequestPriority::kNumPriorities);
   for (int i = 0; i < numPriorities; ++i) {
-    auto& queue = waitingRequests_[i];
-    while (numRequestsProcessing_ <
-               router().opts().proxy_max_inflight_requests &&
+    auto& queue = *waitingRequests_[i];
+    while ((maxInflight == 0 || numRequestsProcessing_ < maxInflight) &&
            !queue.empty()) {
       --numRequestsWaiting_;
-      auto w = queue.popFront();
+      auto w = queue.pop(nowUs());
       stats().decrement(proxy_reqs_waiting_stat);
 
-      w->process(this);
+      static_cast<WaitingRequestBase&>(*w).process(this);
+    }
+  }
+}
+
+template <class RouterInfo>
+folly::dynamic Proxy<RouterInfo>::dumpWaitingTenants() const {
+  folly::dynamic result = folly::dynamic::object;
+  auto numPriorities = static_cast<int>(ProxyRequestPriority::kNumPriorities);
+  for (int i = 0; i < numPriorities; ++i) {
+    auto tenants = waitingRequests_[i]->dumpTenantStats();
+    if (!tenants.empty()) {
+      result[folly::to<std::string>(i)] = std::move(tenants);
     }
   }
+  return result;
+}
+
+template <class RouterInfo>
+void Proxy<RouterInfo>::warmUpDestinations() {
+  const auto& opts = router().opts();
+  if (opts.destination_warmup_timeout_ms == 0) {
+    markReady();
+    return;
+  }
+
+  ++numWarmUpsInProgress_;
+  eventBase().runInEventBaseThread([this, &opts]() {
+    destinationMap()->warmUp(
+        opts.destination_warmup_concurrency,
+        opts.destination_warmup_rate,
+        std::chrono::milliseconds(opts.destination_warmup_timeout_ms),
+        [this]() {
+          if (--numWarmUpsInProgress_ == 0) {
+            markReady();
+            pump();
+          }
+        });
+  });
+}
+
+template <class RouterInfo>
+void Proxy<RouterInfo>::markReady() {
+  if (stats().getValue(startup_to_ready_ms_stat) == 0) {
+    stats().setValue(
+        startup_to_ready_ms_stat,
+        std::max<int64_t>((nowUs() - createdAtUs_) / 1000, 1));
+  }
 }
 
 template <class RouterInfo>
 void proxy_config_swap(
     Proxy<RouterInfo>* proxy,
     std::shared_ptr<ProxyConfig<RouterInfo>> config) {
+  // Start holding requests before the new config can be used. Destinations of
+  // the new config were created when it was built, so the warm-up sees them
+  // all, even if it starts before the swap.
+  proxy->warmUpDestinations();
+  // The new config may need deeper stacks than probed with the old one.
+  proxy->fiberStackTiers().requestReset();
   auto oldConfig = proxy->swapConfig(std::move(config));
   proxy->stats().setValue(config_last_success_stat, time(nullptr));
 
@@ -403,11 +529,14 @@ template <class Request>
 typename std::enable_if<!TNotRateLimited<Request>::value, bool>::type
 Proxy<RouterInfo>::rateLimited(ProxyRequestPriority priority, const Request&)
     const {
+  if (numWarmUpsInProgress_ > 0) {
+    return true;
+  }
   if (!getRouterOptions().proxy_max_inflight_requests) {
     return false;
   }
 
-  if (waitingRequests_[static_cast<int>(priority)].empty() &&
+  if (waitingRequests_[static_cast<int>(priority)]->empty() &&
       numRequestsProcessing_ < getRouterOptions().proxy_max_inflight_requests) {
     return false;
   }
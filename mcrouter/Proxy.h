@@ -27,6 +27,7 @@
 #include <folly/concurrency/CacheLocality.h>
 
 #include "mcrouter/ExponentialSmoothData.h"
+#include "mcrouter/FairRequestQueue.h"
 #include "mcrouter/ProxyBase.h"
 #include "mcrouter/ProxyRequestPriority.h"
 #include "mcrouter/config.h"
@@ -131,10 +132,25 @@ class Proxy : public ProxyBase {
     return requestStats_.dump(filterZeroes);
   }
 
+  /**
+   * @return  Queue depth and wait times of the tenants of the waiting
+   *          requests queues, by priority.
+   */
+  folly::dynamic dumpWaitingTenants() const;
+
   void advanceRequestStatsBin() override {
     requestStats().advanceBin();
   }
 
+  /**
+   * Opens connections to the destinations that were never connected, holding
+   * new requests until done or destination_warmup_timeout_ms passed.
+   * If warm-up is disabled, only marks the proxy as ready.
+   *
+   * Can be called from any thread; called on every config swap.
+   */
+  void warmUpDestinations();
+
  private:
   // If true, processing new requests is not safe.
   bool beingDestroyed_{false};
@@ -147,6 +163,15 @@ class Proxy : public ProxyBase {
 
   std::unique_ptr<MessageQueue<ProxyMessage>> messageQueue_;
 
+  // When this proxy was created, for startup_to_ready_ms.
+  const int64_t createdAtUs_;
+  // Warm-ups in progress. While non-zero, new requests wait in
+  // waitingRequests_.
+  std::atomic<size_t> numWarmUpsInProgress_{0};
+
+  // Records startup_to_ready_ms the first time it's called.
+  void markReady();
+
   static Proxy<RouterInfo>* createProxy(
       CarbonRouterInstanceBase& router,
       folly::VirtualEventBase& evb,
@@ -193,6 +218,10 @@ class Proxy : public ProxyBase {
       const Request& req,
       std::unique_ptr<ProxyRequestContextTyped<RouterInfo, Request>> ctx);
 
+  // Reply to a request whose deadline passed before it was routed
+  template <class Request>
+  void replyDeadlineExpired(ProxyRequestContextTyped<RouterInfo, Request>& ctx);
+
   // Process request (update stats and route the request)
   template <class Request>
   void processRequest(
@@ -205,15 +234,8 @@ class Proxy : public ProxyBase {
    * proxy.h -> ProxyRequestContext.h -> ProxyRequestLogger.h ->
    * ProxyRequestLogger-inl.h -> proxy.h
    */
-  class WaitingRequestBase {
-    UniqueIntrusiveListHook hook;
-
+  class WaitingRequestBase : public FairRequestQueueEntry {
    public:
-    using Queue =
-        UniqueIntrusiveList<WaitingRequestBase, &WaitingRequestBase::hook>;
-
-    virtual ~WaitingRequestBase() = default;
-
     /**
      * Continue processing proxy request.
      *
@@ -243,8 +265,12 @@ class Proxy : public ProxyBase {
     int64_t timePushedOnQueue_{-1};
   };
 
-  /** Queue of requests we didn't start processing yet */
-  typename WaitingRequestBase::Queue
+  /**
+   * Queues of requests we didn't start processing yet, one per priority.
+   * Requests of the same priority are served fairly between tenants if
+   * proxy_fair_queuing is enabled, in arrival order otherwise.
+   */
+  std::unique_ptr<FairRequestQueue>
       waitingRequests_[static_cast<int>(ProxyRequestPriority::kNumPriorities)];
 
   /** If true, we can't start processing this request right now */
@@ -31,7 +31,21 @@ ProxyBase::ProxyBase(
           typename fiber_local<RouterInfo>::ContextTypeTag(),
           std::make_unique<folly::fibers::EventBaseLoopController>(),
           getFiberManagerOptions(router_.opts())),
+      fiberStackTiers_(
+          fiberManager_,
+          getFiberManagerOptions(router_.opts()),
+          router_.opts().fibers_small_stack_size,
+          router_.opts().fibers_medium_stack_size,
+          router_.opts().fibers_stack_tier_probe_every,
+          [](const folly::fibers::FiberManager::Options& fmOpts) {
+            return std::make_unique<folly::fibers::FiberManager>(
+                typename fiber_local<RouterInfo>::ContextTypeTag(),
+                std::make_unique<folly::fibers::EventBaseLoopController>(),
+                fmOpts);
+          }),
       asyncLog_(router_.opts()),
+      hedgeBudget_(router_.opts().failover_hedge_budget_percent / 100.0),
+      shadowBudget_(router_.opts().proxy_max_shadow_bytes),
       stats_(router_.getStatsEnabledPools()),
       flushCallback_(*this),
       destinationMap_(std::make_unique<ProxyDestinationMap>(this)) {
@@ -40,6 +54,19 @@ ProxyBase::ProxyBase(
   folly::Random::seed(randomGenerator_);
 
   statsContainer_ = std::make_unique<ProxyStatsContainer>(*this);
+
+  if (router_.opts().key_prefix_stats_depth > 0) {
+    const auto& delimiter = router_.opts().key_prefix_stats_delimiter;
+    keyPrefixStats_ = std::make_unique<KeyPrefixStats>(
+        router_.opts().key_prefix_stats_capacity,
+        delimiter.empty() ? '\0' : delimiter[0],
+        router_.opts().key_prefix_stats_depth);
+  }
+
+  if (router_.opts().route_profile_sample_rate > 0) {
+    routeProfiler_ = std::make_unique<RouteProfiler>(
+        router_.opts().route_profile_sample_rate);
+  }
 }
 
 } // mcrouter
@@ -17,7 +17,12 @@
 #include <folly/io/async/VirtualEventBase.h>
 
 #include "mcrouter/AsyncLog.h"
+#include "mcrouter/FiberStackTiers.h"
+#include "mcrouter/HedgeBudget.h"
+#include "mcrouter/KeyPrefixStats.h"
 #include "mcrouter/ProxyStats.h"
+#include "mcrouter/RouteProfiler.h"
+#include "mcrouter/ShadowBudget.h"
 #include "mcrouter/config.h"
 #include "mcrouter/lib/network/Transport.h"
 
@@ -70,6 +75,17 @@ class ProxyBase {
     return fiberManager_;
   }
 
+  /**
+   * FiberManagers to run requests on, picked by stack usage. The large tier
+   * is fiberManager().
+   */
+  FiberStackTiers& fiberStackTiers() {
+    return fiberStackTiers_;
+  }
+  const FiberStackTiers& fiberStackTiers() const {
+    return fiberStackTiers_;
+  }
+
   ProxyDestinationMap* destinationMap() {
     return destinationMap_.get();
   }
@@ -106,6 +122,37 @@ class ProxyBase {
   /** Advance the request stats bin. */
   virtual void advanceRequestStatsBin() = 0;
 
+  /**
+   * Budget for hedged requests, shared by all routes of this proxy.
+   */
+  HedgeBudget& hedgeBudget() {
+    return hedgeBudget_;
+  }
+
+  /**
+   * Budget for the memory held by shadow requests, shared by all routes of
+   * this proxy.
+   */
+  ShadowBudget& shadowBudget() {
+    return shadowBudget_;
+  }
+
+  /**
+   * Per (pool, key prefix) stats, nullptr unless enabled with
+   * key_prefix_stats_depth.
+   */
+  KeyPrefixStats* keyPrefixStats() {
+    return keyPrefixStats_.get();
+  }
+
+  /**
+   * Route handle profiler, nullptr unless enabled with
+   * route_profile_sample_rate.
+   */
+  RouteProfiler* routeProfiler() {
+    return routeProfiler_.get();
+  }
+
   FlushList& flushList() {
     return flushList_;
   }
@@ -126,13 +173,19 @@ class ProxyBase {
 
   folly::VirtualEventBase& eventBase_;
   folly::fibers::FiberManager fiberManager_;
+  FiberStackTiers fiberStackTiers_;
 
   AsyncLog asyncLog_;
 
   std::mt19937 randomGenerator_;
 
+  HedgeBudget hedgeBudget_;
+  ShadowBudget shadowBudget_;
+
   ProxyStats stats_;
   std::unique_ptr<ProxyStatsContainer> statsContainer_;
+  std::unique_ptr<KeyPrefixStats> keyPrefixStats_;
+  std::unique_ptr<RouteProfiler> routeProfiler_;
 
   static folly::fibers::FiberManager::Options getFiberManagerOptions(
       const McrouterOptions& opts);
@@ -45,6 +45,31 @@ ReplyT<Request> ProxyDestination<Transport>::send(
   return reply;
 }
 
+template <class Transport>
+template <class Request, class F>
+void ProxyDestination<Transport>::sendAsync(
+    const Request& request,
+    DestinationRequestCtx requestContext,
+    std::chrono::milliseconds timeout,
+    F&& callback) {
+  markAsActive();
+  getTransport().send(
+      request,
+      timeout,
+      [this,
+       &request,
+       requestContext,
+       callback = std::forward<F>(callback)](
+          ReplyT<Request>&& reply, RpcStatsContext rpcStatsContext) mutable {
+        onReply(
+            reply.result(),
+            requestContext,
+            rpcStatsContext,
+            request.isBufferDirty());
+        callback(std::move(reply), requestContext, rpcStatsContext);
+      });
+}
+
 template <class Transport>
 bool ProxyDestination<Transport>::latencyAboveThreshold(uint64_t latency) {
   const auto rxmitDeviation =
@@ -147,7 +172,11 @@ void ProxyDestination<Transport>::onReply(
     DestinationRequestCtx& destreqCtx,
     const RpcStatsContext& rpcStatsContext,
     bool isRequestBufferDirty) {
-  handleTko(result, /* isProbeRequest */ false);
+  // A timeout that only happened because the request ran out of budget says
+  // nothing about the health of the destination.
+  if (!destreqCtx.timeoutShortened || result != carbon::Result::TIMEOUT) {
+    handleTko(result, /* isProbeRequest */ false);
+  }
 
   if (!stats().results) {
     stats().results = std::make_unique<std::array<
@@ -272,6 +301,9 @@ void ProxyDestination<Transport>::initializeTransport() {
   options.numConnectTimeoutRetries = opts.connect_timeout_retries;
   options.connectTimeout = shortestConnectTimeout();
   options.writeTimeout = shortestWriteTimeout();
+  options.batchingMaxDelay =
+      std::chrono::microseconds(opts.destination_batching_max_delay_us);
+  options.batchingMaxSize = opts.destination_batching_max_size;
   options.routerInfoName = proxy().router().routerInfoName();
   options.payloadFormat = opts.use_compact_serialization
       ? PayloadFormat::CompactProtocolCompatibility
@@ -285,9 +317,11 @@ void ProxyDestination<Transport>::initializeTransport() {
     options.qosPath = qosPath();
   }
   options.useJemallocNodumpAllocator = opts.jemalloc_nodump_buffers;
+  options.useIoUring = accessPoint()->useIoUring();
   if (accessPoint()->compressed()) {
     if (auto codecManager = proxy().router().getCodecManager()) {
       options.compressionCodecMap = codecManager->getCodecMap();
+      options.compressionOffloadThreshold = opts.compression_offload_threshold;
     }
   }
 
@@ -341,6 +375,11 @@ void ProxyDestination<Transport>::initializeTransport() {
       },
       [this]() { // onPartialWrite
         proxy().stats().increment(num_socket_partial_writes_stat);
+      },
+      [this](std::chrono::microseconds delay) { // onBatchDelayed
+        proxy().stats().increment(destination_batches_delayed_sum_stat);
+        proxy().stats().increment(
+            destination_batch_delay_us_sum_stat, delay.count());
       }});
 
   transport_->setConnectionStatusCallbacks(ConnectionStatusCallbacks{
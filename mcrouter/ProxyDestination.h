@@ -36,6 +36,9 @@ class TkoTracker;
 struct DestinationRequestCtx {
   int64_t startTime{0};
   int64_t endTime{0};
+  // The request was sent with a timeout shorter than the destination's,
+  // to fit within the request deadline.
+  bool timeoutShortened{false};
 
   explicit DestinationRequestCtx(int64_t now) : startTime(now) {}
 };
@@ -67,6 +70,22 @@ class ProxyDestination : public ProxyDestinationBase {
       std::chrono::milliseconds timeout,
       RpcStatsContext& rpcStatsContext);
 
+  /**
+   * Same as send(), without blocking: sends with the callback send() of
+   * Transport (which has to provide one, e.g. AsyncMcClient).
+   * request must stay alive until callback is called.
+   *
+   * @param callback  void(ReplyT<Request>&&, DestinationRequestCtx&,
+   *                  RpcStatsContext&), with the same arguments as send()
+   *                  fills.
+   */
+  template <class Request, class F>
+  void sendAsync(
+      const Request& request,
+      DestinationRequestCtx requestContext,
+      std::chrono::milliseconds timeout,
+      F&& callback);
+
   void resetInactive() override;
 
   /**
@@ -15,6 +15,7 @@
 #include "mcrouter/ProxyBase.h"
 #include "mcrouter/TkoLog.h"
 #include "mcrouter/TkoTracker.h"
+#include "mcrouter/lib/McResUtil.h"
 
 namespace facebook {
 namespace memcache {
@@ -214,6 +215,21 @@ void ProxyDestinationBase::stopSendingProbes() {
   probeTimer_.reset();
 }
 
+carbon::Result ProxyDestinationBase::warmUp() {
+  // Keep the connection open until requests start using it.
+  markAsActive();
+  auto result = sendProbe();
+  if (isErrorResult(result)) {
+    proxy().stats().increment(destination_warmup_failures_stat);
+    // Same as a failed probe: a dead destination gets marked TKO before the
+    // first request is routed to it.
+    handleTko(result, /* isProbeRequest */ true);
+  } else {
+    proxy().stats().increment(destination_warmup_connects_stat);
+  }
+  return result;
+}
+
 void ProxyDestinationBase::updateConnectionClosedInternalStat() {
   if (stats().inactiveConnectionClosedTimestampUs != 0) {
     std::chrono::microseconds timeClosed(
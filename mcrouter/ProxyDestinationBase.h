@@ -128,6 +128,13 @@ class ProxyDestinationBase {
    */
   virtual void resetInactive() = 0;
 
+  /**
+   * Opens the connection ahead of the first request, by sending a version
+   * request. A failure is accounted for TKO like a failed probe.
+   * Must be called from a fiber on the proxy thread.
+   */
+  carbon::Result warmUp();
+
  protected:
   virtual void updateTransportTimeoutsIfShorter(
       std::chrono::milliseconds shortestConnectTimeout,
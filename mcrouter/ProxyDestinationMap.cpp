@@ -7,9 +7,13 @@
 
 #include "ProxyDestinationMap.h"
 
+#include <algorithm>
 #include <memory>
+#include <vector>
 
 #include <folly/Format.h>
+#include <folly/fibers/Baton.h>
+#include <folly/fibers/FiberManager.h>
 #include <folly/io/async/AsyncTimeout.h>
 #include <folly/io/async/EventBase.h>
 
@@ -18,6 +22,9 @@
 #include "mcrouter/ProxyBase.h"
 #include "mcrouter/ProxyDestination.h"
 #include "mcrouter/ProxyDestinationBase.h"
+#include "mcrouter/TkoTracker.h"
+#include "mcrouter/config.h"
+#include "mcrouter/lib/McResUtil.h"
 #include "mcrouter/lib/fbi/cpp/util.h"
 #include "mcrouter/lib/network/AccessPoint.h"
 
@@ -112,6 +119,118 @@ void ProxyDestinationMap::scheduleTimer(bool initialAttempt) {
   }
 }
 
+void ProxyDestinationMap::warmUp(
+    size_t maxConcurrency,
+    size_t maxPerSecond,
+    std::chrono::milliseconds timeout,
+    folly::Function<void()> onDone) {
+  struct WarmUpState {
+    std::vector<std::shared_ptr<ProxyDestinationBase>> destinations;
+    size_t next{0};
+    size_t workersLeft{0};
+    // Earliest time the next connection may be started.
+    int64_t nextStartUs{0};
+    int64_t startIntervalUs{0};
+    bool stopped{false};
+    folly::fibers::Baton done;
+  };
+
+  auto state = std::make_shared<WarmUpState>();
+  {
+    std::lock_guard<std::mutex> lck(destinationsLock_);
+    for (auto* dst : destinations_) {
+      carbon::Result tkoReason;
+      if (dst->stats().state == ProxyDestinationBase::State::New &&
+          dst->maySend(tkoReason)) {
+        if (auto ptr = dst->selfPtr().lock()) {
+          state->destinations.push_back(std::move(ptr));
+        }
+      }
+    }
+  }
+
+  if (state->destinations.empty()) {
+    onDone();
+    return;
+  }
+
+  VLOG(1) << "Warming up connections to " << state->destinations.size()
+          << " destinations";
+  state->workersLeft =
+      std::min(std::max<size_t>(maxConcurrency, 1), state->destinations.size());
+  state->startIntervalUs = maxPerSecond > 0 ? 1000000 / maxPerSecond : 0;
+
+  auto& fm = proxy_->fiberManager();
+  fm.addTask([state, timeout, onDone = std::move(onDone)]() mutable {
+    state->done.try_wait_for(timeout);
+    // Connections already being established are left to complete.
+    state->stopped = true;
+    onDone();
+  });
+  for (size_t i = 0; i < state->workersLeft; ++i) {
+    fm.addTask([state]() {
+      while (!state->stopped && state->next < state->destinations.size()) {
+        auto& destination = state->destinations[state->next++];
+        const auto now = nowUs();
+        const auto waitUs = state->nextStartUs - now;
+        state->nextStartUs =
+            std::max(state->nextStartUs, now) + state->startIntervalUs;
+        if (waitUs > 0) {
+          folly::fibers::Baton sleep;
+          sleep.try_wait_for(std::chrono::microseconds(waitUs));
+          if (state->stopped) {
+            break;
+          }
+        }
+        destination->warmUp();
+      }
+      if (--state->workersLeft == 0) {
+        state->done.post();
+      }
+    });
+  }
+}
+
+void ProxyDestinationMap::restoreTkoStates(
+    const std::unordered_map<std::string, TkoTrackerState>& states) {
+  if (states.empty() || proxy_->router().opts().disable_tko_tracking) {
+    return;
+  }
+
+  std::vector<
+      std::pair<std::shared_ptr<ProxyDestinationBase>, const TkoTrackerState*>>
+      toRestore;
+  {
+    std::lock_guard<std::mutex> lck(destinationsLock_);
+    for (auto* dst : destinations_) {
+      auto it = states.find(dst->accessPoint()->toHostPortString());
+      if (it != states.end()) {
+        if (auto ptr = dst->selfPtr().lock()) {
+          toRestore.emplace_back(std::move(ptr), &it->second);
+        }
+      }
+    }
+  }
+
+  for (auto& it : toRestore) {
+    auto& dst = *it.first;
+    const auto& state = *it.second;
+    // Several destinations may share a tracker, restore it only once.
+    if (dst.tracker()->consecutiveFailureCount() > 0) {
+      continue;
+    }
+    const auto result = state.tko && isErrorResult(state.tkoReason)
+        ? state.tkoReason
+        : carbon::Result::TIMEOUT;
+    for (size_t i = 0;
+         i < std::max<size_t>(state.consecutiveFailures, 1) &&
+         !dst.tracker()->isTko();
+         ++i) {
+      dst.handleTko(result, /* isProbeRequest */ false);
+    }
+  }
+}
+
 ProxyDestinationMap::~ProxyDestinationMap() {}
 
 } // namespace mcrouter
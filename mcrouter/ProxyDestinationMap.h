@@ -14,6 +14,7 @@
 #include <unordered_map>
 #include <vector>
 
+#include <folly/Function.h>
 #include <folly/Range.h>
 #include <folly/container/F14Set.h>
 #include <folly/io/async/AsyncTimeout.h>
@@ -30,6 +31,7 @@ template <class Transport>
 class ProxyDestination;
 class ProxyDestinationBase;
 struct ProxyDestinationKey;
+struct TkoTrackerState;
 
 /**
  * Manages lifetime of ProxyDestinations. Main goal is to reuse same
@@ -88,6 +90,35 @@ class ProxyDestinationMap {
    */
   void setResetTimer(std::chrono::milliseconds interval);
 
+  /**
+   * Opens connections to all destinations that were never connected (e.g.
+   * added by the last reconfigure), so that requests don't have to wait for
+   * connection establishment and TLS handshakes.
+   * At most maxConcurrency connections are being established at any time,
+   * and at most maxPerSecond are started every second (0 means no limit).
+   *
+   * Must be called on the proxy thread. onDone is called on the proxy thread
+   * once all connection attempts are finished or timeout passed, whichever
+   * comes first.
+   */
+  void warmUp(
+      size_t maxConcurrency,
+      size_t maxPerSecond,
+      std::chrono::milliseconds timeout,
+      folly::Function<void()> onDone);
+
+  /**
+   * Replays TKO state captured in another process (see
+   * TkoTrackerMap::getSuspectServerStates()), keyed by host:port, on the
+   * destinations of this proxy. Destinations that were TKO are marked TKO
+   * again and probed by this proxy until they recover.
+   * Destinations that already saw failures in this process are left as is.
+   *
+   * Must be called on the proxy thread.
+   */
+  void restoreTkoStates(
+      const std::unordered_map<std::string, TkoTrackerState>& states);
+
   /**
    * Calls f(const ProxyDestination&) for each destination stored
    * in ProxyDestinationMap. The whole map is locked during the call.
@@ -11,6 +11,7 @@
 
 #include "mcrouter/CarbonRouterClientBase.h"
 #include "mcrouter/ProxyBase.h"
+#include "mcrouter/RouteProfiler.h"
 #include "mcrouter/config.h"
 
 namespace facebook {
@@ -32,6 +33,14 @@ ProxyRequestContext::~ProxyRequestContext() {
 
   assert(replied_);
 
+  if (routeProfileTrace_) {
+    const auto dropped =
+        proxyBase_.routeProfiler()->submit(*routeProfileTrace_);
+    if (dropped != 0) {
+      proxyBase_.stats().increment(route_profile_frames_dropped_stat, dropped);
+    }
+  }
+
   if (processing_) {
     --proxyBase_.numRequestsProcessing_;
     proxyBase_.stats().decrement(proxy_reqs_processing_stat);
@@ -58,6 +67,10 @@ uint64_t ProxyRequestContext::senderId() const {
   return id;
 }
 
+void ProxyRequestContext::startRouteProfile() {
+  routeProfileTrace_ = std::make_unique<RouteProfileTrace>();
+}
+
 void ProxyRequestContext::setSenderIdForTest(uint64_t id) {
   senderIdForTest_ = id;
 }
@@ -7,9 +7,12 @@
 
 #pragma once
 
+#include <cassert>
+#include <chrono>
 #include <memory>
 #include <string>
 
+#include <folly/Chrono.h>
 #include <folly/Range.h>
 #include <folly/fibers/FiberManager.h>
 
@@ -32,6 +35,7 @@ class ProxyRoute;
 
 class ProxyBase;
 class CarbonRouterClientBase;
+class RouteProfileTrace;
 class ShardSplitter;
 
 /**
@@ -110,6 +114,33 @@ class ProxyRequestContext {
     userIpAddr_ = newAddr.str();
   }
 
+  /**
+   * Client this request is accounted to when the proxy shares its capacity
+   * between clients (see proxy_fair_queuing). Empty if unknown.
+   * Not owned: must stay valid until the reply is sent.
+   */
+  folly::StringPiece tenant() const noexcept {
+    return tenant_;
+  }
+
+  void setTenant(folly::StringPiece tenant) {
+    tenant_ = tenant;
+  }
+
+  /**
+   * Route handle timings of this request, nullptr unless it was sampled by
+   * the RouteProfiler of its proxy.
+   */
+  RouteProfileTrace* routeProfileTrace() const {
+    return routeProfileTrace_.get();
+  }
+
+  /**
+   * Starts recording route handle timings, submitted to the RouteProfiler
+   * of the proxy once the request (including async requests) is done.
+   */
+  void startRouteProfile();
+
   bool isProcessing() const {
     return processing_;
   }
@@ -129,6 +160,39 @@ class ProxyRequestContext {
     return finalResult_;
   }
 
+  /**
+   * Sets the absolute time by which the client needs the reply. Once it has
+   * passed, no more work is done on behalf of this request.
+   */
+  void setDeadline(std::chrono::steady_clock::time_point deadline) {
+    deadline_ = deadline;
+  }
+
+  bool hasDeadline() const {
+    return deadline_ != std::chrono::steady_clock::time_point();
+  }
+
+  bool deadlineExpired(
+      std::chrono::steady_clock::time_point now =
+          std::chrono::steady_clock::now()) const {
+    return hasDeadline() && now >= deadline_;
+  }
+
+  /**
+   * @return  Time left before the deadline, rounded up to a millisecond
+   *          (so it's only zero once the deadline has passed).
+   *          Must only be called if hasDeadline().
+   */
+  std::chrono::milliseconds remainingTime(
+      std::chrono::steady_clock::time_point now =
+          std::chrono::steady_clock::now()) const {
+    assert(hasDeadline());
+    if (now >= deadline_) {
+      return std::chrono::milliseconds(0);
+    }
+    return folly::chrono::ceil<std::chrono::milliseconds>(deadline_ - now);
+  }
+
  protected:
   /**
    * The function that will be called when all replies (including async)
@@ -167,9 +231,14 @@ class ProxyRequestContext {
   uint64_t senderIdForTest_{0};
 
   std::string userIpAddr_;
+  folly::StringPiece tenant_;
 
   ProxyRequestPriority priority_{ProxyRequestPriority::kCritical};
 
+  std::chrono::steady_clock::time_point deadline_;
+
+  std::unique_ptr<RouteProfileTrace> routeProfileTrace_;
+
   bool failoverDisabled_{false};
   /** If true, this is currently being processed by a proxy and
       we want to notify we're done on destruction. */
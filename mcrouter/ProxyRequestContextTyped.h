@@ -13,6 +13,7 @@
 #include "mcrouter/ProxyRequestLogger.h"
 #include "mcrouter/lib/RequestLoggerContext.h"
 #include "mcrouter/lib/carbon/NoopAdditionalLogger.h"
+#include "mcrouter/lib/carbon/RequestReplyUtil.h"
 
 namespace facebook {
 namespace memcache {
@@ -154,6 +155,18 @@ class ProxyRequestContextWithInfo : public ProxyRequestContext {
       poolStats->incrementRequestCount(1);
       poolStats->addDurationSample(endTimeUs - startTimeUs);
     }
+    if (auto keyPrefixStats = proxy_.keyPrefixStats()) {
+      const auto key = carbon::getKeyWithoutRoute(request);
+      if (!key.empty()) {
+        keyPrefixStats->record(
+            poolName,
+            key,
+            rpcStatsContext.requestBodySize,
+            rpcStatsContext.replySizeBeforeCompression,
+            isErrorResult(reply.result()),
+            endTimeUs - startTimeUs);
+      }
+    }
     RequestLoggerContext loggerContext(
         poolName,
         ap,
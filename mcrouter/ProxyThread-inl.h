@@ -8,6 +8,7 @@
 #include "mcrouter/CarbonRouterInstanceBase.h"
 #include "mcrouter/ThreadUtil.h"
 #include "mcrouter/config.h"
+#include "mcrouter/lib/NumaTopology.h"
 
 namespace facebook {
 namespace memcache {
@@ -15,10 +16,19 @@ namespace mcrouter {
 
 inline ProxyThread::ProxyThread(
     const CarbonRouterInstanceBase& router,
-    size_t /* id */) {
+    size_t id) {
   thread_.start();
-  getEventBase().runInEventBaseThreadAndWait(
-      [&] { mcrouterSetThisThreadName(router.opts(), "mcrpxy"); });
+  getEventBase().runInEventBaseThreadAndWait([&] {
+    mcrouterSetThisThreadName(router.opts(), "mcrpxy");
+    if (router.opts().numa_placement) {
+      const auto& topology = NumaTopology::get();
+      auto node = topology.nodeForThread(id, router.opts().num_proxies);
+      if (!topology.bindThisThread(node)) {
+        LOG(WARNING) << "Unable to bind proxy thread " << id
+                     << " to NUMA node " << node;
+      }
+    }
+  });
 }
 
 inline void ProxyThread::stopAndJoin() noexcept {
@@ -0,0 +1,115 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include "RouteProfiler.h"
+
+#include <algorithm>
+#include <chrono>
+#include <utility>
+
+#include <folly/Conv.h>
+#include <folly/Format.h>
+
+namespace facebook {
+namespace memcache {
+namespace mcrouter {
+
+namespace {
+
+uint64_t nowNs() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+} // anonymous namespace
+
+constexpr uint32_t RouteProfiler::kDefaultQueueSize;
+
+int32_t RouteProfileTrace::enter(
+    folly::StringPiece name,
+    int32_t parent,
+    const void* fiber) {
+  Frame frame;
+  frame.name = name.str();
+  frame.parent = parent;
+  frame.fiber = fiber;
+  frame.startNs = nowNs();
+  frames_.push_back(std::move(frame));
+  return static_cast<int32_t>(frames_.size() - 1);
+}
+
+void RouteProfileTrace::exit(int32_t frame) {
+  auto& f = frames_[frame];
+  f.totalNs = nowNs() - f.startNs;
+  f.done = true;
+  if (f.parent >= 0) {
+    auto& parent = frames_[f.parent];
+    if (parent.fiber == f.fiber && !parent.done) {
+      parent.childrenNs += f.totalNs;
+    }
+  }
+}
+
+RouteProfiler::Totals& RouteProfiler::Totals::operator+=(
+    const Totals& other) {
+  samples += other.samples;
+  selfNs += other.selfNs;
+  totalNs += other.totalNs;
+  return *this;
+}
+
+RouteProfiler::RouteProfiler(uint32_t sampleRate, uint32_t queueSize)
+    : sampleRate_(std::max<uint32_t>(sampleRate, 1)),
+      countdown_(sampleRate_),
+      queue_(std::max<uint32_t>(queueSize, 2)) {}
+
+size_t RouteProfiler::submit(const RouteProfileTrace& trace) {
+  const auto& frames = trace.frames_;
+  // Parents are always entered before their children.
+  std::vector<std::string> stacks(frames.size());
+  size_t dropped = 0;
+  for (size_t i = 0; i < frames.size(); ++i) {
+    const auto& frame = frames[i];
+    stacks[i] = frame.parent >= 0
+        ? folly::to<std::string>(stacks[frame.parent], ';', frame.name)
+        : frame.name;
+    if (!frame.done) {
+      continue;
+    }
+    const auto selfNs =
+        frame.totalNs - std::min(frame.childrenNs, frame.totalNs);
+    if (!queue_.write(Sample{stacks[i], selfNs, frame.totalNs})) {
+      ++dropped;
+    }
+  }
+  return dropped;
+}
+
+RouteProfiler::Profile RouteProfiler::collect() {
+  std::lock_guard<std::mutex> lock(collectMutex_);
+  Sample sample;
+  while (queue_.read(sample)) {
+    auto& totals = totals_[sample.stack];
+    ++totals.samples;
+    totals.selfNs += sample.selfNs;
+    totals.totalNs += sample.totalNs;
+  }
+  return totals_;
+}
+
+std::string RouteProfiler::toFolded(const Profile& profile) {
+  std::string result;
+  for (const auto& it : profile) {
+    folly::format(&result, "{} {}\n", it.first, it.second.selfNs / 1000);
+  }
+  return result;
+}
+
+} // namespace mcrouter
+} // namespace memcache
+} // namespace facebook
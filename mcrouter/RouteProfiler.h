@@ -0,0 +1,144 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <folly/ProducerConsumerQueue.h>
+#include <folly/Range.h>
+
+namespace facebook {
+namespace memcache {
+namespace mcrouter {
+
+/**
+ * Time spent by a single request in each route handle it went through.
+ *
+ * Frames are pushed by ProfileRoute on the proxy thread, from any of the
+ * fibers working on the request (e.g. shadow requests).
+ */
+class RouteProfileTrace {
+ public:
+  /**
+   * @param parent  Frame of the calling route handle, -1 for none.
+   * @param fiber   Identifies the fiber entering the route handle: time
+   *                spent in frames entered by other fibers (which run
+   *                concurrently) is not subtracted from their parent.
+   *
+   * @return  Index of the new frame.
+   */
+  int32_t enter(folly::StringPiece name, int32_t parent, const void* fiber);
+
+  void exit(int32_t frame);
+
+ private:
+  struct Frame {
+    std::string name;
+    int32_t parent;
+    const void* fiber;
+    uint64_t startNs;
+    uint64_t totalNs{0};
+    // Time spent in frames entered from this one, by the same fiber.
+    uint64_t childrenNs{0};
+    bool done{false};
+  };
+
+  std::vector<Frame> frames_;
+
+  friend class RouteProfiler;
+};
+
+/**
+ * Samples requests of a proxy and accumulates the time they spend in every
+ * route handle, keyed by the stack of route names that led there.
+ *
+ * Sampled traces are folded into stacks on the proxy thread and handed over
+ * through a bounded single producer/single consumer queue, so collect() may
+ * be called from any thread without slowing down the proxy. Samples that
+ * don't fit in the queue are dropped.
+ */
+class RouteProfiler {
+ public:
+  static constexpr uint32_t kDefaultQueueSize = 16384;
+
+  struct Totals {
+    uint64_t samples{0};
+    // Time spent in the route handle itself, excluding its children.
+    uint64_t selfNs{0};
+    uint64_t totalNs{0};
+
+    Totals& operator+=(const Totals& other);
+  };
+
+  using Profile = std::map<std::string, Totals>;
+
+  /**
+   * @param sampleRate  Profile one request out of sampleRate.
+   */
+  explicit RouteProfiler(
+      uint32_t sampleRate,
+      uint32_t queueSize = kDefaultQueueSize);
+
+  RouteProfiler(const RouteProfiler&) = delete;
+  RouteProfiler& operator=(const RouteProfiler&) = delete;
+
+  /**
+   * @return true if the next request should be profiled. Proxy thread only.
+   */
+  bool shouldSample() {
+    if (--countdown_ != 0) {
+      return false;
+    }
+    countdown_ = sampleRate_;
+    return true;
+  }
+
+  /**
+   * Queues the frames of a completed trace. Proxy thread only.
+   *
+   * @return  Number of frames dropped because the queue was full.
+   */
+  size_t submit(const RouteProfileTrace& trace);
+
+  /**
+   * @return  Totals of all the traces submitted so far. Thread-safe.
+   */
+  Profile collect();
+
+  /**
+   * Formats a profile as folded stacks ("route1;route2;route3 <self us>"
+   * lines), the input of flamegraph.pl.
+   */
+  static std::string toFolded(const Profile& profile);
+
+ private:
+  struct Sample {
+    std::string stack;
+    uint64_t selfNs;
+    uint64_t totalNs;
+  };
+
+  const uint32_t sampleRate_;
+  uint32_t countdown_;
+
+  folly::ProducerConsumerQueue<Sample> queue_;
+
+  // Serializes consumers of queue_, protects totals_.
+  std::mutex collectMutex_;
+  Profile totals_;
+};
+
+} // namespace mcrouter
+} // namespace memcache
+} // namespace facebook
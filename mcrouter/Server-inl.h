@@ -7,6 +7,7 @@
 
 #include <signal.h>
 
+#include <chrono>
 #include <cstdio>
 
 #include <folly/io/async/EventBase.h>
@@ -16,8 +17,10 @@
 #include "mcrouter/McrouterLogFailure.h"
 #include "mcrouter/OptionsUtil.h"
 #include "mcrouter/Proxy.h"
+#include "mcrouter/ProxyDestinationMap.h"
 #include "mcrouter/ProxyThread.h"
 #include "mcrouter/ServerOnRequest.h"
+#include "mcrouter/ServerTakeover.h"
 #include "mcrouter/StandaloneConfig.h"
 #include "mcrouter/config.h"
 #include "mcrouter/lib/network/AsyncMcServer.h"
@@ -52,6 +55,17 @@ inline std::function<void(McServerSession&)> getAclChecker(
   return [](McServerSession&) {};
 }
 
+inline std::chrono::milliseconds getGoAwayTimeout(
+    const McrouterStandaloneOptions& standaloneOpts) {
+  if (standaloneOpts.go_away_timeout_ms >= 0) {
+    return std::chrono::milliseconds(standaloneOpts.go_away_timeout_ms);
+  }
+  // Drain the connections of a process being taken over by default.
+  return standaloneOpts.takeover_socket_path.empty()
+      ? std::chrono::milliseconds(0)
+      : std::chrono::milliseconds(1000);
+}
+
 template <class RouterInfo, template <class> class RequestHandler>
 void serverLoop(
     CarbonRouterInstance<RouterInfo>& router,
@@ -74,7 +88,9 @@ void serverLoop(
       evb,
       standaloneOpts.retain_source_ip,
       standaloneOpts.enable_pass_through_mode,
-      standaloneOpts.remote_thread));
+      standaloneOpts.remote_thread,
+      router.opts().proxy_fair_queuing &&
+          router.opts().proxy_max_inflight_requests > 0));
 
   worker.setOnConnectionAccepted(
       [proxy,
@@ -99,6 +115,13 @@ void serverLoop(
           proxy->stats().decrement(num_client_connections_stat);
         }
       });
+  worker.setOnQueuedReplyBytesChanged(
+      [proxy](McServerSession&, int64_t delta) {
+        proxy->stats().increment(server_queued_reply_bytes_stat, delta);
+      });
+  worker.setOnRequestShed([proxy](McServerSession&) {
+    proxy->stats().increment(server_cpu_shed_requests_stat);
+  });
 
   // Setup compression on each worker.
   if (standaloneOpts.enable_server_compression) {
@@ -128,14 +151,33 @@ bool runServer(
     StandalonePreRunCb preRunCb) {
   AsyncMcServer::Options opts;
 
+  std::unique_ptr<TakeoverClient> takeover;
+  if (!standaloneOpts.takeover_socket_path.empty() &&
+      standaloneOpts.listen_sock_fd < 0 &&
+      standaloneOpts.unix_domain_sock.empty()) {
+    try {
+      takeover = TakeoverClient::connect(
+          standaloneOpts.takeover_socket_path,
+          std::chrono::milliseconds(standaloneOpts.takeover_timeout_ms));
+    } catch (const std::exception& ex) {
+      LOG(ERROR) << "Failed to take over from running mcrouter, "
+                 << "starting from scratch: " << ex.what();
+    }
+  }
+
   if (standaloneOpts.listen_sock_fd >= 0) {
     opts.existingSocketFd = standaloneOpts.listen_sock_fd;
   } else if (!standaloneOpts.unix_domain_sock.empty()) {
     opts.unixDomainSockPath = standaloneOpts.unix_domain_sock;
   } else {
-    opts.listenAddresses = standaloneOpts.listen_addresses;
-    opts.ports = standaloneOpts.ports;
-    opts.sslPorts = standaloneOpts.ssl_ports;
+    if (takeover) {
+      opts.takeoverSocketFds = std::move(takeover->state().sockets.fds);
+      opts.takeoverSslSocketFds = std::move(takeover->state().sockets.sslFds);
+    } else {
+      opts.listenAddresses = standaloneOpts.listen_addresses;
+      opts.ports = standaloneOpts.ports;
+      opts.sslPorts = standaloneOpts.ssl_ports;
+    }
     opts.tlsTicketKeySeedPath = standaloneOpts.tls_ticket_key_seed_path;
     opts.pemCertPath = standaloneOpts.server_pem_cert_path;
     opts.pemKeyPath = standaloneOpts.server_pem_key_path;
@@ -147,9 +189,13 @@ bool runServer(
   }
 
   opts.numThreads = mcrouterOpts.num_proxies;
+  opts.numaPlacement = mcrouterOpts.numa_placement;
   opts.numListeningSockets = standaloneOpts.num_listening_sockets;
   opts.worker.tcpZeroCopyThresholdBytes =
       standaloneOpts.tcp_zero_copy_threshold;
+  opts.worker.compressionOffloadThresholdBytes =
+      mcrouterOpts.compression_offload_threshold;
+  opts.worker.useIoUring = standaloneOpts.server_use_io_uring;
 
   size_t maxConns =
       opts.setMaxConnections(standaloneOpts.max_conns, opts.numThreads);
@@ -162,8 +208,13 @@ bool runServer(
   opts.tcpListenBacklog = standaloneOpts.tcp_listen_backlog;
   opts.worker.defaultVersionHandler = false;
   opts.worker.maxInFlight = standaloneOpts.max_client_outstanding_reqs;
+  opts.worker.queuedReplyBytesHighWatermark =
+      standaloneOpts.max_client_queued_reply_bytes;
+  opts.worker.queuedReplyBytesLowWatermark =
+      standaloneOpts.client_queued_reply_bytes_low_watermark;
   opts.worker.sendTimeout =
       std::chrono::milliseconds{standaloneOpts.client_timeout_ms};
+  opts.worker.goAwayTimeout = detail::getGoAwayTimeout(standaloneOpts);
   if (!mcrouterOpts.debug_fifo_root.empty()) {
     opts.worker.debugFifoPath = getServerDebugFifoFullPath(mcrouterOpts);
   }
@@ -171,6 +222,8 @@ bool runServer(
   if (standaloneOpts.server_load_interval_ms > 0) {
     opts.cpuControllerOpts.dataCollectionInterval =
         std::chrono::milliseconds(standaloneOpts.server_load_interval_ms);
+    opts.worker.cpuShedTargetPercent =
+        standaloneOpts.server_cpu_shed_target_percent;
   }
 
   /* Default to one read per event to help latency-sensitive workloads.
@@ -219,6 +272,16 @@ bool runServer(
       initCompression(*router);
     }
 
+    if (takeover && !takeover->state().tkoStates.empty()) {
+      // Trackers are shared by all proxies, so the state is restored (and
+      // TKO destinations probed) by the first one.
+      auto proxy = router->getProxy(0);
+      proxy->eventBase().runInEventBaseThread(
+          [proxy, states = std::move(takeover->state().tkoStates)]() {
+            proxy->destinationMap()->restoreTkoStates(states);
+          });
+    }
+
     if (preRunCb) {
       preRunCb(*router);
     }
@@ -234,6 +297,29 @@ bool runServer(
         },
         [&shutdownBaton]() { shutdownBaton.post(); });
 
+    if (takeover) {
+      // We accept on the sockets taken over, the other process can go away.
+      try {
+        takeover->confirm();
+      } catch (const std::exception& ex) {
+        LOG(WARNING) << ex.what();
+      }
+      takeover.reset();
+    }
+    std::unique_ptr<TakeoverServer> takeoverServer;
+    if (!standaloneOpts.takeover_socket_path.empty()) {
+      try {
+        takeoverServer = std::make_unique<TakeoverServer>(
+            standaloneOpts.takeover_socket_path,
+            server,
+            router->tkoTrackerMap(),
+            std::chrono::milliseconds(standaloneOpts.takeover_timeout_ms),
+            [&server]() { server.shutdown(); });
+      } catch (const std::exception& ex) {
+        LOG(ERROR) << "Failed to serve takeover socket: " << ex.what();
+      }
+    }
+
     shutdownBaton.wait();
   } catch (const std::exception& e) {
     LOG(ERROR) << e.what();
@@ -0,0 +1,279 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include "ServerTakeover.h"
+
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <system_error>
+
+#include <folly/Format.h>
+#include <folly/ScopeGuard.h>
+#include <folly/String.h>
+#include <folly/dynamic.h>
+#include <folly/json.h>
+#include <folly/system/ThreadName.h>
+#include <glog/logging.h>
+
+#include "mcrouter/lib/network/FdPassing.h"
+
+namespace facebook {
+namespace memcache {
+namespace mcrouter {
+
+namespace {
+
+constexpr int64_t kProtocolVersion = 1;
+constexpr char kConfirmation = 'C';
+
+sockaddr_un makeAddress(const std::string& path) {
+  sockaddr_un addr;
+  std::memset(&addr, 0, sizeof(addr));
+  addr.sun_family = AF_UNIX;
+  if (path.size() >= sizeof(addr.sun_path)) {
+    throw std::invalid_argument(
+        folly::sformat("Takeover socket path is too long: {}", path));
+  }
+  std::memcpy(addr.sun_path, path.data(), path.size());
+  return addr;
+}
+
+folly::File makeSocket() {
+  int fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+  if (fd < 0) {
+    throw std::system_error(
+        errno, std::system_category(), "Failed to create takeover socket");
+  }
+  return folly::File(fd, /* ownsFd */ true);
+}
+
+void setTimeouts(int fd, std::chrono::milliseconds timeout) {
+  timeval tv;
+  tv.tv_sec = timeout.count() / 1000;
+  tv.tv_usec = (timeout.count() % 1000) * 1000;
+  if (::setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv)) != 0 ||
+      ::setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv)) != 0) {
+    throw std::system_error(
+        errno, std::system_category(), "Failed to set takeover timeouts");
+  }
+}
+
+std::string serializeState(
+    const AsyncMcServer::ListeningSockets& sockets,
+    const std::unordered_map<std::string, TkoTrackerState>& tkoStates) {
+  folly::dynamic tko = folly::dynamic::object;
+  for (const auto& it : tkoStates) {
+    tko[it.first] = folly::dynamic::object(
+        "failures", it.second.consecutiveFailures)("tko", it.second.tko)(
+        "reason", carbon::resultToString(it.second.tkoReason));
+  }
+  return folly::toJson(folly::dynamic::object("version", kProtocolVersion)(
+      "sockets", sockets.fds.size())("ssl_sockets", sockets.sslFds.size())(
+      "tko", std::move(tko)));
+}
+
+TakeoverState deserializeState(
+    const std::string& payload,
+    std::vector<int> fds) {
+  SCOPE_FAIL {
+    for (auto fd : fds) {
+      ::close(fd);
+    }
+  };
+
+  auto json = folly::parseJson(payload);
+  if (json["version"].asInt() != kProtocolVersion) {
+    throw std::runtime_error(folly::sformat(
+        "Unsupported takeover protocol version {}", json["version"].asInt()));
+  }
+  const size_t numSockets = json["sockets"].asInt();
+  const size_t numSslSockets = json["ssl_sockets"].asInt();
+  if (numSockets + numSslSockets != fds.size()) {
+    throw std::runtime_error(folly::sformat(
+        "Expected {} listening sockets, received {}",
+        numSockets + numSslSockets,
+        fds.size()));
+  }
+  if (fds.empty()) {
+    throw std::runtime_error("The other process has no listening sockets");
+  }
+
+  TakeoverState state;
+  for (const auto& it : json["tko"].items()) {
+    TkoTrackerState tko;
+    tko.consecutiveFailures = it.second["failures"].asInt();
+    tko.tko = it.second["tko"].asBool();
+    tko.tkoReason =
+        carbon::resultFromString(it.second["reason"].asString().c_str());
+    state.tkoStates.emplace(it.first.asString(), tko);
+  }
+  state.sockets.fds.assign(fds.begin(), fds.begin() + numSockets);
+  state.sockets.sslFds.assign(fds.begin() + numSockets, fds.end());
+  return state;
+}
+
+} // namespace
+
+TakeoverClient::TakeoverClient(folly::File socket)
+    : socket_(std::move(socket)) {}
+
+std::unique_ptr<TakeoverClient> TakeoverClient::connect(
+    const std::string& path,
+    std::chrono::milliseconds timeout) {
+  auto addr = makeAddress(path);
+  auto socket = makeSocket();
+  if (::connect(
+          socket.fd(), reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) !=
+      0) {
+    if (errno == ENOENT || errno == ECONNREFUSED) {
+      // nobody to take over from
+      return nullptr;
+    }
+    throw std::system_error(
+        errno,
+        std::system_category(),
+        folly::sformat("Failed to connect to takeover socket {}", path));
+  }
+  setTimeouts(socket.fd(), timeout);
+
+  std::string payload;
+  auto fds = receiveFds(socket.fd(), payload);
+
+  std::unique_ptr<TakeoverClient> client(new TakeoverClient(std::move(socket)));
+  client->state_ = deserializeState(payload, std::move(fds));
+  LOG(INFO) << "Took over " << client->state_.sockets.fds.size()
+            << " listening sockets, " << client->state_.sockets.sslFds.size()
+            << " SSL listening sockets and the TKO state of "
+            << client->state_.tkoStates.size() << " destinations from "
+            << path;
+  return client;
+}
+
+void TakeoverClient::confirm() {
+  if (::send(socket_.fd(), &kConfirmation, 1, MSG_NOSIGNAL) != 1) {
+    throw std::system_error(
+        errno, std::system_category(), "Failed to confirm takeover");
+  }
+}
+
+TakeoverServer::TakeoverServer(
+    std::string path,
+    AsyncMcServer& server,
+    const TkoTrackerMap& tkoTrackerMap,
+    std::chrono::milliseconds timeout,
+    std::function<void()> onHandedOver)
+    : path_(std::move(path)),
+      server_(server),
+      tkoTrackerMap_(tkoTrackerMap),
+      timeout_(timeout),
+      onHandedOver_(std::move(onHandedOver)),
+      socket_(makeSocket()) {
+  auto addr = makeAddress(path_);
+  ::unlink(path_.c_str());
+  if (::bind(socket_.fd(), reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) !=
+          0 ||
+      ::listen(socket_.fd(), 1) != 0) {
+    throw std::system_error(
+        errno,
+        std::system_category(),
+        folly::sformat("Failed to listen on takeover socket {}", path_));
+  }
+  struct stat st;
+  if (::stat(path_.c_str(), &st) == 0) {
+    dev_ = st.st_dev;
+    ino_ = st.st_ino;
+  }
+
+  thread_ = std::thread([this]() { serve(); });
+}
+
+TakeoverServer::~TakeoverServer() {
+  stopping_ = true;
+  // wakes up accept()
+  ::shutdown(socket_.fd(), SHUT_RDWR);
+  thread_.join();
+
+  struct stat st;
+  if (::stat(path_.c_str(), &st) == 0 && st.st_dev == dev_ &&
+      st.st_ino == ino_) {
+    ::unlink(path_.c_str());
+  }
+}
+
+void TakeoverServer::serve() {
+  folly::setThreadName("mcrtr-takeover");
+  while (!stopping_) {
+    int fd = ::accept4(socket_.fd(), nullptr, nullptr, SOCK_CLOEXEC);
+    if (fd < 0) {
+      if (errno == EINTR || errno == ECONNABORTED) {
+        continue;
+      }
+      if (!stopping_) {
+        LOG(ERROR) << "Failed to accept on takeover socket " << path_ << ": "
+                   << folly::errnoStr(errno);
+      }
+      return;
+    }
+    folly::File conn(fd, /* ownsFd */ true);
+    try {
+      if (handOver(conn.fd())) {
+        onHandedOver_();
+        return;
+      }
+    } catch (const std::exception& ex) {
+      LOG(ERROR) << "Takeover failed: " << ex.what();
+    }
+  }
+}
+
+bool TakeoverServer::handOver(int conn) {
+  setTimeouts(conn, timeout_);
+
+  LOG(INFO) << "Handing listening sockets over to another process";
+  auto tkoStates = tkoTrackerMap_.getSuspectServerStates();
+  auto sockets = server_.releaseListeningSockets();
+  bool handedOver = false;
+  SCOPE_EXIT {
+    // The other process has its own duplicates by now.
+    for (auto fd : sockets.fds) {
+      ::close(fd);
+    }
+    for (auto fd : sockets.sslFds) {
+      ::close(fd);
+    }
+    if (!handedOver) {
+      LOG(WARNING) << "Takeover did not complete, accepting again";
+      try {
+        server_.resumeAccepting();
+      } catch (const std::exception& ex) {
+        LOG(ERROR) << "Failed to resume accepting: " << ex.what();
+      }
+    }
+  };
+
+  std::vector<int> fds(sockets.fds);
+  fds.insert(fds.end(), sockets.sslFds.begin(), sockets.sslFds.end());
+  sendFds(conn, fds, serializeState(sockets, tkoStates));
+
+  char confirmation = 0;
+  auto n = ::recv(conn, &confirmation, 1, 0);
+  handedOver = n == 1 && confirmation == kConfirmation;
+  if (handedOver) {
+    LOG(INFO) << "Listening sockets handed over, shutting down";
+  }
+  return handedOver;
+}
+
+} // namespace mcrouter
+} // namespace memcache
+} // namespace facebook
@@ -0,0 +1,137 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <sys/types.h>
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+#include <unordered_map>
+
+#include <folly/File.h>
+
+#include "mcrouter/TkoTracker.h"
+#include "mcrouter/lib/network/AsyncMcServer.h"
+
+namespace facebook {
+namespace memcache {
+namespace mcrouter {
+
+/**
+ * Zero-downtime restarts.
+ *
+ * A running mcrouter serves a unix domain socket (TakeoverServer). A new
+ * mcrouter started with the same takeover socket path connects to it
+ * (TakeoverClient) and receives the listening sockets of the running one
+ * (as SCM_RIGHTS), along with the TKO state of its destinations.
+ *
+ * The old process stops accepting as soon as it hands its sockets over, and
+ * the new one accepts on the very same sockets, so no connection attempt is
+ * refused. Once the new process confirms that it serves, the old one shuts
+ * down, draining its client connections with GoAway for up to
+ * AsyncMcServerWorkerOptions::goAwayTimeout (1s unless go_away_timeout_ms
+ * says otherwise). If the new process goes
+ * away (or times out) without confirming, the old one resumes accepting.
+ */
+
+struct TakeoverState {
+  // Owned by whoever uses the state, e.g. AsyncMcServer::Options.
+  AsyncMcServer::ListeningSockets sockets;
+  std::unordered_map<std::string, TkoTrackerState> tkoStates;
+};
+
+class TakeoverClient {
+ public:
+  /**
+   * Connects to the takeover socket at `path` and receives the listening
+   * sockets and state of the process serving it.
+   *
+   * @return  nullptr if no process serves `path`.
+   * @throws std::exception  if the takeover failed, in which case the other
+   *                         process keeps serving.
+   */
+  static std::unique_ptr<TakeoverClient> connect(
+      const std::string& path,
+      std::chrono::milliseconds timeout);
+
+  TakeoverState& state() {
+    return state_;
+  }
+
+  /**
+   * Tells the other process that this one accepts on the sockets taken over,
+   * so that it can shut down.
+   */
+  void confirm();
+
+ private:
+  folly::File socket_;
+  TakeoverState state_;
+
+  explicit TakeoverClient(folly::File socket);
+};
+
+class TakeoverServer {
+ public:
+  /**
+   * Starts serving takeover requests on `path` in a background thread,
+   * replacing whatever was bound to `path` before (e.g. the takeover socket
+   * of the process this one took over from).
+   *
+   * @param onHandedOver  Called from the background thread once another
+   *                      process took over the listening sockets of `server`.
+   *                      No more takeover requests are served after that.
+   *
+   * @throws std::system_error  if `path` can't be bound.
+   */
+  TakeoverServer(
+      std::string path,
+      AsyncMcServer& server,
+      const TkoTrackerMap& tkoTrackerMap,
+      std::chrono::milliseconds timeout,
+      std::function<void()> onHandedOver);
+
+  /**
+   * Stops serving, and removes the socket file unless another process
+   * replaced it already.
+   */
+  ~TakeoverServer();
+
+  TakeoverServer(const TakeoverServer&) = delete;
+  TakeoverServer& operator=(const TakeoverServer&) = delete;
+
+ private:
+  const std::string path_;
+  AsyncMcServer& server_;
+  const TkoTrackerMap& tkoTrackerMap_;
+  const std::chrono::milliseconds timeout_;
+  std::function<void()> onHandedOver_;
+
+  folly::File socket_;
+  // identifies the socket file this server bound
+  dev_t dev_{0};
+  ino_t ino_{0};
+
+  std::atomic<bool> stopping_{false};
+  std::thread thread_;
+
+  void serve();
+
+  /**
+   * @return  true if the process at the other end of `conn` took over.
+   */
+  bool handOver(int conn);
+};
+
+} // namespace mcrouter
+} // namespace memcache
+} // namespace facebook
@@ -22,6 +22,7 @@
 #include "mcrouter/Proxy.h"
 #include "mcrouter/ProxyConfigBuilder.h"
 #include "mcrouter/ProxyRequestContextTyped.h"
+#include "mcrouter/RouteProfiler.h"
 #include "mcrouter/config-impl.h"
 #include "mcrouter/config.h"
 #include "mcrouter/lib/RouteHandleTraverser.h"
@@ -306,6 +307,24 @@ ServiceInfo<RouterInfo>::ServiceInfoImpl::ServiceInfoImpl(
         return res;
       });
 
+  commands_.emplace(
+      "route_profile",
+      [this](const std::vector<folly::StringPiece>& /* args */) {
+        if (!proxy_.routeProfiler()) {
+          throw std::runtime_error(
+              "route_profile: disabled, see route_profile_sample_rate");
+        }
+        auto& router = proxy_.router();
+        RouteProfiler::Profile profile;
+        for (size_t i = 0; i < router.opts().num_proxies; ++i) {
+          for (const auto& it :
+               router.getProxyBase(i)->routeProfiler()->collect()) {
+            profile[it.first] += it.second;
+          }
+        }
+        return RouteProfiler::toFolded(profile);
+      });
+
   commands_.emplace(
       "config_md5_digest",
       [&config](const std::vector<folly::StringPiece>& /* args */) {
@@ -335,6 +354,12 @@ ServiceInfo<RouterInfo>::ServiceInfoImpl::ServiceInfoImpl(
         return toPrettySortedJson(builder.preprocessedConfig());
       });
 
+  commands_.emplace(
+      "waiting_tenants",
+      [this](const std::vector<folly::StringPiece>& /* args */) {
+        return toPrettySortedJson(proxy_.dumpWaitingTenants());
+      });
+
   commands_.emplace(
       "hostid", [](const std::vector<folly::StringPiece>& /* args */) {
         return folly::to<std::string>(globals::hostid());
@@ -0,0 +1,62 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+
+namespace facebook {
+namespace memcache {
+namespace mcrouter {
+
+/**
+ * Caps the memory held by shadow requests that are not completed yet.
+ *
+ * Shadow requests share the key and value buffers of the normal request,
+ * keeping them alive until the slowest shadow destination replies. When
+ * shadow destinations are slow, this memory is bounded by skipping new
+ * shadows instead of queueing them.
+ *
+ * Shared by all routes of a proxy. Not thread-safe.
+ */
+class ShadowBudget {
+ public:
+  /**
+   * @param maxBytes  Max number of bytes outstanding, 0 for no limit.
+   */
+  explicit ShadowBudget(size_t maxBytes) : maxBytes_(maxBytes) {}
+
+  /**
+   * @return true if a shadow request of this size can be sent now (and
+   *         accounts for it until release()).
+   */
+  bool tryAcquire(size_t bytes) {
+    if (maxBytes_ != 0 && outstanding_ + bytes > maxBytes_) {
+      return false;
+    }
+    outstanding_ += bytes;
+    return true;
+  }
+
+  void release(size_t bytes) {
+    assert(outstanding_ >= bytes);
+    outstanding_ -= bytes;
+  }
+
+  size_t outstanding() const {
+    return outstanding_;
+  }
+
+ private:
+  const size_t maxBytes_;
+  size_t outstanding_{0};
+};
+
+} // namespace mcrouter
+} // namespace memcache
+} // namespace facebook
@@ -0,0 +1,142 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include "StatsShmExporter.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+
+#include <folly/Conv.h>
+
+#include "mcrouter/CarbonRouterInstanceBase.h"
+#include "mcrouter/McrouterLogFailure.h"
+#include "mcrouter/options.h"
+#include "mcrouter/stats.h"
+
+namespace facebook {
+namespace memcache {
+namespace mcrouter {
+
+namespace {
+
+constexpr std::chrono::seconds kPublishInterval{1};
+// Headroom for pool stats that appear after a reconfiguration.
+constexpr size_t kMinCapacity = 1024;
+
+std::string publishFunctionName(folly::StringPiece routerName) {
+  static std::atomic<uint64_t> uniqueId(0);
+  return folly::to<std::string>(
+      "carbon-stats-shm-fn-", routerName, "-", uniqueId.fetch_add(1));
+}
+
+bool toEntry(const stat_t& stat, ShmStats::Entry& entry) {
+  switch (stat.type) {
+    case stat_uint64:
+      entry.type = ShmStats::Type::Uint64;
+      entry.value.uint64 = stat.data.uint64;
+      break;
+    case stat_int64:
+      entry.type = ShmStats::Type::Int64;
+      entry.value.int64 = stat.data.int64;
+      break;
+    case stat_double:
+      entry.type = ShmStats::Type::Double;
+      entry.value.dbl = stat.data.dbl;
+      break;
+    default:
+      return false;
+  }
+  entry.setName(stat.name);
+  entry.reserved = 0;
+  return true;
+}
+
+} // anonymous namespace
+
+StatsShmExporter::StatsShmExporter(CarbonRouterInstanceBase& router)
+    : router_(router),
+      functionHandle_(publishFunctionName(router_.opts().router_name)) {}
+
+StatsShmExporter::~StatsShmExporter() {
+  stop();
+  if (region_) {
+    region_->retire();
+  }
+}
+
+bool StatsShmExporter::start() {
+  if (router_.opts().stats_shm_path.empty()) {
+    return false;
+  }
+  auto scheduler = router_.functionScheduler();
+  if (!scheduler) {
+    MC_LOG_FAILURE(
+        router_.opts(),
+        memcache::failure::Category::kSystemError,
+        "Scheduler not available, disabling stats shm export");
+    return false;
+  }
+  scheduler->addFunction(
+      [this]() { publish(); }, kPublishInterval, functionHandle_);
+  started_ = true;
+  return true;
+}
+
+void StatsShmExporter::stop() noexcept {
+  if (!started_) {
+    return;
+  }
+  if (auto scheduler = router_.functionScheduler()) {
+    scheduler->cancelFunctionAndWait(functionHandle_);
+  }
+  started_ = false;
+}
+
+void StatsShmExporter::publish() {
+  const auto stats = prepare_aggregated_stats(router_);
+  entries_.clear();
+  for (const auto& stat : stats) {
+    entries_.emplace_back();
+    if (!toEntry(stat, entries_.back())) {
+      entries_.pop_back();
+    }
+  }
+
+  const auto now = std::chrono::duration_cast<std::chrono::milliseconds>(
+                       std::chrono::system_clock::now().time_since_epoch())
+                       .count();
+  if (region_ && region_->publish(entries_.data(), entries_.size(), now)) {
+    return;
+  }
+
+  // First publish, or the region got too small: readers of the previous one
+  // see it retired and reopen the path.
+  const auto& path = router_.opts().stats_shm_path;
+  std::unique_ptr<ShmStats> region;
+  try {
+    region =
+        ShmStats::create(path, std::max(2 * entries_.size(), kMinCapacity));
+  } catch (const std::exception& e) {
+    MC_LOG_FAILURE(
+        router_.opts(),
+        memcache::failure::Category::kSystemError,
+        "Failed to create stats shm region '{}': {}",
+        path,
+        e.what());
+    return;
+  }
+  region->publish(entries_.data(), entries_.size(), now);
+  if (region_) {
+    region_->retire();
+  }
+  region_ = std::move(region);
+}
+
+} // mcrouter
+} // memcache
+} // facebook
@@ -0,0 +1,63 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "mcrouter/lib/debug/ShmStats.h"
+
+namespace facebook {
+namespace memcache {
+namespace mcrouter {
+
+class CarbonRouterInstanceBase;
+
+/**
+ * Publishes all numeric stats of a router, pool stats included, to a
+ * ShmStats region at opts.stats_shm_path every second.
+ *
+ * Stats are aggregated once per publish, on the function scheduler thread,
+ * so scrapers reading the region (e.g. with mcstats) cost the proxies
+ * nothing.
+ */
+class StatsShmExporter {
+ public:
+  explicit StatsShmExporter(CarbonRouterInstanceBase& router);
+
+  ~StatsShmExporter();
+
+  /**
+   * Starts publishing periodically.
+   *
+   * @return  False if disabled (stats_shm_path is empty) or if the function
+   *          scheduler is not available.
+   */
+  bool start();
+
+  /**
+   * Stops publishing, blocks until an ongoing publish completes.
+   */
+  void stop() noexcept;
+
+ private:
+  CarbonRouterInstanceBase& router_;
+  // Name of the periodic function registered with the function scheduler.
+  const std::string functionHandle_;
+  bool started_{false};
+
+  std::unique_ptr<ShmStats> region_;
+  std::vector<ShmStats::Entry> entries_;
+
+  void publish();
+};
+
+} // mcrouter
+} // memcache
+} // facebook
@@ -225,6 +225,24 @@ TkoTrackerMap::getSuspectServers() const {
   return result;
 }
 
+std::unordered_map<std::string, TkoTrackerState>
+TkoTrackerMap::getSuspectServerStates() const {
+  std::unordered_map<std::string, TkoTrackerState> result;
+  foreachTkoTracker(
+      [&result](folly::StringPiece key, const TkoTracker& tracker) mutable {
+        TkoTrackerState state;
+        state.consecutiveFailures = tracker.consecutiveFailureCount();
+        if (state.consecutiveFailures > 0) {
+          state.tko = tracker.isTko();
+          if (state.tko) {
+            state.tkoReason = tracker.tkoReason();
+          }
+          result.emplace(key.str(), state);
+        }
+      });
+  return result;
+}
+
 size_t TkoTrackerMap::getSuspectServersCount() const {
   size_t result = 0;
   foreachTkoTracker(
@@ -28,6 +28,16 @@ namespace mcrouter {
 class ProxyDestinationBase;
 class TkoTrackerMap;
 
+/**
+ * Snapshot of the TKO state of a destination.
+ */
+struct TkoTrackerState {
+  size_t consecutiveFailures{0};
+  bool tko{false};
+  // Result that caused the TKO, UNKNOWN if not TKO.
+  carbon::Result tkoReason{carbon::Result::UNKNOWN};
+};
+
 /**
  * We record the number of consecutive failures for each destination.
  * Once it goes over a certain threshold, we mark the destination as TKO
@@ -228,6 +238,13 @@ class TkoTrackerMap {
   std::unordered_map<std::string, std::pair<bool, size_t>> getSuspectServers()
       const;
 
+  /**
+   * @return  TKO state of all servers that recently returned error replies,
+   *   keyed the same way as getSuspectServers().
+   */
+  std::unordered_map<std::string, TkoTrackerState> getSuspectServerStates()
+      const;
+
   const TkoCounters& globalTkos() const {
     return globalTkos_;
   }
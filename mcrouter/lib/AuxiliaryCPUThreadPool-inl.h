@@ -0,0 +1,46 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <utility>
+
+#include <folly/Try.h>
+#include <folly/fibers/FiberManager.h>
+#include <folly/fibers/Promise.h>
+
+namespace facebook {
+namespace memcache {
+namespace mcrouter {
+
+template <class F>
+auto AuxiliaryCPUThreadPool::run(F&& func) -> decltype(func()) {
+  using Result = decltype(func());
+
+  if (!folly::fibers::onFiber()) {
+    inlineNotOnFiber_.fetch_add(1, std::memory_order_relaxed);
+    return func();
+  }
+  if (!tryReserve()) {
+    return func();
+  }
+  const auto start = std::chrono::steady_clock::now();
+  // func is only referenced until the promise is fulfilled, while the
+  // calling fiber is still waiting.
+  return folly::fibers::await([&](folly::fibers::Promise<Result> promise) {
+    getThreadPool().add(
+        [this, &func, start, promise = std::move(promise)]() mutable {
+          auto result = folly::makeTryWith(std::forward<F>(func));
+          recordCompletion(start);
+          promise.setTry(std::move(result));
+        });
+  });
+}
+
+} // mcrouter
+} // memcache
+} // facebook
@@ -28,6 +28,48 @@ folly::CPUThreadPoolExecutor& AuxiliaryCPUThreadPool::getThreadPool() {
   return *threadPool_;
 }
 
+bool AuxiliaryCPUThreadPool::tryAdd(folly::Function<void()> func) {
+  if (!tryReserve()) {
+    return false;
+  }
+  const auto start = std::chrono::steady_clock::now();
+  getThreadPool().add([this, start, func = std::move(func)]() mutable {
+    func();
+    recordCompletion(start);
+  });
+  return true;
+}
+
+AuxiliaryCPUThreadPoolStats AuxiliaryCPUThreadPool::getStats() const {
+  AuxiliaryCPUThreadPoolStats stats;
+  stats.queueDepth = queueDepth_.load(std::memory_order_relaxed);
+  stats.offloaded = offloaded_.load(std::memory_order_relaxed);
+  stats.inlineFallbacks = inlineFallbacks_.load(std::memory_order_relaxed);
+  stats.inlineNotOnFiber = inlineNotOnFiber_.load(std::memory_order_relaxed);
+  stats.totalLatencyUs = totalLatencyUs_.load(std::memory_order_relaxed);
+  return stats;
+}
+
+bool AuxiliaryCPUThreadPool::tryReserve() {
+  // The limit is approximate: concurrent callers may all pass the check.
+  if (queueDepth_.load(std::memory_order_relaxed) >=
+      maxQueueDepth_.load(std::memory_order_relaxed)) {
+    inlineFallbacks_.fetch_add(1, std::memory_order_relaxed);
+    return false;
+  }
+  queueDepth_.fetch_add(1, std::memory_order_relaxed);
+  return true;
+}
+
+void AuxiliaryCPUThreadPool::recordCompletion(
+    std::chrono::steady_clock::time_point start) {
+  const auto latency = std::chrono::duration_cast<std::chrono::microseconds>(
+      std::chrono::steady_clock::now() - start);
+  totalLatencyUs_.fetch_add(latency.count(), std::memory_order_relaxed);
+  offloaded_.fetch_add(1, std::memory_order_relaxed);
+  queueDepth_.fetch_sub(1, std::memory_order_relaxed);
+}
+
 } // mcrouter
 } // memcache
 } // facebook
@@ -7,6 +7,10 @@
 
 #pragma once
 
+#include <atomic>
+#include <chrono>
+
+#include <folly/Function.h>
 #include <folly/Singleton.h>
 #include <folly/executors/CPUThreadPoolExecutor.h>
 #include <folly/synchronization/CallOnce.h>
@@ -15,6 +19,22 @@ namespace facebook {
 namespace memcache {
 namespace mcrouter {
 
+// Default max number of tasks pending in the pool through tryAdd()/run().
+constexpr size_t kDefaultAuxiliaryCPUThreadPoolMaxQueueDepth = 64;
+
+struct AuxiliaryCPUThreadPoolStats {
+  // Tasks added with tryAdd()/run() that did not complete yet.
+  uint64_t queueDepth{0};
+  // Tasks that ran on the pool.
+  uint64_t offloaded{0};
+  // Tasks that ran inline instead, because the pool was saturated.
+  uint64_t inlineFallbacks{0};
+  // Calls to run() that ran inline because there was no fiber to preempt.
+  uint64_t inlineNotOnFiber{0};
+  // Sum over offloaded tasks of the time from submission to completion.
+  uint64_t totalLatencyUs{0};
+};
+
 /**
  * CPU Thread pool that is shared between router intances.
  *
@@ -25,9 +45,54 @@ class AuxiliaryCPUThreadPool {
  public:
   folly::CPUThreadPoolExecutor& getThreadPool();
 
+  /**
+   * Adds func to the pool, unless maxQueueDepth tasks added with
+   * tryAdd()/run() are already pending.
+   *
+   * @return  false if the pool is saturated, in which case func is dropped.
+   */
+  bool tryAdd(folly::Function<void()> func);
+
+  /**
+   * Runs func on the pool and preempts the calling fiber until it completes.
+   * func runs inline if the pool is saturated or if not called from a fiber.
+   * Exceptions thrown by func are rethrown to the caller.
+   */
+  template <class F>
+  auto run(F&& func) -> decltype(func());
+
+  /**
+   * Changes the max number of tasks pending through tryAdd()/run().
+   * 0 makes every such task run inline.
+   */
+  void setMaxQueueDepth(size_t maxQueueDepth) {
+    maxQueueDepth_.store(maxQueueDepth, std::memory_order_relaxed);
+  }
+
+  AuxiliaryCPUThreadPoolStats getStats() const;
+
  private:
   std::unique_ptr<folly::CPUThreadPoolExecutor> threadPool_;
   folly::once_flag initFlag_;
+
+  std::atomic<size_t> maxQueueDepth_{
+      kDefaultAuxiliaryCPUThreadPoolMaxQueueDepth};
+  std::atomic<uint64_t> queueDepth_{0};
+  std::atomic<uint64_t> offloaded_{0};
+  std::atomic<uint64_t> inlineFallbacks_{0};
+  std::atomic<uint64_t> inlineNotOnFiber_{0};
+  std::atomic<uint64_t> totalLatencyUs_{0};
+
+  /**
+   * Accounts for a new pending task if the pool is not saturated, or for an
+   * inline fallback otherwise.
+   *
+   * @return  true if the task may be added to the pool.
+   */
+  bool tryReserve();
+
+  // Accounts for the completion of a task added at the given time.
+  void recordCompletion(std::chrono::steady_clock::time_point start);
 };
 
 using AuxiliaryCPUThreadPoolSingleton =
@@ -36,3 +101,5 @@ using AuxiliaryCPUThreadPoolSingleton =
 } // mcrouter
 } // memcache
 } // facebook
+
+#include "AuxiliaryCPUThreadPool-inl.h"
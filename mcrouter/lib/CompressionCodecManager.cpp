@@ -91,10 +91,11 @@ const CompressionCodecMap* CompressionCodecManager::getCodecMap() const {
 }
 
 CompressionCodecMap* CompressionCodecManager::buildCodecMap() {
-  if (size_ == 0) {
-    return new CompressionCodecMap();
-  }
-  return new CompressionCodecMap(codecConfigs_, smallestCodecId_, size_);
+  auto codecMap = size_ == 0
+      ? new CompressionCodecMap()
+      : new CompressionCodecMap(codecConfigs_, smallestCodecId_, size_);
+  codecMap->manager_ = this;
+  return codecMap;
 }
 
 /****************
@@ -175,6 +176,10 @@ CompressionCodec* CompressionCodecMap::getBest(
   return codec;
 }
 
+const CompressionCodecMap* CompressionCodecMap::getForCurrentThread() const {
+  return manager_ ? manager_->getCodecMap() : this;
+}
+
 uint32_t CompressionCodecMap::index(uint32_t id) const noexcept {
   return id - firstId_;
 }
@@ -127,10 +127,21 @@ class CompressionCodecMap {
     return {firstId_, size()};
   }
 
+  /**
+   * Returns the map of the calling thread built by the same manager as this
+   * map. Codecs are not thread-safe: a thread compressing on behalf of
+   * another one must use the codecs of its own map.
+   *
+   * @return  The map of the calling thread (or this map if it was not built
+   *          by a CompressionCodecManager).
+   */
+  const CompressionCodecMap* getForCurrentThread() const;
+
  private:
   std::vector<std::unique_ptr<CompressionCodec>> codecs_;
   std::vector<std::vector<uint32_t>> codecsIdByTypeId_;
   const uint32_t firstId_{0};
+  const CompressionCodecManager* manager_{nullptr};
 
   /**
    * Builds an empty codec map.
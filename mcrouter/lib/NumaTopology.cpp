@@ -0,0 +1,137 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include "NumaTopology.h"
+
+#include <dirent.h>
+#include <pthread.h>
+#include <sched.h>
+
+#include <algorithm>
+#include <map>
+#include <string>
+
+#include <folly/Conv.h>
+#include <folly/FileUtil.h>
+#include <folly/String.h>
+
+namespace facebook {
+namespace memcache {
+
+constexpr folly::StringPiece NumaTopology::kSysfsNodeDir;
+
+std::vector<int> parseCpuList(folly::StringPiece list) {
+  std::vector<int> cpus;
+  std::vector<folly::StringPiece> ranges;
+  folly::split(',', folly::trimWhitespace(list), ranges);
+  for (auto range : ranges) {
+    folly::StringPiece first;
+    folly::StringPiece last;
+    if (!folly::split('-', range, first, last)) {
+      first = last = range;
+    }
+    auto from = folly::tryTo<int>(first);
+    auto to = folly::tryTo<int>(last);
+    if (!from.hasValue() || !to.hasValue() || *from < 0 || *from > *to) {
+      continue;
+    }
+    for (int cpu = *from; cpu <= *to; ++cpu) {
+      cpus.push_back(cpu);
+    }
+  }
+  return cpus;
+}
+
+const NumaTopology& NumaTopology::get() {
+  static const NumaTopology topology(kSysfsNodeDir);
+  return topology;
+}
+
+NumaTopology::NumaTopology(folly::StringPiece nodeDir) {
+  // Node ids may have holes, order them by id.
+  std::map<int, std::vector<int>> nodes;
+  if (auto dir = opendir(nodeDir.str().c_str())) {
+    while (auto entry = readdir(dir)) {
+      folly::StringPiece name(entry->d_name);
+      if (!name.removePrefix("node")) {
+        continue;
+      }
+      auto id = folly::tryTo<int>(name);
+      std::string cpuList;
+      if (!id.hasValue() ||
+          !folly::readFile(
+              folly::to<std::string>(nodeDir, "/", entry->d_name, "/cpulist")
+                  .c_str(),
+              cpuList)) {
+        continue;
+      }
+      auto cpus = parseCpuList(cpuList);
+      // Memory-only nodes can't run threads.
+      if (!cpus.empty()) {
+        nodes.emplace(*id, std::move(cpus));
+      }
+    }
+    closedir(dir);
+  }
+
+  for (auto& node : nodes) {
+    for (auto cpu : node.second) {
+      if (static_cast<size_t>(cpu) >= cpuNodes_.size()) {
+        cpuNodes_.resize(cpu + 1, -1);
+      }
+      cpuNodes_[cpu] = nodeCpus_.size();
+    }
+    nodeCpus_.push_back(std::move(node.second));
+  }
+  if (nodeCpus_.empty()) {
+    nodeCpus_.emplace_back();
+  }
+}
+
+size_t NumaTopology::nodeForThread(size_t idx, size_t numThreads) const {
+  if (numThreads == 0) {
+    return 0;
+  }
+  return std::min(idx * numNodes() / numThreads, numNodes() - 1);
+}
+
+std::pair<size_t, size_t> NumaTopology::threadsOfNode(
+    size_t node,
+    size_t numThreads) const {
+  // Smallest idx with idx * numNodes / numThreads >= node.
+  auto firstOf = [&](size_t n) {
+    return (n * numThreads + numNodes() - 1) / numNodes();
+  };
+  return {std::min(firstOf(node), numThreads),
+          std::min(firstOf(node + 1), numThreads)};
+}
+
+folly::Optional<size_t> NumaTopology::currentNode() const {
+  const int cpu = sched_getcpu();
+  if (cpu < 0 || static_cast<size_t>(cpu) >= cpuNodes_.size() ||
+      cpuNodes_[cpu] < 0) {
+    return folly::none;
+  }
+  return static_cast<size_t>(cpuNodes_[cpu]);
+}
+
+bool NumaTopology::bindThisThread(size_t node) const {
+  if (node >= numNodes() || nodeCpus_[node].empty()) {
+    return false;
+  }
+  cpu_set_t cpuSet;
+  CPU_ZERO(&cpuSet);
+  for (auto cpu : nodeCpus_[node]) {
+    if (cpu < CPU_SETSIZE) {
+      CPU_SET(cpu, &cpuSet);
+    }
+  }
+  return pthread_setaffinity_np(pthread_self(), sizeof(cpuSet), &cpuSet) == 0;
+}
+
+} // namespace memcache
+} // namespace facebook
@@ -0,0 +1,93 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+#include <folly/Optional.h>
+#include <folly/Range.h>
+
+namespace facebook {
+namespace memcache {
+
+/**
+ * CPUs of every NUMA node of the host, as reported by sysfs.
+ *
+ * Used to spread numbered threads (proxies, server workers) over the nodes
+ * in contiguous blocks: with N threads and M nodes, threads
+ * [0, N/M) go to node 0, [N/M, 2N/M) to node 1, etc. Threads with the same
+ * index in two groups of the same size thus always land on the same node.
+ *
+ * Memory is not bound explicitly: with the kernel's default (local)
+ * allocation policy, memory first touched by a pinned thread is placed on
+ * that thread's node.
+ */
+class NumaTopology {
+ public:
+  static constexpr folly::StringPiece kSysfsNodeDir{
+      "/sys/devices/system/node"};
+
+  /**
+   * Topology of this host, read once. A host without NUMA information has a
+   * single node.
+   */
+  static const NumaTopology& get();
+
+  /**
+   * Reads the topology from `nodeDir`/node<N>/cpulist files.
+   */
+  explicit NumaTopology(folly::StringPiece nodeDir);
+
+  size_t numNodes() const {
+    return nodeCpus_.size();
+  }
+
+  const std::vector<int>& cpusOfNode(size_t node) const {
+    return nodeCpus_[node];
+  }
+
+  /**
+   * @return  Node thread `idx` out of `numThreads` should run on.
+   */
+  size_t nodeForThread(size_t idx, size_t numThreads) const;
+
+  /**
+   * @return  Indices [first, last) of the threads out of `numThreads` that
+   *          run on `node`. Empty if there are fewer threads than nodes.
+   */
+  std::pair<size_t, size_t> threadsOfNode(size_t node, size_t numThreads)
+      const;
+
+  /**
+   * @return  Node of the CPU the calling thread is running on, if known.
+   */
+  folly::Optional<size_t> currentNode() const;
+
+  /**
+   * Restricts the calling thread to the CPUs of `node`.
+   *
+   * @return  false if it couldn't be done (e.g. no permission).
+   */
+  bool bindThisThread(size_t node) const;
+
+ private:
+  std::vector<std::vector<int>> nodeCpus_;
+  // Node of every CPU, -1 if unknown.
+  std::vector<int> cpuNodes_;
+};
+
+/**
+ * Parses a Linux CPU list, e.g. "0-3,8,10-11".
+ * Invalid parts are skipped.
+ */
+std::vector<int> parseCpuList(folly::StringPiece list);
+
+} // namespace memcache
+} // namespace facebook
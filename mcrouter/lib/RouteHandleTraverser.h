@@ -53,19 +53,32 @@ class RouteHandleTraverser {
   using AccessPointFunc =
       std::function<bool(const AccessPoint&, const PoolContext&)>;
 
+  /**
+   * Called when a route handle forwards the request to a child (see
+   * forward()), right before traversing the child.
+   *
+   * @param child   The route handle the request is forwarded to.
+   */
+  using ForwardFunc = std::function<void(RouteHandleIf& child)>;
+
   /**
    * Creates a route handle traverser.
    */
   explicit RouteHandleTraverser(
       StartFunc start = nullptr,
       EndFunc end = nullptr,
-      AccessPointFunc accessPointFn = nullptr)
+      AccessPointFunc accessPointFn = nullptr,
+      ForwardFunc forwardFn = nullptr)
       : start_(std::move(start)),
         end_(std::move(end)),
-        accessPointFn_(std::move(accessPointFn)) {}
+        accessPointFn_(std::move(accessPointFn)),
+        forwardFn_(std::move(forwardFn)) {}
 
   template <class Request>
   bool operator()(const RouteHandleIf& r, const Request& req) const {
+    if (UNLIKELY(options_.getForwardOnly())) {
+      return true;
+    }
     if (UNLIKELY(start_ != nullptr)) {
       start_(r);
     }
@@ -88,6 +101,24 @@ class RouteHandleTraverser {
     return stopTraversal;
   }
 
+  /**
+   * Traverses child, like operator()(child, req). Route handles call it
+   * instead from traverse() to declare that their route() sends req, as is,
+   * to child only and returns the reply of child as is: routing req to
+   * child is the same as routing it through them. Such route handles can be
+   * skipped by the router (see ProxyRoute::directTarget()).
+   */
+  template <class Request>
+  bool forward(RouteHandleIf& child, const Request& req) const {
+    if (UNLIKELY(forwardFn_ != nullptr)) {
+      forwardFn_(child);
+    }
+    if (UNLIKELY(options_.getForwardOnly())) {
+      return child.traverse(req, *this);
+    }
+    return operator()(child, req);
+  }
+
   /*
    * If a route handle traverse returns true, the RouteHandleTraverser
    * will exit early from the traversal.
@@ -114,6 +145,18 @@ class RouteHandleTraverser {
      */
     size_t splitSize_{0};
 
+    /**
+     * Only follow forward(): route handles are not traversed past the first
+     * one that doesn't forward the request.
+     */
+    bool forwardOnly_{false};
+
+    /**
+     * Route handles forwarding the request to a child selected by its key
+     * forward it to every child they may select instead.
+     */
+    bool forwardAll_{false};
+
    public:
     /**
      * Set splitSize
@@ -128,12 +171,41 @@ class RouteHandleTraverser {
     size_t getSplitSize() const {
       return splitSize_;
     }
+
+    /**
+     * Set forwardOnly
+     */
+    void setForwardOnly(bool value) {
+      forwardOnly_ = value;
+    }
+
+    /**
+     * Get forwardOnly option
+     */
+    bool getForwardOnly() const {
+      return forwardOnly_;
+    }
+
+    /**
+     * Set forwardAll
+     */
+    void setForwardAll(bool value) {
+      forwardAll_ = value;
+    }
+
+    /**
+     * Get forwardAll option
+     */
+    bool getForwardAll() const {
+      return forwardAll_;
+    }
   };
 
  private:
   StartFunc start_;
   EndFunc end_;
   AccessPointFunc accessPointFn_;
+  ForwardFunc forwardFn_;
   Options options_;
 
  public:
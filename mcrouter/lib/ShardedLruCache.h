@@ -0,0 +1,165 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <folly/Hash.h>
+#include <folly/Optional.h>
+#include <folly/Range.h>
+#include <folly/container/EvictingCacheMap.h>
+
+namespace facebook {
+namespace memcache {
+
+/**
+ * Thread-safe LRU map from string keys to values, with a bounded number of
+ * entries.
+ *
+ * Keys are hashed into shards, each with its own lock and an equal share of
+ * the capacity, so that threads working on different keys rarely contend.
+ * LRU order is maintained per shard.
+ *
+ * @param Value  Copyable type of stored values; get() returns a copy.
+ */
+template <class Value>
+class ShardedLruCache {
+ public:
+  static constexpr size_t kDefaultNumShards = 16;
+
+  struct Stats {
+    uint64_t lookups{0};
+    uint64_t hits{0};
+    // Entries dropped to make room for new ones.
+    uint64_t evictions{0};
+    size_t size{0};
+  };
+
+  /**
+   * @param capacity   Max total number of entries. 0 disables the cache.
+   * @param numShards  Number of independently locked shards.
+   */
+  explicit ShardedLruCache(
+      size_t capacity,
+      size_t numShards = kDefaultNumShards) {
+    numShards = std::max<size_t>(numShards, 1);
+    shards_.reserve(numShards);
+    for (size_t i = 0; i < numShards; ++i) {
+      shards_.push_back(std::make_unique<Shard>());
+    }
+    setCapacity(capacity);
+  }
+
+  ShardedLruCache(const ShardedLruCache&) = delete;
+  ShardedLruCache& operator=(const ShardedLruCache&) = delete;
+
+  /**
+   * @return  Copy of the value of key (making it the most recently used
+   *          one in its shard), none if there is no such key.
+   */
+  folly::Optional<Value> get(folly::StringPiece key) {
+    lookups_.fetch_add(1, std::memory_order_relaxed);
+    auto& shard = shardFor(key);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto it = shard.map.find(key.str());
+    if (it == shard.map.end()) {
+      return folly::none;
+    }
+    hits_.fetch_add(1, std::memory_order_relaxed);
+    return it->second;
+  }
+
+  /**
+   * Inserts or replaces the value of key, evicting the least recently used
+   * entry of the shard if it is full.
+   */
+  void set(folly::StringPiece key, Value value) {
+    auto& shard = shardFor(key);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    if (shard.capacity == 0) {
+      return;
+    }
+    auto k = key.str();
+    if (shard.map.size() >= shard.capacity && !shard.map.exists(k)) {
+      evictions_.fetch_add(1, std::memory_order_relaxed);
+    }
+    shard.map.set(std::move(k), std::move(value));
+  }
+
+  /**
+   * @return  true if key was present.
+   */
+  bool remove(folly::StringPiece key) {
+    auto& shard = shardFor(key);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    return shard.map.erase(key.str());
+  }
+
+  /**
+   * Changes the max total number of entries, evicting entries if needed.
+   */
+  void setCapacity(size_t capacity) {
+    // Rounded up, so that a small non-zero capacity leaves every shard usable.
+    const size_t perShard = capacity == 0
+        ? 0
+        : std::max<size_t>((capacity + shards_.size() - 1) / shards_.size(), 1);
+    for (auto& shard : shards_) {
+      std::lock_guard<std::mutex> lock(shard->mutex);
+      shard->capacity = perShard;
+      if (perShard == 0) {
+        shard->map.clear();
+      } else {
+        // EvictingCacheMap prunes the least recently used entries itself.
+        shard->map.setMaxSize(perShard);
+      }
+    }
+  }
+
+  Stats getStats() const {
+    Stats stats;
+    stats.lookups = lookups_.load(std::memory_order_relaxed);
+    stats.hits = hits_.load(std::memory_order_relaxed);
+    stats.evictions = evictions_.load(std::memory_order_relaxed);
+    for (const auto& shard : shards_) {
+      std::lock_guard<std::mutex> lock(shard->mutex);
+      stats.size += shard->map.size();
+    }
+    return stats;
+  }
+
+ private:
+  struct Shard {
+    std::mutex mutex;
+    // 0 means the map is unbounded, so capacity 0 is handled separately.
+    folly::EvictingCacheMap<std::string, Value> map{1};
+    size_t capacity{0};
+  };
+
+  std::vector<std::unique_ptr<Shard>> shards_;
+
+  std::atomic<uint64_t> lookups_{0};
+  std::atomic<uint64_t> hits_{0};
+  std::atomic<uint64_t> evictions_{0};
+
+  Shard& shardFor(folly::StringPiece key) {
+    return *shards_[folly::hasher<folly::StringPiece>()(key) % shards_.size()];
+  }
+};
+
+template <class Value>
+constexpr size_t ShardedLruCache<Value>::kDefaultNumShards;
+
+} // namespace memcache
+} // namespace facebook
@@ -15,6 +15,7 @@
 #include <type_traits>
 #include <utility>
 
+#include <folly/Likely.h>
 #include <folly/Optional.h>
 #include <folly/io/Cursor.h>
 #include <folly/io/IOBuf.h>
@@ -293,6 +294,29 @@ class CarbonProtocolReader {
     return rv;
   }
 
+  /**
+   * Reads the header of the next field only if it is field `id` of type
+   * `fieldType`, as written by CarbonProtocolWriter after the previous field.
+   * Lets code-generated deserializers read fields in their declared order
+   * without dispatching on the field id.
+   *
+   * @return  true iff the header was read.
+   */
+  bool readFieldHeaderIf(const FieldType fieldType, const int16_t id) {
+    const auto delta = id - lastFieldId_;
+    if (delta <= 0 || delta > 0xf) {
+      return false;
+    }
+    const auto bytes = cursor_.peekBytes();
+    if (bytes.empty() ||
+        bytes[0] != ((delta << 4) | static_cast<uint8_t>(fieldType))) {
+      return false;
+    }
+    cursor_.skip(1);
+    lastFieldId_ = id;
+    return true;
+  }
+
   void skip(const FieldType fieldType);
 
  private:
@@ -331,6 +355,22 @@ class CarbonProtocolReader {
     UnsignedT urv = 0;
     uint8_t iter = 0;
     uint8_t byte;
+
+    // Fast path: decode straight from the current buffer.
+    const auto bytes = cursor_.peekBytes();
+    if (LIKELY(bytes.size() >= kMaxIters)) {
+      do {
+        byte = bytes[iter];
+        urv |= static_cast<UnsignedT>(byte & 0x7f) << (kShift * iter++);
+      } while (byte & 0x80 && iter < kMaxIters);
+      if (!(byte & 0x80)) {
+        cursor_.skip(iter);
+        return static_cast<T>(urv);
+      }
+      urv = 0;
+      iter = 0;
+    }
+
     do {
       byte = readByte();
       urv |= static_cast<UnsignedT>(byte & 0x7f) << (kShift * iter++);
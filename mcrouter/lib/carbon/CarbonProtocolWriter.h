@@ -502,6 +502,10 @@ class CarbonProtocolWriterImpl {
     appender_.insert(std::move(buf));
   }
 
+  void appendRawData(const folly::IOBuf& buf) {
+    appender_.insert(buf);
+  }
+
  private:
   template <class T>
   void doWriteVarint(T val) {
@@ -34,8 +34,10 @@ void CarbonQueueAppenderStorage::coalesce() {
     newBuf.append(iovs_[i].iov_len);
   }
 
-  // Release old IOBufs and reset head to new large buffer
+  // Release old IOBufs (including the reserved one, if any) and reset head to
+  // new large buffer
   head_ = std::move(newBuf);
+  clearReserved();
   ++nIovsUsed_;
   iovs_[1] = {const_cast<uint8_t*>(head_->data()), head_->length()};
 }
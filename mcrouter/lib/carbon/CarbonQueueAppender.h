@@ -41,6 +41,14 @@ class CarbonQueueAppenderStorage {
       push(buf.data(), buf.length());
       return;
     }
+    // Anything that fits in the reserved buffer is copied there, which is
+    // cheaper than referencing it from another iovec.
+    if (!buf.empty() && !buf.isChained() &&
+        reservedIdx_ + buf.length() <= reservedLen_ &&
+        nIovsUsed_ < kMaxIovecs) {
+      pushReserved(buf.data(), buf.length());
+      return;
+    }
 
     finalizeLastIovec();
 
@@ -101,11 +109,36 @@ class CarbonQueueAppenderStorage {
 
       std::memcpy(&storage_[storageIdx_], buf, len);
       storageIdx_ += len;
+    } else if (reservedIdx_ + len <= reservedLen_) {
+      pushReserved(buf, len);
     } else {
       appendNoInline(folly::IOBuf(folly::IOBuf::COPY_BUFFER, buf, len));
     }
   }
 
+  /**
+   * Makes room for `len` more bytes of body, e.g. the serialized size upper
+   * bound of a message. If they don't fit in the inline storage, a single
+   * buffer of `len` bytes is allocated, and data that doesn't fit in the
+   * inline storage is copied there instead of into one new IOBuf per write.
+   */
+  void reserve(size_t len) {
+    if (storageIdx_ + len <= sizeof(storage_) ||
+        reservedIdx_ + len <= reservedLen_) {
+      return;
+    }
+    auto buf = folly::IOBuf::create(len);
+    reserved_ = buf->writableData();
+    reservedIdx_ = 0;
+    reservedLen_ = len;
+    // Owned by head_ from now on, like the IOBufs referenced by iovs_.
+    if (!head_) {
+      head_ = std::move(*buf);
+    } else {
+      head_->prependChain(std::move(buf));
+    }
+  }
+
   void coalesce();
 
   bool setFullBuffer(const folly::IOBuf& buf) {
@@ -123,6 +156,7 @@ class CarbonQueueAppenderStorage {
   void reset() {
     storageIdx_ = kMaxHeaderLength;
     head_.clear();
+    clearReserved();
     // Reserve first element of iovs_ for header, which won't be filled in
     // until after body data is serialized.
     iovs_[0] = {storage_, 0};
@@ -210,6 +244,34 @@ class CarbonQueueAppenderStorage {
   // also maintain views into this data via iovs_.
   folly::Optional<folly::IOBuf> head_;
 
+  // Buffer allocated by reserve(), owned by head_.
+  uint8_t* reserved_{nullptr};
+  size_t reservedIdx_{0};
+  size_t reservedLen_{0};
+
+  void pushReserved(const uint8_t* buf, size_t len) {
+    assert(nIovsUsed_ < kMaxIovecs);
+    finalizeLastIovec();
+    canUsePreviousIov_ = false;
+
+    uint8_t* dest = reserved_ + reservedIdx_;
+    auto& lastIov = iovs_[nIovsUsed_ - 1];
+    if (nIovsUsed_ > 1 &&
+        static_cast<uint8_t*>(lastIov.iov_base) + lastIov.iov_len == dest) {
+      lastIov.iov_len += len;
+    } else {
+      iovs_[nIovsUsed_++] = {dest, len};
+    }
+    std::memcpy(dest, buf, len);
+    reservedIdx_ += len;
+  }
+
+  void clearReserved() {
+    reserved_ = nullptr;
+    reservedIdx_ = 0;
+    reservedLen_ = 0;
+  }
+
   FOLLY_NOINLINE void appendNoInline(const folly::IOBuf& buf) {
     append(buf);
   }
@@ -0,0 +1,420 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+
+#include <folly/Range.h>
+
+#include "mcrouter/lib/carbon/CarbonProtocolReader.h"
+#include "mcrouter/lib/carbon/CarbonProtocolWriter.h"
+#include "mcrouter/lib/carbon/CarbonStraightLineWriter.h"
+#include "mcrouter/lib/network/gen/MemcacheMessages.h"
+
+namespace carbon {
+
+/**
+ * Hand-written (de)serializers of the hottest messages, used by the Caret
+ * protocol instead of the code-generated ones (see serializeMessage() and
+ * deserializeMessage() below). The wire format is byte for byte the same.
+ *
+ * A specialization provides:
+ *  - kMaxFixedSize, an upper bound of the serialized size of all fields but
+ *    binary data and container items;
+ *  - serialize(), which writes the fields in order through
+ *    CarbonStraightLineWriter;
+ *  - deserialize(), which reads the fields in declared order, and falls back
+ *    to field id dispatch for out-of-order or unknown fields;
+ *  - sizeUpperBound(), an upper bound of the whole serialized size.
+ */
+template <class Message>
+struct StraightLineSerializer {
+  static constexpr bool kEnabled = false;
+};
+
+namespace detail {
+
+/**
+ * Visitor reading the field with a given id, if the message has one.
+ */
+class FieldIdReader {
+ public:
+  FieldIdReader(CarbonProtocolReader& reader, FieldType type, int16_t id)
+      : reader_(reader), type_(type), id_(id) {}
+
+  template <class T>
+  bool visitField(uint16_t id, folly::StringPiece /* name */, T&& field) {
+    if (static_cast<int16_t>(id) != id_) {
+      return true;
+    }
+    reader_.readField(std::forward<T>(field), type_);
+    found_ = true;
+    return false;
+  }
+
+  bool found() const {
+    return found_;
+  }
+
+ private:
+  CarbonProtocolReader& reader_;
+  const FieldType type_;
+  const int16_t id_;
+  bool found_{false};
+};
+
+template <class Message>
+void readRemainingFields(Message& msg, CarbonProtocolReader& reader) {
+  while (true) {
+    const auto pr = reader.readFieldHeader();
+    if (pr.first == FieldType::Stop) {
+      break;
+    }
+    FieldIdReader fieldReader(reader, pr.first, pr.second);
+    msg.visitFields(fieldReader);
+    if (!fieldReader.found()) {
+      reader.skip(pr.first);
+    }
+  }
+  reader.readStructEnd();
+}
+
+} // namespace detail
+
+template <>
+struct StraightLineSerializer<facebook::memcache::McGetRequest> {
+  using Message = facebook::memcache::McGetRequest;
+
+  static constexpr bool kEnabled = true;
+  static constexpr size_t kMaxFixedSize = kMaxBinaryFieldHeaderSize /* key */ +
+      maxScalarFieldSize<uint64_t>() /* flags */ + kFieldStopSize;
+
+  template <class TS>
+  static void serialize(const Message& msg, CarbonProtocolWriterImpl<TS>& w) {
+    CarbonStraightLineWriter<TS, kMaxFixedSize> out(w);
+    out.writeField(1 /* field id */, msg.key());
+    out.writeField(2 /* field id */, msg.flags());
+    out.writeFieldStop();
+  }
+
+  static void deserialize(Message& msg, CarbonProtocolReader& reader) {
+    reader.readStructBegin();
+    if (reader.readFieldHeaderIf(FieldType::Binary, 1)) {
+      reader.readField(msg.key(), FieldType::Binary);
+    }
+    if (reader.readFieldHeaderIf(FieldType::Int64, 2)) {
+      reader.readField(msg.flags(), FieldType::Int64);
+    }
+    detail::readRemainingFields(msg, reader);
+  }
+
+  static size_t sizeUpperBound(const Message& msg) {
+    return kMaxFixedSize + msg.key().raw().computeChainDataLength();
+  }
+};
+
+template <>
+struct StraightLineSerializer<facebook::memcache::McGetReply> {
+  using Message = facebook::memcache::McGetReply;
+
+  static constexpr bool kEnabled = true;
+  static constexpr size_t kMaxFixedSize =
+      maxScalarFieldSize<int16_t>() /* result */ +
+      kMaxBinaryFieldHeaderSize /* value */ +
+      maxScalarFieldSize<uint64_t>() /* flags */ +
+      kMaxBinaryFieldHeaderSize /* message */ +
+      maxScalarFieldSize<int16_t>() /* appSpecificErrorCode */ +
+      kFieldStopSize;
+
+  template <class TS>
+  static void serialize(const Message& msg, CarbonProtocolWriterImpl<TS>& w) {
+    CarbonStraightLineWriter<TS, kMaxFixedSize> out(w);
+    out.writeField(1 /* field id */, msg.result());
+    out.writeField(2 /* field id */, msg.value());
+    out.writeField(3 /* field id */, msg.flags());
+    out.writeField(4 /* field id */, msg.message());
+    out.writeField(5 /* field id */, msg.appSpecificErrorCode());
+    out.writeFieldStop();
+  }
+
+  static void deserialize(Message& msg, CarbonProtocolReader& reader) {
+    reader.readStructBegin();
+    if (reader.readFieldHeaderIf(FieldType::Int16, 1)) {
+      reader.readField(msg.result(), FieldType::Int16);
+    }
+    if (reader.readFieldHeaderIf(FieldType::Binary, 2)) {
+      reader.readField(msg.value(), FieldType::Binary);
+    }
+    if (reader.readFieldHeaderIf(FieldType::Int64, 3)) {
+      reader.readField(msg.flags(), FieldType::Int64);
+    }
+    if (reader.readFieldHeaderIf(FieldType::Binary, 4)) {
+      reader.readField(msg.message(), FieldType::Binary);
+    }
+    if (reader.readFieldHeaderIf(FieldType::Int16, 5)) {
+      reader.readField(msg.appSpecificErrorCode(), FieldType::Int16);
+    }
+    detail::readRemainingFields(msg, reader);
+  }
+
+  static size_t sizeUpperBound(const Message& msg) {
+    return kMaxFixedSize +
+        (msg.value().has_value() ? msg.value()->computeChainDataLength()
+                                 : 0) +
+        msg.message().size();
+  }
+};
+
+template <>
+struct StraightLineSerializer<facebook::memcache::McSetRequest> {
+  using Message = facebook::memcache::McSetRequest;
+
+  static constexpr bool kEnabled = true;
+  static constexpr size_t kMaxFixedSize = kMaxBinaryFieldHeaderSize /* key */ +
+      maxScalarFieldSize<int32_t>() /* exptime */ +
+      maxScalarFieldSize<uint64_t>() /* flags */ +
+      kMaxBinaryFieldHeaderSize /* value */ + kFieldStopSize;
+
+  template <class TS>
+  static void serialize(const Message& msg, CarbonProtocolWriterImpl<TS>& w) {
+    CarbonStraightLineWriter<TS, kMaxFixedSize> out(w);
+    out.writeField(1 /* field id */, msg.key());
+    out.writeField(2 /* field id */, msg.exptime());
+    out.writeField(3 /* field id */, msg.flags());
+    out.writeField(4 /* field id */, msg.value());
+    out.writeFieldStop();
+  }
+
+  static void deserialize(Message& msg, CarbonProtocolReader& reader) {
+    reader.readStructBegin();
+    if (reader.readFieldHeaderIf(FieldType::Binary, 1)) {
+      reader.readField(msg.key(), FieldType::Binary);
+    }
+    if (reader.readFieldHeaderIf(FieldType::Int32, 2)) {
+      reader.readField(msg.exptime(), FieldType::Int32);
+    }
+    if (reader.readFieldHeaderIf(FieldType::Int64, 3)) {
+      reader.readField(msg.flags(), FieldType::Int64);
+    }
+    if (reader.readFieldHeaderIf(FieldType::Binary, 4)) {
+      reader.readField(msg.value(), FieldType::Binary);
+    }
+    detail::readRemainingFields(msg, reader);
+  }
+
+  static size_t sizeUpperBound(const Message& msg) {
+    return kMaxFixedSize + msg.key().raw().computeChainDataLength() +
+        msg.value().computeChainDataLength();
+  }
+};
+
+template <>
+struct StraightLineSerializer<facebook::memcache::McSetReply> {
+  using Message = facebook::memcache::McSetReply;
+
+  static constexpr bool kEnabled = true;
+  static constexpr size_t kMaxFixedSize =
+      maxScalarFieldSize<int16_t>() /* result */ +
+      maxScalarFieldSize<uint64_t>() /* flags */ +
+      kMaxBinaryFieldHeaderSize /* value */ +
+      kMaxBinaryFieldHeaderSize /* message */ +
+      maxScalarFieldSize<int16_t>() /* appSpecificErrorCode */ +
+      kFieldStopSize;
+
+  template <class TS>
+  static void serialize(const Message& msg, CarbonProtocolWriterImpl<TS>& w) {
+    CarbonStraightLineWriter<TS, kMaxFixedSize> out(w);
+    out.writeField(1 /* field id */, msg.result());
+    out.writeField(2 /* field id */, msg.flags());
+    out.writeField(3 /* field id */, msg.value());
+    out.writeField(4 /* field id */, msg.message());
+    out.writeField(5 /* field id */, msg.appSpecificErrorCode());
+    out.writeFieldStop();
+  }
+
+  static void deserialize(Message& msg, CarbonProtocolReader& reader) {
+    reader.readStructBegin();
+    if (reader.readFieldHeaderIf(FieldType::Int16, 1)) {
+      reader.readField(msg.result(), FieldType::Int16);
+    }
+    if (reader.readFieldHeaderIf(FieldType::Int64, 2)) {
+      reader.readField(msg.flags(), FieldType::Int64);
+    }
+    if (reader.readFieldHeaderIf(FieldType::Binary, 3)) {
+      reader.readField(msg.value(), FieldType::Binary);
+    }
+    if (reader.readFieldHeaderIf(FieldType::Binary, 4)) {
+      reader.readField(msg.message(), FieldType::Binary);
+    }
+    if (reader.readFieldHeaderIf(FieldType::Int16, 5)) {
+      reader.readField(msg.appSpecificErrorCode(), FieldType::Int16);
+    }
+    detail::readRemainingFields(msg, reader);
+  }
+
+  static size_t sizeUpperBound(const Message& msg) {
+    return kMaxFixedSize + msg.value().computeChainDataLength() +
+        msg.message().size();
+  }
+};
+
+template <>
+struct StraightLineSerializer<facebook::memcache::McDeleteRequest> {
+  using Message = facebook::memcache::McDeleteRequest;
+
+  static constexpr bool kEnabled = true;
+  static constexpr size_t kMaxFixedSize = kMaxBinaryFieldHeaderSize /* key */ +
+      maxScalarFieldSize<uint64_t>() /* flags */ +
+      maxScalarFieldSize<int32_t>() /* exptime */ +
+      kMaxBinaryFieldHeaderSize /* value */ +
+      kMaxKVContainerFieldHeaderSize /* attributes */ + kFieldStopSize;
+
+  template <class TS>
+  static void serialize(const Message& msg, CarbonProtocolWriterImpl<TS>& w) {
+    CarbonStraightLineWriter<TS, kMaxFixedSize> out(w);
+    out.writeField(1 /* field id */, msg.key());
+    out.writeField(2 /* field id */, msg.flags());
+    out.writeField(3 /* field id */, msg.exptime());
+    out.writeField(4 /* field id */, msg.value());
+    out.writeField(5 /* field id */, msg.attributes());
+    out.writeFieldStop();
+  }
+
+  static void deserialize(Message& msg, CarbonProtocolReader& reader) {
+    reader.readStructBegin();
+    if (reader.readFieldHeaderIf(FieldType::Binary, 1)) {
+      reader.readField(msg.key(), FieldType::Binary);
+    }
+    if (reader.readFieldHeaderIf(FieldType::Int64, 2)) {
+      reader.readField(msg.flags(), FieldType::Int64);
+    }
+    if (reader.readFieldHeaderIf(FieldType::Int32, 3)) {
+      reader.readField(msg.exptime(), FieldType::Int32);
+    }
+    if (reader.readFieldHeaderIf(FieldType::Binary, 4)) {
+      reader.readField(msg.value(), FieldType::Binary);
+    }
+    if (reader.readFieldHeaderIf(FieldType::Map, 5)) {
+      reader.readField(msg.attributes(), FieldType::Map);
+    }
+    detail::readRemainingFields(msg, reader);
+  }
+
+  static size_t sizeUpperBound(const Message& msg) {
+    size_t size = kMaxFixedSize + msg.key().raw().computeChainDataLength() +
+        msg.value().computeChainDataLength();
+    for (const auto& attribute : msg.attributes()) {
+      size += maxVarintSize<uint32_t>() + attribute.first.size() +
+          maxVarintSize<uint64_t>();
+    }
+    return size;
+  }
+};
+
+template <>
+struct StraightLineSerializer<facebook::memcache::McDeleteReply> {
+  using Message = facebook::memcache::McDeleteReply;
+
+  static constexpr bool kEnabled = true;
+  static constexpr size_t kMaxFixedSize =
+      maxScalarFieldSize<int16_t>() /* result */ +
+      maxScalarFieldSize<uint64_t>() /* flags */ +
+      kMaxBinaryFieldHeaderSize /* value */ +
+      kMaxBinaryFieldHeaderSize /* message */ +
+      maxScalarFieldSize<int16_t>() /* appSpecificErrorCode */ +
+      kFieldStopSize;
+
+  template <class TS>
+  static void serialize(const Message& msg, CarbonProtocolWriterImpl<TS>& w) {
+    CarbonStraightLineWriter<TS, kMaxFixedSize> out(w);
+    out.writeField(1 /* field id */, msg.result());
+    out.writeField(2 /* field id */, msg.flags());
+    out.writeField(3 /* field id */, msg.value());
+    out.writeField(4 /* field id */, msg.message());
+    out.writeField(5 /* field id */, msg.appSpecificErrorCode());
+    out.writeFieldStop();
+  }
+
+  static void deserialize(Message& msg, CarbonProtocolReader& reader) {
+    reader.readStructBegin();
+    if (reader.readFieldHeaderIf(FieldType::Int16, 1)) {
+      reader.readField(msg.result(), FieldType::Int16);
+    }
+    if (reader.readFieldHeaderIf(FieldType::Int64, 2)) {
+      reader.readField(msg.flags(), FieldType::Int64);
+    }
+    if (reader.readFieldHeaderIf(FieldType::Binary, 3)) {
+      reader.readField(msg.value(), FieldType::Binary);
+    }
+    if (reader.readFieldHeaderIf(FieldType::Binary, 4)) {
+      reader.readField(msg.message(), FieldType::Binary);
+    }
+    if (reader.readFieldHeaderIf(FieldType::Int16, 5)) {
+      reader.readField(msg.appSpecificErrorCode(), FieldType::Int16);
+    }
+    detail::readRemainingFields(msg, reader);
+  }
+
+  static size_t sizeUpperBound(const Message& msg) {
+    return kMaxFixedSize + msg.value().computeChainDataLength() +
+        msg.message().size();
+  }
+};
+
+/**
+ * Serializes `msg` with its straight-line serializer if it has one, with the
+ * code-generated serialize() otherwise.
+ */
+template <class Message, class TS>
+typename std::enable_if<StraightLineSerializer<Message>::kEnabled>::type
+serializeMessage(const Message& msg, CarbonProtocolWriterImpl<TS>& writer) {
+  StraightLineSerializer<Message>::serialize(msg, writer);
+}
+
+template <class Message, class TS>
+typename std::enable_if<!StraightLineSerializer<Message>::kEnabled>::type
+serializeMessage(const Message& msg, CarbonProtocolWriterImpl<TS>& writer) {
+  msg.serialize(writer);
+}
+
+/**
+ * Deserializes `msg` with its straight-line deserializer if it has one, with
+ * the code-generated deserialize() otherwise.
+ */
+template <class Message>
+typename std::enable_if<StraightLineSerializer<Message>::kEnabled>::type
+deserializeMessage(Message& msg, CarbonProtocolReader& reader) {
+  StraightLineSerializer<Message>::deserialize(msg, reader);
+}
+
+template <class Message>
+typename std::enable_if<!StraightLineSerializer<Message>::kEnabled>::type
+deserializeMessage(Message& msg, CarbonProtocolReader& reader) {
+  msg.deserialize(reader);
+}
+
+/**
+ * @return  Upper bound of the serialized size of `msg`, or 0 if unknown
+ *          (i.e. it has no straight-line serializer).
+ */
+template <class Message>
+typename std::enable_if<StraightLineSerializer<Message>::kEnabled, size_t>::type
+serializedSizeUpperBound(const Message& msg) {
+  return StraightLineSerializer<Message>::sizeUpperBound(msg);
+}
+
+template <class Message>
+typename std::
+    enable_if<!StraightLineSerializer<Message>::kEnabled, size_t>::type
+    serializedSizeUpperBound(const Message&) {
+  return 0;
+}
+
+} // namespace carbon
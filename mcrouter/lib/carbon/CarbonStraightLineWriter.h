@@ -0,0 +1,224 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <cassert>
+#include <cstring>
+#include <limits>
+#include <string>
+#include <type_traits>
+
+#include <folly/Range.h>
+#include <folly/Traits.h>
+#include <folly/io/IOBuf.h>
+#include <thrift/lib/cpp2/FieldRef.h>
+
+#include "mcrouter/lib/carbon/CarbonProtocolWriter.h"
+#include "mcrouter/lib/carbon/Fields.h"
+#include "mcrouter/lib/carbon/Keys.h"
+#include "mcrouter/lib/carbon/Result.h"
+#include "mcrouter/lib/carbon/Util.h"
+#include "mcrouter/lib/fbi/cpp/util.h"
+
+namespace carbon {
+
+// Upper bounds of the serialized size of field headers and values, used to
+// size the buffer of CarbonStraightLineWriter.
+constexpr size_t kMaxFieldHeaderSize = 1 /* type */ + sizeof(int16_t) /* id */;
+
+template <class T>
+constexpr size_t maxVarintSize() {
+  return (sizeof(T) * 8 + 6) / 7;
+}
+
+template <class T>
+constexpr size_t maxScalarFieldSize() {
+  return kMaxFieldHeaderSize + (sizeof(T) == 1 ? 1 : maxVarintSize<T>());
+}
+
+// Header and length of a binary field (or size of a list), without data.
+constexpr size_t kMaxBinaryFieldHeaderSize =
+    kMaxFieldHeaderSize + maxVarintSize<uint32_t>();
+
+// Header, size and key/value types of a map, without items.
+constexpr size_t kMaxKVContainerFieldHeaderSize =
+    kMaxFieldHeaderSize + maxVarintSize<uint32_t>() + 1;
+
+constexpr size_t kFieldStopSize = 1;
+
+/**
+ * Serializes the fields of a Carbon struct, in order, with the same wire
+ * format as CarbonProtocolWriter::writeField(). Used by the serializers of
+ * hot messages in CarbonStraightLineSerializers.h.
+ *
+ * Headers, lengths and scalars are encoded into a stack buffer of kMaxSize
+ * bytes, which is handed to the writer in one piece before every binary
+ * field and after the field stop. kMaxSize must bound the serialized size
+ * of all fields but binary data and container items.
+ */
+template <class TS, size_t kMaxSize>
+class CarbonStraightLineWriter {
+ public:
+  explicit CarbonStraightLineWriter(CarbonProtocolWriterImpl<TS>& writer)
+      : writer_(writer) {}
+
+  CarbonStraightLineWriter(const CarbonStraightLineWriter&) = delete;
+  CarbonStraightLineWriter& operator=(const CarbonStraightLineWriter&) =
+      delete;
+
+  template <class T>
+  typename std::enable_if<
+      folly::IsOneOf<
+          T,
+          char,
+          int8_t,
+          uint8_t,
+          int16_t,
+          uint16_t,
+          int32_t,
+          uint32_t,
+          int64_t,
+          uint64_t>::value,
+      void>::type
+  writeField(const int16_t id, const T value) {
+    if (!value) {
+      return;
+    }
+    writeFieldHeader(detail::TypeToField<T>::fieldType, id);
+    writeScalar(value);
+  }
+
+  void writeField(const int16_t id, const Result res) {
+    // Same narrowing as CarbonProtocolWriter.
+    writeField(id, static_cast<int16_t>(res));
+  }
+
+  void writeField(const int16_t id, const folly::IOBuf& buf) {
+    if (buf.empty()) {
+      return;
+    }
+    writeFieldAlways(id, buf);
+  }
+
+  void writeField(const int16_t id, const std::string& s) {
+    if (s.empty()) {
+      return;
+    }
+    writeBinaryFieldHeader(id, s.size());
+    flush();
+    writer_.writeFixedSize(folly::ByteRange(folly::StringPiece(s)));
+  }
+
+  template <class Storage>
+  void writeField(const int16_t id, const Keys<Storage>& key) {
+    writeField(id, key.raw());
+  }
+
+  void writeField(
+      const int16_t id,
+      const apache::thrift::optional_field_ref<const folly::IOBuf&> buf) {
+    if (buf.has_value()) {
+      writeFieldAlways(id, *buf);
+    }
+  }
+
+  template <class T>
+  typename std::enable_if<detail::IsKVContainer<T>::value, void>::type
+  writeField(const int16_t id, const T& m) {
+    if (SerializationTraits<T>::size(m) == 0) {
+      return;
+    }
+    writeFieldHeader(FieldType::Map, id);
+    flush();
+    writer_.writeRaw(m);
+  }
+
+  void writeFieldStop() {
+    writeByte(static_cast<uint8_t>(FieldType::Stop));
+    flush();
+  }
+
+ private:
+  CarbonProtocolWriterImpl<TS>& writer_;
+  uint8_t buf_[kMaxSize];
+  size_t pos_{0};
+  int16_t lastFieldId_{0};
+
+  void writeFieldAlways(const int16_t id, const folly::IOBuf& buf) {
+    writeBinaryFieldHeader(id, buf.computeChainDataLength());
+    flush();
+    writer_.appendRawData(buf);
+  }
+
+  void writeBinaryFieldHeader(const int16_t id, const size_t len) {
+    facebook::memcache::checkRuntime(
+        len <= std::numeric_limits<uint32_t>::max(),
+        "Input to writeField() too long (len = {})",
+        len);
+    writeFieldHeader(FieldType::Binary, id);
+    writeVarint(static_cast<uint32_t>(len));
+  }
+
+  void writeFieldHeader(const FieldType type, const int16_t id) {
+    const auto typeByte = static_cast<uint8_t>(type);
+    if (id > lastFieldId_ && (id - lastFieldId_) <= 0xf) {
+      const auto delta = static_cast<uint8_t>(id - lastFieldId_);
+      writeByte((delta << 4) | typeByte);
+    } else {
+      writeByte(typeByte);
+      const auto idBytes = static_cast<uint16_t>(id);
+      assert(pos_ + sizeof(idBytes) <= kMaxSize);
+      std::memcpy(buf_ + pos_, &idBytes, sizeof(idBytes));
+      pos_ += sizeof(idBytes);
+    }
+    lastFieldId_ = id;
+  }
+
+  template <class T>
+  typename std::enable_if<sizeof(T) == 1, void>::type writeScalar(
+      const T value) {
+    writeByte(static_cast<uint8_t>(value));
+  }
+
+  template <class T>
+  typename std::enable_if<sizeof(T) != 1, void>::type writeScalar(
+      const T value) {
+    using SignedT = typename std::make_signed<T>::type;
+    writeVarint(util::zigzag(static_cast<SignedT>(value)));
+  }
+
+  template <class T>
+  void writeVarint(T val) {
+    constexpr uint8_t kMaxIters = maxVarintSize<T>();
+    static_assert(
+        std::is_unsigned<T>::value,
+        "writeVarint should only be called with unsigned types");
+    assert(pos_ + kMaxIters <= kMaxSize);
+
+    uint8_t iter = 0;
+    while (val >= 0x80 && ++iter < kMaxIters) {
+      buf_[pos_++] = 0x80 | (static_cast<uint8_t>(val) & 0x7f);
+      val >>= 7;
+    }
+    buf_[pos_++] = static_cast<uint8_t>(val);
+  }
+
+  void writeByte(const uint8_t byte) {
+    assert(pos_ < kMaxSize);
+    buf_[pos_++] = byte;
+  }
+
+  void flush() {
+    if (pos_ > 0) {
+      writer_.writeFixedSize(folly::ByteRange(buf_, pos_));
+      pos_ = 0;
+    }
+  }
+};
+
+} // namespace carbon
@@ -31,6 +31,7 @@ class RequestCommon : public MessageCommon {
           McFbtraceRef::moveRef(mc_fbtrace_info_deep_copy(other.fbtraceInfo()));
     }
     traceContext_ = other.traceContext_;
+    timeoutMs_ = other.timeoutMs_;
   }
   RequestCommon& operator=(const RequestCommon& other) {
     if (this != &other) {
@@ -42,6 +43,7 @@ class RequestCommon : public MessageCommon {
             mc_fbtrace_info_deep_copy(other.fbtraceInfo()));
       }
       traceContext_ = other.traceContext_;
+      timeoutMs_ = other.timeoutMs_;
     }
     return *this;
   }
@@ -95,6 +97,22 @@ class RequestCommon : public MessageCommon {
   }
 #endif
 
+  /**
+   * Time (in ms) the client is willing to wait for the reply to this request,
+   * as carried over the wire. 0 means the request has no deadline.
+   */
+  uint64_t timeoutMs() const {
+    return timeoutMs_;
+  }
+
+  /**
+   * Sets the time budget sent along with this request. Doesn't affect the
+   * serialized buffer, the budget is only part of the message header.
+   */
+  void setTimeoutMs(uint64_t timeoutMs) {
+    timeoutMs_ = timeoutMs;
+  }
+
   /**
    * Tells whether or not "serializedBuffer()" is dirty, in which case it can't
    * be used.
@@ -137,6 +155,7 @@ class RequestCommon : public MessageCommon {
   static constexpr size_t kTraceIdSize = 11;
 
   const folly::IOBuf* serializedBuffer_{nullptr};
+  uint64_t timeoutMs_{0};
 
 #ifndef LIBMC_FBTRACE_DISABLE
   struct McFbtraceRefPolicy {
@@ -109,6 +109,17 @@ typename std::enable_if_t<!Request::hasKey, folly::StringPiece> getFullKey(
   return "";
 }
 
+template <class Request>
+typename std::enable_if_t<Request::hasKey, folly::StringPiece>
+getKeyWithoutRoute(const Request& req) {
+  return req.key().keyWithoutRoute();
+}
+template <class Request>
+typename std::enable_if_t<!Request::hasKey, folly::StringPiece>
+getKeyWithoutRoute(const Request&) {
+  return "";
+}
+
 template <typename Reply>
 typename std::enable_if_t<
     detail::HasAppSpecificErrorCode<Reply>::value,
@@ -0,0 +1,63 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include "CaptureFilter.h"
+
+#include <boost/regex.hpp>
+
+#include <glog/logging.h>
+
+#include <folly/hash/Hash.h>
+
+namespace facebook {
+namespace memcache {
+
+struct CaptureFilter::KeyPattern {
+  boost::regex regex;
+};
+
+CaptureFilter::CaptureFilter(const ShmRing::Filter& filter)
+    : sampleRate_(filter.sampleRate),
+      minValueSize_(filter.minValueSize),
+      minLatencyUs_(filter.minLatencyUs) {
+  if (filter.keyPattern[0] != '\0') {
+    boost::regex::flag_type flags = boost::regex_constants::basic;
+    if (filter.keyPatternIgnoreCase) {
+      flags |= boost::regex_constants::icase;
+    }
+    try {
+      keyPattern_ = std::make_unique<KeyPattern>();
+      keyPattern_->regex.assign(filter.keyPattern, flags);
+    } catch (const std::exception& e) {
+      LOG(ERROR) << "Invalid debug fifo key pattern '" << filter.keyPattern
+                 << "', ignoring it: " << e.what();
+      keyPattern_.reset();
+    }
+  }
+}
+
+CaptureFilter::~CaptureFilter() = default;
+
+bool CaptureFilter::sampled(uint64_t connectionId) const noexcept {
+  return sampleRate_ <= 1 ||
+      folly::hash::twang_mix64(connectionId) % sampleRate_ == 0;
+}
+
+bool CaptureFilter::matchesKey(folly::StringPiece key) const noexcept {
+  if (!keyPattern_ || key.empty()) {
+    return true;
+  }
+  try {
+    return boost::regex_search(key.begin(), key.end(), keyPattern_->regex);
+  } catch (const std::exception&) {
+    // e.g. the pattern is too complex for the key.
+    return true;
+  }
+}
+
+} // memcache
+} // facebook
@@ -0,0 +1,84 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <memory>
+
+#include <folly/Range.h>
+
+#include "mcrouter/lib/debug/ShmRing.h"
+
+namespace facebook {
+namespace memcache {
+
+/**
+ * Filter pushed down by the reader of a debug fifo ring (i.e. mcpiper), so
+ * that messages it would discard are never written.
+ *
+ * Requests are filtered by connection sampling and key. Replies are
+ * captured only if the request they answer was, and are further filtered
+ * by size and latency.
+ */
+class CaptureFilter {
+ public:
+  explicit CaptureFilter(const ShmRing::Filter& filter);
+  ~CaptureFilter();
+
+  /**
+   * Tells whether this filter lets everything through.
+   */
+  bool empty() const noexcept {
+    return sampleRate_ <= 1 && minValueSize_ == 0 && minLatencyUs_ == 0 &&
+        !keyPattern_;
+  }
+
+  /**
+   * Tells whether replies need to be matched with their requests to be
+   * filtered.
+   */
+  bool matchesReplies() const noexcept {
+    return minLatencyUs_ != 0 || keyPattern_;
+  }
+
+  /**
+   * Tells whether messages of the given connection are sampled.
+   */
+  bool sampled(uint64_t connectionId) const noexcept;
+
+  /**
+   * Tells whether a request with the given key should be captured.
+   * Requests whose key is not known (empty) always are.
+   */
+  bool matchesKey(folly::StringPiece key) const noexcept;
+
+  /**
+   * Tells whether a reply of the given size should be captured.
+   * Replies whose size is not known (0) always are.
+   */
+  bool matchesSize(size_t size) const noexcept {
+    return size == 0 || size >= minValueSize_;
+  }
+
+  /**
+   * Tells whether a reply that took latencyUs should be captured.
+   */
+  bool matchesLatency(uint64_t latencyUs) const noexcept {
+    return latencyUs >= minLatencyUs_;
+  }
+
+ private:
+  struct KeyPattern;
+
+  uint32_t sampleRate_{0};
+  uint32_t minValueSize_{0};
+  uint64_t minLatencyUs_{0};
+  std::unique_ptr<KeyPattern> keyPattern_;
+};
+
+} // memcache
+} // facebook
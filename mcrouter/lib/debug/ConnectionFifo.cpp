@@ -7,6 +7,7 @@
 
 #include "ConnectionFifo.h"
 
+#include <algorithm>
 #include <chrono>
 
 #include <folly/Range.h>
@@ -177,19 +178,89 @@ bool ConnectionFifo::isConnected() const noexcept {
 
 bool ConnectionFifo::startMessage(
     MessageDirection direction,
-    uint32_t typeId) noexcept {
+    uint32_t typeId,
+    const CaptureInfo& info) noexcept {
   if (!isConnected()) {
     return false;
   }
+  const auto timeUs = timeSinceEpoch();
+  if (auto filter = debugFifo_->captureFilter()) {
+    capturing_ = shouldCapture(*filter, typeId, timeUs, info);
+  } else {
+    capturing_ = true;
+    pendingRequests_.clear();
+  }
+  if (!capturing_) {
+    return false;
+  }
   currentMessageHeader_.setDirection(direction);
   currentMessageHeader_.setTypeId(typeId);
-  currentMessageHeader_.setTimeUs(timeSinceEpoch());
+  currentMessageHeader_.setTimeUs(timeUs);
   nextPacketId_ = 0;
   return true;
 }
 
+bool ConnectionFifo::startMessage(
+    MessageDirection direction,
+    uint32_t typeId) noexcept {
+  return startMessage(direction, typeId, CaptureInfo());
+}
+
+bool ConnectionFifo::shouldCapture(
+    const CaptureFilter& filter,
+    uint32_t typeId,
+    uint64_t timeUs,
+    const CaptureInfo& info) noexcept {
+  if (!filter.sampled(currentMessageHeader_.connectionId())) {
+    return false;
+  }
+
+  // Request type ids are odd, reply type ids are the request's + 1.
+  if (typeId % 2 == 1) {
+    const bool captured = filter.matchesKey(info.key);
+    if (filter.matchesReplies() && !info.noreply) {
+      if (pendingRequests_.size() >= kMaxPendingRequests) {
+        pendingRequests_.pop_front();
+      }
+      pendingRequests_.push_back(PendingRequest{info.reqId, timeUs, captured});
+    }
+    return captured;
+  }
+
+  if (!filter.matchesSize(info.size)) {
+    skipReply(info.reqId);
+    return false;
+  }
+  if (!filter.matchesReplies()) {
+    return true;
+  }
+  auto it = std::find_if(
+      pendingRequests_.begin(),
+      pendingRequests_.end(),
+      [&info](const PendingRequest& req) { return req.reqId == info.reqId; });
+  if (it == pendingRequests_.end()) {
+    // The request was not seen (nor by the reader), so the reply can't be
+    // matched with a key nor a latency.
+    return false;
+  }
+  const bool captured =
+      it->captured && filter.matchesLatency(timeUs - it->startTimeUs);
+  pendingRequests_.erase(it);
+  return captured;
+}
+
+void ConnectionFifo::skipReply(uint64_t reqId) noexcept {
+  auto it = std::find_if(
+      pendingRequests_.begin(),
+      pendingRequests_.end(),
+      [reqId](const PendingRequest& req) { return req.reqId == reqId; });
+  if (it != pendingRequests_.end()) {
+    pendingRequests_.erase(it);
+  }
+}
+
 bool ConnectionFifo::writeData(const void* buf, size_t len) noexcept {
-  if (!isConnected()) {
+  if (!isConnected() || !capturing_) {
     return false;
   }
   iovec iov[1];
@@ -246,7 +317,7 @@ bool ConnectionFifo::writeData(
   // | PACKET HEADER | PACKET BODY |
   // -------------------------------
 
-  if (!isConnected() || iovcnt == 0) {
+  if (!isConnected() || !capturing_ || iovcnt == 0) {
     return false;
   }
 
@@ -7,6 +7,8 @@
 
 #pragma once
 
+#include <deque>
+
 #include <folly/Range.h>
 #include <folly/io/async/AsyncTransport.h>
 
@@ -25,6 +27,22 @@ namespace memcache {
  */
 class ConnectionFifo {
  public:
+  /**
+   * What is known about a message when it starts. Used to apply the filter
+   * pushed down by the reader, if any (see CaptureFilter).
+   */
+  struct CaptureInfo {
+    // Id of the request (or of the request replied to), as seen on the wire.
+    // 0 for ASCII, whose replies come in the order of the requests.
+    uint64_t reqId{0};
+    // Key of the request, empty if not known.
+    folly::StringPiece key;
+    // Size of the message, 0 if not known.
+    size_t size{0};
+    // Whether the request won't get a reply.
+    bool noreply{false};
+  };
+
   /**
    * Builds a dumb ConnectionFifo, that never connects.
    */
@@ -52,9 +70,23 @@ class ConnectionFifo {
    *
    * @param direction   Whether the data was received or sent by connection.
    * @param typeId      Id of the type of the message.
+   * @param info        What is known about the message.
+   *
+   * @return  False if the message won't be written, e.g. because it is
+   *          filtered out.
    */
+  bool startMessage(
+      MessageDirection direction,
+      uint32_t typeId,
+      const CaptureInfo& info) noexcept;
   bool startMessage(MessageDirection direction, uint32_t typeId) noexcept;
 
+  /**
+   * Forgets about a request whose reply is part of a message started with
+   * the reply of another request (e.g. ASCII multi-gets).
+   */
+  void skipReply(uint64_t reqId) noexcept;
+
   /**
    * Writes data to the FIFO, but only if there is reader (i.e. mcpiper)
    * connected to it.
@@ -66,9 +98,27 @@ class ConnectionFifo {
   bool writeData(const void* buf, size_t len) noexcept;
 
  private:
+  // Requests captured (or not) that wait for a reply, tracked when the
+  // filter needs to match replies with requests.
+  struct PendingRequest {
+    uint64_t reqId;
+    uint64_t startTimeUs;
+    bool captured;
+  };
+  static constexpr size_t kMaxPendingRequests = 256;
+
   std::shared_ptr<Fifo> debugFifo_;
   MessageHeader currentMessageHeader_;
   uint32_t nextPacketId_{0};
+  // Whether the current message passed the filter.
+  bool capturing_{true};
+  std::deque<PendingRequest> pendingRequests_;
+
+  bool shouldCapture(
+      const CaptureFilter& filter,
+      uint32_t typeId,
+      uint64_t timeUs,
+      const CaptureInfo& info) noexcept;
 };
 
 } // memcache
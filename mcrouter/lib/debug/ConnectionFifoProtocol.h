@@ -24,6 +24,12 @@ enum class MessageDirection : uint8_t { Sent = 0, Received = 1 };
 
 constexpr folly::StringPiece kUnixSocketPrefix{"US:"};
 
+/**
+ * Suffix of the path of the ring of a fifo (see Fifo).
+ * The ring carries the same bytes a reader would get from the pipe.
+ */
+constexpr folly::StringPiece kFifoRingSuffix{".ring"};
+
 /**
  * Header of the message of ConnectionFifo.
  */
@@ -20,6 +20,7 @@
 
 #include <folly/FileUtil.h>
 
+#include "mcrouter/lib/debug/ConnectionFifoProtocol.h"
 #include "mcrouter/lib/fbi/cpp/util.h"
 
 namespace facebook {
@@ -50,12 +51,21 @@ bool isFifo(const char* fifoPath) {
 
 } // anonymous namespace
 
-Fifo::Fifo(std::string path) : path_(std::move(path)) {
+Fifo::Fifo(std::string path, size_t ringCapacity) : path_(std::move(path)) {
   if (UNLIKELY(path_.empty())) {
     throw std::invalid_argument("Fifo path cannot be empty");
   }
   auto dir = boost::filesystem::path(path_).parent_path().string();
   ensureDirExistsAndWritable(dir);
+
+  if (ringCapacity > 0) {
+    try {
+      ring_ = ShmRing::create(path_ + kFifoRingSuffix.str(), ringCapacity);
+    } catch (const std::exception& e) {
+      LOG(ERROR) << "Error creating debug fifo ring, using the pipe only: "
+                 << e.what();
+    }
+  }
 }
 
 Fifo::~Fifo() {
@@ -65,10 +75,18 @@ Fifo::~Fifo() {
       PLOG(ERROR) << "Error removing debug fifo file";
     }
   }
+  if (ring_) {
+    if (!removeFile(ring_->path().c_str())) {
+      PLOG(ERROR) << "Error removing debug fifo ring file";
+    }
+  }
 }
 
 bool Fifo::tryConnect() noexcept {
-  if (isConnected()) {
+  if (ring_) {
+    ring_->expireDeadReader();
+  }
+  if (fd_ >= 0) {
     return true;
   }
 
@@ -114,6 +132,9 @@ bool Fifo::write(void* buf, size_t len) noexcept {
 }
 
 bool Fifo::write(const struct iovec* iov, size_t iovcnt) noexcept {
+  if (ring_ && ring_->hasReader()) {
+    return ring_->write(iov, iovcnt);
+  }
   if (folly::writevNoInt(fd_, iov, iovcnt) == -1) {
     if (errno != EAGAIN) {
       PLOG(WARNING) << "Error writing to debug pipe.";
@@ -127,5 +148,29 @@ bool Fifo::write(const struct iovec* iov, size_t iovcnt) noexcept {
   return true;
 }
 
+const CaptureFilter* Fifo::captureFilter() noexcept {
+  if (!ring_ || !ring_->hasReader()) {
+    // Pipe readers don't push filters down.
+    return nullptr;
+  }
+  if (ring_->filterVersion() != captureFilterVersion_) {
+    ShmRing::Filter filter;
+    uint64_t version;
+    if (ring_->readFilter(filter, version)) {
+      try {
+        captureFilter_ = std::make_unique<CaptureFilter>(filter);
+        if (captureFilter_->empty()) {
+          captureFilter_.reset();
+        }
+      } catch (const std::exception& e) {
+        LOG(ERROR) << "Error building debug fifo capture filter: " << e.what();
+        captureFilter_.reset();
+      }
+      captureFilterVersion_ = version;
+    }
+  }
+  return captureFilter_.get();
+}
+
 } // memcache
 } // facebook
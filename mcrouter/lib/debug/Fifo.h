@@ -10,8 +10,12 @@
 #include <sys/uio.h>
 
 #include <atomic>
+#include <memory>
 #include <string>
 
+#include "mcrouter/lib/debug/CaptureFilter.h"
+#include "mcrouter/lib/debug/ShmRing.h"
+
 namespace facebook {
 namespace memcache {
 
@@ -19,6 +23,10 @@ namespace memcache {
  * Writes data to a named pipe (fifo) for debugging purposes.
  * Instances of this file have a one-to-one mapping with actual FIFOs on disk.
  *
+ * A fifo may also have a ring (see ShmRing), at the same path plus
+ * kFifoRingSuffix. While a reader is attached to the ring, data is written
+ * there instead of the pipe: a memcpy rather than a syscall per write.
+ *
  * Notes:
  *  - Unless specified otherwise, methods of this class are thread-safe.
  *  - Life of Fifo is managed by FifoManager.
@@ -45,12 +53,20 @@ class Fifo {
   bool tryConnect() noexcept;
 
   /**
-   * Tells whether this fifo is connectted.
+   * Tells whether this fifo is connectted, i.e. whether there is a reader
+   * attached to either the pipe or the ring.
    */
   bool isConnected() const noexcept {
-    return fd_ >= 0;
+    return fd_ >= 0 || (ring_ && ring_->hasReader());
   }
 
+  /**
+   * Returns the filter pushed down by the reader of the ring, or nullptr if
+   * everything should be written.
+   * Note: This method must only be called by the thread writing to the fifo.
+   */
+  const CaptureFilter* captureFilter() noexcept;
+
   /**
    * Writes data to the FIFO.
    *
@@ -69,15 +85,24 @@ class Fifo {
   /**
    * Creates a fifo on the given path.
    *
+   * @param path          Path of the fifo.
+   * @param ringCapacity  Size of the ring of the fifo, or 0 for no ring.
+   *
    * @throw std::invalid_argument  If path is empty.
    */
-  explicit Fifo(std::string path);
+  explicit Fifo(std::string path, size_t ringCapacity = 0);
 
   // Path of the fifo
   const std::string path_;
   // Fifo file descriptor.
   std::atomic<int> fd_{-1};
 
+  // Ring of the fifo, preferred to the pipe when it has a reader.
+  std::unique_ptr<ShmRing> ring_;
+  // Filter of the ring reader, as of captureFilterVersion_.
+  std::unique_ptr<CaptureFilter> captureFilter_;
+  uint64_t captureFilterVersion_{0};
+
   /**
    * Disconnects the pipe.
    */
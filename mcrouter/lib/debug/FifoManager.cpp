@@ -90,9 +90,10 @@ std::shared_ptr<Fifo> FifoManager::find(const std::string& fifoPath) {
 }
 
 std::shared_ptr<Fifo> FifoManager::createAndStore(const std::string& fifoPath) {
-  return fifos_.withWLock([&fifoPath](auto& fifos) {
-    auto it =
-        fifos.emplace(fifoPath, std::shared_ptr<Fifo>(new Fifo(fifoPath)));
+  const auto ringCapacity = ringCapacity_.load(std::memory_order_relaxed);
+  return fifos_.withWLock([&fifoPath, ringCapacity](auto& fifos) {
+    auto it = fifos.emplace(
+        fifoPath, std::shared_ptr<Fifo>(new Fifo(fifoPath, ringCapacity)));
     return it.first->second;
   });
 }
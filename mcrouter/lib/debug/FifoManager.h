@@ -7,6 +7,7 @@
 
 #pragma once
 
+#include <atomic>
 #include <condition_variable>
 #include <memory>
 #include <thread>
@@ -48,6 +49,14 @@ class FifoManager {
    */
   void clear();
 
+  /**
+   * Sets the capacity of the rings of the fifos created from now on
+   * (see Fifo). 0 means no rings, i.e. named pipes only.
+   */
+  void setRingCapacity(size_t capacity) {
+    ringCapacity_.store(capacity, std::memory_order_relaxed);
+  }
+
   /**
    * Returns the singleton instance of FifoManager.
    * Note: Keep FifoManager's shared pointer for as little as possible.
@@ -62,6 +71,8 @@ class FifoManager {
       folly::SharedMutex>
       fifos_;
 
+  std::atomic<size_t> ringCapacity_{0};
+
   // Thread that connects to fifos
   std::thread thread_;
   bool running_{true};
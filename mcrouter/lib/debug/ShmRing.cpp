@@ -0,0 +1,227 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include "ShmRing.h"
+
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <new>
+#include <stdexcept>
+#include <system_error>
+
+#include <folly/File.h>
+#include <folly/Format.h>
+#include <folly/lang/Bits.h>
+
+namespace facebook {
+namespace memcache {
+
+namespace {
+
+constexpr uint64_t kMagic = 0x676e697270636d; // "mcpring"
+constexpr uint32_t kVersion = 1;
+// Control block takes the first page, data follows.
+constexpr size_t kControlSize = 4096;
+constexpr size_t kMinCapacity = 64 * 1024;
+
+static_assert(
+    ATOMIC_LLONG_LOCK_FREE == 2 && ATOMIC_INT_LOCK_FREE == 2,
+    "ShmRing needs lock free atomics to be shared between processes");
+
+[[noreturn]] void throwSystemError(const std::string& what) {
+  throw std::system_error(errno, std::system_category(), what);
+}
+
+void* mapFile(int fd, size_t size, const std::string& path) {
+  auto mapping =
+      ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  if (mapping == MAP_FAILED) {
+    throwSystemError(folly::sformat("Failed to map ring '{}'", path));
+  }
+  return mapping;
+}
+
+} // anonymous namespace
+
+ShmRing::ShmRing(std::string path, void* mapping, size_t mappingSize)
+    : path_(std::move(path)),
+      control_(reinterpret_cast<Control*>(mapping)),
+      data_(reinterpret_cast<uint8_t*>(mapping) + kControlSize),
+      capacity_(mappingSize - kControlSize),
+      mappingSize_(mappingSize) {
+  static_assert(sizeof(Control) <= kControlSize, "Control block too large");
+}
+
+ShmRing::~ShmRing() {
+  ::munmap(control_, mappingSize_);
+}
+
+std::unique_ptr<ShmRing> ShmRing::create(
+    const std::string& path,
+    size_t capacity) {
+  capacity = folly::nextPowTwo(std::max(capacity, kMinCapacity));
+  const size_t mappingSize = kControlSize + capacity;
+
+  // Never reuse the inode: readers of a previous ring keep their mapping.
+  ::unlink(path.c_str());
+  folly::File file(path, O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC, 0666);
+  // The file is sparse: pages only get backed once written to, i.e. while a
+  // reader is attached.
+  if (::ftruncate(file.fd(), mappingSize) != 0) {
+    throwSystemError(folly::sformat("Failed to size ring '{}'", path));
+  }
+  auto mapping = mapFile(file.fd(), mappingSize, path);
+
+  auto control = new (mapping) Control();
+  control->magic = kMagic;
+  control->version = kVersion;
+  control->headerSize = kControlSize;
+  control->capacity = capacity;
+  control->writePos.store(0);
+  control->drops.store(0);
+  control->readPos.store(0);
+  control->readerPid.store(0);
+  control->filterSeq.store(0, std::memory_order_release);
+
+  return std::unique_ptr<ShmRing>(new ShmRing(path, mapping, mappingSize));
+}
+
+std::unique_ptr<ShmRing> ShmRing::open(const std::string& path) {
+  folly::File file(path, O_RDWR | O_CLOEXEC);
+  struct stat st;
+  if (::fstat(file.fd(), &st) != 0) {
+    throwSystemError(folly::sformat("Failed to stat ring '{}'", path));
+  }
+  const size_t mappingSize = st.st_size;
+  if (mappingSize <= kControlSize) {
+    throw std::runtime_error(
+        folly::sformat("'{}' is too small to be a ring", path));
+  }
+  auto mapping = mapFile(file.fd(), mappingSize, path);
+  std::unique_ptr<ShmRing> ring(new ShmRing(path, mapping, mappingSize));
+
+  const auto& control = *ring->control_;
+  if (control.magic != kMagic || control.version != kVersion ||
+      control.headerSize != kControlSize ||
+      control.capacity != ring->capacity_ ||
+      !folly::isPowTwo(ring->capacity_)) {
+    throw std::runtime_error(folly::sformat("'{}' is not a valid ring", path));
+  }
+  return ring;
+}
+
+bool ShmRing::write(const struct iovec* iov, size_t iovcnt) noexcept {
+  size_t size = 0;
+  for (size_t i = 0; i < iovcnt; ++i) {
+    size += iov[i].iov_len;
+  }
+  const size_t recordSize = alignRecord(size);
+  if (recordSize > capacity_ / 4) {
+    control_->drops.fetch_add(1, std::memory_order_relaxed);
+    return false;
+  }
+
+  // Only this thread moves writePos.
+  auto pos = control_->writePos.load(std::memory_order_relaxed);
+  const auto readPos = control_->readPos.load(std::memory_order_acquire);
+  auto offset = pos & (capacity_ - 1);
+  const size_t contiguous = capacity_ - offset;
+  const size_t padding = contiguous < recordSize ? contiguous : 0;
+  if (pos + padding + recordSize - readPos > capacity_) {
+    control_->drops.fetch_add(1, std::memory_order_relaxed);
+    return false;
+  }
+
+  if (padding > 0) {
+    // Records are contiguous, skip to the beginning of the ring.
+    RecordHeader header{static_cast<uint32_t>(padding), kPaddingFlag};
+    std::memcpy(data_ + offset, &header, sizeof(header));
+    pos += padding;
+    offset = 0;
+  }
+
+  RecordHeader header{static_cast<uint32_t>(size), 0};
+  auto dst = data_ + offset;
+  std::memcpy(dst, &header, sizeof(header));
+  dst += sizeof(header);
+  for (size_t i = 0; i < iovcnt; ++i) {
+    std::memcpy(dst, iov[i].iov_base, iov[i].iov_len);
+    dst += iov[i].iov_len;
+  }
+
+  control_->writePos.store(pos + recordSize, std::memory_order_release);
+  return true;
+}
+
+bool ShmRing::readFilter(Filter& filter, uint64_t& version) const noexcept {
+  const auto before = control_->filterSeq.load(std::memory_order_acquire);
+  if (before & 1) {
+    return false;
+  }
+  std::memcpy(&filter, &control_->filter, sizeof(Filter));
+  std::atomic_thread_fence(std::memory_order_acquire);
+  if (control_->filterSeq.load(std::memory_order_relaxed) != before) {
+    return false;
+  }
+  filter.keyPattern[kMaxKeyPatternSize - 1] = '\0';
+  version = before;
+  return true;
+}
+
+void ShmRing::expireDeadReader() noexcept {
+  auto pid = control_->readerPid.load(std::memory_order_acquire);
+  if (pid != 0 && ::kill(std::abs(pid), 0) != 0 && errno == ESRCH) {
+    control_->readerPid.compare_exchange_strong(pid, 0);
+  }
+}
+
+bool ShmRing::attach(const Filter& filter) noexcept {
+  expireDeadReader();
+  const pid_t self = ::getpid();
+  if (control_->readerPid.load(std::memory_order_acquire) == self) {
+    return true;
+  }
+  // Claim the ring, negative pid meaning "attaching": the producer doesn't
+  // write until the filter below is published.
+  pid_t expected = 0;
+  if (!control_->readerPid.compare_exchange_strong(expected, -self)) {
+    return false;
+  }
+
+  auto seq = control_->filterSeq.load(std::memory_order_relaxed);
+  control_->filterSeq.store(seq + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  std::memcpy(&control_->filter, &filter, sizeof(Filter));
+  control_->filterSeq.store(seq + 2, std::memory_order_release);
+
+  control_->readPos.store(
+      control_->writePos.load(std::memory_order_acquire),
+      std::memory_order_release);
+  control_->readerPid.store(self, std::memory_order_release);
+  return true;
+}
+
+void ShmRing::detach() noexcept {
+  pid_t self = ::getpid();
+  control_->readerPid.compare_exchange_strong(self, 0);
+}
+
+void ShmRing::skipAll() noexcept {
+  control_->readPos.store(
+      control_->writePos.load(std::memory_order_acquire),
+      std::memory_order_release);
+}
+
+} // memcache
+} // facebook
@@ -0,0 +1,227 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <sys/types.h>
+#include <sys/uio.h>
+
+#include <atomic>
+#include <cstring>
+#include <memory>
+#include <string>
+
+#include <folly/Range.h>
+
+namespace facebook {
+namespace memcache {
+
+/**
+ * Single producer, single consumer ring of variable sized records, living in
+ * a memory mapped file, so that the producer and consumer can be different
+ * processes (mcrouter and mcpiper).
+ *
+ * Writing a record is a memcpy into the mapping: no syscall, no lock. If the
+ * consumer doesn't keep up, records are dropped (and counted) instead of
+ * blocking the producer.
+ *
+ * The consumer attaches to the ring by publishing its pid, along with a
+ * Filter that the producer applies before writing anything.
+ *
+ * Notes:
+ *  - write() must only be called by one thread at a time (the producer).
+ *  - attach()/detach()/read() must only be called by one consumer at a time.
+ */
+class ShmRing {
+ public:
+  static constexpr size_t kMaxKeyPatternSize = 256;
+
+  /**
+   * Filter pushed down by the consumer. Zero means "no filter" for every
+   * field.
+   */
+  struct Filter {
+    // Capture only 1 out of sampleRate connections.
+    uint32_t sampleRate{0};
+    // Capture only replies at least this big.
+    uint32_t minValueSize{0};
+    // Capture only replies that took at least this long.
+    uint64_t minLatencyUs{0};
+    // 0-terminated basic regex (BRE) that keys of the requests captured
+    // must contain a match of.
+    char keyPattern[kMaxKeyPatternSize]{'\0'};
+    bool keyPatternIgnoreCase{false};
+  };
+
+  /**
+   * Creates a ring file at path, replacing whatever was there, and maps it
+   * for writing.
+   *
+   * @param capacity  Size of the data area, rounded up to a power of two.
+   *
+   * @throw std::system_error  If the file can't be created or mapped.
+   */
+  static std::unique_ptr<ShmRing> create(
+      const std::string& path,
+      size_t capacity);
+
+  /**
+   * Maps an existing ring file for reading.
+   *
+   * @throw std::system_error  If the file can't be opened or mapped.
+   * @throw std::runtime_error  If the file is not a valid ring.
+   */
+  static std::unique_ptr<ShmRing> open(const std::string& path);
+
+  ~ShmRing();
+
+  ShmRing(const ShmRing&) = delete;
+  ShmRing& operator=(const ShmRing&) = delete;
+
+  const std::string& path() const noexcept {
+    return path_;
+  }
+
+  size_t capacity() const noexcept {
+    return capacity_;
+  }
+
+  /**
+   * Tells whether a consumer is attached.
+   */
+  bool hasReader() const noexcept {
+    return control_->readerPid.load(std::memory_order_acquire) > 0;
+  }
+
+  /**
+   * Writes a record made of the given buffers.
+   *
+   * @return  False if the record was dropped, because the ring is full.
+   */
+  bool write(const struct iovec* iov, size_t iovcnt) noexcept;
+
+  /**
+   * Number of records dropped because the ring was full.
+   */
+  uint64_t drops() const noexcept {
+    return control_->drops.load(std::memory_order_relaxed);
+  }
+
+  /**
+   * Version of the filter, changes every time a consumer attaches.
+   */
+  uint64_t filterVersion() const noexcept {
+    return control_->filterSeq.load(std::memory_order_acquire);
+  }
+
+  /**
+   * Copies the filter of the current consumer.
+   *
+   * @return  False if the filter is being updated, in which case the caller
+   *          should try again later.
+   */
+  bool readFilter(Filter& filter, uint64_t& version) const noexcept;
+
+  /**
+   * Detaches the consumer if its process is gone.
+   */
+  void expireDeadReader() noexcept;
+
+  /**
+   * Attaches this process as the consumer of the ring, skipping whatever
+   * was written before.
+   *
+   * @return  False if another live process is attached.
+   */
+  bool attach(const Filter& filter) noexcept;
+
+  /**
+   * Detaches this process, if attached.
+   */
+  void detach() noexcept;
+
+  /**
+   * Consumes all records available, calling cb(folly::ByteRange) for each of
+   * them. The range is only valid during the call.
+   *
+   * @return  Number of records consumed.
+   */
+  template <class F>
+  size_t read(F&& cb);
+
+ private:
+  struct RecordHeader {
+    uint32_t size;
+    uint32_t flags;
+  };
+  static constexpr uint32_t kPaddingFlag = 0x1;
+
+  struct Control {
+    uint64_t magic;
+    uint32_t version;
+    uint32_t headerSize;
+    uint64_t capacity;
+
+    alignas(64) std::atomic<uint64_t> writePos;
+    std::atomic<uint64_t> drops;
+
+    alignas(64) std::atomic<uint64_t> readPos;
+    // Pid of the consumer, 0 if none, negative while it attaches.
+    std::atomic<pid_t> readerPid;
+
+    // Seqlock protecting filter: odd while the consumer updates it.
+    alignas(64) std::atomic<uint64_t> filterSeq;
+    Filter filter;
+  };
+
+  const std::string path_;
+  Control* control_{nullptr};
+  uint8_t* data_{nullptr};
+  size_t capacity_{0};
+  size_t mappingSize_{0};
+
+  ShmRing(std::string path, void* mapping, size_t mappingSize);
+
+  static size_t alignRecord(size_t size) noexcept {
+    return (size + sizeof(RecordHeader) + 7) & ~size_t(7);
+  }
+
+  /**
+   * Resets the consumer position after a corrupted record.
+   */
+  void skipAll() noexcept;
+};
+
+template <class F>
+size_t ShmRing::read(F&& cb) {
+  auto pos = control_->readPos.load(std::memory_order_relaxed);
+  const auto end = control_->writePos.load(std::memory_order_acquire);
+  size_t count = 0;
+  while (pos < end) {
+    RecordHeader header;
+    const auto offset = pos & (capacity_ - 1);
+    std::memcpy(&header, data_ + offset, sizeof(header));
+    const auto recordSize = (header.flags & kPaddingFlag)
+        ? header.size
+        : alignRecord(header.size);
+    if (recordSize == 0 || recordSize > capacity_ - offset ||
+        recordSize > end - pos) {
+      skipAll();
+      return count;
+    }
+    if (!(header.flags & kPaddingFlag)) {
+      cb(folly::ByteRange(data_ + offset + sizeof(header), header.size));
+      ++count;
+    }
+    pos += recordSize;
+  }
+  control_->readPos.store(pos, std::memory_order_release);
+  return count;
+}
+
+} // memcache
+} // facebook
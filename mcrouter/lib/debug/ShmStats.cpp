@@ -0,0 +1,189 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include "ShmStats.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+#include <system_error>
+#include <thread>
+
+#include <folly/File.h>
+#include <folly/Format.h>
+
+namespace facebook {
+namespace memcache {
+
+namespace {
+
+constexpr uint64_t kMagic = 0x7374617473636d; // "mcstats"
+constexpr uint32_t kVersion = 1;
+// Control block takes the first page, entries follow.
+constexpr size_t kControlSize = 4096;
+constexpr size_t kMaxReadAttempts = 16;
+
+static_assert(
+    ATOMIC_LLONG_LOCK_FREE == 2 && ATOMIC_BOOL_LOCK_FREE == 2,
+    "ShmStats needs lock free atomics to be shared between processes");
+
+[[noreturn]] void throwSystemError(const std::string& what) {
+  throw std::system_error(errno, std::system_category(), what);
+}
+
+void* mapFile(int fd, size_t size, int prot, const std::string& path) {
+  auto mapping = ::mmap(nullptr, size, prot, MAP_SHARED, fd, 0);
+  if (mapping == MAP_FAILED) {
+    throwSystemError(folly::sformat("Failed to map stats '{}'", path));
+  }
+  return mapping;
+}
+
+} // anonymous namespace
+
+constexpr size_t ShmStats::kMaxNameSize;
+
+void ShmStats::Entry::setName(folly::StringPiece str) noexcept {
+  const size_t size = std::min(str.size(), kMaxNameSize - 1);
+  std::memcpy(name, str.data(), size);
+  name[size] = '\0';
+}
+
+ShmStats::ShmStats(std::string path, void* mapping, size_t mappingSize)
+    : path_(std::move(path)),
+      control_(reinterpret_cast<Control*>(mapping)),
+      entries_(reinterpret_cast<Entry*>(
+          reinterpret_cast<uint8_t*>(mapping) + kControlSize)),
+      capacity_((mappingSize - kControlSize) / sizeof(Entry)),
+      mappingSize_(mappingSize) {
+  static_assert(sizeof(Control) <= kControlSize, "Control block too large");
+}
+
+ShmStats::~ShmStats() {
+  ::munmap(control_, mappingSize_);
+}
+
+std::unique_ptr<ShmStats> ShmStats::create(
+    const std::string& path,
+    size_t capacity) {
+  capacity = std::max<size_t>(capacity, 1);
+  const size_t mappingSize = kControlSize + capacity * sizeof(Entry);
+
+  // Never reuse the inode: readers of a previous region keep their mapping.
+  ::unlink(path.c_str());
+  folly::File file(path, O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC, 0644);
+  if (::ftruncate(file.fd(), mappingSize) != 0) {
+    throwSystemError(folly::sformat("Failed to size stats '{}'", path));
+  }
+  auto mapping =
+      mapFile(file.fd(), mappingSize, PROT_READ | PROT_WRITE, path);
+
+  auto control = new (mapping) Control();
+  control->magic = kMagic;
+  control->version = kVersion;
+  control->headerSize = kControlSize;
+  control->capacity = capacity;
+  control->entrySize = sizeof(Entry);
+  control->pid = ::getpid();
+  control->numEntries = 0;
+  control->timestampMs = 0;
+  control->retired.store(false);
+  control->seq.store(0, std::memory_order_release);
+
+  return std::unique_ptr<ShmStats>(new ShmStats(path, mapping, mappingSize));
+}
+
+std::unique_ptr<ShmStats> ShmStats::open(const std::string& path) {
+  folly::File file(path, O_RDONLY | O_CLOEXEC);
+  struct stat st;
+  if (::fstat(file.fd(), &st) != 0) {
+    throwSystemError(folly::sformat("Failed to stat stats '{}'", path));
+  }
+  const size_t mappingSize = st.st_size;
+  if (mappingSize < kControlSize + sizeof(Entry)) {
+    throw std::runtime_error(
+        folly::sformat("'{}' is too small to be a stats region", path));
+  }
+  auto mapping = mapFile(file.fd(), mappingSize, PROT_READ, path);
+  std::unique_ptr<ShmStats> stats(new ShmStats(path, mapping, mappingSize));
+
+  const auto& control = *stats->control_;
+  if (control.magic != kMagic || control.version != kVersion ||
+      control.headerSize != kControlSize ||
+      control.entrySize != sizeof(Entry) ||
+      control.capacity != stats->capacity_) {
+    throw std::runtime_error(
+        folly::sformat("'{}' is not a valid stats region", path));
+  }
+  return stats;
+}
+
+bool ShmStats::publish(
+    const Entry* entries,
+    size_t numEntries,
+    uint64_t timestampMs) noexcept {
+  if (numEntries > capacity_) {
+    return false;
+  }
+
+  // Only this thread moves seq.
+  const auto seq = control_->seq.load(std::memory_order_relaxed);
+  control_->seq.store(seq + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  control_->numEntries = numEntries;
+  control_->timestampMs = timestampMs;
+  std::memcpy(entries_, entries, numEntries * sizeof(Entry));
+  control_->seq.store(seq + 2, std::memory_order_release);
+  return true;
+}
+
+void ShmStats::retire() noexcept {
+  control_->retired.store(true, std::memory_order_release);
+}
+
+bool ShmStats::read(Snapshot& snapshot) const {
+  for (size_t attempt = 0; attempt < kMaxReadAttempts; ++attempt) {
+    if (attempt > 0) {
+      std::this_thread::yield();
+    }
+    const auto before = control_->seq.load(std::memory_order_acquire);
+    if (before == 0) {
+      return false;
+    }
+    if (before & 1) {
+      continue;
+    }
+    // May be torn, only trusted once seq is checked again.
+    const size_t numEntries =
+        std::min<size_t>(control_->numEntries, capacity_);
+    snapshot.entries.resize(numEntries);
+    std::memcpy(
+        snapshot.entries.data(), entries_, numEntries * sizeof(Entry));
+    snapshot.timestampMs = control_->timestampMs;
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (control_->seq.load(std::memory_order_relaxed) != before) {
+      continue;
+    }
+    for (auto& entry : snapshot.entries) {
+      entry.name[kMaxNameSize - 1] = '\0';
+    }
+    snapshot.version = before / 2;
+    snapshot.pid = control_->pid;
+    return true;
+  }
+  return false;
+}
+
+} // memcache
+} // facebook
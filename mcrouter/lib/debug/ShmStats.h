@@ -0,0 +1,162 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <sys/types.h>
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <folly/Range.h>
+
+namespace facebook {
+namespace memcache {
+
+/**
+ * Snapshot of numeric stats living in a memory mapped file, so that external
+ * scrapers can read them without talking to the process that owns them.
+ *
+ * The owner publishes a whole snapshot at once, under a seqlock: readers
+ * copy it and retry if a publish happened meanwhile. Reading costs the owner
+ * nothing, no matter how often it's done.
+ *
+ * A region holds at most capacity() entries. An owner that needs more
+ * retires the region and creates a bigger one at the same path: readers
+ * notice with retired() and reopen the path.
+ *
+ * Notes:
+ *  - publish()/retire() must only be called by one thread at a time.
+ *  - Any number of processes may read() concurrently.
+ */
+class ShmStats {
+ public:
+  static constexpr size_t kMaxNameSize = 120;
+
+  enum class Type : uint32_t {
+    Uint64 = 0,
+    Int64 = 1,
+    Double = 2,
+  };
+
+  struct Entry {
+    // 0-terminated, longer names are truncated.
+    char name[kMaxNameSize];
+    Type type;
+    uint32_t reserved;
+    union {
+      uint64_t uint64;
+      int64_t int64;
+      double dbl;
+    } value;
+
+    void setName(folly::StringPiece str) noexcept;
+  };
+
+  struct Snapshot {
+    // Number of publishes since the region was created.
+    uint64_t version{0};
+    // Time of the publish, in ms since epoch.
+    uint64_t timestampMs{0};
+    // Pid of the owner.
+    pid_t pid{0};
+    std::vector<Entry> entries;
+  };
+
+  /**
+   * Creates a region at path, replacing whatever was there, and maps it for
+   * writing.
+   *
+   * @param capacity  Max number of entries per snapshot.
+   *
+   * @throw std::system_error  If the file can't be created or mapped.
+   */
+  static std::unique_ptr<ShmStats> create(
+      const std::string& path,
+      size_t capacity);
+
+  /**
+   * Maps an existing region for reading.
+   *
+   * @throw std::system_error  If the file can't be opened or mapped.
+   * @throw std::runtime_error  If the file is not a valid region.
+   */
+  static std::unique_ptr<ShmStats> open(const std::string& path);
+
+  ~ShmStats();
+
+  ShmStats(const ShmStats&) = delete;
+  ShmStats& operator=(const ShmStats&) = delete;
+
+  const std::string& path() const noexcept {
+    return path_;
+  }
+
+  size_t capacity() const noexcept {
+    return capacity_;
+  }
+
+  /**
+   * Replaces the current snapshot.
+   *
+   * @return  False if there are more than capacity() entries, in which case
+   *          nothing is published.
+   */
+  bool publish(
+      const Entry* entries,
+      size_t numEntries,
+      uint64_t timestampMs) noexcept;
+
+  /**
+   * Tells readers that this region won't be published to anymore.
+   */
+  void retire() noexcept;
+
+  bool retired() const noexcept {
+    return control_->retired.load(std::memory_order_acquire);
+  }
+
+  /**
+   * Copies the current snapshot.
+   *
+   * @return  False if no snapshot was published yet, or if publishes kept
+   *          racing with the copy, in which case the caller should try again
+   *          later.
+   */
+  bool read(Snapshot& snapshot) const;
+
+ private:
+  struct Control {
+    uint64_t magic;
+    uint32_t version;
+    uint32_t headerSize;
+    uint64_t capacity;
+    uint32_t entrySize;
+    pid_t pid;
+
+    std::atomic<bool> retired;
+
+    // Seqlock protecting everything below and the entries: odd while the
+    // owner publishes.
+    alignas(64) std::atomic<uint64_t> seq;
+    uint64_t numEntries;
+    uint64_t timestampMs;
+  };
+
+  const std::string path_;
+  Control* control_{nullptr};
+  Entry* entries_{nullptr};
+  size_t capacity_{0};
+  size_t mappingSize_{0};
+
+  ShmStats(std::string path, void* mapping, size_t mappingSize);
+};
+
+} // memcache
+} // facebook
@@ -0,0 +1,194 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include "TraceFile.h"
+
+#include <fcntl.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <system_error>
+
+#include <folly/FileUtil.h>
+#include <folly/Format.h>
+#include <folly/Varint.h>
+#include <folly/lang/Bits.h>
+#include <glog/logging.h>
+
+namespace facebook {
+namespace memcache {
+
+namespace {
+
+constexpr folly::StringPiece kMagic{"MCTRACE\0", 8};
+constexpr uint32_t kVersion = 1;
+// magic + version + flags
+constexpr size_t kFileHeaderSize = 16;
+// timeUs, connectionId, typeId and body size
+constexpr size_t kMaxRecordHeaderSize = 4 * folly::kMaxVarintLength64;
+constexpr size_t kWriteBufferSize = 64 * 1024;
+
+[[noreturn]] void throwSystemError(const std::string& what) {
+  throw std::system_error(errno, std::system_category(), what);
+}
+
+void appendVarint(std::string& buffer, uint64_t value) {
+  uint8_t buf[folly::kMaxVarintLength64];
+  const auto size = folly::encodeVarint(value, buf);
+  buffer.append(reinterpret_cast<const char*>(buf), size);
+}
+
+template <class T>
+void appendLittleEndian(std::string& buffer, T value) {
+  value = folly::Endian::little(value);
+  buffer.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+} // anonymous namespace
+
+constexpr uint32_t TraceFileHeader::kAnonymized;
+
+TraceWriter::TraceWriter(const std::string& path, TraceFileHeader header)
+    : file_(path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644) {
+  buffer_.reserve(kWriteBufferSize);
+  buffer_.append(kMagic.data(), kMagic.size());
+  appendLittleEndian(buffer_, kVersion);
+  appendLittleEndian(buffer_, header.flags);
+  flush();
+}
+
+TraceWriter::~TraceWriter() {
+  try {
+    flush();
+  } catch (const std::exception& ex) {
+    LOG(ERROR) << "Failed to write trace: " << ex.what();
+  }
+}
+
+void TraceWriter::write(
+    const TraceRecord& record,
+    const struct iovec* iov,
+    size_t iovcnt) {
+  size_t size = 0;
+  for (size_t i = 0; i < iovcnt; ++i) {
+    size += iov[i].iov_len;
+  }
+
+  // Records of different fifos are interleaved, so time can go backwards.
+  appendVarint(
+      buffer_,
+      folly::encodeZigZag(
+          static_cast<int64_t>(record.timeUs - lastTimeUs_)));
+  appendVarint(buffer_, record.connectionId);
+  appendVarint(buffer_, record.typeId);
+  appendVarint(buffer_, size);
+  for (size_t i = 0; i < iovcnt; ++i) {
+    buffer_.append(static_cast<const char*>(iov[i].iov_base), iov[i].iov_len);
+  }
+  lastTimeUs_ = record.timeUs;
+  ++recordsWritten_;
+
+  if (buffer_.size() >= kWriteBufferSize) {
+    flush();
+  }
+}
+
+void TraceWriter::flush() {
+  if (buffer_.empty()) {
+    return;
+  }
+  if (folly::writeFull(file_.fd(), buffer_.data(), buffer_.size()) < 0) {
+    throwSystemError("Failed to write trace");
+  }
+  buffer_.clear();
+}
+
+TraceReader::TraceReader(const std::string& path)
+    : file_(path, O_RDONLY | O_CLOEXEC) {
+  fill(kFileHeaderSize);
+  if (buffer_.size() < kFileHeaderSize ||
+      folly::StringPiece(buffer_.data(), kMagic.size()) != kMagic) {
+    throw std::runtime_error(
+        folly::sformat("'{}' is not a trace file", path));
+  }
+  uint32_t version;
+  std::memcpy(&version, buffer_.data() + kMagic.size(), sizeof(version));
+  if (folly::Endian::little(version) != kVersion) {
+    throw std::runtime_error(folly::sformat(
+        "Unsupported version {} of trace file '{}'",
+        folly::Endian::little(version),
+        path));
+  }
+  uint32_t flags;
+  std::memcpy(
+      &flags,
+      buffer_.data() + kMagic.size() + sizeof(version),
+      sizeof(flags));
+  header_.flags = folly::Endian::little(flags);
+  pos_ = kFileHeaderSize;
+}
+
+void TraceReader::fill(size_t size) {
+  if (buffer_.size() - pos_ >= size) {
+    return;
+  }
+  buffer_.erase(0, pos_);
+  pos_ = 0;
+  while (!eof_ && buffer_.size() < size) {
+    const auto oldSize = buffer_.size();
+    const auto toRead = std::max(size - oldSize, kWriteBufferSize);
+    buffer_.resize(oldSize + toRead);
+    auto n = folly::readFull(file_.fd(), &buffer_[oldSize], toRead);
+    if (n < 0) {
+      buffer_.resize(oldSize);
+      throwSystemError("Failed to read trace");
+    }
+    buffer_.resize(oldSize + n);
+    // readFull() only reads less than asked for at the end of the file.
+    eof_ = static_cast<size_t>(n) < toRead;
+  }
+}
+
+bool TraceReader::next(TraceRecord& record) {
+  fill(kMaxRecordHeaderSize);
+  if (pos_ == buffer_.size()) {
+    return false;
+  }
+
+  folly::ByteRange range(
+      reinterpret_cast<const uint8_t*>(buffer_.data()) + pos_,
+      buffer_.size() - pos_);
+  uint64_t fields[4];
+  for (auto& field : fields) {
+    auto value = folly::tryDecodeVarint(range);
+    if (!value) {
+      throw std::runtime_error("Corrupted trace record header");
+    }
+    field = *value;
+  }
+  pos_ = buffer_.size() - range.size();
+
+  const size_t size = fields[3];
+  fill(size);
+  if (buffer_.size() - pos_ < size) {
+    throw std::runtime_error("Truncated trace record");
+  }
+
+  lastTimeUs_ += folly::decodeZigZag(fields[0]);
+  record.timeUs = lastTimeUs_;
+  record.connectionId = fields[1];
+  record.typeId = fields[2];
+  record.body = folly::ByteRange(
+      reinterpret_cast<const uint8_t*>(buffer_.data()) + pos_, size);
+  pos_ += size;
+  return true;
+}
+
+} // memcache
+} // facebook
@@ -0,0 +1,132 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <sys/uio.h>
+
+#include <string>
+
+#include <folly/File.h>
+#include <folly/Range.h>
+
+namespace facebook {
+namespace memcache {
+
+/**
+ * A request of a trace file.
+ */
+struct TraceRecord {
+  // Time mcrouter saw the request, in microseconds since epoch.
+  uint64_t timeUs{0};
+  // Id of the connection the request was received (or sent) on.
+  uint64_t connectionId{0};
+  // Carbon type id of the request.
+  uint32_t typeId{0};
+  // Request, serialized with carbon::CarbonProtocolWriter.
+  folly::ByteRange body;
+};
+
+/**
+ * Trace files are a header followed by records, each being:
+ *   varint(zigzag(timeUs - previous timeUs)) varint(connectionId)
+ *   varint(typeId) varint(body size) body
+ */
+struct TraceFileHeader {
+  // Keys were hashed and values replaced by zeros when recording.
+  static constexpr uint32_t kAnonymized = 0x1;
+
+  uint32_t flags{0};
+};
+
+/**
+ * Writes a trace file, buffering records in memory.
+ */
+class TraceWriter {
+ public:
+  /**
+   * Creates (or truncates) the trace file at path and writes its header.
+   *
+   * @throw std::system_error  If the file can't be created or written.
+   */
+  TraceWriter(const std::string& path, TraceFileHeader header);
+  ~TraceWriter();
+
+  TraceWriter(const TraceWriter&) = delete;
+  TraceWriter& operator=(const TraceWriter&) = delete;
+
+  /**
+   * Appends a record whose body is made of the given buffers
+   * (record.body is ignored).
+   *
+   * @throw std::system_error  If the file can't be written.
+   */
+  void write(const TraceRecord& record, const struct iovec* iov, size_t iovcnt);
+
+  /**
+   * Writes everything buffered to the file.
+   *
+   * @throw std::system_error  If the file can't be written.
+   */
+  void flush();
+
+  size_t recordsWritten() const noexcept {
+    return recordsWritten_;
+  }
+
+ private:
+  folly::File file_;
+  std::string buffer_;
+  uint64_t lastTimeUs_{0};
+  size_t recordsWritten_{0};
+};
+
+/**
+ * Reads a trace file sequentially.
+ */
+class TraceReader {
+ public:
+  /**
+   * Opens the trace file at path and reads its header.
+   *
+   * @throw std::system_error  If the file can't be opened or read.
+   * @throw std::runtime_error  If the file is not a valid trace.
+   */
+  explicit TraceReader(const std::string& path);
+
+  TraceReader(const TraceReader&) = delete;
+  TraceReader& operator=(const TraceReader&) = delete;
+
+  const TraceFileHeader& header() const noexcept {
+    return header_;
+  }
+
+  /**
+   * Reads the next record. record.body is only valid until the next call.
+   *
+   * @return  False at the end of the file.
+   * @throw std::runtime_error  If the record is truncated or corrupted.
+   */
+  bool next(TraceRecord& record);
+
+ private:
+  folly::File file_;
+  TraceFileHeader header_;
+  std::string buffer_;
+  size_t pos_{0};
+  bool eof_{false};
+  uint64_t lastTimeUs_{0};
+
+  /**
+   * Makes sure at least size bytes are buffered past pos_, unless the file
+   * ends before.
+   */
+  void fill(size_t size);
+};
+
+} // memcache
+} // facebook
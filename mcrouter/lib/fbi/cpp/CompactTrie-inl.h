@@ -0,0 +1,200 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#include <glog/logging.h>
+
+namespace facebook {
+namespace memcache {
+
+template <class Value>
+constexpr uint32_t CompactTrie<Value>::kNone;
+
+template <class Value>
+CompactTrie<Value>::CompactTrie() {
+  build();
+}
+
+template <class Value>
+CompactTrie<Value>::CompactTrie(std::vector<value_type> entries)
+    : entries_(std::move(entries)) {
+  std::stable_sort(
+      entries_.begin(),
+      entries_.end(),
+      [](const value_type& a, const value_type& b) {
+        return a.first < b.first;
+      });
+  // drop duplicates, keeping the last value of each key
+  size_t unique = 0;
+  for (size_t i = 0; i < entries_.size(); ++i) {
+    if (unique > 0 && entries_[unique - 1].first == entries_[i].first) {
+      entries_[unique - 1] = std::move(entries_[i]);
+    } else {
+      if (unique != i) {
+        entries_[unique] = std::move(entries_[i]);
+      }
+      ++unique;
+    }
+  }
+  entries_.erase(entries_.begin() + unique, entries_.end());
+  entries_.shrink_to_fit();
+
+  build();
+}
+
+template <class Value>
+void CompactTrie<Value>::build() {
+  CHECK_LT(entries_.size(), kNone) << "Too many keys for CompactTrie";
+
+  struct Range {
+    uint32_t node;
+    size_t begin;
+    size_t end;
+    // length of the prefix common to all keys in [begin, end)
+    size_t depth;
+  };
+
+  nodes_.emplace_back();
+  firstChars_.push_back(0);
+  std::vector<Range> pending{{0, 0, entries_.size(), 0}};
+
+  while (!pending.empty()) {
+    auto range = pending.back();
+    pending.pop_back();
+
+    // keys are sorted, so the key equal to the common prefix is first
+    if (range.begin < range.end &&
+        entries_[range.begin].first.size() == range.depth) {
+      nodes_[range.node].entry = range.begin++;
+    }
+
+    // All children of a node are created here at once, so they are
+    // contiguous in nodes_ no matter in which order ranges are processed.
+    const uint32_t firstChild = nodes_.size();
+    auto i = range.begin;
+    while (i < range.end) {
+      const auto& first = entries_[i].first;
+      const auto c = first[range.depth];
+      auto j = i + 1;
+      while (j < range.end && entries_[j].first[range.depth] == c) {
+        ++j;
+      }
+      // common prefix of a sorted range is the one of its first and last key
+      const auto& last = entries_[j - 1].first;
+      auto depth = range.depth + 1;
+      while (depth < first.size() && depth < last.size() &&
+             first[depth] == last[depth]) {
+        ++depth;
+      }
+
+      Node child;
+      child.labelBegin = labels_.size();
+      child.labelSize = depth - range.depth;
+      labels_.append(first, range.depth, child.labelSize);
+      pending.push_back({static_cast<uint32_t>(nodes_.size()), i, j, depth});
+      nodes_.push_back(child);
+      firstChars_.push_back(static_cast<unsigned char>(c));
+      i = j;
+    }
+    nodes_[range.node].firstChild = firstChild;
+    nodes_[range.node].numChildren = nodes_.size() - firstChild;
+  }
+
+  firstChars_.resize(firstChars_.size() + 16, 0);
+  nodes_.shrink_to_fit();
+  firstChars_.shrink_to_fit();
+  labels_.shrink_to_fit();
+}
+
+template <class Value>
+uint32_t CompactTrie<Value>::findChild(const Node& node, unsigned char c)
+    const {
+  const unsigned char* chars = firstChars_.data() + node.firstChild;
+#ifdef __SSE2__
+  const __m128i needle = _mm_set1_epi8(static_cast<char>(c));
+  for (uint32_t i = 0; i < node.numChildren; i += 16) {
+    const __m128i block =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(chars + i));
+    uint32_t mask = _mm_movemask_epi8(_mm_cmpeq_epi8(block, needle));
+    const auto left = node.numChildren - i;
+    if (left < 16) {
+      mask &= (1u << left) - 1;
+    }
+    if (mask != 0) {
+      return node.firstChild + i + __builtin_ctz(mask);
+    }
+  }
+  return kNone;
+#else
+  // children are sorted by their first char
+  const unsigned char* end = chars + node.numChildren;
+  const unsigned char* it = std::lower_bound(chars, end, c);
+  return it != end && *it == c ? node.firstChild + (it - chars) : kNone;
+#endif
+}
+
+template <class Value>
+uint32_t CompactTrie<Value>::lookup(folly::StringPiece key, bool exact)
+    const {
+  uint32_t result = kNone;
+  const Node* node = &nodes_[0];
+  size_t pos = 0;
+  while (true) {
+    if (node->entry != kNone) {
+      result = node->entry;
+    }
+    if (pos == key.size() || node->numChildren == 0) {
+      break;
+    }
+    const auto childIdx =
+        findChild(*node, static_cast<unsigned char>(key[pos]));
+    if (childIdx == kNone) {
+      break;
+    }
+    const Node& child = nodes_[childIdx];
+    // first char is already known to match
+    if (key.size() - pos < child.labelSize ||
+        std::memcmp(
+            key.data() + pos + 1,
+            labels_.data() + child.labelBegin + 1,
+            child.labelSize - 1) != 0) {
+      break;
+    }
+    pos += child.labelSize;
+    node = &child;
+  }
+  if (exact) {
+    return pos == key.size() ? node->entry : kNone;
+  }
+  return result;
+}
+
+template <class Value>
+typename CompactTrie<Value>::const_iterator CompactTrie<Value>::find(
+    folly::StringPiece key) const {
+  const auto idx = lookup(key, /* exact */ true);
+  return idx == kNone ? end() : begin() + idx;
+}
+
+template <class Value>
+typename CompactTrie<Value>::const_iterator CompactTrie<Value>::findPrefix(
+    folly::StringPiece key) const {
+  const auto idx = lookup(key, /* exact */ false);
+  return idx == kNone ? end() : begin() + idx;
+}
+
+} // namespace memcache
+} // namespace facebook
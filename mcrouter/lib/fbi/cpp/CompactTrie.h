@@ -0,0 +1,126 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <folly/Range.h>
+
+namespace facebook {
+namespace memcache {
+
+/**
+ * Read-only radix trie, built once from a set of keys.
+ *
+ * Chains of single-child nodes are compressed into one edge with a multi-char
+ * label, and all nodes live in one contiguous array with the children of
+ * every node stored next to each other. A child is found by scanning the
+ * first chars of its siblings (16 at a time with SSE2), then comparing the
+ * rest of its label with a single memcmp. A lookup thus touches
+ * O(number of distinct prefixes of the key) cache lines instead of two
+ * pointer dereferences per char as with Trie.
+ *
+ * Entries are kept sorted by key, iteration enumerates them in lexicographic
+ * order.
+ *
+ * @param Value type of stored value.
+ */
+template <class Value>
+class CompactTrie {
+ public:
+  typedef std::pair<std::string, Value> value_type;
+  typedef Value mapped_type;
+  typedef typename std::vector<value_type>::const_iterator const_iterator;
+  typedef const_iterator iterator;
+
+  CompactTrie();
+
+  /**
+   * Builds trie with given entries. If a key occurs multiple times, the last
+   * value for that key is kept.
+   */
+  explicit CompactTrie(std::vector<value_type> entries);
+
+  /**
+   * Return iterator for given key
+   *
+   * @return end() if no key found, iterator for given key otherwise
+   */
+  const_iterator find(folly::StringPiece key) const;
+
+  /**
+   * Get value of longest prefix stored in trie
+   *
+   * @param key   String with any characters
+   *
+   * @return Iterator to the element with the longest prefix.
+   *         If no such element is found, past-the-end (i.e. end()) iterator
+   *         is returned.
+   */
+  const_iterator findPrefix(folly::StringPiece key) const;
+
+  const_iterator begin() const {
+    return entries_.begin();
+  }
+
+  const_iterator end() const {
+    return entries_.end();
+  }
+
+  size_t size() const {
+    return entries_.size();
+  }
+
+  bool empty() const {
+    return entries_.empty();
+  }
+
+ private:
+  static constexpr uint32_t kNone = static_cast<uint32_t>(-1);
+
+  struct Node {
+    // label of the edge leading to this node, in labels_
+    uint32_t labelBegin{0};
+    uint32_t labelSize{0};
+    // children are nodes_[firstChild, firstChild + numChildren)
+    uint32_t firstChild{0};
+    uint32_t numChildren{0};
+    // index in entries_, kNone if no key ends in this node
+    uint32_t entry{kNone};
+  };
+
+  std::vector<value_type> entries_;
+  std::vector<Node> nodes_;
+  // first char of the label of every node, same indices as nodes_,
+  // padded so that a 16 byte load past the last node stays in bounds
+  std::vector<unsigned char> firstChars_;
+  std::string labels_;
+
+  void build();
+
+  /**
+   * @return index of the child of `node` whose label starts with `c`,
+   *         kNone if there is none.
+   */
+  uint32_t findChild(const Node& node, unsigned char c) const;
+
+  /**
+   * Walks down the trie along `key`.
+   *
+   * @return index in entries_ of the exact match (if exact is true) or the
+   *         longest prefix of key, kNone if none.
+   */
+  uint32_t lookup(folly::StringPiece key, bool exact) const;
+};
+} // namespace memcache
+} // namespace facebook
+
+#include "CompactTrie-inl.h"
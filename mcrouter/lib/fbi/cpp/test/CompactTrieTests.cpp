@@ -0,0 +1,131 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "mcrouter/lib/fbi/cpp/CompactTrie.h"
+#include "mcrouter/lib/fbi/cpp/Trie.h"
+#include "mcrouter/lib/fbi/cpp/util.h"
+
+using facebook::memcache::CompactTrie;
+using facebook::memcache::Trie;
+
+TEST(CompactTrie, Empty) {
+  CompactTrie<int> trie;
+  EXPECT_TRUE(trie.empty());
+  EXPECT_TRUE(trie.find("") == trie.end());
+  EXPECT_TRUE(trie.find("abc") == trie.end());
+  EXPECT_TRUE(trie.findPrefix("abc") == trie.end());
+  EXPECT_TRUE(trie.begin() == trie.end());
+}
+
+TEST(CompactTrie, SanityTest) {
+  CompactTrie<int> trie({{"hello", 1},
+                         {"world", 2},
+                         {"!helloo~", 3},
+                         {"", 4},
+                         {"hel", 5},
+                         {"help", 6}});
+  EXPECT_EQ(6, trie.size());
+
+  EXPECT_EQ(1, trie.find("hello")->second);
+  EXPECT_EQ(2, trie.find("world")->second);
+  EXPECT_EQ(3, trie.find("!helloo~")->second);
+  EXPECT_EQ(4, trie.find("")->second);
+  EXPECT_EQ(5, trie.find("hel")->second);
+  EXPECT_EQ(6, trie.find("help")->second);
+
+  EXPECT_TRUE(trie.find("he") == trie.end());
+  EXPECT_TRUE(trie.find("hell") == trie.end());
+  EXPECT_TRUE(trie.find("helloo") == trie.end());
+  EXPECT_TRUE(trie.find("w") == trie.end());
+
+  EXPECT_EQ(4, trie.findPrefix("he")->second);
+  EXPECT_EQ(5, trie.findPrefix("hell")->second);
+  EXPECT_EQ(1, trie.findPrefix("hello, world")->second);
+  EXPECT_EQ(6, trie.findPrefix("helper")->second);
+  EXPECT_EQ(4, trie.findPrefix("worl")->second);
+  EXPECT_EQ(4, trie.findPrefix("xyz")->second);
+
+  // iteration is in lexicographic order
+  std::vector<std::string> keys;
+  for (const auto& it : trie) {
+    keys.push_back(it.first);
+  }
+  EXPECT_EQ(
+      std::vector<std::string>(
+          {"", "!helloo~", "hel", "hello", "help", "world"}),
+      keys);
+}
+
+TEST(CompactTrie, NoEmptyKey) {
+  CompactTrie<int> trie({{"abc", 1}, {"abd", 2}});
+  EXPECT_TRUE(trie.findPrefix("ab") == trie.end());
+  EXPECT_TRUE(trie.findPrefix("xyz") == trie.end());
+  EXPECT_EQ(2, trie.findPrefix("abde")->second);
+}
+
+TEST(CompactTrie, DuplicateKeys) {
+  CompactTrie<int> trie({{"a", 1}, {"b", 2}, {"a", 3}});
+  EXPECT_EQ(2, trie.size());
+  EXPECT_EQ(3, trie.find("a")->second);
+  EXPECT_EQ(2, trie.find("b")->second);
+}
+
+TEST(CompactTrie, ManyChildren) {
+  // every char as a child of the root and of "x", to cover all SIMD blocks
+  std::vector<std::pair<std::string, int>> entries;
+  for (int c = 0; c < 256; ++c) {
+    entries.emplace_back(std::string(1, static_cast<char>(c)), c);
+    entries.emplace_back("x" + std::string(1, static_cast<char>(c)), 256 + c);
+  }
+  CompactTrie<int> trie(std::move(entries));
+  for (int c = 0; c < 256; ++c) {
+    auto ch = std::string(1, static_cast<char>(c));
+    EXPECT_EQ(c, trie.find(ch)->second);
+    EXPECT_EQ(256 + c, trie.find("x" + ch)->second);
+    EXPECT_EQ(256 + c, trie.findPrefix("x" + ch + "suffix")->second);
+  }
+}
+
+TEST(CompactTrie, MatchesTrie) {
+  srand(1234);
+  Trie<int> trie;
+  std::vector<std::pair<std::string, int>> entries;
+  for (int i = 0; i < 5000; ++i) {
+    auto key = facebook::memcache::randomString(0, 8, "abc:");
+    trie.emplace(key, i);
+    entries.emplace_back(std::move(key), i);
+  }
+  CompactTrie<int> compact(std::move(entries));
+
+  size_t size = 0;
+  for (const auto& it : trie) {
+    ++size;
+    auto found = compact.find(it.first);
+    ASSERT_TRUE(found != compact.end());
+    EXPECT_EQ(it.second, found->second);
+  }
+  EXPECT_EQ(size, compact.size());
+
+  for (int i = 0; i < 5000; ++i) {
+    auto key = facebook::memcache::randomString(0, 12, "abc:");
+    auto expected = trie.findPrefix(key);
+    auto actual = compact.findPrefix(key);
+    ASSERT_EQ(expected == trie.end(), actual == compact.end()) << key;
+    if (expected != trie.end()) {
+      EXPECT_EQ(expected->second, actual->second) << key;
+    }
+    auto expectedExact = trie.find(key);
+    auto actualExact = compact.find(key);
+    ASSERT_EQ(expectedExact == trie.end(), actualExact == compact.end());
+  }
+}
@@ -15,8 +15,11 @@
 #include <folly/experimental/StringKeyedUnorderedMap.h>
 #include <folly/init/Init.h>
 
+#include "mcrouter/lib/fbi/cpp/CompactTrie.h"
 #include "mcrouter/lib/fbi/cpp/Trie.h"
+#include "mcrouter/lib/fbi/cpp/util.h"
 
+using facebook::memcache::CompactTrie;
 using facebook::memcache::Trie;
 
 namespace {
@@ -59,14 +62,19 @@ class KeyPrefixMap : public folly::StringKeyedUnorderedMap<Value> {
   std::vector<size_t> prefixLength_;
 };
 
-std::vector<std::string> keysToGet[3];
+// sets 0-2 are small hand-picked configs, set 3 has thousands of prefixes
+constexpr int kNumSets = 4;
+constexpr int kNumManyKeys = 4096;
 
-Trie<int> randTrie[3];
-KeyPrefixMap<int> randMap[3];
+std::vector<std::string> keysToGet[kNumSets];
+
+Trie<int> randTrie[kNumSets];
+KeyPrefixMap<int> randMap[kNumSets];
+CompactTrie<int> randCompactTrie[kNumSets];
 int x = 0;
 
 void prepareRand() {
-  std::vector<std::string> keys[3] = {
+  std::vector<std::string> keys[kNumSets] = {
       {
           "abacaba", "abacabadabacaba", "b123", "qwerty:qwerty:qwerty:123456",
       },
@@ -88,15 +96,24 @@ void prepareRand() {
           "rblplmbf.abc",
           "rubajvnr.ghu",
           "rubajvnr.abc",
-      }};
+      },
+      {}};
+
+  srand(1234);
+  for (int j = 0; j < kNumManyKeys; ++j) {
+    keys[3].push_back(facebook::memcache::randomString(4, 12));
+  }
 
   std::string missKeys[] = {"zahskjsdf", "aba", "", "z", "asdjl:dafnsjsdf"};
 
-  for (int i = 0; i < 3; ++i) {
+  for (int i = 0; i < kNumSets; ++i) {
+    std::vector<std::pair<std::string, int>> entries;
     for (size_t j = 0; j < keys[i].size(); ++j) {
       randTrie[i].emplace(keys[i][j], i + j + 1);
       randMap[i].emplace(keys[i][j], i + j + 1);
+      entries.emplace_back(keys[i][j], i + j + 1);
     }
+    randCompactTrie[i] = CompactTrie<int>(std::move(entries));
 
     for (size_t j = 0; j < keys[i].size(); ++j) {
       keysToGet[i].push_back(keys[i][j] + ":hit");
@@ -138,6 +155,10 @@ BENCHMARK_RELATIVE(Map_get0) {
   runGet(randMap[0], 0);
 }
 
+BENCHMARK_RELATIVE(CompactTrie_get0) {
+  runGet(randCompactTrie[0], 0);
+}
+
 BENCHMARK(Trie_get1) {
   runGet(randTrie[1], 1);
 }
@@ -146,6 +167,10 @@ BENCHMARK_RELATIVE(Map_get1) {
   runGet(randMap[1], 1);
 }
 
+BENCHMARK_RELATIVE(CompactTrie_get1) {
+  runGet(randCompactTrie[1], 1);
+}
+
 BENCHMARK(Trie_get2) {
   runGet(randTrie[2], 2);
 }
@@ -154,6 +179,10 @@ BENCHMARK_RELATIVE(Map_get2) {
   runGet(randMap[2], 2);
 }
 
+BENCHMARK_RELATIVE(CompactTrie_get2) {
+  runGet(randCompactTrie[2], 2);
+}
+
 BENCHMARK(Trie_get_prefix0) {
   runGetPrefix(randTrie[0], 0);
 }
@@ -162,6 +191,10 @@ BENCHMARK_RELATIVE(Map_get_prefix0) {
   runGet(randMap[0], 0);
 }
 
+BENCHMARK_RELATIVE(CompactTrie_get_prefix0) {
+  runGetPrefix(randCompactTrie[0], 0);
+}
+
 BENCHMARK(Trie_get_prefix1) {
   runGetPrefix(randTrie[1], 1);
 }
@@ -170,6 +203,10 @@ BENCHMARK_RELATIVE(Map_get_prefix1) {
   runGet(randMap[1], 1);
 }
 
+BENCHMARK_RELATIVE(CompactTrie_get_prefix1) {
+  runGetPrefix(randCompactTrie[1], 1);
+}
+
 BENCHMARK(Trie_get_prefix2) {
   runGetPrefix(randTrie[2], 2);
 }
@@ -178,6 +215,26 @@ BENCHMARK_RELATIVE(Map_get_prefix2) {
   runGet(randMap[2], 2);
 }
 
+BENCHMARK_RELATIVE(CompactTrie_get_prefix2) {
+  runGetPrefix(randCompactTrie[2], 2);
+}
+
+BENCHMARK(Trie_get3) {
+  runGet(randTrie[3], 3);
+}
+
+BENCHMARK_RELATIVE(CompactTrie_get3) {
+  runGet(randCompactTrie[3], 3);
+}
+
+BENCHMARK(Trie_get_prefix3) {
+  runGetPrefix(randTrie[3], 3);
+}
+
+BENCHMARK_RELATIVE(CompactTrie_get_prefix3) {
+  runGetPrefix(randCompactTrie[3], 3);
+}
+
 int main(int argc, char** argv) {
   folly::init(&argc, &argv, true /* removeFlags */);
   prepareRand();
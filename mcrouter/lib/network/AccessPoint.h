@@ -79,6 +79,14 @@ struct AccessPoint {
     return unixDomainSocket_;
   }
 
+  /**
+   * @return  true if connections to this destination should be moved to
+   *          io_uring when possible (see IoUringUtil).
+   */
+  bool useIoUring() const {
+    return useIoUring_;
+  }
+
   /**
    * @return [host]:port if address is IPv6, host:port otherwise
    */
@@ -99,6 +107,10 @@ struct AccessPoint {
     port_ = port;
   }
 
+  void setUseIoUring(bool useIoUring) {
+    useIoUring_ = useIoUring;
+  }
+
  private:
   std::string host_;
   uint64_t hash_{0};
@@ -108,6 +120,7 @@ struct AccessPoint {
   bool compressed_{false};
   bool isV6_{false};
   bool unixDomainSocket_{false};
+  bool useIoUring_{false};
 };
 
 } // namespace memcache
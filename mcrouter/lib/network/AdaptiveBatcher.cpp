@@ -0,0 +1,72 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include "AdaptiveBatcher.h"
+
+#include <algorithm>
+
+namespace facebook {
+namespace memcache {
+
+void AdaptiveBatcher::onRequestQueued(Clock::time_point now) {
+  if (!enabled()) {
+    return;
+  }
+  if (lastArrival_ != Clock::time_point()) {
+    auto sample = std::chrono::duration<double, std::micro>(now - lastArrival_)
+                      .count();
+    // Gaps longer than the budget all mean the same thing to us ("don't
+    // wait"), clamp them so one idle period doesn't dominate the average.
+    sample = std::min(sample, static_cast<double>(maxDelay_.count()) * 2);
+    interArrivalUs_ = interArrivalUs_ == 0.0
+        ? sample
+        : kSmoothing * sample + (1 - kSmoothing) * interArrivalUs_;
+  }
+  lastArrival_ = now;
+}
+
+std::chrono::microseconds AdaptiveBatcher::holdTime(
+    Clock::time_point now,
+    size_t numPending,
+    size_t numInflight) {
+  const std::chrono::microseconds kFlushNow{0};
+  if (!enabled() || numPending == 0 || numInflight == 0) {
+    return kFlushNow;
+  }
+
+  const size_t targetBatchSize = std::min(numInflight, maxBatchSize_);
+  if (numPending >= targetBatchSize) {
+    return kFlushNow;
+  }
+
+  if (!holding_) {
+    holding_ = true;
+    holdStart_ = now;
+  }
+  auto remaining = maxDelay_ -
+      std::chrono::duration_cast<std::chrono::microseconds>(now - holdStart_);
+  if (remaining.count() <= 0 || interArrivalUs_ <= 0.0 ||
+      interArrivalUs_ >= remaining.count()) {
+    return kFlushNow;
+  }
+
+  auto expectedFill = std::chrono::microseconds(static_cast<int64_t>(
+      interArrivalUs_ * (targetBatchSize - numPending)));
+  return std::min(remaining, expectedFill);
+}
+
+std::chrono::microseconds AdaptiveBatcher::onFlush(Clock::time_point now) {
+  if (!holding_) {
+    return std::chrono::microseconds(0);
+  }
+  holding_ = false;
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+      now - holdStart_);
+}
+
+} // namespace memcache
+} // namespace facebook
@@ -0,0 +1,101 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+
+namespace facebook {
+namespace memcache {
+
+/**
+ * Decides for how long a client should hold back pending requests in order to
+ * send them to the network in a bigger batch.
+ *
+ * The decision is based on the arrival rate of requests (exponentially
+ * weighted moving average of the inter-arrival time) and on the number of
+ * requests already in flight:
+ *  - if nothing is in flight, the connection is idle and requests are flushed
+ *    immediately;
+ *  - if the next request is not expected to arrive before the latency budget
+ *    runs out, requests are flushed immediately;
+ *  - otherwise requests are held until enough of them are expected to have
+ *    arrived to fill a batch as big as the in-flight depth (capped by
+ *    maxBatchSize), but never longer than maxDelay after the batch was first
+ *    held.
+ *
+ * Not thread-safe, every client has its own instance.
+ */
+class AdaptiveBatcher {
+ public:
+  using Clock = std::chrono::steady_clock;
+
+  /**
+   * @param maxDelay      Hard cap on the latency added to any request.
+   *                      Zero disables batching.
+   * @param maxBatchSize  Max number of requests to wait for.
+   */
+  AdaptiveBatcher(std::chrono::microseconds maxDelay, size_t maxBatchSize)
+      : maxDelay_(maxDelay), maxBatchSize_(maxBatchSize) {}
+
+  bool enabled() const {
+    return maxDelay_.count() > 0;
+  }
+
+  /**
+   * Must be called every time a new request is queued.
+   */
+  void onRequestQueued(Clock::time_point now);
+
+  /**
+   * @return  For how long to hold the pending requests, measured from `now`.
+   *          Zero means that pending requests should be flushed now.
+   */
+  std::chrono::microseconds holdTime(
+      Clock::time_point now,
+      size_t numPending,
+      size_t numInflight);
+
+  /**
+   * Must be called when pending requests are flushed.
+   *
+   * @return  The latency added to the oldest request of this batch, zero if
+   *          the batch was not held.
+   */
+  std::chrono::microseconds onFlush(Clock::time_point now);
+
+  /**
+   * Forgets about the batch being held, e.g. because the connection went down.
+   */
+  void reset() {
+    holding_ = false;
+  }
+
+  /**
+   * @return  Current estimate of the time between two requests.
+   */
+  std::chrono::microseconds interArrivalTime() const {
+    return std::chrono::microseconds(static_cast<int64_t>(interArrivalUs_));
+  }
+
+ private:
+  // Weight of the most recent inter-arrival time in the moving average.
+  static constexpr double kSmoothing = 0.1;
+
+  const std::chrono::microseconds maxDelay_;
+  const size_t maxBatchSize_;
+
+  double interArrivalUs_{0.0};
+  Clock::time_point lastArrival_;
+  // When we first decided to hold the current batch.
+  Clock::time_point holdStart_;
+  bool holding_{false};
+};
+
+} // namespace memcache
+} // namespace facebook
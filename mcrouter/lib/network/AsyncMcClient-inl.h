@@ -45,6 +45,14 @@ ReplyT<Request> AsyncMcClient::sendSync(
   return base_->sendSync(request, timeout, rpcContext);
 }
 
+template <class Request, class F>
+void AsyncMcClient::send(
+    const Request& request,
+    std::chrono::milliseconds timeout,
+    F&& callback) {
+  base_->send(request, timeout, std::forward<F>(callback));
+}
+
 inline void AsyncMcClient::setThrottle(size_t maxInflight, size_t maxPending) {
   base_->setThrottle(maxInflight, maxPending);
 }
@@ -88,6 +88,24 @@ class AsyncMcClient : public Transport {
       std::chrono::milliseconds timeout,
       RpcStatsContext* rpcContext = nullptr);
 
+  /**
+   * Send request without blocking: doesn't need a fiber.
+   * NOTE: request must stay alive until callback is called. The callback is
+   *       called from the EventBase loop, except if the request can't be
+   *       queued at all (max pending requests reached), in which case it is
+   *       called before send() returns.
+   *
+   * @param request       The request to send.
+   * @param timeout       The timeout of this call.
+   * @param callback      Called with the reply and information about it (see
+   *                      sendSync()): void(ReplyT<Request>&&, RpcStatsContext)
+   */
+  template <class Request, class F>
+  void send(
+      const Request& request,
+      std::chrono::milliseconds timeout,
+      F&& callback);
+
   /**
    * Set throttling options.
    *
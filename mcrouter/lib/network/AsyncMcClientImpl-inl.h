@@ -5,6 +5,7 @@
  * LICENSE file in the root directory of this source tree.
  */
 
+#include "mcrouter/lib/AuxiliaryCPUThreadPool.h"
 #include "mcrouter/lib/Reply.h"
 #include "mcrouter/lib/network/FBTrace.h"
 #include "mcrouter/lib/network/RpcStatsContext.h"
@@ -59,6 +60,52 @@ ReplyT<Request> AsyncMcClientImpl::sendSync(
   return reply;
 }
 
+template <class Request>
+void AsyncMcClientImpl::send(
+    const Request& request,
+    std::chrono::milliseconds timeout,
+    folly::Function<void(ReplyT<Request>&&, RpcStatsContext)> callback) {
+  DestructorGuard dg(this);
+
+  if (maxPending_ != 0 && queue_.getPendingRequestCount() >= maxPending_) {
+    callback(
+        createReply<Request>(
+            ErrorReply,
+            folly::sformat(
+                "Max pending requests ({}) reached for destination \"{}\".",
+                maxPending_,
+                connectionOptions_.accessPoint->toHostPortString())),
+        RpcStatsContext());
+    return;
+  }
+
+  // We need to send fbtrace before serializing, or otherwise we are going to
+  // miss fbtrace id.
+  facebook::mcrouter::fbTraceOnSend(request, *connectionOptions_.accessPoint);
+
+  // Like the fiber blocked in sendSync() does, the context keeps us alive
+  // until the request is done.
+  auto ctx = new McClientAsyncRequestContext<Request>(
+      request,
+      nextMsgId_,
+      connectionOptions_.accessPoint->getProtocol(),
+      queue_,
+      [](ParserT& parser) { parser.expectNext<Request>(); },
+      requestStatusCallbacks_.onStateChange,
+      supportedCompressionCodecs_,
+      connectionOptions_.payloadFormat,
+      eventBase_,
+      timeout,
+      [self = selfPtr_.lock(), callback = std::move(callback)](
+          ReplyT<Request>&& reply, RpcStatsContext rpcContext) mutable {
+        // Schedule next writer loop, in case we didn't before
+        // due to max inflight requests limit.
+        self->scheduleNextWriterLoop();
+        callback(std::move(reply), rpcContext);
+      });
+  sendCommon(*ctx);
+}
+
 template <class Reply>
 void AsyncMcClientImpl::replyReady(
     Reply&& r,
@@ -70,5 +117,34 @@ void AsyncMcClientImpl::replyReady(
   queue_.reply(reqId, std::move(r), rpcStatsContext);
 }
 
+template <class Reply>
+bool AsyncMcClientImpl::replyReadyOffloaded(
+    folly::Function<Reply()> makeReply,
+    uint64_t reqId,
+    RpcStatsContext rpcStatsContext) {
+  auto pool = mcrouter::AuxiliaryCPUThreadPoolSingleton::try_get_fast();
+  if (!pool) {
+    return false;
+  }
+  return pool->tryAdd([selfWeak = selfPtr_,
+                       evb = folly::getKeepAliveToken(eventBase_),
+                       makeReply = std::move(makeReply),
+                       reqId,
+                       rpcStatsContext]() mutable {
+    auto reply = makeReply();
+    evb->add([selfWeak = std::move(selfWeak),
+              reply = std::move(reply),
+              reqId,
+              rpcStatsContext]() mutable {
+      auto self = selfWeak.lock();
+      // Requests of a connection that went down were already failed, and
+      // request ids are never reused.
+      if (self && self->connectionState_ == ConnectionState::Up) {
+        self->replyReady(std::move(reply), reqId, rpcStatsContext);
+      }
+    });
+  });
+}
+
 } // namespace memcache
 } // namespace facebook
@@ -18,6 +18,7 @@
 
 #include "mcrouter/lib/debug/FifoManager.h"
 #include "mcrouter/lib/fbi/cpp/LogFailure.h"
+#include "mcrouter/lib/network/IoUringUtil.h"
 #include "mcrouter/lib/network/McFizzClient.h"
 #include "mcrouter/lib/network/McSSLUtil.h"
 #include "mcrouter/lib/network/SocketConnector.h"
@@ -89,6 +90,9 @@ void AsyncMcClientImpl::WriterLoop::runLoopCallback() noexcept {
     return;
   }
   rescheduled_ = false;
+  if (client_.holdBatch()) {
+    return;
+  }
   client_.pushMessages();
 }
 
@@ -101,6 +105,9 @@ AsyncMcClientImpl::AsyncMcClientImpl(
       outOfOrder_(options.accessPoint->getProtocol() != mc_ascii_protocol),
       writer_(*this),
       connectionOptions_(std::move(options)),
+      batcher_(
+          connectionOptions_.batchingMaxDelay,
+          connectionOptions_.batchingMaxSize),
       eventBaseDestructionCallback_(
           std::make_unique<OnEventBaseDestructionCallback>(*this)) {
   eventBase.runOnDestruction(*eventBaseDestructionCallback_);
@@ -183,6 +190,9 @@ void AsyncMcClientImpl::sendCommon(McClientRequestContextBase& req) {
       incMsgId(nextMsgId_);
 
       queue_.markAsPending(req);
+      if (batcher_.enabled()) {
+        batcher_.onRequestQueued(AdaptiveBatcher::Clock::now());
+      }
       scheduleNextWriterLoop();
       if (connectionState_ == ConnectionState::Down) {
         attemptConnection();
@@ -225,6 +235,37 @@ void AsyncMcClientImpl::scheduleNextWriterLoop() {
 
 void AsyncMcClientImpl::cancelWriterCallback() {
   writer_.cancelLoopCallback();
+  if (batchTimeout_) {
+    batchTimeout_->cancelTimeout();
+  }
+  batcher_.reset();
+}
+
+bool AsyncMcClientImpl::holdBatch() {
+  if (!batcher_.enabled()) {
+    return false;
+  }
+  auto holdTime = batcher_.holdTime(
+      AdaptiveBatcher::Clock::now(),
+      getNumToSend(),
+      queue_.getInflightRequestCount());
+  if (holdTime.count() == 0) {
+    if (batchTimeout_) {
+      batchTimeout_->cancelTimeout();
+    }
+    return false;
+  }
+
+  if (!batchTimeout_) {
+    batchTimeout_ = folly::AsyncTimeout::make(eventBase_, [this]() noexcept {
+      DestructorGuard dg(this);
+      if (connectionState_ == ConnectionState::Up) {
+        pushMessages();
+      }
+    });
+  }
+  batchTimeout_->scheduleTimeoutHighRes(holdTime);
+  return true;
 }
 
 void AsyncMcClientImpl::pushMessages() {
@@ -232,6 +273,15 @@ void AsyncMcClientImpl::pushMessages() {
 
   assert(connectionState_ == ConnectionState::Up);
   auto numToSend = getNumToSend();
+  if (batcher_.enabled()) {
+    auto addedDelay = batcher_.onFlush(AdaptiveBatcher::Clock::now());
+    if (batchTimeout_) {
+      batchTimeout_->cancelTimeout();
+    }
+    if (requestStatusCallbacks_.onBatchDelayed && addedDelay.count() > 0) {
+      requestStatusCallbacks_.onBatchDelayed(addedDelay);
+    }
+  }
   // Call batch status callback
   if (requestStatusCallbacks_.onWrite && numToSend > 0) {
     requestStatusCallbacks_.onWrite(numToSend);
@@ -264,7 +314,11 @@ void AsyncMcClientImpl::pushMessages() {
     auto iov = req.reqContext.getIovs();
     auto iovcnt = req.reqContext.getIovsCount();
     if (debugFifo_.isConnected()) {
-      debugFifo_.startMessage(MessageDirection::Sent, req.reqContext.typeId());
+      ConnectionFifo::CaptureInfo info;
+      info.reqId = outOfOrder_ ? req.id : 0;
+      info.key = req.getKey();
+      debugFifo_.startMessage(
+          MessageDirection::Sent, req.reqContext.typeId(), info);
       debugFifo_.writeData(iov, iovcnt);
     }
 
@@ -434,9 +488,21 @@ void AsyncMcClientImpl::attemptConnection() {
 void AsyncMcClientImpl::connectSuccess() noexcept {
   assert(connectionState_ == ConnectionState::Connecting);
   DestructorGuard dg(this);
-  connectionState_ = ConnectionState::Up;
 
   const auto mech = connectionOptions_.accessPoint->getSecurityMech();
+  if (connectionOptions_.useIoUring && mech == SecurityMech::NONE) {
+    if (IoUringUtil::moveToIoUring(socket_)) {
+      socket_->setSendTimeout(connectionOptions_.writeTimeout.count());
+    } else if (!socket_) {
+      connectErr(folly::AsyncSocketException(
+          folly::AsyncSocketException::INTERNAL_ERROR,
+          "Failed to move connection to io_uring"));
+      return;
+    }
+  }
+
+  connectionState_ = ConnectionState::Up;
+
   if (isAsyncSSLSocketMech(mech)) {
     auto* sslSocket = socket_->getUnderlyingTransport<folly::AsyncSSLSocket>();
     assert(sslSocket != nullptr);
@@ -524,6 +590,8 @@ void AsyncMcClientImpl::connectSuccess() noexcept {
       connectionOptions_.useJemallocNodumpAllocator,
       connectionOptions_.compressionCodecMap,
       &debugFifo_);
+  parser_->setCompressionOffloadThreshold(
+      connectionOptions_.compressionOffloadThreshold);
   socket_->setReadCB(this);
 }
 
@@ -825,10 +893,14 @@ double AsyncMcClientImpl::getRetransmitsPerKb() {
     struct tcp_info tcpinfo;
     socklen_t len = sizeof(struct tcp_info);
 
-    auto& socket = dynamic_cast<folly::AsyncSocket&>(*socket_);
+    // io_uring sockets don't expose TCP_INFO.
+    auto socket = socket_->getUnderlyingTransport<folly::AsyncSocket>();
+    if (socket == nullptr) {
+      return -1.0;
+    }
 
-    if (socket.getSockOpt(IPPROTO_TCP, TCP_INFO, &tcpinfo, &len) == 0) {
-      const uint64_t totalKBytes = socket.getRawBytesWritten() / 1000;
+    if (socket->getSockOpt(IPPROTO_TCP, TCP_INFO, &tcpinfo, &len) == 0) {
+      const uint64_t totalKBytes = socket->getRawBytesWritten() / 1000;
       if (totalKBytes == lastKBytes_) {
         return 0.0;
       }
@@ -10,8 +10,10 @@
 #include <chrono>
 #include <string>
 
+#include <folly/Function.h>
 #include <folly/fibers/Baton.h>
 #include <folly/io/IOBufQueue.h>
+#include <folly/io/async/AsyncTimeout.h>
 #include <folly/io/async/AsyncSocket.h>
 #include <folly/io/async/AsyncTransport.h>
 #include <folly/io/async/DelayedDestruction.h>
@@ -21,6 +23,7 @@
 #include "mcrouter/lib/Reply.h"
 #include "mcrouter/lib/debug/ConnectionFifo.h"
 #include "mcrouter/lib/fbi/cpp/ObjectPool.h"
+#include "mcrouter/lib/network/AdaptiveBatcher.h"
 #include "mcrouter/lib/network/ClientMcParser.h"
 #include "mcrouter/lib/network/ConnectionDownReason.h"
 #include "mcrouter/lib/network/ConnectionOptions.h"
@@ -71,6 +74,12 @@ class AsyncMcClientImpl : public folly::DelayedDestruction,
       std::chrono::milliseconds timeout,
       RpcStatsContext* rpcContext);
 
+  template <class Request>
+  void send(
+      const Request& request,
+      std::chrono::milliseconds timeout,
+      folly::Function<void(ReplyT<Request>&&, RpcStatsContext)> callback);
+
   void setThrottle(size_t maxInflight, size_t maxPending);
 
   RequestQueueStats getRequestQueueStats() const;
@@ -86,6 +95,20 @@ class AsyncMcClientImpl : public folly::DelayedDestruction,
     return socket_.get();
   }
 
+  /**
+   * Callback for ClientMcParser (see CanReplyReadyOffloaded): runs makeReply
+   * on the auxiliary CPU thread pool, then forwards the reply as replyReady()
+   * would, on the event base thread. The reply is dropped if the connection
+   * went down meanwhile.
+   *
+   * @return  false if the pool is saturated, nothing is done in that case.
+   */
+  template <class Reply>
+  bool replyReadyOffloaded(
+      folly::Function<Reply()> makeReply,
+      uint64_t reqId,
+      RpcStatsContext rpcStatsContext);
+
   double getRetransmitsPerKb();
 
   void setFlushList(FlushList* flushList) {
@@ -148,6 +171,11 @@ class AsyncMcClientImpl : public folly::DelayedDestruction,
 
   ConnectionOptions connectionOptions_;
 
+  // Adaptive batching, holds writes back for up to
+  // connectionOptions_.batchingMaxDelay.
+  AdaptiveBatcher batcher_;
+  std::unique_ptr<folly::AsyncTimeout> batchTimeout_;
+
   std::unique_ptr<folly::EventBase::OnDestructionCallback>
       eventBaseDestructionCallback_;
 
@@ -171,6 +199,9 @@ class AsyncMcClientImpl : public folly::DelayedDestruction,
   void pushMessages();
   // Schedule next writer loop if it's not scheduled.
   void scheduleNextWriterLoop();
+  // Returns true if pending requests should be held back to build a bigger
+  // batch, in which case pushMessages() will be called later.
+  bool holdBatch();
   void cancelWriterCallback();
   size_t getNumToSend() const;
 
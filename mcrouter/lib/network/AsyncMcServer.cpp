@@ -7,6 +7,7 @@
 
 #include "AsyncMcServer.h"
 
+#include <fcntl.h>
 #include <signal.h>
 #include <sys/resource.h>
 #include <sys/time.h>
@@ -33,7 +34,9 @@
 #include <wangle/ssl/TLSCredProcessor.h>
 #include <wangle/ssl/TLSTicketKeySeeds.h>
 
+#include "mcrouter/lib/NumaTopology.h"
 #include "mcrouter/lib/network/AsyncMcServerWorker.h"
+#include "mcrouter/lib/network/IoUringUtil.h"
 #include "mcrouter/lib/network/ThreadLocalSSLContextProvider.h"
 
 namespace facebook {
@@ -44,6 +47,19 @@ namespace {
 /* Global pointer to the server for signal handlers */
 facebook::memcache::AsyncMcServer* gServer;
 
+std::unique_ptr<folly::EventBase> createEventBase(
+    const AsyncMcServerWorkerOptions& opts) {
+  if (opts.useIoUring) {
+    if (auto evb =
+            IoUringUtil::createEventBase(opts.enableEventBaseTimeMeasurement)) {
+      return evb;
+    }
+    LOG(WARNING) << "io_uring is not available, falling back to epoll";
+  }
+  return std::make_unique<folly::EventBase>(
+      opts.enableEventBaseTimeMeasurement);
+}
+
 class ShutdownPipe : public folly::EventHandler {
  public:
   ShutdownPipe(AsyncMcServer& server, folly::EventBase& evb)
@@ -167,8 +183,7 @@ class McServerThread {
  public:
   explicit McServerThread(AsyncMcServer& server, size_t id)
       : server_(server),
-        evb_(std::make_unique<folly::EventBase>(
-            server.opts_.worker.enableEventBaseTimeMeasurement)),
+        evb_(createEventBase(server.opts_.worker)),
         vevb_(nullptr),
         id_(id),
         worker_(server.opts_.worker, *evb_),
@@ -197,8 +212,7 @@ class McServerThread {
 
   McServerThread(AcceptorT, AsyncMcServer& server, size_t id, bool reusePort)
       : server_(server),
-        evb_(std::make_unique<folly::EventBase>(
-            server.opts_.worker.enableEventBaseTimeMeasurement)),
+        evb_(createEventBase(server.opts_.worker)),
         vevb_(nullptr),
         id_(id),
         worker_(server.opts_.worker, *evb_),
@@ -278,6 +292,17 @@ class McServerThread {
         evbToDestroy.reset();
       };
 
+      if (server_.opts_.numaPlacement) {
+        // Pin before the worker allocates its buffers, so that they are
+        // node-local.
+        const auto& topology = NumaTopology::get();
+        auto node = topology.nodeForThread(id_, server_.opts_.numThreads);
+        if (!topology.bindThisThread(node)) {
+          LOG(WARNING) << "Unable to bind server thread " << id_
+                       << " to NUMA node " << node;
+        }
+      }
+
       try {
         server_.threadsSpawnController_->waitToStart();
 
@@ -382,6 +407,39 @@ class McServerThread {
     }
   }
 
+  /**
+   * Pauses accepting on the listening sockets of this thread and appends
+   * duplicates of their fds to `out`.
+   *
+   * Safe to call from other threads.
+   */
+  void releaseListeningSockets(AsyncMcServer::ListeningSockets& out) {
+    if (!accepting_) {
+      return;
+    }
+    runInAcceptorThread([&]() {
+      pauseAndDupFds(socket_.get(), out.fds);
+      pauseAndDupFds(sslSocket_.get(), out.sslFds);
+    });
+  }
+
+  /**
+   * Safe to call from other threads.
+   */
+  void resumeAccepting() {
+    if (!accepting_) {
+      return;
+    }
+    runInAcceptorThread([&]() {
+      if (socket_) {
+        socket_->startAccepting();
+      }
+      if (sslSocket_) {
+        sslSocket_->startAccepting();
+      }
+    });
+  }
+
   void join() {
     if (isVirtualEventBase()) {
       shutdownFuture_.get();
@@ -479,6 +537,63 @@ class McServerThread {
     return (vevb_ != nullptr);
   }
 
+  /**
+   * Runs fn in the thread of this acceptor and waits for it, rethrowing
+   * anything fn throws. Does nothing if the acceptor is already shut down.
+   */
+  template <class F>
+  void runInAcceptorThread(F&& fn) {
+    auto keepAlive = getKeepAlive();
+    if (!keepAlive) {
+      return;
+    }
+    if (keepAlive->inRunningEventBaseThread()) {
+      fn();
+      return;
+    }
+    std::exception_ptr exception;
+    keepAlive->runInEventBaseThreadAndWait([&]() {
+      try {
+        fn();
+      } catch (...) {
+        exception = std::current_exception();
+      }
+    });
+    if (exception) {
+      std::rethrow_exception(exception);
+    }
+  }
+
+  static void pauseAndDupFds(
+      folly::AsyncServerSocket* socket,
+      std::vector<int>& fds) {
+    if (socket == nullptr) {
+      return;
+    }
+    socket->pauseAccepting();
+    for (auto networkSocket : socket->getNetworkSockets()) {
+      int fd = ::fcntl(networkSocket.toFd(), F_DUPFD_CLOEXEC, 0);
+      if (fd < 0) {
+        throw std::system_error(
+            errno, std::system_category(), "Failed to dup listening socket");
+      }
+      fds.push_back(fd);
+    }
+  }
+
+  /**
+   * @return  The part of `fds` this listening thread is responsible for.
+   */
+  std::vector<folly::NetworkSocket> takeoverSocketsForThread(
+      const std::vector<int>& fds) const {
+    std::vector<folly::NetworkSocket> result;
+    const auto numListeningSockets = server_.opts_.numListeningSockets;
+    for (size_t i = id_; i < fds.size(); i += numListeningSockets) {
+      result.push_back(folly::NetworkSocket::fromFd(fds[i]));
+    }
+    return result;
+  }
+
   /**
    * Start accepting new connections.
    *
@@ -488,7 +603,33 @@ class McServerThread {
     CHECK(accepting_);
     auto& opts = server_.opts_;
 
-    if (opts.existingSocketFd != -1) {
+    if (!opts.takeoverSocketFds.empty() ||
+        !opts.takeoverSslSocketFds.empty()) {
+      checkLogic(
+          opts.ports.empty() && opts.sslPorts.empty() &&
+              opts.existingSocketFd == -1 && opts.unixDomainSockPath.empty(),
+          "Can't bind sockets if taking over listening sockets");
+      if (!opts.takeoverSslSocketFds.empty()) {
+        checkLogic(
+            !opts.pemCertPath.empty() && !opts.pemKeyPath.empty() &&
+                !opts.pemCaPath.empty(),
+            "All of pemCertPath, pemKeyPath, pemCaPath required"
+            " with takeoverSslSocketFds");
+      }
+
+      // Listening threads may be more or fewer than in the previous process,
+      // sockets of a port are all part of the same SO_REUSEPORT group anyway.
+      auto fds = takeoverSocketsForThread(opts.takeoverSocketFds);
+      if (!fds.empty()) {
+        socket_.reset(new folly::AsyncServerSocket());
+        socket_->useExistingSockets(fds);
+      }
+      auto sslFds = takeoverSocketsForThread(opts.takeoverSslSocketFds);
+      if (!sslFds.empty()) {
+        sslSocket_.reset(new folly::AsyncServerSocket());
+        sslSocket_->useExistingSockets(sslFds);
+      }
+    } else if (opts.existingSocketFd != -1) {
       checkLogic(
           opts.ports.empty() && opts.sslPorts.empty(),
           "Can't use ports if using existing socket");
@@ -881,6 +1022,33 @@ void AsyncMcServer::shutdown() {
   }
 }
 
+AsyncMcServer::ListeningSockets AsyncMcServer::releaseListeningSockets() {
+  CHECK(spawned_);
+  ListeningSockets result;
+  try {
+    for (auto& thread : threads_) {
+      thread->releaseListeningSockets(result);
+    }
+  } catch (...) {
+    for (auto fd : result.fds) {
+      ::close(fd);
+    }
+    for (auto fd : result.sslFds) {
+      ::close(fd);
+    }
+    resumeAccepting();
+    throw;
+  }
+  return result;
+}
+
+void AsyncMcServer::resumeAccepting() {
+  CHECK(spawned_);
+  for (auto& thread : threads_) {
+    thread->resumeAccepting();
+  }
+}
+
 void AsyncMcServer::installShutdownHandler(const std::vector<int>& signals) {
   gServer = this;
 
@@ -55,6 +55,16 @@ class AsyncMcServer {
      */
     int existingSocketFd{-1};
 
+    /**
+     * Listening sockets handed over by another server process, see
+     * releaseListeningSockets(). If any is set, they are used instead of
+     * binding ports (ports and sslPorts must be empty) and existingSocketFd
+     * must be unset (-1). The sockets are spread over the listening threads.
+     * takeoverSslSocketFds require all of pem* paths to be set.
+     */
+    std::vector<int> takeoverSocketFds;
+    std::vector<int> takeoverSslSocketFds;
+
     /**
      * Create Unix Domain Socket to listen on.
      * If this is used (not empty), port must be empty,
@@ -121,6 +131,14 @@ class AsyncMcServer {
      */
     size_t numThreads{1};
 
+    /**
+     * If true, threads are spread over the NUMA nodes of the host and pinned
+     * there (thread i of numThreads goes to node
+     * NumaTopology::nodeForThread(i, numThreads)).
+     * Ignored when eventBases are provided.
+     */
+    bool numaPlacement{false};
+
     /**
      * If set, AsyncMcServer does not own create threads/EventBases and uses
      * the event bases in this vector to create Virtual Event Bases.
@@ -241,6 +259,29 @@ class AsyncMcServer {
    */
   void shutdown();
 
+  struct ListeningSockets {
+    std::vector<int> fds;
+    std::vector<int> sslFds;
+  };
+
+  /**
+   * Stops accepting new connections, without closing the listening sockets,
+   * so that another process can take them over (see takeoverSocketFds).
+   * Established connections are not affected.
+   * Can only be called after spawn(), from a thread that is not one of the
+   * server threads.
+   *
+   * @return  Duplicates of the listening fds, owned by the caller.
+   */
+  ListeningSockets releaseListeningSockets();
+
+  /**
+   * Starts accepting new connections again after releaseListeningSockets(),
+   * e.g. if the process that was to take over the sockets failed.
+   * Same threading requirements as releaseListeningSockets().
+   */
+  void resumeAccepting();
+
   /**
    * Installs a new handler for the given signals that would shutdown
    * this server when delivered.
@@ -16,6 +16,7 @@
 #include <folly/io/async/SSLContext.h>
 #include <folly/io/async/VirtualEventBase.h>
 
+#include "mcrouter/lib/network/IoUringUtil.h"
 #include "mcrouter/lib/network/McFizzServer.h"
 #include "mcrouter/lib/network/McServerSession.h"
 
@@ -62,6 +63,16 @@ bool AsyncMcServerWorker::addClientSocket(
   auto socket = transport->getUnderlyingTransport<folly::AsyncSocket>();
   CHECK(socket) << "Underlying transport expected to be AsyncSocket";
   McServerSession::applySocketOptions(*socket, opts_);
+  // McServerSession's zero copy writes rely on AsyncSocket's zero copy
+  // notifications, that io_uring sockets don't implement.
+  if (opts_.useIoUring && opts_.tcpZeroCopyThresholdBytes > 0) {
+    LOG_FIRST_N(WARNING, 1)
+        << "TCP zero copy is enabled, not using io_uring sockets";
+  } else if (
+      opts_.useIoUring && !IoUringUtil::moveToIoUring(transport) &&
+      !transport) {
+    return false;
+  }
   return addClientTransport(std::move(transport), userCtxt);
 }
 
@@ -183,6 +183,44 @@ class AsyncMcServerWorker {
     tracker_.setOnShutdownOperation(std::move(cb));
   }
 
+  /**
+   * Will be called whenever the number of bytes of replies queued by a
+   * connection changes (see McServerSession::queuedReplyBytes()). `delta` is
+   * positive when replies are queued and negative when they are written out.
+   *
+   * Can be nullptr for no action.
+   */
+  void setOnQueuedReplyBytesChanged(
+      std::function<void(McServerSession&, int64_t delta)> cb) {
+    tracker_.setOnQueuedReplyBytesChanged(std::move(cb));
+  }
+
+  /**
+   * Total number of bytes of replies queued by all connections of this
+   * worker.
+   */
+  size_t queuedReplyBytes() const {
+    return tracker_.queuedReplyBytes();
+  }
+
+  /**
+   * Will be called whenever a request is rejected because the server is over
+   * its CPU target (see AsyncMcServerWorkerOptions::cpuShedTargetPercent).
+   *
+   * Can be nullptr for no action.
+   */
+  void setOnRequestShed(std::function<void(McServerSession&)> cb) {
+    tracker_.setOnRequestShed(std::move(cb));
+  }
+
+  /**
+   * Total number of requests rejected by this worker because the server was
+   * over its CPU target.
+   */
+  uint64_t numCpuShedRequests() const {
+    return tracker_.numCpuShedRequests();
+  }
+
   void setCompressionCodecMap(const CompressionCodecMap* codecMap) {
     compressionCodecMap_ = codecMap;
   }
@@ -62,6 +62,21 @@ struct AsyncMcServerWorkerOptions {
    */
   size_t maxInFlight{0};
 
+  /**
+   * Once the replies queued by a session (waiting for earlier replies or for
+   * the transport to be writable) take at least this many bytes, we stop
+   * reading from the client socket until they drop to
+   * queuedReplyBytesLowWatermark.
+   * If 0, there is no limit.
+   */
+  size_t queuedReplyBytesHighWatermark{0};
+
+  /**
+   * See queuedReplyBytesHighWatermark.
+   * If 0, half of the high watermark is used.
+   */
+  size_t queuedReplyBytesLowWatermark{0};
+
   /**
    * Max connections used at any moment.
    */
@@ -99,6 +114,16 @@ struct AsyncMcServerWorkerOptions {
    */
   std::shared_ptr<CpuController> cpuController;
 
+  /**
+   * If non-zero and cpuController is set, once the CPU utilization exceeds
+   * this percentage, new requests are rejected early with BUSY (before being
+   * deserialized or routed). The rejection probability grows from 0 at the
+   * target to 1 at 100% CPU and favors connections with fewer requests in
+   * flight (see cpuShedProbability()). Administrative requests (version,
+   * stats, etc.) are never rejected.
+   */
+  uint32_t cpuShedTargetPercent{0};
+
   /**
    * Payloads >= tcpZeroCopyThresholdBytes will undergo copy avoidance and
    * the kernel will queue a completion notification once transmission is
@@ -114,6 +139,18 @@ struct AsyncMcServerWorkerOptions {
    */
   size_t tcpZeroCopyThresholdBytes{0};
 
+  /**
+   * Replies whose body is at least this size are compressed on the
+   * auxiliary CPU thread pool, while the fiber sending the reply is
+   * preempted, instead of blocking the worker thread. Replies with a big
+   * enough value sent outside of a fiber are prepared on a fiber of the
+   * worker thread. Compression still happens inline when the pool is
+   * saturated.
+   *
+   * 0 means that compression always happens inline.
+   */
+  size_t compressionOffloadThresholdBytes{0};
+
   /**
    * EXPERIMENTAL FEATURE!
    *
@@ -132,6 +169,14 @@ struct AsyncMcServerWorkerOptions {
    * Whether to enable tos reflection
    */
   bool tosReflection{false};
+
+  /**
+   * Whether to drive worker EventBases with io_uring and move accepted
+   * plaintext connections to io_uring sockets. Falls back to epoll if
+   * io_uring is not available. Connections stay on epoll sockets if
+   * tcpZeroCopyThresholdBytes is set.
+   */
+  bool useIoUring{false};
 };
 } // namespace memcache
 } // namespace facebook
@@ -14,6 +14,7 @@
 #include "mcrouter/lib/carbon/CarbonProtocolReader.h"
 #include "mcrouter/lib/carbon/CarbonProtocolWriter.h"
 #include "mcrouter/lib/carbon/CarbonQueueAppender.h"
+#include "mcrouter/lib/carbon/CarbonStraightLineSerializers.h"
 #include "mcrouter/lib/carbon/CarbonWriter.h"
 #include "mcrouter/lib/carbon/RequestReplyUtil.h"
 #include "mcrouter/lib/network/CaretHeader.h"
@@ -25,6 +26,10 @@ namespace memcache {
 
 class McServerRequestContext;
 
+// Messages whose serialized size may be up to this big get a single buffer
+// for their whole body. Bigger values are referenced rather than copied.
+constexpr size_t kMaxReservedSerializedSize = 4096;
+
 /*
  * Takes a Carbon struct and serializes it to an IOBuf
  * @param msg: The typed structure to serialize
@@ -34,8 +39,12 @@ template <class Message>
 void serializeCarbonStruct(
     const Message& msg,
     carbon::CarbonQueueAppenderStorage& storage) {
+  const auto sizeBound = carbon::serializedSizeUpperBound(msg);
+  if (sizeBound <= kMaxReservedSerializedSize) {
+    storage.reserve(sizeBound);
+  }
   carbon::CarbonProtocolWriter writer(storage);
-  msg.serialize(writer);
+  carbon::serializeMessage(msg, writer);
 }
 
 template <class Message>
@@ -136,8 +145,9 @@ class CarbonMessageDispatcher {
     req.setTraceId(headerInfo.traceId);
     req.setTraceContext(
         carbon::tracing::deserializeTraceContext(headerInfo.traceId));
+    req.setTimeoutMs(headerInfo.timeoutMs);
 
-    req.deserialize(reader);
+    carbon::deserializeMessage(req, reader);
     static_cast<Proc&>(me).onTypedMessage(
         headerInfo, reqBuf, std::move(req), std::forward<Args>(args)...);
   }
@@ -17,7 +17,7 @@ namespace facebook {
 namespace memcache {
 
 constexpr char kCaretMagicByte = '^';
-constexpr size_t kMaxAdditionalFields = 6;
+constexpr size_t kMaxAdditionalFields = 7;
 constexpr size_t kMaxHeaderLength = 1 /* magic byte */ +
     1 /* GroupVarint header (lengths of 4 ints) */ +
     4 * sizeof(uint32_t) /* body size, typeId, reqId, num additional fields */ +
@@ -40,6 +40,7 @@ struct CaretMessageInfo {
   uint64_t uncompressedBodySize{0};
   uint64_t dropProbability{0}; // Deprecated in version 37
   ServerLoad serverLoad{0};
+  uint64_t timeoutMs{0};
 };
 
 enum class CaretAdditionalFieldType {
@@ -64,6 +65,9 @@ enum class CaretAdditionalFieldType {
 
   // Load on the server
   SERVER_LOAD = 7,
+
+  // Time left (in ms) before the client stops waiting for the reply.
+  TIMEOUT_MS = 8,
 };
 
 } // namespace memcache
@@ -27,6 +27,7 @@ void resetAdditionalFields(CaretMessageInfo& info) {
   info.uncompressedBodySize = 0;
   info.dropProbability = 0;
   info.serverLoad = ServerLoad::zero();
+  info.timeoutMs = 0;
 }
 
 size_t getNumAdditionalFields(const CaretMessageInfo& info) {
@@ -55,6 +56,9 @@ size_t getNumAdditionalFields(const CaretMessageInfo& info) {
   if (!info.serverLoad.isZero()) {
     ++nAdditionalFields;
   }
+  if (info.timeoutMs != 0) {
+    ++nAdditionalFields;
+  }
   return nAdditionalFields;
 }
 
@@ -101,6 +105,8 @@ size_t serializeAdditionalFields(
       buf, CaretAdditionalFieldType::DROP_PROBABILITY, info.dropProbability);
   buf += serializeAdditionalFieldIfNonZero(
       buf, CaretAdditionalFieldType::SERVER_LOAD, info.serverLoad.raw());
+  buf += serializeAdditionalFieldIfNonZero(
+      buf, CaretAdditionalFieldType::TIMEOUT_MS, info.timeoutMs);
 
   return buf - destination;
 }
@@ -158,7 +164,7 @@ ParseStatus caretParseHeader(
     }
 
     if (fieldType >
-        static_cast<uint64_t>(CaretAdditionalFieldType::SERVER_LOAD)) {
+        static_cast<uint64_t>(CaretAdditionalFieldType::TIMEOUT_MS)) {
       // Additional Field Type not recognized, ignore.
       continue;
     }
@@ -188,6 +194,9 @@ ParseStatus caretParseHeader(
       case CaretAdditionalFieldType::SERVER_LOAD:
         headerInfo.serverLoad = ServerLoad(fieldValue);
         break;
+      case CaretAdditionalFieldType::TIMEOUT_MS:
+        headerInfo.timeoutMs = fieldValue;
+        break;
     }
   }
 
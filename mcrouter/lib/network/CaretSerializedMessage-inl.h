@@ -7,6 +7,7 @@
 
 #pragma once
 
+#include "mcrouter/lib/AuxiliaryCPUThreadPool.h"
 #include "mcrouter/lib/carbon/Artillery.h"
 #include "mcrouter/lib/network/CarbonMessageDispatcher.h"
 #include "mcrouter/lib/network/CaretProtocol.h"
@@ -94,6 +95,7 @@ bool CaretSerializedMessage::fill(
     info.supportedCodecsFirstId = supportedCodecs.firstId;
     info.supportedCodecsSize = supportedCodecs.size;
   }
+  info.timeoutMs = message.timeoutMs();
   fillImpl(info, reqId, typeId, traceId, ServerLoad::zero(), iovOut, niovOut);
   return true;
 }
@@ -125,7 +127,7 @@ bool CaretSerializedMessage::fill(
       ? nullptr
       : compressionCodecMap->getBest(supportedCodecs, uncompressedSize, typeId);
 
-  if (maybeCompress(codec, uncompressedSize)) {
+  if (codec && maybeCompress(*compressionCodecMap, codec, uncompressedSize)) {
     info.usedCodecId = codec->id();
     info.uncompressedBodySize = uncompressedSize;
   }
@@ -135,6 +137,7 @@ bool CaretSerializedMessage::fill(
 }
 
 inline bool CaretSerializedMessage::maybeCompress(
+    const CompressionCodecMap& codecMap,
     CompressionCodec* codec,
     size_t uncompressedSize) {
   if (!codec) {
@@ -149,7 +152,14 @@ inline bool CaretSerializedMessage::maybeCompress(
   static constexpr size_t kCompressionOverhead = 4;
   try {
     const auto iovs = storage_.getIovecs();
-    auto compressedBuf = codec->compress(iovs.first, iovs.second);
+    std::unique_ptr<folly::IOBuf> compressedBuf;
+    if (compressionOffloadThreshold_ > 0 &&
+        uncompressedSize >= compressionOffloadThreshold_) {
+      compressedBuf = compressOffloaded(codecMap, codec->id(), iovs);
+    }
+    if (!compressedBuf) {
+      compressedBuf = codec->compress(iovs.first, iovs.second);
+    }
     auto compressedSize = compressedBuf->computeChainDataLength();
     if ((compressedSize + kCompressionOverhead) < uncompressedSize) {
       storage_.reset();
@@ -163,6 +173,22 @@ inline bool CaretSerializedMessage::maybeCompress(
   return false;
 }
 
+inline std::unique_ptr<folly::IOBuf> CaretSerializedMessage::compressOffloaded(
+    const CompressionCodecMap& codecMap,
+    uint32_t codecId,
+    std::pair<const struct iovec*, size_t> iovs) {
+  auto pool = mcrouter::AuxiliaryCPUThreadPoolSingleton::try_get_fast();
+  if (!pool) {
+    return nullptr;
+  }
+  // Preempts the fiber sending the reply (if any), so that other requests of
+  // this thread make progress meanwhile. storage_ is not touched until then.
+  return pool->run([&codecMap, codecId, iovs]() {
+    return codecMap.getForCurrentThread()->get(codecId)->compress(
+        iovs.first, iovs.second);
+  });
+}
+
 inline void CaretSerializedMessage::fillImpl(
     CaretMessageInfo& info,
     uint32_t reqId,
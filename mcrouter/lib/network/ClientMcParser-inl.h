@@ -10,13 +10,45 @@
 #include <folly/Format.h>
 #include <folly/io/Cursor.h>
 
+#include "mcrouter/lib/Reply.h"
 #include "mcrouter/lib/carbon/Artillery.h"
+#include "mcrouter/lib/carbon/CarbonStraightLineSerializers.h"
 #include "mcrouter/lib/fbi/cpp/LogFailure.h"
 #include "mcrouter/lib/network/CarbonMessageList.h"
 
 namespace facebook {
 namespace memcache {
 
+/**
+ * Whether Callback can build replies off its thread, with:
+ *
+ *   bool replyReadyOffloaded(
+ *       folly::Function<Reply()> makeReply,
+ *       uint64_t reqId,
+ *       RpcStatsContext rpcStatsContext);
+ *
+ * which calls makeReply on the auxiliary CPU thread pool and forwards its
+ * result with replyReady() on the thread of the callback, or returns false
+ * if the pool is saturated.
+ */
+template <class Callback, class Reply, class Enable = void>
+struct CanReplyReadyOffloaded {
+  static constexpr std::false_type value{};
+};
+
+template <class Callback, class Reply>
+struct CanReplyReadyOffloaded<
+    Callback,
+    Reply,
+    typename std::enable_if<std::is_same<
+        decltype(std::declval<Callback&>().replyReadyOffloaded(
+            std::declval<folly::Function<Reply()>>(),
+            std::declval<uint64_t>(),
+            std::declval<RpcStatsContext>())),
+        bool>::value>::type> {
+  static constexpr std::true_type value{};
+};
+
 template <class Callback>
 ClientMcParser<Callback>::ClientMcParser(
     Callback& cb,
@@ -105,45 +137,100 @@ void ClientMcParser<Callback>::forwardCaretReply(
     const CaretMessageInfo& headerInfo,
     const folly::IOBuf& buffer,
     uint64_t reqId) {
+  if (headerInfo.usedCodecId > 0 && compressionCodecMap_ &&
+      compressionOffloadThreshold_ > 0 &&
+      headerInfo.uncompressedBodySize >= compressionOffloadThreshold_ &&
+      forwardCaretReplyOffloaded<Request>(
+          headerInfo,
+          buffer,
+          reqId,
+          CanReplyReadyOffloaded<Callback, ReplyT<Request>>::value)) {
+    return;
+  }
+
   const folly::IOBuf* finalBuffer = &buffer;
   size_t offset = headerInfo.headerSize;
 
   // Uncompress if compressed
   std::unique_ptr<folly::IOBuf> uncompressedBuf;
   if (headerInfo.usedCodecId > 0) {
-    uncompressedBuf = decompress(headerInfo, buffer);
+    assert(!buffer.isChained());
+    uncompressedBuf = decompress(
+        compressionCodecMap_, headerInfo, buffer.data() + offset);
     finalBuffer = uncompressedBuf.get();
     offset = 0;
   }
 
+  callback_.replyReady(
+      parseCaretReply<Request>(headerInfo, *finalBuffer, offset),
+      reqId,
+      getReplyStats(headerInfo));
+}
+
+template <class Callback>
+template <class Request>
+bool ClientMcParser<Callback>::forwardCaretReplyOffloaded(
+    const CaretMessageInfo& headerInfo,
+    const folly::IOBuf& buffer,
+    uint64_t reqId,
+    std::true_type) {
+  assert(!buffer.isChained());
+  // The read buffer is reused as soon as we return: copy the compressed body,
+  // which is cheap compared to uncompressing it.
+  auto body = folly::IOBuf::copyBuffer(
+      buffer.data() + headerInfo.headerSize, headerInfo.bodySize);
+  // Codecs are not thread-safe, the pool thread uses its own ones.
+  folly::Function<ReplyT<Request>()> makeReply =
+      [codecMap = compressionCodecMap_,
+       headerInfo,
+       body = std::move(body)]() -> ReplyT<Request> {
+    try {
+      auto uncompressedBuf = decompress(
+          codecMap->getForCurrentThread(), headerInfo, body->data());
+      return parseCaretReply<Request>(headerInfo, *uncompressedBuf, 0);
+    } catch (const std::exception& e) {
+      // Unlike inline parsing, the connection may have moved on: only fail
+      // this request.
+      return createReply<Request>(
+          ErrorReply,
+          carbon::Result::LOCAL_ERROR,
+          folly::sformat("Error parsing Caret message: {}", e.what()));
+    }
+  };
+  return callback_.replyReadyOffloaded(
+      std::move(makeReply), reqId, getReplyStats(headerInfo));
+}
+
+template <class Callback>
+template <class Request>
+ReplyT<Request> ClientMcParser<Callback>::parseCaretReply(
+    const CaretMessageInfo& headerInfo,
+    const folly::IOBuf& buffer,
+    size_t offset) {
   ReplyT<Request> reply;
-  folly::io::Cursor cur(finalBuffer);
+  folly::io::Cursor cur(&buffer);
   cur += offset;
   carbon::CarbonProtocolReader reader(cur);
-  reply.deserialize(reader);
+  carbon::deserializeMessage(reply, reader);
   reply.setTraceContext(
       carbon::tracing::deserializeTraceContext(headerInfo.traceId));
-
-  callback_.replyReady(std::move(reply), reqId, getReplyStats(headerInfo));
+  return reply;
 }
 
 template <class Callback>
 std::unique_ptr<folly::IOBuf> ClientMcParser<Callback>::decompress(
+    const CompressionCodecMap* codecMap,
     const CaretMessageInfo& headerInfo,
-    const folly::IOBuf& buffer) {
-  assert(!buffer.isChained());
-  auto* codec = compressionCodecMap_
-      ? compressionCodecMap_->get(headerInfo.usedCodecId)
-      : nullptr;
+    const uint8_t* body) {
+  auto* codec = codecMap ? codecMap->get(headerInfo.usedCodecId) : nullptr;
   if (!codec) {
     throw std::runtime_error(folly::sformat(
         "Failed to get compression codec id {}. Reply is likely corrupted!",
         headerInfo.usedCodecId));
   }
 
-  auto buf = buffer.data() + headerInfo.headerSize;
   return codec->uncompress(
-      buf, headerInfo.bodySize, headerInfo.uncompressedBodySize);
+      body, headerInfo.bodySize, headerInfo.uncompressedBodySize);
 }
 
 template <class Callback>
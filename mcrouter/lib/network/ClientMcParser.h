@@ -10,6 +10,7 @@
 #include <type_traits>
 #include <utility>
 
+#include <folly/Function.h>
 #include <folly/Range.h>
 #include <folly/io/IOBuf.h>
 
@@ -68,6 +69,15 @@ class ClientMcParser : private McParser::ParserCallback {
     parser_.setProtocol(protocol);
   }
 
+  /**
+   * Compressed Caret replies of at least this size (uncompressed) are
+   * uncompressed and parsed on the auxiliary CPU thread pool, if the
+   * callback supports it (see CanReplyReadyOffloaded). 0 disables it.
+   */
+  void setCompressionOffloadThreshold(size_t threshold) {
+    compressionOffloadThreshold_ = threshold;
+  }
+
  private:
   McParser parser_;
   McClientAsciiParser asciiParser_;
@@ -83,6 +93,8 @@ class ClientMcParser : private McParser::ParserCallback {
 
   const CompressionCodecMap* compressionCodecMap_{nullptr};
 
+  size_t compressionOffloadThreshold_{0};
+
   template <class Request>
   void forwardAsciiReply();
 
@@ -92,9 +104,37 @@ class ClientMcParser : private McParser::ParserCallback {
       const folly::IOBuf& buffer,
       uint64_t reqId);
 
-  std::unique_ptr<folly::IOBuf> decompress(
+  /**
+   * Hands the compressed reply to the callback, to be uncompressed and
+   * parsed on the auxiliary CPU thread pool.
+   *
+   * @return  false if the reply must be forwarded inline instead.
+   */
+  template <class Request>
+  bool forwardCaretReplyOffloaded(
+      const CaretMessageInfo& headerInfo,
+      const folly::IOBuf& buffer,
+      uint64_t reqId,
+      std::true_type);
+  template <class Request>
+  bool forwardCaretReplyOffloaded(
+      const CaretMessageInfo&,
+      const folly::IOBuf&,
+      uint64_t,
+      std::false_type) {
+    return false;
+  }
+
+  template <class Request>
+  static ReplyT<Request> parseCaretReply(
+      const CaretMessageInfo& headerInfo,
+      const folly::IOBuf& buffer,
+      size_t offset);
+
+  static std::unique_ptr<folly::IOBuf> decompress(
+      const CompressionCodecMap* codecMap,
       const CaretMessageInfo& headerInfo,
-      const folly::IOBuf& buffer);
+      const uint8_t* body);
 
   // McParser callbacks
   bool caretMessageReady(
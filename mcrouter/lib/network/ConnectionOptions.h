@@ -98,6 +98,17 @@ struct ConnectionOptions {
    */
   std::chrono::milliseconds writeTimeout{0};
 
+  /**
+   * Max latency adaptive batching may add to a request before it's written to
+   * the network (see AdaptiveBatcher). Zero disables adaptive batching.
+   */
+  std::chrono::microseconds batchingMaxDelay{0};
+
+  /**
+   * Max number of requests adaptive batching waits for.
+   */
+  size_t batchingMaxSize{32};
+
   /**
    * Informs whether QoS is enabled.
    */
@@ -142,10 +153,25 @@ struct ConnectionOptions {
    */
   const CompressionCodecMap* compressionCodecMap{nullptr};
 
+  /**
+   * Compressed replies of at least this size (uncompressed) are uncompressed
+   * on the auxiliary CPU thread pool instead of the event base thread, unless
+   * the pool is saturated. 0 means that replies are always uncompressed
+   * inline.
+   */
+  size_t compressionOffloadThreshold{0};
+
   /**
    * The payload format.
    */
   PayloadFormat payloadFormat{PayloadFormat::Carbon};
+
+  /**
+   * Move plaintext connections to io_uring once connected. Only takes effect
+   * if the client's EventBase is driven by io_uring (see IoUringUtil),
+   * otherwise epoll is used.
+   */
+  bool useIoUring{false};
 };
 } // namespace memcache
 } // namespace facebook
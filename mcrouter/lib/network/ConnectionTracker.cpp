@@ -105,6 +105,35 @@ void ConnectionTracker::onCloseFinish(
   }
 }
 
+void ConnectionTracker::onQueuedReplyBytesChanged(
+    McServerSession& session,
+    int64_t delta) {
+  queuedReplyBytes_ += delta;
+  if (onQueuedReplyBytesChanged_) {
+    onQueuedReplyBytesChanged_(session, delta);
+  }
+}
+
+void ConnectionTracker::onRequestsInFlightChanged(
+    McServerSession& /* session */,
+    int64_t delta) {
+  requestsInFlight_ += delta;
+}
+
+void ConnectionTracker::onRequestShed(McServerSession& session) {
+  ++numCpuShedRequests_;
+  if (onRequestShed_) {
+    onRequestShed_(session);
+  }
+}
+
+double ConnectionTracker::avgRequestsInFlight() const {
+  if (sessions_.empty()) {
+    return 0.0;
+  }
+  return static_cast<double>(requestsInFlight_) / sessions_.size();
+}
+
 void ConnectionTracker::onShutdown() {
   if (onShutdown_) {
     onShutdown_();
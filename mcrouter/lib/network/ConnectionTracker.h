@@ -52,6 +52,15 @@ class ConnectionTracker : public McServerSession::StateCallback {
     onShutdown_ = std::move(cb);
   }
 
+  void setOnQueuedReplyBytesChanged(
+      std::function<void(McServerSession&, int64_t delta)> cb) {
+    onQueuedReplyBytesChanged_ = std::move(cb);
+  }
+
+  void setOnRequestShed(std::function<void(McServerSession&)> cb) {
+    onRequestShed_ = std::move(cb);
+  }
+
   /**
    * Creates a new entry in the LRU and places the connection at the front.
    *
@@ -76,6 +85,21 @@ class ConnectionTracker : public McServerSession::StateCallback {
    */
   bool writesPending() const;
 
+  /**
+   * Total number of bytes of replies queued by all connections (sessions).
+   */
+  size_t queuedReplyBytes() const {
+    return queuedReplyBytes_;
+  }
+
+  /**
+   * Total number of requests rejected by all connections because the server
+   * was over its CPU target.
+   */
+  uint64_t numCpuShedRequests() const {
+    return numCpuShedRequests_;
+  }
+
  private:
   McServerSession::Queue sessions_;
   std::function<void(McServerSession&)> onAccepted_;
@@ -83,7 +107,13 @@ class ConnectionTracker : public McServerSession::StateCallback {
   std::function<void(McServerSession&)> onCloseStart_;
   std::function<void(McServerSession&, bool onAcceptedCalled)> onCloseFinish_;
   std::function<void()> onShutdown_;
+  std::function<void(McServerSession&, int64_t delta)>
+      onQueuedReplyBytesChanged_;
+  std::function<void(McServerSession&)> onRequestShed_;
   size_t maxConns_{0};
+  size_t queuedReplyBytes_{0};
+  size_t requestsInFlight_{0};
+  uint64_t numCpuShedRequests_{0};
 
   void touch(McServerSession& session);
 
@@ -95,6 +125,12 @@ class ConnectionTracker : public McServerSession::StateCallback {
   void onCloseStart(McServerSession& session) final;
   void onCloseFinish(McServerSession& session, bool onAcceptedCalled) final;
   void onShutdown() final;
+  void onQueuedReplyBytesChanged(McServerSession& session, int64_t delta)
+      final;
+  void onRequestsInFlightChanged(McServerSession& session, int64_t delta)
+      final;
+  void onRequestShed(McServerSession& session) final;
+  double avgRequestsInFlight() const final;
 };
 } // namespace memcache
 } // namespace facebook
@@ -42,6 +42,14 @@ class CpuController : public std::enable_shared_from_this<CpuController> {
   void start();
   void stop();
 
+  /**
+   * Overrides the measured load. Meant for tests of a controller that was
+   * never started (a started one overwrites it on its next collection).
+   */
+  void setPercentLoadForTest(double percentLoad) {
+    update(percentLoad);
+  }
+
  private:
   // The function responsible for logging the CPU utilization.
   void cpuLoggingFn();
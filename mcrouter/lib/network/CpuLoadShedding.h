@@ -0,0 +1,64 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <type_traits>
+
+#include "mcrouter/lib/network/gen/CommonMessages.h"
+
+namespace facebook {
+namespace memcache {
+
+/**
+ * Probability with which a server above its CPU target should reject a new
+ * request of a connection.
+ *
+ * The probability grows linearly from 0 at `targetPercent` to 1 at 100% CPU,
+ * and is scaled down for connections with fewer requests in flight than the
+ * average connection, so that the heaviest clients are shed first. A
+ * connection with nothing in flight is never shed: every client can always
+ * make progress, however loaded the server is.
+ *
+ * @param cpuPercent       Current CPU utilization, in [0, 100].
+ * @param targetPercent    CPU utilization above which requests are shed.
+ * @param sessionInFlight  Requests in flight on the connection.
+ * @param avgInFlight      Average requests in flight per connection.
+ */
+inline double cpuShedProbability(
+    double cpuPercent,
+    double targetPercent,
+    size_t sessionInFlight,
+    double avgInFlight) {
+  if (cpuPercent <= targetPercent || targetPercent >= 100.0 ||
+      sessionInFlight == 0) {
+    return 0.0;
+  }
+  const double overload =
+      std::min((cpuPercent - targetPercent) / (100.0 - targetPercent), 1.0);
+  const double share = sessionInFlight / std::max(avgInFlight, 1.0);
+  return overload * std::min(share, 1.0);
+}
+
+/**
+ * Requests that may be rejected when the server is over its CPU target.
+ * Administrative requests are always served.
+ */
+template <class Request>
+struct IsCpuSheddable
+    : std::integral_constant<
+          bool,
+          !std::is_same<Request, McVersionRequest>::value &&
+              !std::is_same<Request, McStatsRequest>::value &&
+              !std::is_same<Request, McShutdownRequest>::value &&
+              !std::is_same<Request, McQuitRequest>::value &&
+              !std::is_same<Request, McExecRequest>::value> {};
+
+} // namespace memcache
+} // namespace facebook
@@ -0,0 +1,186 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include "FdPassing.h"
+
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <system_error>
+
+#include <folly/Format.h>
+
+namespace facebook {
+namespace memcache {
+
+namespace {
+
+constexpr uint32_t kMagic = 0x6d636664; // "mcfd"
+
+struct Header {
+  uint32_t magic;
+  uint32_t numFds;
+  uint64_t payloadSize;
+};
+
+[[noreturn]] void throwSystemError(const char* what) {
+  throw std::system_error(errno, std::system_category(), what);
+}
+
+void sendAll(int sockFd, const char* data, size_t size) {
+  while (size > 0) {
+    auto n = ::send(sockFd, data, size, MSG_NOSIGNAL);
+    if (n < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      throwSystemError("send() failed");
+    }
+    data += n;
+    size -= n;
+  }
+}
+
+void receiveAll(int sockFd, char* data, size_t size) {
+  while (size > 0) {
+    auto n = ::recv(sockFd, data, size, 0);
+    if (n < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      throwSystemError("recv() failed");
+    }
+    if (n == 0) {
+      throw std::runtime_error("Connection closed by peer");
+    }
+    data += n;
+    size -= n;
+  }
+}
+
+void closeAll(const std::vector<int>& fds) {
+  for (auto fd : fds) {
+    ::close(fd);
+  }
+}
+
+} // namespace
+
+void sendFds(
+    int sockFd,
+    const std::vector<int>& fds,
+    folly::StringPiece payload) {
+  if (fds.size() > kMaxPassedFds) {
+    throw std::invalid_argument(folly::sformat(
+        "Can't pass {} fds at once, max is {}", fds.size(), kMaxPassedFds));
+  }
+
+  Header header;
+  header.magic = kMagic;
+  header.numFds = fds.size();
+  header.payloadSize = payload.size();
+
+  struct iovec iov;
+  iov.iov_base = &header;
+  iov.iov_len = sizeof(header);
+
+  struct msghdr msg;
+  std::memset(&msg, 0, sizeof(msg));
+  msg.msg_iov = &iov;
+  msg.msg_iovlen = 1;
+
+  std::vector<char> control;
+  if (!fds.empty()) {
+    const size_t fdsSize = sizeof(int) * fds.size();
+    control.resize(CMSG_SPACE(fdsSize));
+    msg.msg_control = control.data();
+    msg.msg_controllen = control.size();
+    auto* cmsg = CMSG_FIRSTHDR(&msg);
+    cmsg->cmsg_level = SOL_SOCKET;
+    cmsg->cmsg_type = SCM_RIGHTS;
+    cmsg->cmsg_len = CMSG_LEN(fdsSize);
+    std::memcpy(CMSG_DATA(cmsg), fds.data(), fdsSize);
+  }
+
+  ssize_t sent;
+  do {
+    sent = ::sendmsg(sockFd, &msg, MSG_NOSIGNAL);
+  } while (sent < 0 && errno == EINTR);
+  if (sent < 0) {
+    throwSystemError("sendmsg() failed");
+  }
+  // The fds went with the first byte, the rest of the header is plain data.
+  sendAll(
+      sockFd,
+      reinterpret_cast<const char*>(&header) + sent,
+      sizeof(header) - sent);
+  sendAll(sockFd, payload.data(), payload.size());
+}
+
+std::vector<int> receiveFds(int sockFd, std::string& payload) {
+  Header header;
+  struct iovec iov;
+  iov.iov_base = &header;
+  iov.iov_len = sizeof(header);
+
+  std::vector<char> control(CMSG_SPACE(sizeof(int) * kMaxPassedFds));
+  struct msghdr msg;
+  std::memset(&msg, 0, sizeof(msg));
+  msg.msg_iov = &iov;
+  msg.msg_iovlen = 1;
+  msg.msg_control = control.data();
+  msg.msg_controllen = control.size();
+
+  ssize_t received;
+  do {
+    received = ::recvmsg(sockFd, &msg, MSG_CMSG_CLOEXEC);
+  } while (received < 0 && errno == EINTR);
+  if (received < 0) {
+    throwSystemError("recvmsg() failed");
+  }
+  if (received == 0) {
+    throw std::runtime_error("Connection closed by peer");
+  }
+
+  std::vector<int> fds;
+  for (auto* cmsg = CMSG_FIRSTHDR(&msg); cmsg != nullptr;
+       cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+    if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_RIGHTS) {
+      const size_t n = (cmsg->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+      const auto* data = reinterpret_cast<const int*>(CMSG_DATA(cmsg));
+      fds.insert(fds.end(), data, data + n);
+    }
+  }
+
+  try {
+    if (msg.msg_flags & MSG_CTRUNC) {
+      throw std::runtime_error("Too many fds received");
+    }
+    receiveAll(
+        sockFd,
+        reinterpret_cast<char*>(&header) + received,
+        sizeof(header) - received);
+    if (header.magic != kMagic || header.numFds != fds.size()) {
+      throw std::runtime_error(folly::sformat(
+          "Malformed fd passing header: expected {} fds, received {}",
+          header.numFds,
+          fds.size()));
+    }
+    payload.resize(header.payloadSize);
+    receiveAll(sockFd, &payload[0], payload.size());
+  } catch (...) {
+    closeAll(fds);
+    throw;
+  }
+  return fds;
+}
+
+} // namespace memcache
+} // namespace facebook
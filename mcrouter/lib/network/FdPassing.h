@@ -0,0 +1,51 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include <folly/Range.h>
+
+namespace facebook {
+namespace memcache {
+
+/**
+ * Max number of fds that can be passed in one sendFds() call
+ * (SCM_MAX_FD on Linux).
+ */
+constexpr size_t kMaxPassedFds = 253;
+
+/**
+ * Sends duplicates of `fds` (as SCM_RIGHTS ancillary data), followed by
+ * `payload`, over the connected unix domain socket `sockFd`.
+ * Blocks until everything is sent. The caller keeps ownership of `fds`.
+ *
+ * @throws std::system_error  on socket errors.
+ * @throws std::invalid_argument  if there are more than kMaxPassedFds fds.
+ */
+void sendFds(
+    int sockFd,
+    const std::vector<int>& fds,
+    folly::StringPiece payload);
+
+/**
+ * Receives fds and payload sent with sendFds().
+ * Blocks until everything is received (or the socket receive timeout fires).
+ *
+ * @return  received fds, in the order they were sent. They are close-on-exec
+ *          and owned by the caller.
+ *
+ * @throws std::system_error  on socket errors.
+ * @throws std::runtime_error  if the peer sent a malformed message or closed
+ *                             the connection early.
+ */
+std::vector<int> receiveFds(int sockFd, std::string& payload);
+
+} // namespace memcache
+} // namespace facebook
@@ -8,7 +8,6 @@
 #include "FizzContextProvider.h"
 
 #include <fizz/client/FizzClientContext.h>
-#include <fizz/client/SynchronizedLruPskCache.h>
 #include <fizz/protocol/DefaultCertificateVerifier.h>
 #include <fizz/server/FizzServerContext.h>
 #include <fizz/server/TicketCodec.h>
@@ -17,6 +16,7 @@
 #include <folly/ssl/Init.h>
 
 #include "mcrouter/lib/fbi/cpp/LogFailure.h"
+#include "mcrouter/lib/network/TlsSessionCache.h"
 
 namespace facebook {
 namespace memcache {
@@ -38,13 +38,10 @@ FizzContextAndVerifier createClientFizzContextAndVerifier(
     std::string keyData,
     folly::StringPiece pemCaPath,
     bool preferOcbCipher) {
-  // global session cache
-  static auto SESSION_CACHE =
-      std::make_shared<fizz::client::SynchronizedLruPskCache>(100);
   initSSL();
   auto ctx = std::make_shared<fizz::client::FizzClientContext>();
   ctx->setSupportedVersions({fizz::ProtocolVersion::tls_1_3});
-  ctx->setPskCache(SESSION_CACHE);
+  ctx->setPskCache(getSharedFizzPskCache());
 
   if (!certData.empty() && !keyData.empty()) {
     auto cert =
@@ -0,0 +1,103 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include "IoUringUtil.h"
+
+#include <glog/logging.h>
+
+// MCROUTER_HAVE_LIBURING is set by configure when liburing is found.
+#if defined(__linux__) && defined(MCROUTER_HAVE_LIBURING) && \
+    __has_include(<folly/experimental/io/AsyncIoUringSocket.h>)
+#define MCROUTER_IO_URING_SUPPORTED 1
+#include <folly/experimental/io/AsyncIoUringSocket.h>
+#include <folly/experimental/io/IoUringBackend.h>
+#else
+#define MCROUTER_IO_URING_SUPPORTED 0
+#endif
+
+namespace facebook {
+namespace memcache {
+
+namespace {
+
+#if MCROUTER_IO_URING_SUPPORTED
+// Number of SQEs/CQEs per ring. Every connection has at most one read and
+// one write outstanding, plus a few for timers and notification queues.
+constexpr size_t kRingCapacity = 4096;
+// Max number of SQEs submitted with one io_uring_enter call.
+constexpr size_t kMaxSubmit = 256;
+#endif
+
+} // anonymous namespace
+
+bool IoUringUtil::isAvailable() noexcept {
+#if MCROUTER_IO_URING_SUPPORTED
+  static const bool available = folly::IoUringBackend::isAvailable();
+  return available;
+#else
+  return false;
+#endif
+}
+
+std::unique_ptr<folly::EventBase> IoUringUtil::createEventBase(
+    bool enableTimeMeasurement) {
+#if MCROUTER_IO_URING_SUPPORTED
+  if (!isAvailable()) {
+    return nullptr;
+  }
+  try {
+    return std::make_unique<folly::EventBase>(
+        folly::EventBase::Options()
+            .setSkipTimeMeasurement(!enableTimeMeasurement)
+            .setBackendFactory([] {
+              folly::IoUringBackend::Options options;
+              options.setCapacity(kRingCapacity)
+                  .setMaxSubmit(kMaxSubmit)
+                  .setUseRegisteredFds(kRingCapacity);
+              return std::make_unique<folly::IoUringBackend>(options);
+            }));
+  } catch (const std::exception& ex) {
+    LOG(WARNING) << "Failed to create io_uring EventBase: " << ex.what();
+    return nullptr;
+  }
+#else
+  (void)enableTimeMeasurement;
+  return nullptr;
+#endif
+}
+
+bool IoUringUtil::supportsIoUringSockets(folly::EventBase& evb) noexcept {
+#if MCROUTER_IO_URING_SUPPORTED
+  return folly::AsyncIoUringSocket::supports(&evb);
+#else
+  (void)evb;
+  return false;
+#endif
+}
+
+bool IoUringUtil::moveToIoUring(
+    folly::AsyncTransportWrapper::UniquePtr& transport) noexcept {
+#if MCROUTER_IO_URING_SUPPORTED
+  if (!transport || !transport->getEventBase() ||
+      !supportsIoUringSockets(*transport->getEventBase())) {
+    return false;
+  }
+  try {
+    transport.reset(new folly::AsyncIoUringSocket(std::move(transport)));
+    return true;
+  } catch (const std::exception& ex) {
+    LOG(WARNING) << "Failed to move transport to io_uring: " << ex.what();
+    return false;
+  }
+#else
+  (void)transport;
+  return false;
+#endif
+}
+
+} // namespace memcache
+} // namespace facebook
@@ -0,0 +1,77 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <memory>
+
+#include <folly/io/async/AsyncTransport.h>
+#include <folly/io/async/EventBase.h>
+
+namespace facebook {
+namespace memcache {
+
+/**
+ * A utility class for running AsyncMcClient and AsyncMcServer connections on
+ * io_uring instead of epoll.
+ *
+ * io_uring is used in two places:
+ *  - the EventBase itself is driven by an io_uring backend, so that event
+ *    registration and timers are submitted in batches once per loop;
+ *  - plaintext connections are moved from folly::AsyncSocket to an io_uring
+ *    socket once connected/accepted. Reads are submitted directly into the
+ *    buffer handed out by McParser (getReadBuffer()), and the iovecs from
+ *    WriteBuffer/McSerializedRequest are submitted as a single writev SQE that
+ *    gets flushed together with every other SQE at the end of the loop.
+ *
+ * Buffers are not registered with the ring (no READ_FIXED/WRITE_FIXED):
+ * fixed buffers only save pinning user pages for every IO, which socket IO
+ * doesn't do anyway (data is copied to/from socket buffers). They would
+ * instead cost a copy of every payload, since McParser buffers are
+ * reallocated as they grow and handed out with reply values, and writes come
+ * from the serialized requests' own IOBufs.
+ *
+ * io_uring sockets only work on EventBases created by createEventBase().
+ * Everything gracefully falls back to epoll when mcrouter was built without
+ * io_uring support or the kernel doesn't support it.
+ */
+class IoUringUtil {
+ public:
+  /**
+   * @return  true if mcrouter was built with io_uring support and the running
+   *          kernel supports it.
+   */
+  static bool isAvailable() noexcept;
+
+  /**
+   * Creates an EventBase driven by io_uring.
+   *
+   * @return  nullptr if io_uring is not available.
+   */
+  static std::unique_ptr<folly::EventBase> createEventBase(
+      bool enableTimeMeasurement);
+
+  /**
+   * @return  true if io_uring sockets can be used on the given EventBase.
+   */
+  static bool supportsIoUringSockets(folly::EventBase& evb) noexcept;
+
+  /**
+   * Move a connected plaintext transport to an io_uring socket. The
+   * underlying FD does not change.
+   *
+   * @return  true if `transport` was replaced with an io_uring socket, false
+   *          otherwise. If io_uring is not supported on the transport's
+   *          EventBase, `transport` is left untouched. If the conversion
+   *          itself failed, `transport` is closed and set to nullptr.
+   */
+  static bool moveToIoUring(
+      folly::AsyncTransportWrapper::UniquePtr& transport) noexcept;
+};
+
+} // namespace memcache
+} // namespace facebook
@@ -8,6 +8,7 @@
 #pragma once
 
 #include "mcrouter/lib/Reply.h"
+#include "mcrouter/lib/carbon/RequestReplyUtil.h"
 #include "mcrouter/lib/fbi/cpp/LogFailure.h"
 
 namespace facebook {
@@ -72,6 +73,11 @@ std::string McClientRequestContext<Request>::getContextTypeStr() const {
   return folly::sformat("RequestT is {}", typeid(Request).name());
 }
 
+template <class Request>
+folly::StringPiece McClientRequestContext<Request>::getKey() const {
+  return carbon::getFullKey(request_);
+}
+
 template <class Request>
 typename McClientRequestContext<Request>::Reply
 McClientRequestContext<Request>::waitForReply(
@@ -79,14 +85,20 @@ McClientRequestContext<Request>::waitForReply(
   batonWaitTimeout_ = timeout;
   baton_.wait(batonTimeoutHandler_);
 
+  if (state() == ReqState::REPLIED_QUEUE) {
+    // The request was already replied, but we're still waiting for socket
+    // write to succeed.
+    baton_.reset();
+    baton_.wait();
+    assert(state() == ReqState::COMPLETE);
+  }
+  return takeReply();
+}
+
+template <class Request>
+typename McClientRequestContext<Request>::Reply
+McClientRequestContext<Request>::takeReply() {
   switch (state()) {
-    case ReqState::REPLIED_QUEUE:
-      // The request was already replied, but we're still waiting for socket
-      // write to succeed.
-      baton_.reset();
-      baton_.wait();
-      assert(state() == ReqState::COMPLETE);
-      return std::move(replyStorage_.value());
     case ReqState::PENDING_QUEUE:
       // Request wasn't sent to the network yet, reply with timeout.
       queue_.removePending(*this);
@@ -101,6 +113,7 @@ McClientRequestContext<Request>::waitForReply(
     case ReqState::COMPLETE:
       assert(replyStorage_.hasValue());
       return std::move(replyStorage_.value());
+    case ReqState::REPLIED_QUEUE:
     case ReqState::WRITE_QUEUE:
     case ReqState::NONE:
       LOG_FAILURE(
@@ -132,6 +145,7 @@ McClientRequestContext<Request>::McClientRequestContext(
           onStateChange,
           supportedCodecs,
           payloadFormat),
+      request_(request),
       requestTraceContext_(request.traceContext())
 #ifndef LIBMC_FBTRACE_DISABLE
       ,
@@ -148,6 +162,68 @@ void McClientRequestContext<Request>::sendTraceOnReply() {
 #endif
 }
 
+template <class Request>
+McClientAsyncRequestContext<Request>::McClientAsyncRequestContext(
+    const Request& request,
+    uint64_t reqid,
+    mc_protocol_t protocol,
+    McClientRequestContextQueue& queue,
+    McClientRequestContextBase::InitializerFuncPtr func,
+    const std::function<void(int pendingDiff, int inflightDiff)>& onStateChange,
+    const CodecIdRange& supportedCodecs,
+    PayloadFormat payloadFormat,
+    folly::EventBase& eventBase,
+    std::chrono::milliseconds timeout,
+    ReplyCallback callback)
+    : McClientRequestContext<Request>(
+          request,
+          reqid,
+          protocol,
+          queue,
+          func,
+          onStateChange,
+          supportedCodecs,
+          payloadFormat),
+      eventBase_(eventBase),
+      timeout_(timeout),
+      callback_(std::move(callback)) {
+  this->baton_.setWaiter(*this);
+}
+
+template <class Request>
+void McClientAsyncRequestContext<Request>::scheduleTimeout() {
+  if (this->state() != McClientRequestContextBase::ReqState::COMPLETE) {
+    eventBase_.timer().scheduleTimeout(this, timeout_);
+  }
+}
+
+template <class Request>
+void McClientAsyncRequestContext<Request>::post() {
+  cancelTimeout();
+  // The queue may still use this context after posting it (e.g. the write
+  // callback after markNextAsSent()), call back from the loop instead.
+  eventBase_.runInLoop(this);
+}
+
+template <class Request>
+void McClientAsyncRequestContext<Request>::timeoutExpired() noexcept {
+  complete();
+}
+
+template <class Request>
+void McClientAsyncRequestContext<Request>::runLoopCallback() noexcept {
+  complete();
+}
+
+template <class Request>
+void McClientAsyncRequestContext<Request>::complete() {
+  auto reply = this->takeReply();
+  auto rpcStatsContext = this->getRpcStatsContext();
+  auto callback = std::move(callback_);
+  delete this;
+  callback(std::move(reply), rpcStatsContext);
+}
+
 template <class Reply>
 void McClientRequestContextQueue::reply(
     uint64_t id,
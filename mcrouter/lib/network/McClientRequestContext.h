@@ -12,8 +12,11 @@
 
 #include <boost/intrusive/unordered_set.hpp>
 
+#include <folly/Function.h>
 #include <folly/IntrusiveList.h>
 #include <folly/fibers/Baton.h>
+#include <folly/io/async/EventBase.h>
+#include <folly/io/async/HHWheelTimer.h>
 
 #include "mcrouter/lib/network/ClientMcParser.h"
 #include "mcrouter/lib/network/FBTrace.h"
@@ -53,6 +56,12 @@ class McClientRequestContextBase
    */
   virtual std::string getContextTypeStr() const = 0;
 
+  /**
+   * Key of the request, empty if it has none. Only needed for capturing, so
+   * it is not computed unless asked for.
+   */
+  virtual folly::StringPiece getKey() const = 0;
+
   /**
    * Propagate an error to the user.
    *
@@ -64,7 +73,7 @@ class McClientRequestContextBase
    * Schedule a timeout so that the request does not wait
    * indefinitely for a reply.
    */
-  void scheduleTimeout();
+  virtual void scheduleTimeout();
 
   void setRpcStatsContext(RpcStatsContext value) {
     rpcStatsContext_ = value;
@@ -192,11 +201,24 @@ class McClientRequestContext : public McClientRequestContextBase {
 
   std::string getContextTypeStr() const final;
 
+  folly::StringPiece getKey() const final;
+
   Reply waitForReply(std::chrono::milliseconds timeout);
 
+ protected:
+  /**
+   * Takes the reply once baton_ was posted, or the request timed out
+   * (in which case it is removed from the queue).
+   */
+  Reply takeReply();
+
  private:
   folly::Optional<Reply> replyStorage_;
 
+  // The request outlives this context, since its sender waits for the reply
+  // (or is called back).
+  const Request& request_;
+
   // tracing fields
   const std::string& requestTraceContext_;
 #ifndef LIBMC_FBTRACE_DISABLE
@@ -208,6 +230,53 @@ class McClientRequestContext : public McClientRequestContextBase {
       final;
 };
 
+/**
+ * Context of a request sent with AsyncMcClient::send(): instead of blocking
+ * a fiber until baton_ is posted, calls back with the reply from the loop of
+ * the client's EventBase. Owns itself until then.
+ */
+template <class Request>
+class McClientAsyncRequestContext final
+    : public McClientRequestContext<Request>,
+      private folly::fibers::Baton::Waiter,
+      private folly::HHWheelTimer::Callback,
+      private folly::EventBase::LoopCallback {
+ public:
+  using Reply = ReplyT<Request>;
+  using ReplyCallback = folly::Function<void(Reply&&, RpcStatsContext)>;
+
+  McClientAsyncRequestContext(
+      const Request& request,
+      uint64_t reqid,
+      mc_protocol_t protocol,
+      McClientRequestContextQueue& queue,
+      McClientRequestContextBase::InitializerFuncPtr,
+      const std::function<void(int pendingDiff, int inflightDiff)>&
+          onStateChange,
+      const CodecIdRange& supportedCodecs,
+      PayloadFormat payloadFormat,
+      folly::EventBase& eventBase,
+      std::chrono::milliseconds timeout,
+      ReplyCallback callback);
+
+  void scheduleTimeout() final;
+
+ private:
+  folly::EventBase& eventBase_;
+  const std::chrono::milliseconds timeout_;
+  ReplyCallback callback_;
+
+  // Baton::Waiter: the request is done.
+  void post() final;
+  // HHWheelTimer::Callback: no reply within timeout_ of the request being
+  // sent.
+  void timeoutExpired() noexcept final;
+  // EventBase::LoopCallback: calls back after a post().
+  void runLoopCallback() noexcept final;
+
+  void complete();
+};
+
 class McClientRequestContextQueue {
  public:
   explicit McClientRequestContextQueue(bool outOfOrder) noexcept;
@@ -156,7 +156,11 @@ bool McParser::readCaretData() {
     // Case 1: Entire message (and possibly part of next) is in the buffer
     if (readBuffer_.length() >= messageSize) {
       if (UNLIKELY(debugFifo_ && debugFifo_->isConnected())) {
-        debugFifo_->startMessage(MessageDirection::Received, msgInfo_.typeId);
+        ConnectionFifo::CaptureInfo info;
+        info.reqId = msgInfo_.reqId;
+        info.size = messageSize;
+        debugFifo_->startMessage(
+            MessageDirection::Received, msgInfo_.typeId, info);
         debugFifo_->writeData(readBuffer_.writableData(), messageSize);
       }
 
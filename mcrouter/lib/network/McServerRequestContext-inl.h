@@ -5,6 +5,8 @@
  * LICENSE file in the root directory of this source tree.
  */
 
+#include <folly/fibers/FiberManagerMap.h>
+
 #include "mcrouter/lib/network/McServerSession.h"
 #include "mcrouter/lib/network/WriteBuffer.h"
 
@@ -15,6 +17,17 @@
 namespace facebook {
 namespace memcache {
 
+namespace detail {
+
+inline folly::fibers::FiberManager::Options replyFiberManagerOptions() {
+  folly::fibers::FiberManager::Options opts;
+  // The reply may be written to the socket from the fiber.
+  opts.stackSize = 64 * 1024;
+  return opts;
+}
+
+} // namespace detail
+
 template <class Reply>
 void McServerRequestContext::reply(
     McServerRequestContext&& ctx,
@@ -98,6 +111,38 @@ void McServerRequestContext::replyImpl2(
     return;
   }
 
+  if (UNLIKELY(compressionMayBeOffloaded(*session, reply))) {
+    // Big replies are compressed on the auxiliary CPU pool while the calling
+    // fiber is preempted (see CaretSerializedMessage::compressOffloaded()).
+    // A reply sent from the main context, e.g. from the finally function of
+    // a routing fiber, is prepared on a fiber of the session thread instead.
+    // ctx keeps the session alive until then.
+    folly::fibers::getFiberManager(
+        session->eventBase_, detail::replyFiberManagerOptions())
+        .addTask([ctx = std::move(ctx),
+                  reply = std::move(reply),
+                  destructorContainer = std::move(destructorContainer),
+                  flush]() mutable {
+          prepareAndSendReply<SessionType>(
+              std::move(ctx),
+              std::move(reply),
+              std::move(destructorContainer),
+              flush);
+        });
+    return;
+  }
+
+  prepareAndSendReply<SessionType>(
+      std::move(ctx), std::move(reply), std::move(destructorContainer), flush);
+}
+
+template <class SessionType, class Reply>
+void McServerRequestContext::prepareAndSendReply(
+    McServerRequestContext&& ctx,
+    Reply&& reply,
+    std::unique_ptr<void, void (*)(void*)> destructorContainer,
+    bool flush) {
+  SessionType* const session = ctx.session_;
   uint64_t reqid = ctx.reqid_;
   auto wb = session->writeBufs_.get(session->parser_.protocol());
   if (!wb->prepareTyped(
@@ -106,7 +151,8 @@ void McServerRequestContext::replyImpl2(
           std::move(destructorContainer),
           session->compressionCodecMap_,
           session->codecIdRange_,
-          session->options_.tcpZeroCopyThresholdBytes)) {
+          session->options_.tcpZeroCopyThresholdBytes,
+          session->options_.compressionOffloadThresholdBytes)) {
     session->transport_->close();
     return;
   }
@@ -116,6 +162,22 @@ void McServerRequestContext::replyImpl2(
   }
 }
 
+template <class SessionType, class Reply>
+bool McServerRequestContext::compressionMayBeOffloaded(
+    const SessionType& session,
+    const Reply& reply) {
+  const auto threshold = session.options_.compressionOffloadThresholdBytes;
+  // The codec id range is only set by caret requests of clients that support
+  // compression.
+  if (threshold == 0 || session.compressionCodecMap_ == nullptr ||
+      session.codecIdRange_.isEmpty() || folly::fibers::onFiber()) {
+    return false;
+  }
+  // Only the value of a reply may make it big.
+  const auto* value = carbon::valuePtrUnsafe(reply);
+  return value != nullptr && value->computeChainDataLength() >= threshold;
+}
+
 /**
  * No reply if either:
  *  1) We saw an error (the error will be printed out by the end context),
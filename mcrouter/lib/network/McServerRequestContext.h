@@ -106,6 +106,22 @@ class McServerRequestContext {
       void* toDestruct = nullptr,
       bool flush = false);
 
+  template <class SessionType, class Reply>
+  static void prepareAndSendReply(
+      McServerRequestContext&& ctx,
+      Reply&& reply,
+      std::unique_ptr<void, void (*)(void*)> destructorContainer,
+      bool flush);
+
+  /**
+   * Whether the reply is big enough for its compression to be offloaded, but
+   * there is no fiber to preempt meanwhile.
+   */
+  template <class SessionType, class Reply>
+  static bool compressionMayBeOffloaded(
+      const SessionType& session,
+      const Reply& reply);
+
   folly::Optional<folly::IOBuf>& asciiKey() {
     if (!asciiState_) {
       asciiState_ = std::make_unique<AsciiState>();
@@ -10,6 +10,7 @@
 #include <memory>
 
 #include "mcrouter/lib/network/CarbonMessageList.h"
+#include "mcrouter/lib/network/CpuLoadShedding.h"
 #include "mcrouter/lib/network/McServerRequestContext.h"
 #include "mcrouter/lib/network/MultiOpParent.h"
 
@@ -32,6 +33,9 @@ void McServerSession::asciiRequestReady(
     return;
   }
 
+  // Decided before ctx is created, so that it isn't counted as in flight.
+  const bool shed = IsCpuSheddable<Request>::value && shouldShedForCpu();
+
   if (carbon::GetLike<Request>::value && !currentMultiop_) {
     currentMultiop_ = std::make_shared<MultiOpParent>(*this, tailReqid_++);
   }
@@ -45,6 +49,9 @@ void McServerSession::asciiRequestReady(
   if (result == carbon::Result::BAD_KEY) {
     McServerRequestContext::reply(
         std::move(ctx), Reply(carbon::Result::BAD_KEY));
+  } else if (shed) {
+    McServerRequestContext::reply(std::move(ctx), Reply(carbon::Result::BUSY));
+    onRequestShed();
   } else {
     try {
       onRequest_->requestReady(std::move(ctx), std::move(req));
@@ -7,18 +7,24 @@
 
 #include "McServerSession.h"
 
+#include <algorithm>
 #include <memory>
 
 #include <folly/Executor.h>
+#include <folly/Random.h>
 #include <folly/io/async/AsyncSSLSocket.h>
 #include <folly/io/async/VirtualEventBase.h>
 #include <folly/small_vector.h>
 
 #include "mcrouter/lib/debug/FifoManager.h"
+#include "mcrouter/lib/network/CarbonMessageList.h"
+#include "mcrouter/lib/network/CpuController.h"
+#include "mcrouter/lib/network/CpuLoadShedding.h"
 #include "mcrouter/lib/network/McFizzServer.h"
 #include "mcrouter/lib/network/McSSLUtil.h"
 #include "mcrouter/lib/network/McServerRequestContext.h"
 #include "mcrouter/lib/network/MultiOpParent.h"
+#include "mcrouter/lib/network/TypedMsg.h"
 #include "mcrouter/lib/network/WriteBuffer.h"
 
 namespace facebook {
@@ -146,8 +152,45 @@ void McServerSession::resume(PauseReason reason) {
   }
 }
 
+void McServerSession::addQueuedReplyBytes(size_t bytes) {
+  if (bytes == 0) {
+    return;
+  }
+  queuedReplyBytes_ += bytes;
+  stateCb_.onQueuedReplyBytesChanged(*this, static_cast<int64_t>(bytes));
+
+  const auto highWatermark = options_.queuedReplyBytesHighWatermark;
+  if (highWatermark > 0 && queuedReplyBytes_ >= highWatermark &&
+      !(pauseState_ & static_cast<uint64_t>(PAUSE_REPLY_BYTES))) {
+    ++numQueuedReplyBytesPauses_;
+    pause(PAUSE_REPLY_BYTES);
+  }
+}
+
+void McServerSession::releaseQueuedReplyBytes(size_t bytes) {
+  // Replies still queued when the session closed were released all at once.
+  bytes = std::min(bytes, queuedReplyBytes_);
+  if (bytes == 0) {
+    return;
+  }
+  queuedReplyBytes_ -= bytes;
+  stateCb_.onQueuedReplyBytesChanged(*this, -static_cast<int64_t>(bytes));
+
+  if (pauseState_ & static_cast<uint64_t>(PAUSE_REPLY_BYTES)) {
+    const auto lowWatermark = options_.queuedReplyBytesLowWatermark > 0
+        ? options_.queuedReplyBytesLowWatermark
+        : options_.queuedReplyBytesHighWatermark / 2;
+    if (queuedReplyBytes_ <= lowWatermark) {
+      resume(PAUSE_REPLY_BYTES);
+    }
+  }
+}
+
 void McServerSession::onTransactionStarted(bool isSubRequest) {
   ++inFlight_;
+  if (cpuSheddingEnabled()) {
+    stateCb_.onRequestsInFlightChanged(*this, 1);
+  }
   if (options_.maxInFlight > 0 && !isSubRequest) {
     if (++realRequestsInFlight_ >= options_.maxInFlight) {
       DestructorGuard dg(this);
@@ -165,6 +208,7 @@ void McServerSession::checkClosed() {
       // It's possible to call close() more than once from the same stack.
       // Prevent second close() from doing anything
       state_ = CLOSED;
+      releaseQueuedReplyBytes(queuedReplyBytes_);
       // Call onCloseFinish() before transport reset to keep transport in tact
       onCloseFinish();
       if (transport_) {
@@ -182,6 +226,9 @@ void McServerSession::onTransactionCompleted(bool isSubRequest) {
 
   assert(inFlight_ > 0);
   --inFlight_;
+  if (cpuSheddingEnabled()) {
+    stateCb_.onRequestsInFlightChanged(*this, -1);
+  }
   if (options_.maxInFlight > 0 && !isSubRequest) {
     assert(realRequestsInFlight_ > 0);
     if (--realRequestsInFlight_ < options_.maxInFlight) {
@@ -192,24 +239,73 @@ void McServerSession::onTransactionCompleted(bool isSubRequest) {
   checkClosed();
 }
 
+bool McServerSession::shouldShedForCpu() {
+  if (!cpuSheddingEnabled()) {
+    return false;
+  }
+  const auto probability = cpuShedProbability(
+      options_.cpuController->getServerLoad().percentLoad(),
+      options_.cpuShedTargetPercent,
+      inFlight_,
+      stateCb_.avgRequestsInFlight());
+  return probability > 0.0 && folly::Random::randDouble01() < probability;
+}
+
+namespace {
+
+struct CaretShedder {
+  bool shed{false};
+
+  template <class Request>
+  static void processMsg(CaretShedder& me, McServerRequestContext& ctx) {
+    if (IsCpuSheddable<Request>::value) {
+      McServerRequestContext::reply(
+          std::move(ctx), ReplyT<Request>(carbon::Result::BUSY));
+      me.shed = true;
+    }
+  }
+};
+
+} // anonymous namespace
+
+bool McServerSession::shedCaretRequest(
+    size_t typeId,
+    McServerRequestContext& ctx) {
+  static CallDispatcher<McRequestList, CaretShedder, McServerRequestContext&>
+      dispatcher;
+  // Requests unknown to McRequestList can't be replied to here, let them be.
+  CaretShedder shedder;
+  dispatcher.dispatch(typeId, shedder, ctx);
+  if (shedder.shed) {
+    onRequestShed();
+  }
+  return shedder.shed;
+}
+
+void McServerSession::onRequestShed() {
+  ++numCpuShedRequests_;
+  stateCb_.onRequestShed(*this);
+}
+
 void McServerSession::reply(std::unique_ptr<WriteBuffer> wb, uint64_t reqid) {
   DestructorGuard dg(this);
 
+  if (wb) {
+    addQueuedReplyBytes(wb->getIovsTotalLen());
+  }
+
   if (parser_.outOfOrder()) {
     queueWrite(std::move(wb));
   } else {
     if (reqid == headReqid_) {
       /* head of line reply, write it and all contiguous blocked replies */
       queueWrite(std::move(wb));
-      auto it = blockedReplies_.find(++headReqid_);
-      while (it != blockedReplies_.end()) {
-        queueWrite(std::move(it->second));
-        blockedReplies_.erase(it);
-        it = blockedReplies_.find(++headReqid_);
+      while (blockedReplies_.take(++headReqid_, wb)) {
+        queueWrite(std::move(wb));
       }
     } else {
       /* can't write this reply now, save for later */
-      blockedReplies_.emplace(reqid, std::move(wb));
+      blockedReplies_.put(reqid, headReqid_, std::move(wb));
     }
   }
 }
@@ -356,6 +452,8 @@ void McServerSession::caretRequestReady(
     return;
   }
 
+  // Decided before ctx is created, so that it isn't counted as in flight.
+  const bool shed = shouldShedForCpu();
   McServerRequestContext ctx(*this, headerInfo.reqId);
 
   if (McVersionRequest::typeId == headerInfo.typeId &&
@@ -364,6 +462,8 @@ void McServerSession::caretRequestReady(
     versionReply.value() =
         folly::IOBuf(folly::IOBuf::COPY_BUFFER, options_.versionString);
     McServerRequestContext::reply(std::move(ctx), std::move(versionReply));
+  } else if (shed && shedCaretRequest(headerInfo.typeId, ctx)) {
+    // Rejected before deserializing the body.
   } else {
     try {
       onRequest_->caretRequestReady(headerInfo, reqBody, std::move(ctx));
@@ -438,8 +538,10 @@ void McServerSession::sendZeroCopyIOBuf(
   assert(wbufInfo != nullptr);
   wbuf.setZeroCopyPendingNotifications(iovsCount);
   std::unique_ptr<folly::IOBuf> chainTail;
+  size_t bytes = 0;
   for (size_t i = 0; i < iovsCount; i++) {
     size_t len = iovs[i].iov_len;
+    bytes += len;
     if (len > 0) {
       std::unique_ptr<folly::IOBuf> iobuf = folly::IOBuf::takeOwnership(
           iovs[i].iov_base,
@@ -468,7 +570,7 @@ void McServerSession::sendZeroCopyIOBuf(
     }
   }
 
-  zeroCopySessionCB_.incCallbackPending();
+  zeroCopySessionCB_.incCallbackPending(bytes);
   transport_->writeChain(
       &zeroCopySessionCB_ /* write cb */,
       std::move(chainTail),
@@ -536,6 +638,9 @@ void McServerSession::sendWrites() {
           iovs.end(),
           wb->getIovsBegin(),
           wb->getIovsBegin() + wb->getIovsCount());
+    } else if (doZeroCopy) {
+      // Zero copy writes only account for the bytes they actually send.
+      releaseQueuedReplyBytes(wb->getIovsTotalLen());
     }
     if (pendingWrites_.empty()) {
       wb->markEndOfBatch();
@@ -560,14 +665,20 @@ void McServerSession::sendWrites() {
 }
 
 void McServerSession::writeToDebugFifo(const WriteBuffer* wb) noexcept {
+  ConnectionFifo::CaptureInfo info;
+  info.reqId = wb->reqId();
   if (!wb->isSubRequest()) {
-    debugFifo_.startMessage(MessageDirection::Sent, wb->typeId());
+    info.size = wb->getIovsTotalLen();
+    debugFifo_.startMessage(MessageDirection::Sent, wb->typeId(), info);
     hasPendingMultiOp_ = false;
   } else {
     // Handle multi-op
     if (!hasPendingMultiOp_) {
-      debugFifo_.startMessage(MessageDirection::Sent, wb->typeId());
+      debugFifo_.startMessage(MessageDirection::Sent, wb->typeId(), info);
       hasPendingMultiOp_ = true;
+    } else if (!wb->isEndContext()) {
+      // Every key of the multi-op was captured as a request of its own.
+      debugFifo_.skipReply(info.reqId);
     }
     if (wb->isEndContext()) {
       // Multi-op replies always finish with an end context
@@ -578,7 +689,8 @@ void McServerSession::writeToDebugFifo(const WriteBuffer* wb) noexcept {
 }
 
 void McServerSession::completeWrite() {
-  writeBufs_.pop(!options_.singleWrite /* popBatch */);
+  releaseQueuedReplyBytes(
+      writeBufs_.pop(!options_.singleWrite /* popBatch */));
 }
 
 void McServerSession::writeSuccess() noexcept {
@@ -7,6 +7,8 @@
 
 #pragma once
 
+#include <deque>
+
 #include <fizz/server/AsyncFizzServer.h>
 #include <folly/IntrusiveList.h>
 #include <folly/io/async/AsyncSSLSocket.h>
@@ -18,6 +20,7 @@
 #include "mcrouter/lib/CompressionCodecManager.h"
 #include "mcrouter/lib/debug/ConnectionFifo.h"
 #include "mcrouter/lib/network/AsyncMcServerWorkerOptions.h"
+#include "mcrouter/lib/network/ReplyReorderRing.h"
 #include "mcrouter/lib/network/SecurityOptions.h"
 #include "mcrouter/lib/network/ServerMcParser.h"
 #include "mcrouter/lib/network/WriteBuffer.h"
@@ -58,6 +61,27 @@ class McServerSession
     virtual void onCloseStart(McServerSession&) = 0;
     virtual void onCloseFinish(McServerSession&, bool onAcceptedCalled) = 0;
     virtual void onShutdown() = 0;
+    /**
+     * Called whenever the number of bytes of queued replies changes,
+     * see McServerSession::queuedReplyBytes().
+     */
+    virtual void onQueuedReplyBytesChanged(
+        McServerSession& /* session */,
+        int64_t /* delta */) {}
+    /**
+     * The following are only called if CPU load shedding is enabled,
+     * see AsyncMcServerWorkerOptions::cpuShedTargetPercent.
+     */
+    virtual void onRequestsInFlightChanged(
+        McServerSession& /* session */,
+        int64_t /* delta */) {}
+    virtual void onRequestShed(McServerSession& /* session */) {}
+    /**
+     * @return  Average number of requests in flight per session.
+     */
+    virtual double avgRequestsInFlight() const {
+      return 0.0;
+    }
   };
 
   class ZeroCopySessionCB : public folly::AsyncTransportWrapper::WriteCallback {
@@ -74,6 +98,7 @@ class McServerSession
     void writeSuccess() noexcept final {
       // Zero Copy write still in progress until async notification
       assert(numCallbackPending_ > 0);
+      releaseBytes();
       if (--numCallbackPending_ == 0 && session_.state_ == STREAMING) {
         session_.stateCb_.onWriteQuiescence(session_);
         // No-op if not paused
@@ -89,12 +114,14 @@ class McServerSession
         const folly::AsyncSocketException&) noexcept final {
       assert(numCallbackPending_ > 0);
       // Buffers will be freed by FreeFn in ~IOBuf
+      releaseBytes();
       --numCallbackPending_;
       session_.close();
     }
 
-    void incCallbackPending() {
+    void incCallbackPending(size_t bytes) {
       ++numCallbackPending_;
+      pendingBytes_.push_back(bytes);
     }
 
     uint64_t getCallbackPending() const {
@@ -104,6 +131,14 @@ class McServerSession
    private:
     McServerSession& session_;
     uint64_t numCallbackPending_{0};
+    // Bytes of every pending write, in the order the writes were issued.
+    std::deque<size_t> pendingBytes_;
+
+    void releaseBytes() {
+      assert(!pendingBytes_.empty());
+      session_.releaseQueuedReplyBytes(pendingBytes_.front());
+      pendingBytes_.pop_front();
+    }
   };
 
   /**
@@ -204,6 +239,31 @@ class McServerSession
     return (pauseState_ & static_cast<uint64_t>(PAUSE_USER)) != 0;
   }
 
+  /**
+   * @return  Number of bytes of replies that are queued, i.e. waiting for
+   *          replies to earlier requests (in-order protocols) or waiting to be
+   *          written to the transport.
+   */
+  size_t queuedReplyBytes() const noexcept {
+    return queuedReplyBytes_;
+  }
+
+  /**
+   * @return  Number of times reading was paused because queuedReplyBytes()
+   *          reached AsyncMcServerWorkerOptions::queuedReplyBytesHighWatermark.
+   */
+  uint64_t numQueuedReplyBytesPauses() const noexcept {
+    return numQueuedReplyBytesPauses_;
+  }
+
+  /**
+   * @return  Number of requests rejected with BUSY because the server was
+   *          over its CPU target.
+   */
+  uint64_t numCpuShedRequests() const noexcept {
+    return numCpuShedRequests_;
+  }
+
   /**
    * Get the user context associated with this session.
    */
@@ -218,6 +278,16 @@ class McServerSession
     return socketAddress_;
   }
 
+  /**
+   * The peer's address as a string, formatted once per session.
+   */
+  folly::StringPiece getSocketAddressStr() {
+    if (socketAddressStr_.empty()) {
+      socketAddressStr_ = socketAddress_.getAddressStr();
+    }
+    return socketAddressStr_;
+  }
+
   /**
    * Get the socket's local address
    */
@@ -353,6 +423,7 @@ class McServerSession
     PAUSE_THROTTLED = 1 << 0,
     PAUSE_WRITE = 1 << 1,
     PAUSE_USER = 1 << 2,
+    PAUSE_REPLY_BYTES = 1 << 3,
   };
 
   /* Reads are enabled iff pauseState_ == 0 */
@@ -368,15 +439,22 @@ class McServerSession
 
   /* headReqid_ <= tailReqid_.  Since we must output replies sequentially,
      headReqid_ tracks the last reply id we're allowed to sent out.
-     Out of order replies are stalled in the blockedReplies_ queue. */
+     Out of order replies are stalled in the blockedReplies_ ring. */
   uint64_t headReqid_{0}; /**< Id of next unblocked reply */
   uint64_t tailReqid_{0}; /**< Id to assign to next request */
-  std::unordered_map<uint64_t, std::unique_ptr<WriteBuffer>> blockedReplies_;
+  ReplyReorderRing blockedReplies_;
+
+  /* Reply byte accounting, see queuedReplyBytes() */
+  size_t queuedReplyBytes_{0};
+  uint64_t numQueuedReplyBytesPauses_{0};
+
+  uint64_t numCpuShedRequests_{0};
 
   /* If non-null, a multi-op operation is being parsed.*/
   std::shared_ptr<MultiOpParent> currentMultiop_;
 
   folly::SocketAddress socketAddress_;
+  std::string socketAddressStr_;
 
   /**
    * If this session corresponds to an SSL session then
@@ -401,6 +479,13 @@ class McServerSession
   void pause(PauseReason reason);
   void resume(PauseReason reason);
 
+  /**
+   * Account for reply bytes entering/leaving the session, pausing or resuming
+   * reads on the watermarks.
+   */
+  void addQueuedReplyBytes(size_t bytes);
+  void releaseQueuedReplyBytes(size_t bytes);
+
   /**
    * Flush pending writes to the transport.
    */
@@ -490,6 +575,26 @@ class McServerSession
   void onTransactionStarted(bool isSubRequest);
   void onTransactionCompleted(bool isSubRequest);
 
+  bool cpuSheddingEnabled() const noexcept {
+    return options_.cpuShedTargetPercent > 0 && options_.cpuController;
+  }
+
+  /**
+   * Decides whether the next request should be rejected because the server
+   * is over its CPU target. Must be called before the request's context is
+   * created.
+   */
+  bool shouldShedForCpu();
+
+  /**
+   * Replies BUSY to the Caret request if it is sheddable.
+   *
+   * @return  true iff the request was rejected.
+   */
+  bool shedCaretRequest(size_t typeId, McServerRequestContext& ctx);
+
+  void onRequestShed();
+
   void writeToDebugFifo(const WriteBuffer* wb) noexcept;
 
   /**
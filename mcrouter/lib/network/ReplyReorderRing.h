@@ -0,0 +1,117 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <cassert>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "mcrouter/lib/network/WriteBuffer.h"
+
+namespace facebook {
+namespace memcache {
+
+/**
+ * Holds replies of in-order protocols that completed before the replies of
+ * earlier requests, until they can be written out.
+ *
+ * Replies are stored in a power-of-two ring indexed by request id. Since
+ * requests mostly complete close to the order they were received in, the
+ * ring stays small and lookups are a mask away, without any hashing or
+ * per-reply allocation. The ring grows whenever a reply is too far ahead of
+ * the head to fit.
+ *
+ * Not thread-safe.
+ */
+class ReplyReorderRing {
+ public:
+  ReplyReorderRing() = default;
+
+  ReplyReorderRing(const ReplyReorderRing&) = delete;
+  ReplyReorderRing& operator=(const ReplyReorderRing&) = delete;
+
+  /**
+   * Stores the reply for `reqid` (which can be nullptr).
+   *
+   * @param headReqid  Id of the next reply to be written out, must be less
+   *                   than `reqid` and not greater than any stored id.
+   */
+  void put(
+      uint64_t reqid,
+      uint64_t headReqid,
+      std::unique_ptr<WriteBuffer> wb) {
+    assert(reqid > headReqid);
+    while (reqid - headReqid >= slots_.size()) {
+      grow(headReqid);
+    }
+    auto& slot = slots_[reqid & (slots_.size() - 1)];
+    assert(!slot.used);
+    slot.wb = std::move(wb);
+    slot.used = true;
+    ++size_;
+  }
+
+  /**
+   * Removes the reply for `reqid` if it's stored.
+   *
+   * @return  true if there was a reply for `reqid` (which is moved to `wb`).
+   */
+  bool take(uint64_t reqid, std::unique_ptr<WriteBuffer>& wb) {
+    if (size_ == 0) {
+      return false;
+    }
+    auto& slot = slots_[reqid & (slots_.size() - 1)];
+    if (!slot.used) {
+      return false;
+    }
+    wb = std::move(slot.wb);
+    slot.used = false;
+    --size_;
+    return true;
+  }
+
+  size_t size() const noexcept {
+    return size_;
+  }
+
+  bool empty() const noexcept {
+    return size_ == 0;
+  }
+
+ private:
+  static constexpr size_t kInitialCapacity = 16;
+
+  struct Slot {
+    std::unique_ptr<WriteBuffer> wb;
+    bool used{false};
+  };
+
+  std::vector<Slot> slots_;
+  size_t size_{0};
+
+  void grow(uint64_t headReqid) {
+    if (slots_.empty()) {
+      slots_.resize(kInitialCapacity);
+      return;
+    }
+    std::vector<Slot> slots(slots_.size() * 2);
+    const auto oldMask = slots_.size() - 1;
+    const auto newMask = slots.size() - 1;
+    for (uint64_t id = headReqid; id < headReqid + slots_.size(); ++id) {
+      auto& from = slots_[id & oldMask];
+      if (from.used) {
+        slots[id & newMask] = std::move(from);
+      }
+    }
+    slots_ = std::move(slots);
+  }
+};
+
+} // namespace memcache
+} // namespace facebook
@@ -7,6 +7,7 @@
 
 #include <folly/lang/Bits.h>
 
+#include "mcrouter/lib/carbon/RequestReplyUtil.h"
 #include "mcrouter/lib/debug/ConnectionFifo.h"
 
 namespace facebook {
@@ -99,7 +100,7 @@ template <class Callback>
 template <class Request>
 void ServerMcParser<Callback>::onRequest(Request&& req, bool noreply) {
   if (UNLIKELY(debugFifo_ && debugFifo_->isConnected())) {
-    writeToPipe(req);
+    writeToPipe(req, noreply);
   }
   callback_.onRequest(std::move(req), noreply);
 }
@@ -111,13 +112,19 @@ void ServerMcParser<Callback>::multiOpEnd() {
 
 template <class Callback>
 template <class Request>
-void ServerMcParser<Callback>::writeToPipe(const Request& req) {
+void ServerMcParser<Callback>::writeToPipe(const Request& req, bool noreply) {
   assert(debugFifo_);
+  ConnectionFifo::CaptureInfo info;
+  info.key = carbon::getFullKey(req);
+  info.noreply = noreply;
+  if (!debugFifo_->startMessage(
+          MessageDirection::Received, Request::typeId, info)) {
+    return;
+  }
   AsciiSerializedRequest debugSerializedRequest;
   const struct iovec* iov;
   size_t iovLen;
   debugSerializedRequest.prepare(req, iov, iovLen);
-  debugFifo_->startMessage(MessageDirection::Received, Request::typeId);
   debugFifo_->writeData(iov, iovLen);
 }
 }
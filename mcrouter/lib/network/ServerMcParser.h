@@ -69,7 +69,7 @@ class ServerMcParser : private McParser::ParserCallback {
   // Debug fifo fields and methods
   ConnectionFifo* debugFifo_{nullptr};
   template <class Request>
-  FOLLY_NOINLINE void writeToPipe(const Request& req);
+  FOLLY_NOINLINE void writeToPipe(const Request& req, bool noreply);
 
   /* McParser callbacks */
   bool caretMessageReady(
@@ -24,16 +24,19 @@
 #include "mcrouter/lib/network/ConnectionOptions.h"
 #include "mcrouter/lib/network/McFizzClient.h"
 #include "mcrouter/lib/network/ThreadLocalSSLContextProvider.h"
+#include "mcrouter/lib/network/TlsSessionCache.h"
 
 namespace facebook {
 namespace memcache {
 
 namespace {
 
-std::string getServiceIdentity(const ConnectionOptions& opts) {
-  const auto& svcIdentity = opts.securityOpts.sslServiceIdentity;
-  return svcIdentity.empty() ? opts.accessPoint->toHostPortString()
-                             : svcIdentity;
+// Sessions are shared by all threads, so the key has to tell destinations
+// apart even if they share a service identity.
+std::string getSessionKey(const ConnectionOptions& opts) {
+  return tlsSessionCacheKey(
+      opts.accessPoint->toHostPortString(),
+      opts.securityOpts.sslServiceIdentity);
 }
 
 void createTCPKeepAliveOptions(
@@ -162,7 +165,7 @@ createSocketCommon(
         "SSL protocol is not applicable for Unix Domain Sockets"));
   }
   const auto& securityOpts = connectionOptions.securityOpts;
-  const auto& serviceId = getServiceIdentity(connectionOptions);
+  const auto sessionKey = getSessionKey(connectionOptions);
   // openssl based tls
   auto sslContext = getClientContext(securityOpts, mech);
   if (!sslContext) {
@@ -177,8 +180,8 @@ createSocketCommon(
   if (securityOpts.sessionCachingEnabled) {
     if (auto clientCtx =
             std::dynamic_pointer_cast<ClientSSLContext>(sslContext)) {
-      sslSocket->setSessionKey(serviceId);
-      auto session = clientCtx->getCache().getSSLSession(serviceId);
+      sslSocket->setSessionKey(sessionKey);
+      auto session = clientCtx->getCache().getSSLSession(sessionKey);
       if (session) {
         sslSocket->setSSLSession(session.release(), true);
       }
@@ -213,7 +216,7 @@ createSocket(
         "SSL protocol is not applicable for Unix Domain Sockets"));
   }
   const auto& securityOpts = connectionOptions.securityOpts;
-  const auto& serviceId = getServiceIdentity(connectionOptions);
+  const auto sessionKey = getSessionKey(connectionOptions);
   // tls 13 fizz
   auto fizzContextAndVerifier = getFizzClientConfig(securityOpts);
   if (!fizzContextAndVerifier.first) {
@@ -226,7 +229,7 @@ createSocket(
       &eventBase,
       std::move(fizzContextAndVerifier.first),
       std::move(fizzContextAndVerifier.second));
-  fizzClient->setSessionKey(serviceId);
+  fizzClient->setSessionKey(sessionKey);
   if (securityOpts.tfoEnabledForSsl) {
     if (auto underlyingSocket =
             fizzClient->getUnderlyingTransport<folly::AsyncSocket>()) {
@@ -9,15 +9,11 @@
 
 #include <unordered_map>
 
-#include <folly/Singleton.h>
 #include <folly/hash/Hash.h>
 #include <folly/io/async/SSLContext.h>
 #include <folly/io/async/SSLOptions.h>
 #include <folly/portability/OpenSSL.h>
 #include <folly/ssl/Init.h>
-#include <wangle/client/persistence/SharedMutexCacheLockGuard.h>
-#include <wangle/client/ssl/SSLSessionCacheData.h>
-#include <wangle/client/ssl/SSLSessionPersistentCache.h>
 #include <wangle/ssl/SSLCacheOptions.h>
 #include <wangle/ssl/SSLContextConfig.h>
 #include <wangle/ssl/SSLSessionCacheManager.h>
@@ -27,6 +23,7 @@
 
 #include "mcrouter/lib/fbi/cpp/LogFailure.h"
 #include "mcrouter/lib/network/SecurityOptions.h"
+#include "mcrouter/lib/network/TlsSessionCache.h"
 
 using folly::SSLContext;
 
@@ -199,35 +196,6 @@ bool configureServerSSLContext(
   return true;
 }
 
-using TicketCacheLayer = wangle::LRUPersistentCache<
-    std::string,
-    wangle::SSLSessionCacheData,
-    folly::SharedMutex>;
-
-// a SSL session cache that keys off string
-class SSLTicketCache
-    : public wangle::SSLSessionPersistentCacheBase<std::string> {
- public:
-  explicit SSLTicketCache(std::shared_ptr<TicketCacheLayer> cache)
-      : wangle::SSLSessionPersistentCacheBase<std::string>(std::move(cache)) {}
-
- protected:
-  std::string getKey(const std::string& identity) const override {
-    return identity;
-  }
-};
-
-// global thread safe ticket cache
-// TODO(jmswen) Try to come up with a cleaner approach here that doesn't require
-// leaking.
-folly::LeakySingleton<SSLTicketCache> ticketCache([] {
-  // create cache layer of max size 100;
-  auto cacheLayer = std::make_shared<TicketCacheLayer>(
-      wangle::PersistentCacheConfig::Builder().setCapacity(100).build());
-  cacheLayer->init();
-  return new SSLTicketCache(std::move(cacheLayer));
-});
-
 std::shared_ptr<SSLContext> createServerSSLContext(
     folly::StringPiece pemCertPath,
     folly::StringPiece certData,
@@ -305,7 +273,7 @@ std::string readFile(folly::StringPiece path) {
 std::shared_ptr<SSLContext> createClientSSLContext(
     SecurityOptions opts,
     SecurityMech mech) {
-  auto context = std::make_shared<ClientSSLContext>(ticketCache.get());
+  auto context = std::make_shared<ClientSSLContext>(getSharedSSLSessionCache());
   auto ciphers = folly::ssl::SSLCommonOptions::ciphers();
   std::vector<std::string> cVec(ciphers.begin(), ciphers.end());
 #if FOLLY_OPENSSL_HAS_ALPN
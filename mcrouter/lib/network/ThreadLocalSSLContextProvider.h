@@ -43,7 +43,8 @@ class ClientSSLContext : public folly::SSLContext {
   }
 
  private:
-  // In our usage, cache_ is a LeakySingleton so the raw reference is safe.
+  // In our usage, cache_ is the leaked process-wide session cache
+  // (see TlsSessionCache.h) so the raw reference is safe.
   wangle::SSLSessionCallbacks& cache_;
 };
 
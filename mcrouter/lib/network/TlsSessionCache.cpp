@@ -0,0 +1,150 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include "TlsSessionCache.h"
+
+#include <fizz/client/PskCache.h>
+#include <folly/Conv.h>
+#include <folly/portability/OpenSSL.h>
+#include <folly/ssl/OpenSSLPtrTypes.h>
+#include <wangle/client/ssl/SSLSessionCallbacks.h>
+
+#include "mcrouter/lib/ShardedLruCache.h"
+
+namespace facebook {
+namespace memcache {
+
+namespace {
+
+/**
+ * OpenSSL sessions are kept as they are (no serialization), sessions are
+ * reference counted so that a cached one can be handed out to any number of
+ * connections.
+ */
+class SharedSSLSessionCache : public wangle::SSLSessionCallbacks {
+ public:
+  explicit SharedSSLSessionCache(size_t capacity) : cache_(capacity) {}
+
+  void setSSLSession(
+      const std::string& identity,
+      folly::ssl::SSLSessionUniquePtr session) noexcept override {
+    if (!session) {
+      return;
+    }
+    cache_.set(
+        identity,
+        std::shared_ptr<SSL_SESSION>(session.release(), SSL_SESSION_free));
+  }
+
+  folly::ssl::SSLSessionUniquePtr getSSLSession(
+      const std::string& identity) const noexcept override {
+    auto session = cache_.get(identity);
+    if (!session) {
+      return nullptr;
+    }
+    // the caller owns a reference of its own
+    SSL_SESSION_up_ref(session->get());
+    return folly::ssl::SSLSessionUniquePtr(session->get());
+  }
+
+  bool removeSSLSession(const std::string& identity) noexcept override {
+    return cache_.remove(identity);
+  }
+
+  size_t size() const override {
+    return cache_.getStats().size;
+  }
+
+  ShardedLruCache<std::shared_ptr<SSL_SESSION>>& cache() {
+    return cache_;
+  }
+
+ private:
+  // lookups are logically const, but update LRU order and stats
+  mutable ShardedLruCache<std::shared_ptr<SSL_SESSION>> cache_;
+};
+
+class SharedFizzPskCache : public fizz::client::PskCache {
+ public:
+  explicit SharedFizzPskCache(size_t capacity) : cache_(capacity) {}
+
+  folly::Optional<fizz::client::CachedPsk> getPsk(
+      const std::string& identity) override {
+    return cache_.get(identity);
+  }
+
+  void putPsk(const std::string& identity, fizz::client::CachedPsk psk)
+      override {
+    cache_.set(identity, std::move(psk));
+  }
+
+  void removePsk(const std::string& identity) override {
+    cache_.remove(identity);
+  }
+
+  ShardedLruCache<fizz::client::CachedPsk>& cache() {
+    return cache_;
+  }
+
+ private:
+  ShardedLruCache<fizz::client::CachedPsk> cache_;
+};
+
+// Leaked on purpose: contexts referencing them may outlive static destruction.
+SharedSSLSessionCache& sslSessionCache() {
+  static auto* cache =
+      new SharedSSLSessionCache(kDefaultTlsSessionCacheCapacity);
+  return *cache;
+}
+
+const std::shared_ptr<SharedFizzPskCache>& fizzPskCache() {
+  static auto* cache = new std::shared_ptr<SharedFizzPskCache>(
+      std::make_shared<SharedFizzPskCache>(kDefaultTlsSessionCacheCapacity));
+  return *cache;
+}
+
+template <class Stats>
+void addStats(TlsSessionCacheStats& result, const Stats& stats) {
+  result.lookups += stats.lookups;
+  result.hits += stats.hits;
+  result.evictions += stats.evictions;
+  result.size += stats.size;
+}
+
+} // namespace
+
+wangle::SSLSessionCallbacks& getSharedSSLSessionCache() {
+  return sslSessionCache();
+}
+
+std::shared_ptr<fizz::client::PskCache> getSharedFizzPskCache() {
+  return fizzPskCache();
+}
+
+void setTlsSessionCacheCapacity(size_t capacity) {
+  sslSessionCache().cache().setCapacity(capacity);
+  fizzPskCache()->cache().setCapacity(capacity);
+}
+
+TlsSessionCacheStats getTlsSessionCacheStats() {
+  TlsSessionCacheStats result;
+  addStats(result, sslSessionCache().cache().getStats());
+  addStats(result, fizzPskCache()->cache().getStats());
+  return result;
+}
+
+std::string tlsSessionCacheKey(
+    folly::StringPiece hostPort,
+    folly::StringPiece serviceIdentity) {
+  if (serviceIdentity.empty()) {
+    return hostPort.str();
+  }
+  return folly::to<std::string>(serviceIdentity, '@', hostPort);
+}
+
+} // namespace memcache
+} // namespace facebook
@@ -0,0 +1,68 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <string>
+
+#include <folly/Range.h>
+
+namespace fizz {
+namespace client {
+class PskCache;
+} // namespace client
+} // namespace fizz
+
+namespace wangle {
+class SSLSessionCallbacks;
+} // namespace wangle
+
+namespace facebook {
+namespace memcache {
+
+/**
+ * Process-wide caches of client TLS sessions (OpenSSL) and PSKs (Fizz),
+ * shared by all threads: a connection can resume a session established by
+ * any other thread. Both are sharded LRU caches with a bounded number of
+ * entries (kDefaultTlsSessionCacheCapacity each unless changed).
+ */
+constexpr size_t kDefaultTlsSessionCacheCapacity = 4096;
+
+wangle::SSLSessionCallbacks& getSharedSSLSessionCache();
+
+std::shared_ptr<fizz::client::PskCache> getSharedFizzPskCache();
+
+/**
+ * Changes the max number of entries of each of the shared caches.
+ * 0 disables session caching.
+ */
+void setTlsSessionCacheCapacity(size_t capacity);
+
+struct TlsSessionCacheStats {
+  uint64_t lookups{0};
+  uint64_t hits{0};
+  uint64_t evictions{0};
+  size_t size{0};
+};
+
+/**
+ * @return  Stats of both shared caches combined.
+ */
+TlsSessionCacheStats getTlsSessionCacheStats();
+
+/**
+ * Key of the sessions of a destination: sessions are only resumed with the
+ * host they were established with, and only for the same service identity.
+ */
+std::string tlsSessionCacheKey(
+    folly::StringPiece hostPort,
+    folly::StringPiece serviceIdentity);
+
+} // namespace memcache
+} // namespace facebook
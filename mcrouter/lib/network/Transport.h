@@ -7,6 +7,7 @@
 
 #pragma once
 
+#include <chrono>
 #include <cstddef>
 #include <functional>
 
@@ -112,6 +113,13 @@ class Transport {
      * again when the transport becomes ready to be written to again.
      */
     std::function<void()> onPartialWrite;
+
+    /**
+     * Will be called everytime a batch was held back by adaptive batching,
+     * right before it is written. The delay argument holds the latency that
+     * was added to the oldest request of the batch.
+     */
+    std::function<void(std::chrono::microseconds delay)> onBatchDelayed;
   };
 
   /**
@@ -26,7 +26,8 @@ WriteBuffer::prepareTyped(
     Destructor destructor,
     const CompressionCodecMap* compressionCodecMap,
     const CodecIdRange& codecIdRange,
-    size_t tcpZeroCopyThreshold) {
+    size_t tcpZeroCopyThreshold,
+    size_t compressionOffloadThreshold) {
   ctx_.emplace(std::move(ctx));
   assert(!destructor_.hasValue());
   if (destructor) {
@@ -44,6 +45,7 @@ WriteBuffer::prepareTyped(
 
     case mc_caret_protocol:
       caretReply_.setTCPZeroCopyThreshold(tcpZeroCopyThreshold);
+      caretReply_.setCompressionOffloadThreshold(compressionOffloadThreshold);
       return caretReply_.prepare(
           std::move(reply),
           ctx_->reqid_,
@@ -71,7 +73,8 @@ WriteBuffer::prepareTyped(
     Destructor destructor,
     const CompressionCodecMap* compressionCodecMap,
     const CodecIdRange& codecIdRange,
-    size_t tcpZeroCopyThreshold) {
+    size_t tcpZeroCopyThreshold,
+    size_t compressionOffloadThreshold) {
   assert(protocol_ == mc_caret_protocol);
   ctx_.emplace(std::move(ctx));
   assert(!destructor_.hasValue());
@@ -82,6 +85,7 @@ WriteBuffer::prepareTyped(
   typeId_ = static_cast<uint32_t>(Reply::typeId);
 
   caretReply_.setTCPZeroCopyThreshold(tcpZeroCopyThreshold);
+  caretReply_.setCompressionOffloadThreshold(compressionOffloadThreshold);
 
   return caretReply_.prepare(
       std::move(reply),
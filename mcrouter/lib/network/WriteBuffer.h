@@ -64,7 +64,8 @@ class WriteBuffer {
       Destructor destructor,
       const CompressionCodecMap* compressionCodecMap,
       const CodecIdRange& codecIdRange,
-      size_t tcpZeroCopyThreshold = 0);
+      size_t tcpZeroCopyThreshold = 0,
+      size_t compressionOffloadThreshold = 0);
 
   template <class Reply>
   typename std::enable_if<
@@ -78,7 +79,8 @@ class WriteBuffer {
       Destructor destructor,
       const CompressionCodecMap* compressionCodecMap,
       const CodecIdRange& codecIdRange,
-      size_t tcpZeroCopyThreshold = 0);
+      size_t tcpZeroCopyThreshold = 0,
+      size_t compressionOffloadThreshold = 0);
 
   const struct iovec* getIovsBegin() const {
     return iovsBegin_;
@@ -87,6 +89,17 @@ class WriteBuffer {
     return iovsCount_;
   }
 
+  /**
+   * @return  Total number of bytes referenced by this buffer's iovecs.
+   */
+  size_t getIovsTotalLen() const {
+    size_t len = 0;
+    for (size_t i = 0; i < iovsCount_; ++i) {
+      len += iovsBegin_[i].iov_len;
+    }
+    return len;
+  }
+
   /**
    * Checks if we should send a reply for this request.
    *
@@ -113,6 +126,14 @@ class WriteBuffer {
     return typeId_;
   }
 
+  /**
+   * @return  Id of the request replied to, as seen on the wire
+   *          (0 for ASCII, which has no request ids).
+   */
+  uint64_t reqId() const {
+    return protocol_ == mc_caret_protocol && ctx_ ? ctx_->reqid_ : 0;
+  }
+
   /* TCP Zero copy only supported for caret */
   bool shouldApplyZeroCopy() {
     if (protocol_ == mc_caret_protocol) {
@@ -173,19 +194,27 @@ class WriteBufferQueue {
     queue_.pushBack(std::move(wb));
   }
 
-  void pop(bool popBatch) {
+  /**
+   * @return  Total number of bytes in the popped buffers.
+   */
+  size_t pop(bool popBatch) {
     assert(tlFreeStack_ && "must have been initialized");
     bool done = false;
+    size_t bytes = 0;
     do {
       assert(!empty());
       if (tlFreeStack_->size() < kMaxFreeQueueSz) {
         auto& wb = tlFreeStack_->pushFront(queue_.popFront());
         done = wb.isEndOfBatch();
+        bytes += wb.getIovsTotalLen();
         wb.clear();
       } else {
-        done = queue_.popFront()->isEndOfBatch();
+        auto wb = queue_.popFront();
+        done = wb->isEndOfBatch();
+        bytes += wb->getIovsTotalLen();
       }
     } while (!done && popBatch);
+    return bytes;
   }
 
   bool empty() const noexcept {
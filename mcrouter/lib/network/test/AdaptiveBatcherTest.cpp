@@ -0,0 +1,99 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <gtest/gtest.h>
+
+#include "mcrouter/lib/network/AdaptiveBatcher.h"
+
+using namespace facebook::memcache;
+
+using std::chrono::microseconds;
+
+namespace {
+
+// Queues `num` requests, `gap` apart, starting at `start`.
+AdaptiveBatcher::Clock::time_point queueRequests(
+    AdaptiveBatcher& batcher,
+    AdaptiveBatcher::Clock::time_point start,
+    size_t num,
+    microseconds gap) {
+  auto now = start;
+  for (size_t i = 0; i < num; ++i) {
+    now += gap;
+    batcher.onRequestQueued(now);
+  }
+  return now;
+}
+
+} // anonymous namespace
+
+TEST(AdaptiveBatcher, disabled) {
+  AdaptiveBatcher batcher(microseconds(0), 32);
+  EXPECT_FALSE(batcher.enabled());
+
+  auto now = queueRequests(
+      batcher, AdaptiveBatcher::Clock::now(), 10, microseconds(1));
+  EXPECT_EQ(0, batcher.holdTime(now, 1, 100).count());
+  EXPECT_EQ(0, batcher.onFlush(now).count());
+}
+
+TEST(AdaptiveBatcher, flushWhenIdle) {
+  AdaptiveBatcher batcher(microseconds(100), 32);
+  auto now = queueRequests(
+      batcher, AdaptiveBatcher::Clock::now(), 10, microseconds(5));
+
+  // Nothing in flight: flush right away.
+  EXPECT_EQ(0, batcher.holdTime(now, 1, 0).count());
+  EXPECT_EQ(0, batcher.onFlush(now).count());
+}
+
+TEST(AdaptiveBatcher, flushWhenArrivalsAreSlow) {
+  AdaptiveBatcher batcher(microseconds(100), 32);
+  auto now = queueRequests(
+      batcher, AdaptiveBatcher::Clock::now(), 10, microseconds(500));
+
+  // Next request is not expected within the budget.
+  EXPECT_EQ(0, batcher.holdTime(now, 1, 10).count());
+}
+
+TEST(AdaptiveBatcher, holdUntilBatchIsFull) {
+  AdaptiveBatcher batcher(microseconds(100), 32);
+  auto now = queueRequests(
+      batcher, AdaptiveBatcher::Clock::now(), 10, microseconds(5));
+
+  // 4 in flight, 1 pending: wait for ~3 more requests.
+  EXPECT_EQ(15, batcher.holdTime(now, 1, 4).count());
+
+  // Batch as big as the in-flight depth: flush.
+  now = queueRequests(batcher, now, 3, microseconds(5));
+  EXPECT_EQ(0, batcher.holdTime(now, 4, 4).count());
+  EXPECT_EQ(15, batcher.onFlush(now).count());
+}
+
+TEST(AdaptiveBatcher, maxBatchSize) {
+  AdaptiveBatcher batcher(microseconds(100), 2);
+  auto now = queueRequests(
+      batcher, AdaptiveBatcher::Clock::now(), 10, microseconds(5));
+
+  EXPECT_EQ(5, batcher.holdTime(now, 1, 100).count());
+  EXPECT_EQ(0, batcher.holdTime(now, 2, 100).count());
+}
+
+TEST(AdaptiveBatcher, maxDelayIsAHardCap) {
+  AdaptiveBatcher batcher(microseconds(100), 32);
+  auto start = queueRequests(
+      batcher, AdaptiveBatcher::Clock::now(), 10, microseconds(20));
+
+  EXPECT_EQ(100, batcher.holdTime(start, 1, 100).count());
+  EXPECT_EQ(40, batcher.holdTime(start + microseconds(60), 3, 100).count());
+  EXPECT_EQ(0, batcher.holdTime(start + microseconds(100), 5, 100).count());
+  EXPECT_EQ(100, batcher.onFlush(start + microseconds(100)).count());
+
+  // A new batch gets a new budget.
+  EXPECT_EQ(
+      100, batcher.holdTime(start + microseconds(200), 1, 100).count());
+}
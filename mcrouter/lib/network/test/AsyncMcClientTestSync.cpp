@@ -617,6 +617,43 @@ TEST(AsyncMcClient, asciiSentTimeouts) {
   EXPECT_EQ(1, server->getAcceptedConns());
 }
 
+TEST(AsyncMcClient, sendWithCallback) {
+  TestServer::Config config;
+  config.outOfOrder = false;
+  config.useSsl = false;
+  auto server = TestServer::create(std::move(config));
+  TestClient client(
+      "localhost", server->getListenPort(), 200, mc_ascii_protocol);
+
+  // No fiber: replies come back from the EventBase loop.
+  folly::Optional<McGetReply> reply;
+  auto onReply = [&reply](McGetReply&& r, RpcStatsContext) {
+    reply = std::move(r);
+  };
+  McGetRequest req("test");
+  client.getClient().send(req, std::chrono::milliseconds(200), onReply);
+  EXPECT_FALSE(reply.hasValue());
+  while (!reply) {
+    client.loopOnce();
+  }
+  EXPECT_EQ(carbon::Result::FOUND, reply->result());
+  EXPECT_EQ("test", carbon::valueRangeSlow(*reply).str());
+
+  reply.clear();
+  McGetRequest holdReq("hold");
+  client.getClient().send(holdReq, std::chrono::milliseconds(200), onReply);
+  while (!reply) {
+    client.loopOnce();
+  }
+  EXPECT_EQ(carbon::Result::TIMEOUT, reply->result());
+
+  client.sendGet("flush", carbon::Result::FOUND);
+  client.sendGet("shutdown", carbon::Result::NOTFOUND);
+  client.waitForReplies();
+  server->join();
+  EXPECT_EQ(1, server->getAcceptedConns());
+}
+
 TEST(AsyncMcClient, asciiPendingTimeouts) {
   TestServer::Config config;
   config.outOfOrder = false;
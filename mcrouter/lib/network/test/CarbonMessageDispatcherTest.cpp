@@ -109,3 +109,46 @@ TEST(CarbonMessage, basic) {
   EXPECT_TRUE(ret);
   EXPECT_TRUE(getCalled);
 }
+
+TEST(CarbonMessage, timeout) {
+  McGetRequest get;
+  get.key() = folly::IOBuf(folly::IOBuf::COPY_BUFFER, "12345");
+
+  carbon::CarbonQueueAppenderStorage storage;
+  carbon::CarbonProtocolWriter writer(storage);
+  get.serialize(writer);
+
+  folly::IOBuf body(folly::IOBuf::CREATE, storage.computeBodySize());
+  const auto iovs = storage.getIovecs();
+  for (size_t i = 0; i < iovs.second; ++i) {
+    const struct iovec* iov = iovs.first + i;
+    std::memcpy(body.writableTail(), iov->iov_base, iov->iov_len);
+    body.append(iov->iov_len);
+  }
+
+  CaretMessageInfo headerInfo;
+  headerInfo.typeId = 1;
+  headerInfo.bodySize = storage.computeBodySize();
+  headerInfo.timeoutMs = 250;
+
+  folly::IOBuf requestBuf(folly::IOBuf::CREATE, 1024);
+  headerInfo.headerSize = caretPrepareHeader(
+      headerInfo, reinterpret_cast<char*>(requestBuf.writableTail()));
+  requestBuf.append(headerInfo.headerSize);
+  requestBuf.appendChain(body.clone());
+
+  CaretMessageInfo parsedInfo;
+  ASSERT_EQ(
+      ParseStatus::Ok,
+      caretParseHeader(
+          requestBuf.data(), requestBuf.length(), parsedInfo));
+  EXPECT_EQ(headerInfo.headerSize, parsedInfo.headerSize);
+  EXPECT_EQ(250, parsedInfo.timeoutMs);
+
+  uint64_t timeoutMs = 0;
+  TestCallback cb(
+      [&timeoutMs](McGetRequest&& req) { timeoutMs = req.timeoutMs(); },
+      [](McSetRequest&&) {});
+  EXPECT_TRUE(cb.dispatchTypedRequest(parsedInfo, requestBuf));
+  EXPECT_EQ(250, timeoutMs);
+}
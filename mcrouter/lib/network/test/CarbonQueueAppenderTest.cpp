@@ -205,3 +205,34 @@ TEST(CarbonQueueAppender, manyFields) {
   EXPECT_STREQ(str1, reinterpret_cast<const char*>(manyFields2.buf39().data()));
   EXPECT_STREQ(str2, reinterpret_cast<const char*>(manyFields2.buf40().data()));
 }
+
+TEST(CarbonQueueAppender, reserve) {
+  carbon::CarbonQueueAppenderStorage storage;
+  const std::string a(600, 'a');
+  const std::string b(600, 'b');
+  const auto c = folly::IOBuf::copyBuffer(std::string(600, 'c'));
+
+  // None of these fit in the inline storage, they are all copied one after
+  // the other into the reserved buffer.
+  storage.reserve(2000);
+  storage.push(reinterpret_cast<const uint8_t*>(a.data()), a.size());
+  storage.push(reinterpret_cast<const uint8_t*>(b.data()), b.size());
+  storage.append(*c);
+  // Doesn't fit anymore.
+  storage.push(reinterpret_cast<const uint8_t*>(a.data()), a.size());
+
+  EXPECT_EQ(2400, storage.computeBodySize());
+  // The reserved buffer, then a copy of the last push. No header was set.
+  const auto iovs = storage.getIovecs();
+  ASSERT_EQ(2, iovs.second);
+  EXPECT_EQ(
+      a + b + std::string(600, 'c'),
+      std::string(
+          static_cast<const char*>(iovs.first[0].iov_base),
+          iovs.first[0].iov_len));
+  EXPECT_EQ(
+      a,
+      std::string(
+          static_cast<const char*>(iovs.first[1].iov_base),
+          iovs.first[1].iov_len));
+}
@@ -0,0 +1,170 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <sys/uio.h>
+
+#include <cstring>
+#include <string>
+#include <utility>
+
+#include <folly/Benchmark.h>
+#include <folly/init/Init.h>
+#include <folly/io/Cursor.h>
+#include <folly/io/IOBuf.h>
+
+#include "mcrouter/lib/carbon/CarbonProtocolReader.h"
+#include "mcrouter/lib/carbon/CarbonProtocolWriter.h"
+#include "mcrouter/lib/carbon/CarbonQueueAppender.h"
+#include "mcrouter/lib/carbon/CarbonStraightLineSerializers.h"
+#include "mcrouter/lib/network/CarbonMessageDispatcher.h"
+#include "mcrouter/lib/network/gen/MemcacheMessages.h"
+
+/**
+ * Serialize and parse throughput of hot Carbon messages.
+ *
+ * serializeGeneric uses the field by field serializer, serializeStraightLine
+ * and parse the straight-line (de)serializers used by the caret protocol.
+ */
+
+using namespace facebook::memcache;
+
+namespace {
+
+constexpr folly::StringPiece kKey =
+    "/region/cluster/someKey_ABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789";
+
+McGetRequest makeMcGetRequest(size_t /* valueSize */) {
+  McGetRequest req(kKey);
+  req.flags() = 0x10;
+  return req;
+}
+
+McGetReply makeMcGetReply(size_t valueSize) {
+  McGetReply reply(carbon::Result::FOUND);
+  reply.value() = folly::IOBuf(
+      folly::IOBuf::COPY_BUFFER, std::string(valueSize, 'v'));
+  reply.flags() = 0x10;
+  return reply;
+}
+
+McSetRequest makeMcSetRequest(size_t valueSize) {
+  McSetRequest req(kKey);
+  req.exptime() = 3600;
+  req.flags() = 0x10;
+  req.value() = folly::IOBuf(
+      folly::IOBuf::COPY_BUFFER, std::string(valueSize, 'v'));
+  return req;
+}
+
+McSetReply makeMcSetReply(size_t /* valueSize */) {
+  return McSetReply(carbon::Result::STORED);
+}
+
+McDeleteRequest makeMcDeleteRequest(size_t /* valueSize */) {
+  McDeleteRequest req(kKey);
+  req.exptime() = 10;
+  return req;
+}
+
+McDeleteReply makeMcDeleteReply(size_t /* valueSize */) {
+  return McDeleteReply(carbon::Result::DELETED);
+}
+
+template <class Message>
+void serializeGeneric(
+    size_t iters,
+    Message (*make)(size_t),
+    size_t valueSize) {
+  Message msg;
+  BENCHMARK_SUSPEND {
+    msg = make(valueSize);
+  }
+  for (size_t i = 0; i < iters; ++i) {
+    carbon::CarbonQueueAppenderStorage storage;
+    carbon::CarbonProtocolWriter writer(storage);
+    msg.serialize(writer);
+    folly::doNotOptimizeAway(storage.getIovecs());
+  }
+}
+
+template <class Message>
+void serializeStraightLine(
+    size_t iters,
+    Message (*make)(size_t),
+    size_t valueSize) {
+  Message msg;
+  BENCHMARK_SUSPEND {
+    msg = make(valueSize);
+  }
+  for (size_t i = 0; i < iters; ++i) {
+    carbon::CarbonQueueAppenderStorage storage;
+    serializeCarbonStruct(msg, storage);
+    folly::doNotOptimizeAway(storage.getIovecs());
+  }
+}
+
+template <class Message>
+void parse(size_t iters, Message (*make)(size_t), size_t valueSize) {
+  folly::IOBuf buf;
+  BENCHMARK_SUSPEND {
+    const auto msg = make(valueSize);
+    carbon::CarbonQueueAppenderStorage storage;
+    carbon::CarbonProtocolWriter writer(storage);
+    carbon::serializeMessage(msg, writer);
+    buf = folly::IOBuf(
+        folly::IOBuf::CREATE, carbon::serializedSizeUpperBound(msg));
+    const auto iovs = storage.getIovecs();
+    for (size_t i = 0; i < iovs.second; ++i) {
+      const struct iovec* iov = iovs.first + i;
+      std::memcpy(buf.writableTail(), iov->iov_base, iov->iov_len);
+      buf.append(iov->iov_len);
+    }
+  }
+  for (size_t i = 0; i < iters; ++i) {
+    carbon::CarbonProtocolReader reader(folly::io::Cursor(&buf));
+    Message msg;
+    carbon::deserializeMessage(msg, reader);
+    folly::doNotOptimizeAway(msg);
+  }
+}
+
+} // anonymous namespace
+
+// The message type is deduced from make##Message.
+#define CARBON_SERIALIZATION_BENCHMARKS(Message, valueSize) \
+  BENCHMARK_NAMED_PARAM(                                    \
+      serializeGeneric,                                     \
+      Message##_##valueSize,                                \
+      make##Message,                                        \
+      valueSize)                                            \
+  BENCHMARK_RELATIVE_NAMED_PARAM(                           \
+      serializeStraightLine,                                \
+      Message##_##valueSize,                                \
+      make##Message,                                        \
+      valueSize)                                            \
+  BENCHMARK_NAMED_PARAM(                                    \
+      parse,                                                \
+      Message##_##valueSize,                                \
+      make##Message,                                        \
+      valueSize)                                            \
+  BENCHMARK_DRAW_LINE();
+
+CARBON_SERIALIZATION_BENCHMARKS(McGetRequest, 0)
+CARBON_SERIALIZATION_BENCHMARKS(McGetReply, 100)
+CARBON_SERIALIZATION_BENCHMARKS(McGetReply, 10000)
+CARBON_SERIALIZATION_BENCHMARKS(McSetRequest, 100)
+CARBON_SERIALIZATION_BENCHMARKS(McSetRequest, 10000)
+CARBON_SERIALIZATION_BENCHMARKS(McSetReply, 0)
+CARBON_SERIALIZATION_BENCHMARKS(McDeleteRequest, 0)
+CARBON_SERIALIZATION_BENCHMARKS(McDeleteReply, 0)
+
+int main(int argc, char** argv) {
+  folly::init(&argc, &argv, true);
+
+  folly::runBenchmarks();
+  return 0;
+}
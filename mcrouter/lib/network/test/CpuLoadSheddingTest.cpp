@@ -0,0 +1,39 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <gtest/gtest.h>
+
+#include "mcrouter/lib/network/CpuLoadShedding.h"
+#include "mcrouter/lib/network/gen/MemcacheMessages.h"
+
+using namespace facebook::memcache;
+
+TEST(CpuLoadShedding, belowTarget) {
+  EXPECT_DOUBLE_EQ(0.0, cpuShedProbability(50, 80, 10, 10));
+  EXPECT_DOUBLE_EQ(0.0, cpuShedProbability(80, 80, 10, 10));
+}
+
+TEST(CpuLoadShedding, growsWithCpu) {
+  EXPECT_DOUBLE_EQ(0.5, cpuShedProbability(90, 80, 10, 10));
+  EXPECT_DOUBLE_EQ(1.0, cpuShedProbability(100, 80, 10, 10));
+}
+
+TEST(CpuLoadShedding, fairness) {
+  // Heavier than average connections get the full probability.
+  EXPECT_DOUBLE_EQ(0.5, cpuShedProbability(90, 80, 40, 10));
+  // Lighter ones proportionally less.
+  EXPECT_DOUBLE_EQ(0.25, cpuShedProbability(90, 80, 5, 10));
+  // Idle connections are never shed.
+  EXPECT_DOUBLE_EQ(0.0, cpuShedProbability(100, 80, 0, 10));
+}
+
+TEST(CpuLoadShedding, sheddable) {
+  EXPECT_TRUE(IsCpuSheddable<McGetRequest>::value);
+  EXPECT_TRUE(IsCpuSheddable<McSetRequest>::value);
+  EXPECT_FALSE(IsCpuSheddable<McVersionRequest>::value);
+  EXPECT_FALSE(IsCpuSheddable<McStatsRequest>::value);
+}
@@ -0,0 +1,81 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "mcrouter/lib/network/FdPassing.h"
+
+using namespace facebook::memcache;
+
+namespace {
+
+struct SocketPair {
+  int fds[2];
+
+  SocketPair() {
+    EXPECT_EQ(0, ::socketpair(AF_UNIX, SOCK_STREAM, 0, fds));
+  }
+  ~SocketPair() {
+    ::close(fds[0]);
+    ::close(fds[1]);
+  }
+};
+
+} // namespace
+
+TEST(FdPassing, PassFdsAndPayload) {
+  SocketPair channel;
+  int pipes[2][2];
+  ASSERT_EQ(0, ::pipe(pipes[0]));
+  ASSERT_EQ(0, ::pipe(pipes[1]));
+
+  // fits in the socket buffer, since nothing reads while sending
+  std::string payload(16 * 1024, 'x');
+  payload[1234] = 'y';
+  sendFds(channel.fds[0], {pipes[0][1], pipes[1][1]}, payload);
+  ::close(pipes[0][1]);
+  ::close(pipes[1][1]);
+
+  std::string received;
+  auto fds = receiveFds(channel.fds[1], received);
+  EXPECT_EQ(payload, received);
+  ASSERT_EQ(2, fds.size());
+  EXPECT_TRUE(::fcntl(fds[0], F_GETFD) & FD_CLOEXEC);
+
+  // received fds are the write ends of the pipes, in order
+  for (size_t i = 0; i < 2; ++i) {
+    char c = 'a' + i;
+    ASSERT_EQ(1, ::write(fds[i], &c, 1));
+    char read = 0;
+    ASSERT_EQ(1, ::read(pipes[i][0], &read, 1));
+    EXPECT_EQ(c, read);
+    ::close(fds[i]);
+    ::close(pipes[i][0]);
+  }
+}
+
+TEST(FdPassing, NoFds) {
+  SocketPair channel;
+  sendFds(channel.fds[0], {}, "payload");
+  std::string received;
+  EXPECT_TRUE(receiveFds(channel.fds[1], received).empty());
+  EXPECT_EQ("payload", received);
+}
+
+TEST(FdPassing, PeerClosed) {
+  SocketPair channel;
+  ::shutdown(channel.fds[0], SHUT_WR);
+  std::string received;
+  EXPECT_THROW(receiveFds(channel.fds[1], received), std::runtime_error);
+}
@@ -0,0 +1,189 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include <folly/io/async/AsyncSocket.h>
+#include <folly/io/async/EventBase.h>
+
+#include "mcrouter/lib/network/AsyncMcServerWorker.h"
+#include "mcrouter/lib/network/AsyncMcServerWorkerOptions.h"
+#include "mcrouter/lib/network/IoUringUtil.h"
+#include "mcrouter/lib/network/McServerSession.h"
+#include "mcrouter/lib/network/gen/MemcacheServer.h"
+
+using namespace facebook::memcache;
+
+namespace {
+
+struct SocketPair {
+  int fds[2];
+
+  SocketPair() {
+    EXPECT_EQ(0, ::socketpair(AF_UNIX, SOCK_STREAM, 0, fds));
+  }
+  ~SocketPair() {
+    if (fds[0] >= 0) {
+      ::close(fds[0]);
+    }
+    ::close(fds[1]);
+  }
+};
+
+class WriteCallback : public folly::AsyncWriter::WriteCallback {
+ public:
+  bool done{false};
+  bool failed{false};
+
+  void writeSuccess() noexcept override {
+    done = true;
+  }
+  void writeErr(size_t, const folly::AsyncSocketException&) noexcept
+      override {
+    done = true;
+    failed = true;
+  }
+};
+
+class ReadCallback : public folly::AsyncReader::ReadCallback {
+ public:
+  explicit ReadCallback(size_t expected) : expected_(expected) {}
+
+  std::string data;
+  bool failed{false};
+
+  void getReadBuffer(void** bufReturn, size_t* lenReturn) override {
+    *bufReturn = buf_;
+    *lenReturn = sizeof(buf_);
+  }
+  void readDataAvailable(size_t len) noexcept override {
+    data.append(buf_, len);
+  }
+  void readEOF() noexcept override {}
+  void readErr(const folly::AsyncSocketException&) noexcept override {
+    failed = true;
+  }
+
+  bool done() const {
+    return failed || data.size() >= expected_;
+  }
+
+ private:
+  const size_t expected_;
+  char buf_[1024];
+};
+
+folly::AsyncTransportWrapper::UniquePtr wrap(folly::EventBase& evb, int& fd) {
+  folly::AsyncTransportWrapper::UniquePtr transport(
+      new folly::AsyncSocket(&evb, folly::NetworkSocket::fromFd(fd)));
+  // The transport owns the fd now.
+  fd = -1;
+  return transport;
+}
+
+struct NoOpOnRequest {
+  template <class Request>
+  void onRequest(McServerRequestContext&&, Request&&) {}
+};
+
+/**
+ * @return  true if a worker with the given options moved an accepted
+ *          connection to an io_uring socket.
+ */
+bool acceptedOnIoUring(AsyncMcServerWorkerOptions opts) {
+  auto evb = IoUringUtil::createEventBase(false);
+  AsyncMcServerWorker worker(std::move(opts), *evb);
+  worker.setOnRequest(MemcacheRequestHandler<NoOpOnRequest>());
+  bool onIoUring = false;
+  worker.setOnConnectionAccepted([&](McServerSession& session) {
+    onIoUring = !dynamic_cast<const folly::AsyncSocket*>(
+        session.getTransport());
+  });
+
+  SocketPair sockets;
+  EXPECT_TRUE(worker.addClientSocket(sockets.fds[0]));
+  // The worker owns the fd now.
+  sockets.fds[0] = -1;
+  worker.shutdown();
+  evb->loop();
+  return onIoUring;
+}
+
+} // anonymous namespace
+
+TEST(IoUringUtil, epollFallback) {
+  folly::EventBase evb;
+  EXPECT_FALSE(IoUringUtil::supportsIoUringSockets(evb));
+
+  SocketPair sockets;
+  auto transport = wrap(evb, sockets.fds[0]);
+  auto original = transport.get();
+  EXPECT_FALSE(IoUringUtil::moveToIoUring(transport));
+  EXPECT_EQ(original, transport.get());
+}
+
+TEST(IoUringUtil, submitAndComplete) {
+  auto evb = IoUringUtil::createEventBase(false);
+  if (!IoUringUtil::isAvailable()) {
+    // Built without liburing, or the kernel doesn't support io_uring.
+    EXPECT_EQ(nullptr, evb);
+    return;
+  }
+  ASSERT_NE(nullptr, evb);
+  ASSERT_TRUE(IoUringUtil::supportsIoUringSockets(*evb));
+
+  SocketPair sockets;
+  auto transport = wrap(*evb, sockets.fds[0]);
+  ASSERT_TRUE(IoUringUtil::moveToIoUring(transport));
+  ASSERT_NE(nullptr, transport);
+
+  // Write: submitted as an SQE, completed by the loop.
+  const std::string request = "get key\r\n";
+  WriteCallback writeCallback;
+  transport->write(&writeCallback, request.data(), request.size());
+  while (!writeCallback.done) {
+    evb->loopOnce();
+  }
+  EXPECT_FALSE(writeCallback.failed);
+  std::string received(request.size(), '\0');
+  ASSERT_EQ(
+      request.size(),
+      ::read(sockets.fds[1], &received[0], received.size()));
+  EXPECT_EQ(request, received);
+
+  // Read: lands in the buffer handed out by the read callback.
+  const std::string reply = "END\r\n";
+  ReadCallback readCallback(reply.size());
+  transport->setReadCB(&readCallback);
+  ASSERT_EQ(reply.size(), ::write(sockets.fds[1], reply.data(), reply.size()));
+  while (!readCallback.done()) {
+    evb->loopOnce();
+  }
+  EXPECT_FALSE(readCallback.failed);
+  EXPECT_EQ(reply, readCallback.data);
+
+  transport->setReadCB(nullptr);
+  transport.reset();
+}
+
+TEST(IoUringUtil, serverZeroCopy) {
+  if (!IoUringUtil::isAvailable()) {
+    return;
+  }
+  AsyncMcServerWorkerOptions opts;
+  opts.useIoUring = true;
+  EXPECT_TRUE(acceptedOnIoUring(opts));
+
+  // Zero copy writes need an AsyncSocket: io_uring is not used.
+  opts.tcpZeroCopyThresholdBytes = 1024;
+  EXPECT_FALSE(acceptedOnIoUring(opts));
+}
@@ -0,0 +1,91 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <memory>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "mcrouter/lib/network/ReplyReorderRing.h"
+
+using namespace facebook::memcache;
+
+namespace {
+
+std::unique_ptr<WriteBuffer> makeBuffer() {
+  return std::make_unique<WriteBuffer>(mc_ascii_protocol);
+}
+
+} // anonymous namespace
+
+TEST(ReplyReorderRing, takeInOrder) {
+  ReplyReorderRing ring;
+  std::vector<WriteBuffer*> buffers;
+  for (uint64_t id = 1; id <= 5; ++id) {
+    auto wb = makeBuffer();
+    buffers.push_back(wb.get());
+    ring.put(id, 0, std::move(wb));
+  }
+  EXPECT_EQ(5, ring.size());
+
+  std::unique_ptr<WriteBuffer> wb;
+  EXPECT_FALSE(ring.take(0, wb));
+  for (uint64_t id = 1; id <= 5; ++id) {
+    ASSERT_TRUE(ring.take(id, wb));
+    EXPECT_EQ(buffers[id - 1], wb.get());
+  }
+  EXPECT_FALSE(ring.take(6, wb));
+  EXPECT_TRUE(ring.empty());
+}
+
+TEST(ReplyReorderRing, nullReplies) {
+  ReplyReorderRing ring;
+  ring.put(2, 1, nullptr);
+
+  std::unique_ptr<WriteBuffer> wb = makeBuffer();
+  EXPECT_FALSE(ring.take(1, wb));
+  ASSERT_TRUE(ring.take(2, wb));
+  EXPECT_EQ(nullptr, wb);
+}
+
+TEST(ReplyReorderRing, grow) {
+  ReplyReorderRing ring;
+  std::vector<WriteBuffer*> buffers(1000);
+
+  // Head stays at 100 while replies far ahead of it complete in reverse.
+  for (uint64_t id = 1099; id > 100; --id) {
+    auto wb = makeBuffer();
+    buffers[id - 100] = wb.get();
+    ring.put(id, 100, std::move(wb));
+  }
+  EXPECT_EQ(999, ring.size());
+
+  std::unique_ptr<WriteBuffer> wb;
+  for (uint64_t id = 101; id < 1100; ++id) {
+    ASSERT_TRUE(ring.take(id, wb));
+    EXPECT_EQ(buffers[id - 100], wb.get());
+  }
+  EXPECT_TRUE(ring.empty());
+}
+
+TEST(ReplyReorderRing, wrapAround) {
+  ReplyReorderRing ring;
+  std::unique_ptr<WriteBuffer> wb;
+
+  // Keep a sliding window of outstanding replies moving far past the
+  // initial capacity, the ring should not need to grow.
+  uint64_t head = 0;
+  for (uint64_t id = 1; id < 10000; ++id) {
+    ring.put(id, head, makeBuffer());
+    if (id % 4 == 0) {
+      while (ring.take(head + 1, wb)) {
+        ++head;
+      }
+      EXPECT_EQ(id, head);
+    }
+  }
+}
@@ -189,3 +189,60 @@ TEST(Session, invalidSocketAdd) {
 
   worker.addClientSocket(invalidFd);
 }
+
+TEST(Session, queuedReplyBytesWatermarks) {
+  // Every "get keyN" reply is 34 bytes.
+  const std::string reply1 = "VALUE key1 0 10\r\nkey1_value\r\nEND\r\n";
+  ASSERT_EQ(34, reply1.size());
+
+  AsyncMcServerWorkerOptions opts;
+  opts.queuedReplyBytesHighWatermark = 100;
+  opts.queuedReplyBytesLowWatermark = 40;
+  SessionTestHarness t(opts);
+
+  t.pause();
+  t.inputPackets(
+      "get key1\r\n",
+      "get key2\r\n",
+      "get key3\r\n",
+      "get key4\r\n",
+      "get key5\r\n");
+
+  /* Replies after the first one are parked until key1 is replied */
+  t.replyTo("key2");
+  t.replyTo("key4");
+  EXPECT_EQ(68, t.session().queuedReplyBytes());
+  EXPECT_EQ(0, t.session().numQueuedReplyBytesPauses());
+
+  /* Reaching the high watermark stops reading */
+  t.replyTo("key5");
+  EXPECT_EQ(102, t.session().queuedReplyBytes());
+  EXPECT_EQ(1, t.session().numQueuedReplyBytesPauses());
+  t.inputPackets("get key6\r\n");
+  EXPECT_EQ(vector<string>({"key1", "key3"}), t.pausedKeys());
+
+  /* Writing key1 and key2 isn't enough to get to the low watermark */
+  t.replyTo("key1");
+  EXPECT_EQ(68, t.session().queuedReplyBytes());
+  EXPECT_EQ(vector<string>({"key3"}), t.pausedKeys());
+
+  /* Now everything is written, reading resumes */
+  t.replyTo("key3");
+  EXPECT_EQ(0, t.session().queuedReplyBytes());
+  EXPECT_EQ(vector<string>({"key6"}), t.pausedKeys());
+  EXPECT_EQ(1, t.session().numQueuedReplyBytesPauses());
+
+  string output;
+  for (const auto& write : t.flushWrites()) {
+    output += write;
+  }
+  EXPECT_EQ(
+      reply1 + "VALUE key2 0 10\r\nkey2_value\r\nEND\r\n" +
+          "VALUE key3 0 10\r\nkey3_value\r\nEND\r\n" +
+          "VALUE key4 0 10\r\nkey4_value\r\nEND\r\n" +
+          "VALUE key5 0 10\r\nkey5_value\r\nEND\r\n",
+      output);
+
+  t.resume();
+  t.closeSession();
+}
@@ -110,6 +110,29 @@ class SessionTestHarness {
     flushSavedInputs();
   }
 
+  /**
+   * Reply to the accumulated request with the given key, ahead of the
+   * requests before it.
+   */
+  void replyTo(folly::StringPiece key) {
+    for (auto it = transactions_.begin(); it != transactions_.end(); ++it) {
+      if ((*it)->key() == key) {
+        auto t = std::move(*it);
+        transactions_.erase(it);
+        t->reply();
+        break;
+      }
+    }
+
+    /* flush writes on the socket */
+    eventBase_.loopOnce();
+    flushSavedInputs();
+  }
+
+  McServerSession& session() {
+    return session_;
+  }
+
   /**
    * Initiate session close
    */
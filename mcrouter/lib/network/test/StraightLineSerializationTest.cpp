@@ -0,0 +1,198 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <sys/uio.h>
+
+#include <string>
+#include <utility>
+
+#include <gtest/gtest.h>
+
+#include <folly/io/Cursor.h>
+#include <folly/io/IOBuf.h>
+
+#include "mcrouter/lib/carbon/CarbonProtocolReader.h"
+#include "mcrouter/lib/carbon/CarbonProtocolWriter.h"
+#include "mcrouter/lib/carbon/CarbonQueueAppender.h"
+#include "mcrouter/lib/carbon/CarbonStraightLineSerializers.h"
+#include "mcrouter/lib/network/gen/MemcacheMessages.h"
+
+using namespace facebook::memcache;
+
+namespace {
+
+std::string toString(carbon::CarbonQueueAppenderStorage& storage) {
+  std::string out;
+  const auto iovs = storage.getIovecs();
+  for (size_t i = 0; i < iovs.second; ++i) {
+    const struct iovec* iov = iovs.first + i;
+    out.append(static_cast<const char*>(iov->iov_base), iov->iov_len);
+  }
+  return out;
+}
+
+template <class Message>
+std::string serializeStraightLine(const Message& msg) {
+  carbon::CarbonQueueAppenderStorage storage;
+  carbon::CarbonProtocolWriter writer(storage);
+  carbon::serializeMessage(msg, writer);
+  EXPECT_LE(storage.computeBodySize(), carbon::serializedSizeUpperBound(msg));
+  return toString(storage);
+}
+
+template <class Message>
+std::string serializeGeneric(const Message& msg) {
+  carbon::CarbonQueueAppenderStorage storage;
+  carbon::CarbonProtocolWriter writer(storage);
+  msg.serialize(writer);
+  return toString(storage);
+}
+
+template <class Message>
+Message deserialize(const std::string& data) {
+  auto buf = folly::IOBuf::copyBuffer(data);
+  carbon::CarbonProtocolReader reader(folly::io::Cursor(buf.get()));
+  Message msg;
+  carbon::deserializeMessage(msg, reader);
+  EXPECT_TRUE(reader.cursor().isAtEnd());
+  return msg;
+}
+
+template <class Message>
+Message roundTrip(const Message& msg) {
+  const auto data = serializeStraightLine(msg);
+  EXPECT_EQ(serializeGeneric(msg), data);
+  return deserialize<Message>(data);
+}
+
+std::string toString(const folly::IOBuf& buf) {
+  return buf.cloneAsValue().moveToFbString().toStdString();
+}
+
+} // anonymous namespace
+
+TEST(StraightLineSerialization, getRequest) {
+  McGetRequest empty;
+  EXPECT_EQ("", toString(roundTrip(empty).key().raw()));
+
+  McGetRequest req("/region/cluster/abc");
+  req.flags() = 0x1234567890;
+  const auto res = roundTrip(req);
+  EXPECT_EQ("/region/cluster/abc", res.key().fullKey().str());
+  EXPECT_EQ("abc", res.key().keyWithoutRoute().str());
+  EXPECT_EQ(0x1234567890UL, res.flags());
+}
+
+TEST(StraightLineSerialization, getReply) {
+  McGetReply reply(carbon::Result::FOUND);
+  reply.value() = folly::IOBuf(folly::IOBuf::COPY_BUFFER, "value");
+  reply.flags() = 17;
+  reply.appSpecificErrorCode() = -3;
+  auto res = roundTrip(reply);
+  EXPECT_EQ(carbon::Result::FOUND, res.result());
+  ASSERT_TRUE(res.value().has_value());
+  EXPECT_EQ("value", toString(*res.value()));
+  EXPECT_EQ(17, res.flags());
+  EXPECT_EQ(-3, res.appSpecificErrorCode());
+
+  // An empty value is still serialized, since the field is optional.
+  McGetReply emptyValue(carbon::Result::FOUND);
+  emptyValue.value() = folly::IOBuf();
+  res = roundTrip(emptyValue);
+  EXPECT_TRUE(res.value().has_value());
+
+  McGetReply miss(carbon::Result::NOTFOUND);
+  miss.message() = std::string(1024, 'm');
+  res = roundTrip(miss);
+  EXPECT_EQ(carbon::Result::NOTFOUND, res.result());
+  EXPECT_FALSE(res.value().has_value());
+  EXPECT_EQ(std::string(1024, 'm'), res.message());
+}
+
+TEST(StraightLineSerialization, setRequest) {
+  McSetRequest req("key");
+  req.exptime() = -1;
+  req.flags() = 1;
+  // Chained value, larger than the inline storage of the writer.
+  auto value = folly::IOBuf::copyBuffer(std::string(300, 'a'));
+  value->prependChain(folly::IOBuf::copyBuffer(std::string(300, 'b')));
+  req.value() = std::move(*value);
+  const auto res = roundTrip(req);
+  EXPECT_EQ("key", res.key().fullKey().str());
+  EXPECT_EQ(-1, res.exptime());
+  EXPECT_EQ(1, res.flags());
+  EXPECT_EQ(
+      std::string(300, 'a') + std::string(300, 'b'), toString(res.value()));
+}
+
+TEST(StraightLineSerialization, setReply) {
+  McSetReply reply(carbon::Result::STORED);
+  reply.flags() = 5;
+  const auto res = roundTrip(reply);
+  EXPECT_EQ(carbon::Result::STORED, res.result());
+  EXPECT_EQ(5, res.flags());
+  EXPECT_TRUE(res.value().empty());
+  EXPECT_TRUE(res.message().empty());
+}
+
+TEST(StraightLineSerialization, deleteRequest) {
+  McDeleteRequest req("key");
+  req.exptime() = 10;
+  req.attributes()["a"] = 1;
+  req.attributes()["bb"] = 0xffffffffffffffff;
+  const auto res = roundTrip(req);
+  EXPECT_EQ("key", res.key().fullKey().str());
+  EXPECT_EQ(10, res.exptime());
+  EXPECT_EQ(0, res.flags());
+  EXPECT_EQ(req.attributes(), res.attributes());
+}
+
+TEST(StraightLineSerialization, deleteReply) {
+  McDeleteReply reply(carbon::Result::DELETED);
+  reply.message() = "message";
+  const auto res = roundTrip(reply);
+  EXPECT_EQ(carbon::Result::DELETED, res.result());
+  EXPECT_EQ("message", res.message());
+}
+
+TEST(StraightLineSerialization, outOfOrderAndUnknownFields) {
+  // Fields out of the declared order, or unknown to the reader, fall back to
+  // dispatching on the field id.
+  carbon::CarbonQueueAppenderStorage storage;
+  carbon::CarbonProtocolWriter writer(storage);
+  writer.writeStructBegin();
+  writer.writeField(3 /* field id */, static_cast<uint64_t>(7) /* flags */);
+  writer.writeField(4 /* field id */, std::string("value"));
+  writer.writeField(1 /* field id */, std::string("key"));
+  writer.writeField(100 /* field id */, static_cast<int32_t>(1));
+  writer.writeField(2 /* field id */, static_cast<int32_t>(60) /* exptime */);
+  writer.writeFieldStop();
+  writer.writeStructEnd();
+
+  const auto res = deserialize<McSetRequest>(toString(storage));
+  EXPECT_EQ("key", res.key().fullKey().str());
+  EXPECT_EQ(60, res.exptime());
+  EXPECT_EQ(7, res.flags());
+  EXPECT_EQ("value", toString(res.value()));
+}
+
+TEST(StraightLineSerialization, varintAcrossBuffers) {
+  McGetRequest req("key");
+  req.flags() = 0xffffffffffffffff;
+  const auto data = serializeStraightLine(req);
+
+  // Split the message in one byte buffers, so that no varint is contiguous.
+  auto buf = folly::IOBuf::copyBuffer(data.data(), 1);
+  for (size_t i = 1; i < data.size(); ++i) {
+    buf->prependChain(folly::IOBuf::copyBuffer(data.data() + i, 1));
+  }
+  carbon::CarbonProtocolReader reader(folly::io::Cursor(buf.get()));
+  McGetRequest res;
+  carbon::deserializeMessage(res, reader);
+  EXPECT_EQ("key", res.key().fullKey().str());
+  EXPECT_EQ(0xffffffffffffffff, res.flags());
+}
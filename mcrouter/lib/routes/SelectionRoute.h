@@ -112,6 +112,18 @@ class SelectionRoute {
   bool traverse(
       const Request& req,
       const RouteHandleTraverser<RouteHandleIf>& t) const {
+    if (shadowChildren_.empty()) {
+      // route() only sends the request to the selected child.
+      if (UNLIKELY(t.options().getForwardAll())) {
+        for (const auto& child : children_) {
+          if (t.forward(*child, req)) {
+            return true;
+          }
+        }
+        return false;
+      }
+      return t.forward(select(req), req);
+    }
     if (t(select(req), req)) {
       return true;
     }
@@ -166,7 +178,11 @@ class SelectionRoute {
     if (idx >= children_.size()) {
       return *outOfRangeDestination_;
     }
-    mcrouter::fiber_local<RouterInfo>::setSelectedIndex(idx);
+    // Requests may be routed to their destination from the main context
+    // (see ProxyRoute::directTarget()), where fiber locals are thread locals.
+    if (folly::fibers::onFiber()) {
+      mcrouter::fiber_local<RouterInfo>::setSelectedIndex(idx);
+    }
     return *children_[idx];
   }
 
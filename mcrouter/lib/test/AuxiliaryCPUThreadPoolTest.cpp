@@ -0,0 +1,105 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <stdexcept>
+#include <thread>
+
+#include <gtest/gtest.h>
+
+#include <folly/fibers/FiberManagerMap.h>
+#include <folly/io/async/EventBase.h>
+#include <folly/synchronization/Baton.h>
+
+#include "mcrouter/lib/AuxiliaryCPUThreadPool.h"
+
+using namespace facebook::memcache::mcrouter;
+
+namespace {
+
+template <class F>
+void runInFiber(F&& func) {
+  folly::EventBase evb;
+  auto& fm = folly::fibers::getFiberManager(evb);
+  fm.addTask(std::forward<F>(func));
+  evb.loop();
+}
+
+} // anonymous namespace
+
+TEST(AuxiliaryCPUThreadPool, runOnFiber) {
+  AuxiliaryCPUThreadPool pool;
+  const auto evbThread = std::this_thread::get_id();
+  runInFiber([&] {
+    const auto poolThread =
+        pool.run([] { return std::this_thread::get_id(); });
+    EXPECT_NE(evbThread, poolThread);
+  });
+
+  const auto stats = pool.getStats();
+  EXPECT_EQ(0, stats.queueDepth);
+  EXPECT_EQ(1, stats.offloaded);
+  EXPECT_EQ(0, stats.inlineFallbacks);
+  EXPECT_EQ(0, stats.inlineNotOnFiber);
+}
+
+TEST(AuxiliaryCPUThreadPool, runPropagatesExceptions) {
+  AuxiliaryCPUThreadPool pool;
+  runInFiber([&] {
+    EXPECT_THROW(
+        pool.run([]() -> int { throw std::runtime_error("failed"); }),
+        std::runtime_error);
+  });
+  EXPECT_EQ(1, pool.getStats().offloaded);
+}
+
+TEST(AuxiliaryCPUThreadPool, runInlineOutsideOfFiber) {
+  AuxiliaryCPUThreadPool pool;
+  const auto thread = std::this_thread::get_id();
+  EXPECT_EQ(thread, pool.run([] { return std::this_thread::get_id(); }));
+
+  const auto stats = pool.getStats();
+  EXPECT_EQ(0, stats.offloaded);
+  EXPECT_EQ(0, stats.inlineFallbacks);
+  EXPECT_EQ(1, stats.inlineNotOnFiber);
+}
+
+TEST(AuxiliaryCPUThreadPool, saturated) {
+  AuxiliaryCPUThreadPool pool;
+  pool.setMaxQueueDepth(1);
+
+  // Keep the only slot busy.
+  folly::Baton<> started;
+  folly::Baton<> release;
+  EXPECT_TRUE(pool.tryAdd([&] {
+    started.post();
+    release.wait();
+  }));
+  started.wait();
+  EXPECT_EQ(1, pool.getStats().queueDepth);
+  EXPECT_FALSE(pool.tryAdd([] {}));
+
+  const auto evbThread = std::this_thread::get_id();
+  runInFiber([&] {
+    EXPECT_EQ(
+        evbThread, pool.run([] { return std::this_thread::get_id(); }));
+  });
+
+  release.post();
+  // The slot is freed right after the task returns.
+  while (pool.getStats().queueDepth != 0) {
+    std::this_thread::yield();
+  }
+  runInFiber([&] {
+    EXPECT_NE(
+        evbThread, pool.run([] { return std::this_thread::get_id(); }));
+  });
+
+  const auto stats = pool.getStats();
+  EXPECT_EQ(0, stats.queueDepth);
+  EXPECT_EQ(2, stats.offloaded);
+  EXPECT_EQ(2, stats.inlineFallbacks);
+}
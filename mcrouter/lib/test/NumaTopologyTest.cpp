@@ -0,0 +1,83 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <sys/stat.h>
+
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <folly/FileUtil.h>
+#include <folly/experimental/TestUtil.h>
+
+#include "mcrouter/lib/NumaTopology.h"
+
+using namespace facebook::memcache;
+
+using folly::test::TemporaryDirectory;
+
+namespace {
+
+void addNode(const std::string& root, int id, const std::string& cpuList) {
+  auto dir = root + "/node" + std::to_string(id);
+  ASSERT_EQ(0, mkdir(dir.c_str(), 0755));
+  ASSERT_TRUE(folly::writeFile(cpuList, (dir + "/cpulist").c_str()));
+}
+
+} // anonymous namespace
+
+TEST(NumaTopology, parseCpuList) {
+  EXPECT_EQ(std::vector<int>({0, 1, 2, 3}), parseCpuList("0-3\n"));
+  EXPECT_EQ(
+      std::vector<int>({0, 1, 8, 10, 11}), parseCpuList("0-1,8,10-11"));
+  EXPECT_EQ(std::vector<int>({5}), parseCpuList("x,5,3-1"));
+  EXPECT_TRUE(parseCpuList("").empty());
+}
+
+TEST(NumaTopology, fromSysfs) {
+  TemporaryDirectory dir;
+  auto root = dir.path().string();
+  addNode(root, 0, "0-1,4-5\n");
+  addNode(root, 1, "2-3,6-7\n");
+  // Memory-only node.
+  addNode(root, 2, "\n");
+
+  NumaTopology topology(root);
+  ASSERT_EQ(2, topology.numNodes());
+  EXPECT_EQ(std::vector<int>({0, 1, 4, 5}), topology.cpusOfNode(0));
+  EXPECT_EQ(std::vector<int>({2, 3, 6, 7}), topology.cpusOfNode(1));
+}
+
+TEST(NumaTopology, noNuma) {
+  TemporaryDirectory dir;
+  NumaTopology topology(dir.path().string() + "/missing");
+  EXPECT_EQ(1, topology.numNodes());
+  EXPECT_EQ(0, topology.nodeForThread(3, 4));
+  EXPECT_EQ(std::make_pair<size_t, size_t>(0, 4), topology.threadsOfNode(0, 4));
+}
+
+TEST(NumaTopology, threadPlacement) {
+  TemporaryDirectory dir;
+  auto root = dir.path().string();
+  addNode(root, 0, "0-3");
+  addNode(root, 1, "4-7");
+  NumaTopology topology(root);
+
+  std::vector<size_t> nodes;
+  for (size_t i = 0; i < 5; ++i) {
+    nodes.push_back(topology.nodeForThread(i, 5));
+  }
+  EXPECT_EQ(std::vector<size_t>({0, 0, 0, 1, 1}), nodes);
+  EXPECT_EQ(std::make_pair<size_t, size_t>(0, 3), topology.threadsOfNode(0, 5));
+  EXPECT_EQ(std::make_pair<size_t, size_t>(3, 5), topology.threadsOfNode(1, 5));
+
+  // Fewer threads than nodes.
+  EXPECT_EQ(0, topology.nodeForThread(0, 1));
+  EXPECT_EQ(std::make_pair<size_t, size_t>(0, 1), topology.threadsOfNode(0, 1));
+  EXPECT_EQ(std::make_pair<size_t, size_t>(1, 1), topology.threadsOfNode(1, 1));
+}
@@ -381,6 +381,70 @@ TEST(routeHandleTest, hashSalt) {
   });
 }
 
+TEST(routeHandleTest, hashForward) {
+  vector<std::shared_ptr<TestHandle>> test_handles{
+      make_shared<TestHandle>(GetRouteTestData(carbon::Result::FOUND, "a")),
+      make_shared<TestHandle>(GetRouteTestData(carbon::Result::FOUND, "b")),
+  };
+  auto outOfRangeRh = createNullRoute<typename TestRouterInfo::RouteHandleIf>();
+
+  TestRouteHandle<SelectionRoute<TestRouterInfo, HashSelector<HashFunc>>> rh(
+      get_route_handles(test_handles),
+      HashSelector<HashFunc>(/* salt= */ "", HashFunc(test_handles.size())),
+      std::move(outOfRangeRh));
+
+  /* Selection routes declare that they forward requests to the selected
+     child, which can be found without a fiber */
+  vector<TestRouteHandleIf*> forwarded;
+  RouteHandleTraverser<TestRouteHandleIf> t(
+      nullptr, nullptr, nullptr, [&forwarded](TestRouteHandleIf& child) {
+        forwarded.push_back(&child);
+      });
+  rh.traverse(McGetRequest("1"), t);
+  EXPECT_EQ(vector<TestRouteHandleIf*>{test_handles[1]->rh.get()}, forwarded);
+}
+
+TEST(routeHandleTest, hashForwardOnly) {
+  vector<std::shared_ptr<TestHandle>> test_handles{
+      make_shared<TestHandle>(GetRouteTestData(carbon::Result::FOUND, "a")),
+      make_shared<TestHandle>(GetRouteTestData(carbon::Result::FOUND, "b")),
+  };
+  auto outOfRangeRh = createNullRoute<typename TestRouterInfo::RouteHandleIf>();
+
+  TestRouteHandle<SelectionRoute<TestRouterInfo, HashSelector<HashFunc>>> rh(
+      get_route_handles(test_handles),
+      HashSelector<HashFunc>(/* salt= */ "", HashFunc(test_handles.size())),
+      std::move(outOfRangeRh));
+
+  /* Only the selector runs: the selected child is not traversed past, and
+     the selected index is not set outside of fibers */
+  vector<TestRouteHandleIf*> forwarded;
+  size_t started = 0;
+  RouteHandleTraverser<TestRouteHandleIf> t(
+      [&started](const TestRouteHandleIf&) { ++started; },
+      nullptr,
+      nullptr,
+      [&forwarded](TestRouteHandleIf& child) { forwarded.push_back(&child); });
+  t.options().setForwardOnly(true);
+  rh.traverse(McGetRequest("1"), t);
+  EXPECT_EQ(vector<TestRouteHandleIf*>{test_handles[1]->rh.get()}, forwarded);
+  EXPECT_EQ(0, started);
+  EXPECT_EQ(-1, mcrouter::fiber_local<TestRouterInfo>::getSelectedIndex());
+
+  /* When the config is loaded, all the children it may select */
+  forwarded.clear();
+  RouteHandleTraverser<TestRouteHandleIf> all(
+      nullptr, nullptr, nullptr, [&forwarded](TestRouteHandleIf& child) {
+        forwarded.push_back(&child);
+      });
+  all.options().setForwardAll(true);
+  rh.traverse(McGetRequest("1"), all);
+  EXPECT_EQ(
+      (vector<TestRouteHandleIf*>{
+          test_handles[0]->rh.get(), test_handles[1]->rh.get()}),
+      forwarded);
+}
+
 TEST(routeHandleTest, allSyncCollector) {
   vector<std::shared_ptr<TestHandle>> test_handles{
       make_shared<TestHandle>(GetRouteTestData(carbon::Result::FOUND, "a")),
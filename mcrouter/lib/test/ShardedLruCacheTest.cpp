@@ -0,0 +1,102 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <folly/Conv.h>
+
+#include "mcrouter/lib/ShardedLruCache.h"
+
+using namespace facebook::memcache;
+
+TEST(ShardedLruCache, GetSetRemove) {
+  ShardedLruCache<int> cache(100);
+  EXPECT_FALSE(cache.get("a").hasValue());
+  cache.set("a", 1);
+  cache.set("b", 2);
+  cache.set("a", 3);
+  EXPECT_EQ(3, *cache.get("a"));
+  EXPECT_EQ(2, *cache.get("b"));
+  EXPECT_TRUE(cache.remove("a"));
+  EXPECT_FALSE(cache.remove("a"));
+  EXPECT_FALSE(cache.get("a").hasValue());
+
+  auto stats = cache.getStats();
+  EXPECT_EQ(4, stats.lookups);
+  EXPECT_EQ(2, stats.hits);
+  EXPECT_EQ(0, stats.evictions);
+  EXPECT_EQ(1, stats.size);
+}
+
+TEST(ShardedLruCache, EvictsLeastRecentlyUsed) {
+  ShardedLruCache<int> cache(2, /* numShards */ 1);
+  cache.set("a", 1);
+  cache.set("b", 2);
+  // "a" becomes the most recently used one
+  EXPECT_TRUE(cache.get("a").hasValue());
+  cache.set("c", 3);
+  EXPECT_TRUE(cache.get("a").hasValue());
+  EXPECT_FALSE(cache.get("b").hasValue());
+  EXPECT_TRUE(cache.get("c").hasValue());
+  EXPECT_EQ(1, cache.getStats().evictions);
+  EXPECT_EQ(2, cache.getStats().size);
+}
+
+TEST(ShardedLruCache, Bounded) {
+  ShardedLruCache<int> cache(64, 4);
+  for (int i = 0; i < 1000; ++i) {
+    cache.set(folly::to<std::string>("key", i), i);
+  }
+  auto stats = cache.getStats();
+  EXPECT_LE(stats.size, 64);
+  EXPECT_EQ(1000 - stats.size, stats.evictions);
+}
+
+TEST(ShardedLruCache, SetCapacity) {
+  ShardedLruCache<int> cache(100, 4);
+  for (int i = 0; i < 100; ++i) {
+    cache.set(folly::to<std::string>("key", i), i);
+  }
+  cache.setCapacity(8);
+  EXPECT_LE(cache.getStats().size, 8);
+
+  cache.setCapacity(0);
+  EXPECT_EQ(0, cache.getStats().size);
+  cache.set("a", 1);
+  EXPECT_FALSE(cache.get("a").hasValue());
+
+  cache.setCapacity(1);
+  cache.set("a", 1);
+  EXPECT_EQ(1, *cache.get("a"));
+}
+
+TEST(ShardedLruCache, Concurrent) {
+  ShardedLruCache<std::string> cache(256);
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 8; ++t) {
+    threads.emplace_back([&cache, t] {
+      for (int i = 0; i < 10000; ++i) {
+        auto key = folly::to<std::string>(t, ":", i % 50);
+        if (auto value = cache.get(key)) {
+          EXPECT_EQ(key, *value);
+        } else {
+          cache.set(key, key);
+        }
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  auto stats = cache.getStats();
+  EXPECT_EQ(80000, stats.lookups);
+  EXPECT_LE(stats.size, 256);
+}
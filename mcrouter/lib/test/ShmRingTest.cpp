@@ -0,0 +1,175 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <sys/uio.h>
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <folly/experimental/TestUtil.h>
+
+#include "mcrouter/lib/debug/ShmRing.h"
+
+using namespace facebook::memcache;
+
+using folly::test::TemporaryDirectory;
+
+namespace {
+
+bool write(ShmRing& ring, const std::string& data) {
+  iovec iov[2];
+  const size_t half = data.size() / 2;
+  iov[0].iov_base = const_cast<char*>(data.data());
+  iov[0].iov_len = half;
+  iov[1].iov_base = const_cast<char*>(data.data() + half);
+  iov[1].iov_len = data.size() - half;
+  return ring.write(iov, 2);
+}
+
+std::vector<std::string> readAll(ShmRing& ring) {
+  std::vector<std::string> records;
+  ring.read([&records](folly::ByteRange data) {
+    records.emplace_back(
+        reinterpret_cast<const char*>(data.data()), data.size());
+  });
+  return records;
+}
+
+} // namespace
+
+TEST(ShmRing, WriteRead) {
+  TemporaryDirectory dir;
+  const auto path = (dir.path() / "ring").string();
+  auto writer = ShmRing::create(path, 64 * 1024);
+  auto reader = ShmRing::open(path);
+  EXPECT_EQ(writer->capacity(), reader->capacity());
+
+  EXPECT_FALSE(writer->hasReader());
+  ShmRing::Filter filter;
+  ASSERT_TRUE(reader->attach(filter));
+  EXPECT_TRUE(writer->hasReader());
+
+  EXPECT_TRUE(write(*writer, "hello"));
+  EXPECT_TRUE(write(*writer, std::string(1000, 'x')));
+  EXPECT_TRUE(write(*writer, ""));
+  EXPECT_EQ(
+      (std::vector<std::string>{"hello", std::string(1000, 'x'), ""}),
+      readAll(*reader));
+  EXPECT_TRUE(readAll(*reader).empty());
+
+  reader->detach();
+  EXPECT_FALSE(writer->hasReader());
+}
+
+TEST(ShmRing, WrapAround) {
+  TemporaryDirectory dir;
+  const auto path = (dir.path() / "ring").string();
+  auto writer = ShmRing::create(path, 64 * 1024);
+  auto reader = ShmRing::open(path);
+  ASSERT_TRUE(reader->attach(ShmRing::Filter()));
+
+  // Odd sizes, so that records end at every possible offset.
+  size_t next = 0;
+  for (size_t i = 0; i < 2000; ++i) {
+    std::vector<std::string> written;
+    for (size_t j = 0; j < 7; ++j, ++next) {
+      written.emplace_back(next % 1999, static_cast<char>('a' + next % 26));
+      ASSERT_TRUE(write(*writer, written.back()));
+    }
+    ASSERT_EQ(written, readAll(*reader));
+  }
+  EXPECT_EQ(0, writer->drops());
+}
+
+TEST(ShmRing, DropsWhenFull) {
+  TemporaryDirectory dir;
+  const auto path = (dir.path() / "ring").string();
+  auto writer = ShmRing::create(path, 64 * 1024);
+  auto reader = ShmRing::open(path);
+  ASSERT_TRUE(reader->attach(ShmRing::Filter()));
+
+  const std::string record(1000, 'x');
+  size_t written = 0;
+  while (write(*writer, record)) {
+    ++written;
+  }
+  EXPECT_EQ(1, writer->drops());
+  EXPECT_EQ(written, readAll(*reader).size());
+
+  // Space is reclaimed once read.
+  EXPECT_TRUE(write(*writer, record));
+
+  // Records larger than a quarter of the ring are always dropped.
+  EXPECT_FALSE(write(*writer, std::string(32 * 1024, 'y')));
+  EXPECT_EQ(2, reader->drops());
+}
+
+TEST(ShmRing, Filter) {
+  TemporaryDirectory dir;
+  const auto path = (dir.path() / "ring").string();
+  auto writer = ShmRing::create(path, 64 * 1024);
+  auto reader = ShmRing::open(path);
+  const auto initialVersion = writer->filterVersion();
+
+  ShmRing::Filter filter;
+  filter.sampleRate = 10;
+  filter.minLatencyUs = 1000;
+  std::strcpy(filter.keyPattern, "^foo");
+  ASSERT_TRUE(reader->attach(filter));
+  EXPECT_NE(initialVersion, writer->filterVersion());
+
+  ShmRing::Filter pushed;
+  uint64_t version;
+  ASSERT_TRUE(writer->readFilter(pushed, version));
+  EXPECT_EQ(writer->filterVersion(), version);
+  EXPECT_EQ(10, pushed.sampleRate);
+  EXPECT_EQ(1000, pushed.minLatencyUs);
+  EXPECT_STREQ("^foo", pushed.keyPattern);
+}
+
+TEST(ShmRing, AttachDetach) {
+  TemporaryDirectory dir;
+  const auto path = (dir.path() / "ring").string();
+  auto writer = ShmRing::create(path, 64 * 1024);
+  auto reader = ShmRing::open(path);
+  auto otherReader = ShmRing::open(path);
+
+  ASSERT_TRUE(reader->attach(ShmRing::Filter()));
+  // Same process: already attached.
+  EXPECT_TRUE(otherReader->attach(ShmRing::Filter()));
+
+  // A live reader is never expired.
+  writer->expireDeadReader();
+  EXPECT_TRUE(writer->hasReader());
+
+  // What was written before attaching is skipped.
+  reader->detach();
+  EXPECT_TRUE(write(*writer, "stale"));
+  ASSERT_TRUE(reader->attach(ShmRing::Filter()));
+  EXPECT_TRUE(readAll(*reader).empty());
+}
+
+TEST(ShmRing, Recreate) {
+  TemporaryDirectory dir;
+  const auto path = (dir.path() / "ring").string();
+  EXPECT_THROW(ShmRing::open(path), std::system_error);
+
+  auto oldWriter = ShmRing::create(path, 64 * 1024);
+  auto oldReader = ShmRing::open(path);
+  ASSERT_TRUE(oldReader->attach(ShmRing::Filter()));
+
+  // Recreating replaces the file, rather than reusing it.
+  auto writer = ShmRing::create(path, 64 * 1024);
+  EXPECT_TRUE(oldWriter->hasReader());
+  EXPECT_FALSE(writer->hasReader());
+  auto reader = ShmRing::open(path);
+  ASSERT_TRUE(reader->attach(ShmRing::Filter()));
+  EXPECT_TRUE(writer->hasReader());
+}
@@ -0,0 +1,146 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <unistd.h>
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <folly/FileUtil.h>
+#include <folly/experimental/TestUtil.h>
+
+#include "mcrouter/lib/debug/ShmStats.h"
+
+using namespace facebook::memcache;
+
+using folly::test::TemporaryDirectory;
+
+namespace {
+
+ShmStats::Entry makeEntry(folly::StringPiece name, uint64_t value) {
+  ShmStats::Entry entry;
+  entry.setName(name);
+  entry.type = ShmStats::Type::Uint64;
+  entry.value.uint64 = value;
+  return entry;
+}
+
+} // namespace
+
+TEST(ShmStats, PublishRead) {
+  TemporaryDirectory dir;
+  const auto path = (dir.path() / "stats").string();
+  auto writer = ShmStats::create(path, 16);
+  auto reader = ShmStats::open(path);
+  EXPECT_EQ(16, reader->capacity());
+
+  ShmStats::Snapshot snapshot;
+  // Nothing published yet.
+  EXPECT_FALSE(reader->read(snapshot));
+
+  std::vector<ShmStats::Entry> entries{makeEntry("uptime", 10)};
+  entries.emplace_back();
+  entries.back().setName("rate");
+  entries.back().type = ShmStats::Type::Double;
+  entries.back().value.dbl = 0.5;
+  ASSERT_TRUE(writer->publish(entries.data(), entries.size(), 1000));
+
+  ASSERT_TRUE(reader->read(snapshot));
+  EXPECT_EQ(1, snapshot.version);
+  EXPECT_EQ(1000, snapshot.timestampMs);
+  EXPECT_EQ(::getpid(), snapshot.pid);
+  ASSERT_EQ(2, snapshot.entries.size());
+  EXPECT_STREQ("uptime", snapshot.entries[0].name);
+  EXPECT_EQ(ShmStats::Type::Uint64, snapshot.entries[0].type);
+  EXPECT_EQ(10, snapshot.entries[0].value.uint64);
+  EXPECT_STREQ("rate", snapshot.entries[1].name);
+  EXPECT_EQ(ShmStats::Type::Double, snapshot.entries[1].type);
+  EXPECT_EQ(0.5, snapshot.entries[1].value.dbl);
+
+  // Snapshots are replaced as a whole.
+  entries = {makeEntry("uptime", 11)};
+  ASSERT_TRUE(writer->publish(entries.data(), entries.size(), 2000));
+  ASSERT_TRUE(reader->read(snapshot));
+  EXPECT_EQ(2, snapshot.version);
+  EXPECT_EQ(2000, snapshot.timestampMs);
+  ASSERT_EQ(1, snapshot.entries.size());
+  EXPECT_EQ(11, snapshot.entries[0].value.uint64);
+}
+
+TEST(ShmStats, LongNamesAreTruncated) {
+  ShmStats::Entry entry = makeEntry(std::string(1000, 'x'), 1);
+  EXPECT_EQ(
+      std::string(ShmStats::kMaxNameSize - 1, 'x'), std::string(entry.name));
+}
+
+TEST(ShmStats, Capacity) {
+  TemporaryDirectory dir;
+  const auto path = (dir.path() / "stats").string();
+  auto writer = ShmStats::create(path, 2);
+  auto reader = ShmStats::open(path);
+
+  std::vector<ShmStats::Entry> entries(3, makeEntry("a", 1));
+  EXPECT_FALSE(writer->publish(entries.data(), entries.size(), 1000));
+  ShmStats::Snapshot snapshot;
+  EXPECT_FALSE(reader->read(snapshot));
+
+  // Bigger snapshots go to a new region, at the same path.
+  auto newWriter = ShmStats::create(path, 4);
+  writer->retire();
+  EXPECT_TRUE(reader->retired());
+  ASSERT_TRUE(newWriter->publish(entries.data(), entries.size(), 1000));
+  auto newReader = ShmStats::open(path);
+  EXPECT_FALSE(newReader->retired());
+  ASSERT_TRUE(newReader->read(snapshot));
+  EXPECT_EQ(3, snapshot.entries.size());
+}
+
+TEST(ShmStats, Invalid) {
+  TemporaryDirectory dir;
+  const auto path = (dir.path() / "stats").string();
+  EXPECT_THROW(ShmStats::open(path), std::system_error);
+
+  ASSERT_TRUE(folly::writeFile(std::string(8192, 'x'), path.c_str()));
+  EXPECT_THROW(ShmStats::open(path), std::runtime_error);
+}
+
+TEST(ShmStats, ConcurrentReads) {
+  TemporaryDirectory dir;
+  const auto path = (dir.path() / "stats").string();
+  auto writer = ShmStats::create(path, 64);
+  auto reader = ShmStats::open(path);
+
+  std::atomic<bool> done{false};
+  std::thread publisher([&] {
+    std::vector<ShmStats::Entry> entries;
+    for (uint64_t i = 1; !done.load(); ++i) {
+      entries.assign(1 + i % 64, makeEntry("counter", i));
+      writer->publish(entries.data(), entries.size(), i);
+    }
+  });
+
+  // Every snapshot read must be consistent.
+  ShmStats::Snapshot snapshot;
+  size_t reads = 0;
+  while (reads < 10000) {
+    if (!reader->read(snapshot)) {
+      continue;
+    }
+    ++reads;
+    const auto i = snapshot.timestampMs;
+    ASSERT_EQ(1 + i % 64, snapshot.entries.size());
+    for (const auto& entry : snapshot.entries) {
+      ASSERT_EQ(i, entry.value.uint64);
+    }
+  }
+  done = true;
+  publisher.join();
+}
@@ -0,0 +1,129 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <sys/uio.h>
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <folly/experimental/TestUtil.h>
+
+#include "mcrouter/lib/debug/TraceFile.h"
+
+using namespace facebook::memcache;
+
+using folly::test::TemporaryDirectory;
+
+namespace {
+
+struct Record {
+  uint64_t timeUs;
+  uint64_t connectionId;
+  uint32_t typeId;
+  std::string body;
+
+  bool operator==(const Record& other) const {
+    return timeUs == other.timeUs && connectionId == other.connectionId &&
+        typeId == other.typeId && body == other.body;
+  }
+};
+
+void write(TraceWriter& writer, const Record& record) {
+  TraceRecord traceRecord;
+  traceRecord.timeUs = record.timeUs;
+  traceRecord.connectionId = record.connectionId;
+  traceRecord.typeId = record.typeId;
+  iovec iov;
+  iov.iov_base = const_cast<char*>(record.body.data());
+  iov.iov_len = record.body.size();
+  writer.write(traceRecord, &iov, 1);
+}
+
+std::vector<Record> readAll(TraceReader& reader) {
+  std::vector<Record> records;
+  TraceRecord record;
+  while (reader.next(record)) {
+    records.push_back(Record{
+        record.timeUs,
+        record.connectionId,
+        record.typeId,
+        std::string(
+            reinterpret_cast<const char*>(record.body.data()),
+            record.body.size())});
+  }
+  return records;
+}
+
+} // namespace
+
+TEST(TraceFile, WriteRead) {
+  TemporaryDirectory dir;
+  const auto path = (dir.path() / "trace").string();
+
+  // Time going backwards, large bodies spanning several read buffers.
+  std::vector<Record> records;
+  uint64_t timeUs = 1500000000000000;
+  for (uint32_t i = 0; i < 1000; ++i) {
+    timeUs = i % 3 == 0 ? timeUs - 7 : timeUs + 1000 * i;
+    records.push_back(Record{
+        timeUs, i % 17, 2 * (i % 5) + 1, std::string(i * 97 % 5000, 'a')});
+  }
+  records.push_back(Record{timeUs, 1, 1, std::string(200 * 1024, 'x')});
+
+  {
+    TraceFileHeader header;
+    header.flags = TraceFileHeader::kAnonymized;
+    TraceWriter writer(path, header);
+    for (const auto& record : records) {
+      write(writer, record);
+    }
+    EXPECT_EQ(records.size(), writer.recordsWritten());
+  }
+
+  TraceReader reader(path);
+  EXPECT_EQ(TraceFileHeader::kAnonymized, reader.header().flags);
+  EXPECT_EQ(records, readAll(reader));
+}
+
+TEST(TraceFile, Empty) {
+  TemporaryDirectory dir;
+  const auto path = (dir.path() / "trace").string();
+  { TraceWriter writer(path, TraceFileHeader()); }
+
+  TraceReader reader(path);
+  EXPECT_EQ(0, reader.header().flags);
+  EXPECT_TRUE(readAll(reader).empty());
+}
+
+TEST(TraceFile, Invalid) {
+  TemporaryDirectory dir;
+  const auto path = (dir.path() / "trace").string();
+  EXPECT_THROW(TraceReader reader(path), std::system_error);
+
+  { std::ofstream(path) << "not a trace file"; }
+  EXPECT_THROW(TraceReader reader(path), std::runtime_error);
+}
+
+TEST(TraceFile, Truncated) {
+  TemporaryDirectory dir;
+  const auto path = (dir.path() / "trace").string();
+  {
+    TraceWriter writer(path, TraceFileHeader());
+    write(writer, Record{1, 2, 3, "complete"});
+    write(writer, Record{4, 5, 6, std::string(100, 'y')});
+  }
+  ::truncate(path.c_str(), 16 + 4 + 8 + 4 + 50);
+
+  TraceReader reader(path);
+  TraceRecord record;
+  ASSERT_TRUE(reader.next(record));
+  EXPECT_EQ(8, record.body.size());
+  EXPECT_THROW(reader.next(record), std::runtime_error);
+}
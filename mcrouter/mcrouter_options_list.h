@@ -197,6 +197,35 @@ MCROUTER_OPTION_INTEGER(
     " fibers-pool-resize-period-ms milliseconds.  If value is 0, periodic"
     " resizing of the free pool is disabled.")
 
+MCROUTER_OPTION_INTEGER(
+    size_t,
+    fibers_small_stack_size,
+    0,
+    "fibers-small-stack-size",
+    no_short,
+    "If non zero (and smaller than fibers-stack-size), request types observed"
+    " to need little stack run on fibers with stacks of this size (at least"
+    " 16KB). These fibers always have guard pages. 0 disables the small"
+    " tier.")
+
+MCROUTER_OPTION_INTEGER(
+    size_t,
+    fibers_medium_stack_size,
+    0,
+    "fibers-medium-stack-size",
+    no_short,
+    "Like fibers-small-stack-size, for a tier between the small one and"
+    " fibers-stack-size. 0 disables the medium tier.")
+
+MCROUTER_OPTION_INTEGER(
+    size_t,
+    fibers_stack_tier_probe_every,
+    1000,
+    "fibers-stack-tier-probe-every",
+    no_short,
+    "If stack tiers are enabled, measure the stack used by one request out of"
+    " N of every type, to pick the tier of the type.")
+
 MCROUTER_OPTION_GROUP("Network")
 
 MCROUTER_OPTION_INTEGER(
@@ -232,6 +261,36 @@ MCROUTER_OPTION_INTEGER(
     "Maximum number of non-blocking event loops before we flush batched "
     "requests")
 
+MCROUTER_OPTION_INTEGER(
+    uint32_t,
+    destination_batching_max_delay_us,
+    0,
+    "destination-batching-max-delay-us",
+    no_short,
+    "Max latency (in microseconds) that adaptive batching may add to a request"
+    " sent to a destination. Requests are only held back while the"
+    " destination has requests in flight and more requests are expected to"
+    " arrive within this budget. 0 disables adaptive batching.")
+
+MCROUTER_OPTION_INTEGER(
+    uint32_t,
+    destination_batching_max_size,
+    32,
+    "destination-batching-max-size",
+    no_short,
+    "Max number of requests adaptive batching waits for before flushing a"
+    " batch to a destination.")
+
+MCROUTER_OPTION_INTEGER(
+    uint32_t,
+    failover_hedge_budget_percent,
+    5,
+    "failover-hedge-budget-percent",
+    no_short,
+    "Max percentage of requests eligible for hedging (see 'hedging' in"
+    " FailoverRoute) for which a proxy may actually send a hedged request."
+    " 0 disables hedging.")
+
 MCROUTER_OPTION_INTEGER(
     unsigned int,
     reset_inactive_connection_interval,
@@ -279,6 +338,17 @@ MCROUTER_OPTION_INTEGER(
     " per target per thread.  Requests that would exceed this limit are dropped"
     " immediately.")
 
+MCROUTER_OPTION_INTEGER(
+    size_t,
+    proxy_max_shadow_bytes,
+    0,
+    "proxy-max-shadow-bytes",
+    no_short,
+    "If non-zero, max number of bytes (keys and values) of shadow requests"
+    " outstanding per proxy thread. Requests are not shadowed while this"
+    " limit would be exceeded. All shadows of a request share one charge,"
+    " held until the last of them replied.")
+
 MCROUTER_OPTION_INTEGER(
     size_t,
     proxy_max_inflight_requests,
@@ -301,6 +371,24 @@ MCROUTER_OPTION_INTEGER(
     "proxy. Further requests will be rejected with an error immediately. 0 means "
     "disabled.")
 
+MCROUTER_OPTION_TOGGLE(
+    proxy_fair_queuing,
+    false,
+    "proxy-fair-queuing",
+    no_short,
+    "Only active if proxy-max-inflight-requests is non-zero. Share the"
+    " capacity of each proxy fairly between clients (identified by TLS common"
+    " name, or else by IP address) instead of serving queued requests in"
+    " arrival order.")
+
+MCROUTER_OPTION_STRING_MAP(
+    proxy_fair_queue_weights,
+    "proxy-fair-queue-weights",
+    no_short,
+    "Weights of clients for proxy-fair-queuing, in format"
+    " 'client1:weight1,client2:weight2'. A client with weight N gets N times"
+    " the share of a client with weight 1 (the default).")
+
 MCROUTER_OPTION_STRING(
     pem_cert_path,
     "", // this may get overwritten by finalizeOptions
@@ -383,6 +471,17 @@ MCROUTER_OPTION_TOGGLE(
     no_short,
     "If enabled, limited number of SSL sessions will be cached")
 
+MCROUTER_OPTION_INTEGER(
+    size_t,
+    ssl_session_cache_capacity,
+    4096,
+    "ssl-session-cache-capacity",
+    no_short,
+    "Max number of client TLS sessions (and, separately, of TLS 1.3 PSKs)"
+    " kept in the cache shared by all proxy threads, keyed by destination and"
+    " service identity. The cache is process-wide: the last router to start"
+    " sets its size. 0 disables session caching.")
+
 MCROUTER_OPTION_TOGGLE(
     ssl_handshake_offload,
     false,
@@ -406,6 +505,28 @@ MCROUTER_OPTION_TOGGLE(
     "compression algorithms/dictionaries supported by the client. Only "
     "compresses caret protocol replies.")
 
+MCROUTER_OPTION_INTEGER(
+    size_t,
+    compression_offload_threshold,
+    0,
+    "compression-offload-threshold",
+    no_short,
+    "Replies (to clients) and replies from destinations of at least this many"
+    " bytes are compressed/uncompressed on the auxiliary CPU thread pool"
+    " instead of the server or proxy thread, which keeps serving other"
+    " requests meanwhile. 0 (the default) always (de)compresses inline.")
+
+MCROUTER_OPTION_INTEGER(
+    size_t,
+    auxiliary_cpu_pool_max_queue_depth,
+    64,
+    "auxiliary-cpu-pool-max-queue-depth",
+    no_short,
+    "Max number of (de)compressions pending on the auxiliary CPU thread pool."
+    " Past this limit, the pool is considered saturated and payloads are"
+    " (de)compressed inline. The pool is process-wide: the last router to"
+    " start sets the limit.")
+
 MCROUTER_OPTION_GROUP("Routing configuration")
 
 MCROUTER_OPTION_TOGGLE(
@@ -470,6 +591,55 @@ MCROUTER_OPTION_STRING(
     no_short,
     "File containing stats enabled pool names.")
 
+MCROUTER_OPTION_INTEGER(
+    size_t,
+    key_prefix_stats_depth,
+    0,
+    "key-prefix-stats-depth",
+    no_short,
+    "If non zero, requests, bytes, errors and latency are accounted per"
+    " (pool, key prefix), see 'stats key_prefixes'. The prefix of a key is"
+    " made of its first N components separated by key-prefix-stats-delimiter,"
+    " or of its first N bytes if the delimiter is empty.")
+
+MCROUTER_OPTION_STRING(
+    key_prefix_stats_delimiter,
+    ":",
+    "key-prefix-stats-delimiter",
+    no_short,
+    "Delimiter (single character) of key components for key prefix stats.")
+
+MCROUTER_OPTION_INTEGER(
+    size_t,
+    key_prefix_stats_capacity,
+    256,
+    "key-prefix-stats-capacity",
+    no_short,
+    "Max number of (pool, key prefix) tracked by each proxy. Less requested"
+    " prefixes are evicted to make room for new ones.")
+
+MCROUTER_OPTION_INTEGER(
+    uint32_t,
+    route_profile_sample_rate,
+    0,
+    "route-profile-sample-rate",
+    no_short,
+    "If non zero, one request out of N records the time spent in every route"
+    " handle, reported as folded stacks by __mcrouter__.route_profile. Route"
+    " handles are only instrumented if set when the config is loaded.")
+
+MCROUTER_OPTION_TOGGLE(
+    direct_routing,
+    false,
+    "direct-routing",
+    no_short,
+    "Route requests whose route handle tree is a plain chain down to a single"
+    " destination (e.g. prefix, PoolRoute hash, destination) straight to the"
+    " destination: the chain is resolved in the main context, and the"
+    " request is sent without a fiber to memcache (AsyncMcClient)"
+    " destinations, or from a fiber that only runs the destination. Other"
+    " requests go through the whole tree on their fiber.")
+
 MCROUTER_OPTION_STRING(
     config_str,
     "",
@@ -640,6 +810,34 @@ MCROUTER_OPTION_INTEGER(
     " connect timeout. We will just return the result back to the client after"
     " either the connection is esblished, or we exhausted all retries.")
 
+MCROUTER_OPTION_INTEGER(
+    unsigned int,
+    destination_warmup_timeout_ms,
+    0,
+    "destination-warmup-timeout-ms",
+    no_short,
+    "If non-zero, on startup and after every reconfigure each proxy opens"
+    " connections to all destinations that were never connected, and holds new"
+    " requests until this is done or this many ms passed.")
+
+MCROUTER_OPTION_INTEGER(
+    unsigned int,
+    destination_warmup_concurrency,
+    32,
+    "destination-warmup-concurrency",
+    no_short,
+    "Max number of connections each proxy establishes in parallel while"
+    " warming up (see destination-warmup-timeout-ms).")
+
+MCROUTER_OPTION_INTEGER(
+    unsigned int,
+    destination_warmup_rate,
+    1000,
+    "destination-warmup-rate",
+    no_short,
+    "Max number of connections each proxy starts per second while warming up"
+    " (see destination-warmup-timeout-ms). 0 means no limit.")
+
 MCROUTER_OPTION_GROUP("Custom Memory Allocation")
 
 MCROUTER_OPTION_TOGGLE(
@@ -668,6 +866,18 @@ MCROUTER_OPTION_STRING(
     no_short,
     "Root directory for debug fifos. If empty, debug fifos are disabled.")
 
+MCROUTER_OPTION_INTEGER(
+    size_t,
+    debug_fifo_ring_size,
+    0,
+    "debug-fifo-ring-size",
+    no_short,
+    "Size in bytes of the memory mapped ring created next to each debug fifo."
+    " While mcpiper reads from a ring, traffic is copied there instead of"
+    " being written to the fifo, and mcpiper's filters are applied before"
+    " copying. 0 means no rings. debug-fifo-root should be on tmpfs when"
+    " rings are enabled.")
+
 MCROUTER_OPTION_INTEGER(
     unsigned int,
     stats_logging_interval,
@@ -676,6 +886,16 @@ MCROUTER_OPTION_INTEGER(
     no_short,
     "Time in ms between stats reports, or 0 for no logging")
 
+MCROUTER_OPTION_STRING(
+    stats_shm_path,
+    "",
+    "stats-shm-path",
+    no_short,
+    "If not empty, all numeric stats (pool stats included) are published"
+    " every second to a memory mapped file at this path, which mcstats and"
+    " other scrapers can read without querying the server. Each router"
+    " instance needs its own path; it should be on tmpfs.")
+
 MCROUTER_OPTION_INTEGER(
     unsigned int,
     logging_rtt_outlier_threshold_us,
@@ -805,6 +1025,16 @@ MCROUTER_OPTION_TOGGLE(
     "Enable deterministic selection of the proxy thread to lower the number of"
     "connections between client and server.")
 
+MCROUTER_OPTION_TOGGLE(
+    numa_placement,
+    false,
+    "numa-placement",
+    no_short,
+    "Spread proxy threads (and server worker threads in standalone mode) over"
+    " the NUMA nodes of the host and pin them there, so that their memory"
+    " (fiber stacks, buffers) is node-local. Clients prefer proxies on the"
+    " node they run on.")
+
 MCROUTER_OPTION_TOGGLE(
     disable_shard_split_route,
     false,
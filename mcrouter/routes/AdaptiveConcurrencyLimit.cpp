@@ -0,0 +1,117 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include "AdaptiveConcurrencyLimit.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include <folly/dynamic.h>
+
+#include "mcrouter/lib/fbi/cpp/ParsingUtil.h"
+#include "mcrouter/lib/fbi/cpp/util.h"
+
+namespace facebook {
+namespace memcache {
+namespace mcrouter {
+
+namespace {
+
+constexpr int64_t kMaxLimit = 1000000;
+
+size_t parseLimit(
+    const folly::dynamic& json,
+    folly::StringPiece name,
+    size_t defaultValue) {
+  if (auto jValue = json.get_ptr(name)) {
+    return parseInt(*jValue, name, 1, kMaxLimit);
+  }
+  return defaultValue;
+}
+
+double parseTolerance(const folly::dynamic& json) {
+  if (auto jTolerance = json.get_ptr("tolerance")) {
+    checkLogic(
+        jTolerance->isNumber(),
+        "AdaptiveConcurrencyLimit: tolerance is not a number");
+    return jTolerance->asDouble();
+  }
+  return 2.0;
+}
+
+} // anonymous namespace
+
+AdaptiveConcurrencyLimit::AdaptiveConcurrencyLimit(const folly::dynamic& json)
+    : AdaptiveConcurrencyLimit(
+          parseLimit(json, "initial_limit", 20),
+          parseLimit(json, "min_limit", 1),
+          parseLimit(json, "max_limit", 1000),
+          parseTolerance(json)) {}
+
+AdaptiveConcurrencyLimit::AdaptiveConcurrencyLimit(
+    size_t initialLimit,
+    size_t minLimit,
+    size_t maxLimit,
+    double tolerance)
+    : limit_(initialLimit),
+      minLimit_(minLimit),
+      maxLimit_(maxLimit),
+      tolerance_(tolerance) {
+  checkLogic(
+      minLimit >= 1 && minLimit <= maxLimit,
+      "AdaptiveConcurrencyLimit: min_limit must be in [1, max_limit]");
+  checkLogic(
+      initialLimit >= minLimit && initialLimit <= maxLimit,
+      "AdaptiveConcurrencyLimit: initial_limit must be in "
+      "[min_limit, max_limit]");
+  checkLogic(
+      tolerance >= 1.0, "AdaptiveConcurrencyLimit: tolerance must be >= 1");
+}
+
+void AdaptiveConcurrencyLimit::onSample(
+    std::chrono::microseconds latency,
+    size_t inflight) {
+  const int64_t us = std::max<int64_t>(latency.count(), 1);
+
+  if (windowMinUs_ == 0 || us < windowMinUs_) {
+    windowMinUs_ = us;
+  }
+  if (baselineUs_ == 0 || us < baselineUs_) {
+    baselineUs_ = us;
+  }
+  if (++windowSamples_ >= kBaselineWindow) {
+    baselineUs_ = windowMinUs_;
+    windowMinUs_ = 0;
+    windowSamples_ = 0;
+  }
+
+  latencyUs_ = latencyUs_ == 0.0
+      ? us
+      : kLatencySmoothing * us + (1 - kLatencySmoothing) * latencyUs_;
+
+  const double gradient = std::max(
+      0.5, std::min(1.0, tolerance_ * baselineUs_ / latencyUs_));
+  const double newLimit = limit_ * gradient + std::sqrt(limit_);
+
+  // Nothing to learn about a bigger limit if we aren't even using this one.
+  if (newLimit > limit_ && inflight * 2 < limit_) {
+    return;
+  }
+  setLimit((1 - kSmoothing) * limit_ + kSmoothing * newLimit);
+}
+
+void AdaptiveConcurrencyLimit::onDrop() {
+  setLimit(limit_ * kBackoffRatio);
+}
+
+void AdaptiveConcurrencyLimit::setLimit(double limit) {
+  limit_ = std::min(std::max(limit, minLimit_), maxLimit_);
+}
+
+} // namespace mcrouter
+} // namespace memcache
+} // namespace facebook
@@ -0,0 +1,101 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+namespace folly {
+struct dynamic;
+} // folly
+
+namespace facebook {
+namespace memcache {
+namespace mcrouter {
+
+/**
+ * Estimates how many requests can be outstanding to a destination before
+ * they start queueing up on its side, from the latency it replies with.
+ *
+ * The baseline is the minimum latency seen recently (the latency of an
+ * unloaded destination). As long as the smoothed latency stays within
+ * `tolerance` times the baseline, the limit keeps growing by about its square
+ * root; once latency rises above that, the limit shrinks proportionally to
+ * the latency increase (gradient algorithm). Timeouts and overload errors
+ * also shrink the limit multiplicatively.
+ *
+ * The baseline is re-measured periodically so that it follows permanent
+ * changes of the destination (e.g. new hardware).
+ *
+ * Not thread-safe.
+ */
+class AdaptiveConcurrencyLimit {
+ public:
+  /**
+   * @param json  Settings; must be an object. Format:
+   *                {
+   *                  "initial_limit": [min_limit..max_limit] (default 20),
+   *                  "min_limit": [1..INF] (default 1),
+   *                  "max_limit": [min_limit..INF] (default 1000),
+   *                  "tolerance": [1.0..INF] (default 2.0)
+   *                }
+   */
+  explicit AdaptiveConcurrencyLimit(const folly::dynamic& json);
+
+  AdaptiveConcurrencyLimit(
+      size_t initialLimit,
+      size_t minLimit,
+      size_t maxLimit,
+      double tolerance);
+
+  size_t limit() const {
+    return static_cast<size_t>(limit_);
+  }
+
+  /**
+   * Must be called when a request completes normally.
+   *
+   * @param latency   Time it took the destination to reply.
+   * @param inflight  Number of requests in flight when this one was sent,
+   *                  including itself.
+   */
+  void onSample(std::chrono::microseconds latency, size_t inflight);
+
+  /**
+   * Must be called when a request timed out or the destination rejected it
+   * as overloaded.
+   */
+  void onDrop();
+
+ private:
+  // Weight of the new estimate when updating the limit.
+  static constexpr double kSmoothing = 0.2;
+  // Weight of the most recent latency in the smoothed latency.
+  static constexpr double kLatencySmoothing = 0.1;
+  // Limit reduction applied on timeouts / overload errors.
+  static constexpr double kBackoffRatio = 0.9;
+  // Number of samples after which the baseline is re-measured.
+  static constexpr size_t kBaselineWindow = 1000;
+
+  double limit_;
+  double minLimit_;
+  double maxLimit_;
+  double tolerance_;
+
+  double latencyUs_{0.0};
+  int64_t baselineUs_{0};
+  int64_t windowMinUs_{0};
+  size_t windowSamples_{0};
+
+  void setLimit(double limit);
+};
+
+} // namespace mcrouter
+} // namespace memcache
+} // namespace facebook
@@ -37,11 +37,18 @@ class AsynclogRoute {
   AsynclogRoute(std::shared_ptr<RouteHandleIf> rh, std::string asynclogName)
       : rh_(std::move(rh)), asynclogName_(std::move(asynclogName)) {}
 
+  bool traverse(
+      const memcache::McDeleteRequest& req,
+      const RouteHandleTraverser<RouteHandleIf>& t) const {
+    return t(*rh_, req);
+  }
+
   template <class Request>
   bool traverse(
       const Request& req,
       const RouteHandleTraverser<RouteHandleIf>& t) const {
-    return t(*rh_, req);
+    // Only deletes are logged, other requests are passed through as is.
+    return t.forward(*rh_, req);
   }
 
   memcache::McDeleteReply route(const memcache::McDeleteRequest& req) const {
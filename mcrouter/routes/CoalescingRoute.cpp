@@ -0,0 +1,135 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include "CoalescingRoute.h"
+
+#include <limits>
+
+#include <folly/Format.h>
+#include <folly/ScopeGuard.h>
+#include <folly/dynamic.h>
+
+#include "mcrouter/McrouterFiberContext.h"
+#include "mcrouter/ProxyBase.h"
+#include "mcrouter/lib/config/RouteHandleFactory.h"
+#include "mcrouter/lib/fbi/cpp/ParsingUtil.h"
+#include "mcrouter/lib/fbi/cpp/util.h"
+#include "mcrouter/lib/network/gen/MemcacheRouterInfo.h"
+
+namespace facebook {
+namespace memcache {
+namespace mcrouter {
+
+namespace {
+
+void incrementStat(stat_name_t stat) {
+  if (auto& ctx = fiber_local<MemcacheRouterInfo>::getSharedCtx()) {
+    ctx->proxy().stats().increment(stat);
+  }
+}
+
+} // anonymous namespace
+
+std::string CoalescingRoute::routeName() const {
+  return folly::sformat(
+      "coalescing|max-waiters={}|wait-timeout={}ms",
+      maxWaiters_,
+      waitTimeout_.count());
+}
+
+McGetReply CoalescingRoute::route(const McGetRequest& req) {
+  auto key = req.key().fullKey().str();
+  auto it = inflight_.find(key);
+  if (it == inflight_.end()) {
+    return routeLeader(req, std::move(key));
+  }
+
+  // Keep the entry alive: the leader removes it from inflight_ once done.
+  auto inflight = it->second;
+  if (inflight->waiters.size() >= maxWaiters_) {
+    incrementStat(coalescing_route_waiters_limited_stat);
+    return child_->route(req);
+  }
+
+  if (auto reply = waitForLeader(*inflight)) {
+    incrementStat(coalescing_route_reqs_coalesced_stat);
+    return std::move(*reply);
+  }
+  return child_->route(req);
+}
+
+McGetReply CoalescingRoute::routeLeader(
+    const McGetRequest& req,
+    std::string key) {
+  auto inflight = std::make_shared<InflightGet>();
+  inflight_.emplace(key, inflight);
+
+  SCOPE_EXIT {
+    // Iterators may be invalidated by rehashing while we wait, erase by key.
+    inflight_.erase(key);
+    for (auto* baton : inflight->waiters) {
+      baton->post();
+    }
+    inflight->waiters.clear();
+  };
+
+  auto reply = child_->route(req);
+  inflight->reply = reply;
+  return reply;
+}
+
+folly::Optional<McGetReply> CoalescingRoute::waitForLeader(
+    InflightGet& inflight) {
+  folly::fibers::Baton baton;
+  auto waiterIt = inflight.waiters.insert(inflight.waiters.end(), &baton);
+
+  if (waitTimeout_.count() == 0) {
+    baton.wait();
+  } else if (!baton.try_wait_for(waitTimeout_)) {
+    // The leader hasn't replied yet and still holds a pointer to our baton.
+    inflight.waiters.erase(waiterIt);
+    incrementStat(coalescing_route_wait_timeouts_stat);
+    return folly::none;
+  }
+
+  return inflight.reply;
+}
+
+std::shared_ptr<MemcacheRouteHandleIf> makeCoalescingRoute(
+    RouteHandleFactory<MemcacheRouteHandleIf>& factory,
+    const folly::dynamic& json) {
+  checkLogic(json.isObject(), "CoalescingRoute should be an object");
+  auto jChild = json.get_ptr("child");
+  checkLogic(jChild != nullptr, "CoalescingRoute: 'child' property is missing");
+
+  size_t maxWaiters = 1000;
+  if (auto jMaxWaiters = json.get_ptr("max_waiters")) {
+    maxWaiters = parseInt(
+        *jMaxWaiters,
+        "max_waiters",
+        0,
+        std::numeric_limits<int64_t>::max());
+  }
+
+  std::chrono::milliseconds waitTimeout{0};
+  if (auto jWaitTimeout = json.get_ptr("wait_timeout_ms")) {
+    waitTimeout = parseTimeout(*jWaitTimeout, "wait_timeout_ms");
+  }
+
+  auto child = factory.create(*jChild);
+  if (maxWaiters == 0) {
+    // Nothing can be coalesced, optimize this rh away.
+    return child;
+  }
+
+  return std::make_shared<MemcacheRouteHandle<CoalescingRoute>>(
+      std::move(child), maxWaiters, waitTimeout);
+}
+
+} // namespace mcrouter
+} // namespace memcache
+} // namespace facebook
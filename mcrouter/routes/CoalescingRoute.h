@@ -0,0 +1,119 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <list>
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+#include <folly/Optional.h>
+#include <folly/fibers/Baton.h>
+
+#include "mcrouter/lib/Reply.h"
+#include "mcrouter/lib/RouteHandleTraverser.h"
+#include "mcrouter/lib/network/gen/MemcacheMessages.h"
+#include "mcrouter/lib/network/gen/MemcacheRouteHandleIf.h"
+
+namespace folly {
+struct dynamic;
+}
+
+namespace facebook {
+namespace memcache {
+
+template <class RouteHandleIf>
+class RouteHandleFactory;
+
+namespace mcrouter {
+
+/**
+ * Collapses concurrent gets for the same key into a single request to the
+ * child route ("single-flight").
+ *
+ * The first get for a key is sent to the child. Gets for the same key that
+ * arrive while it is in flight are parked on fibers and receive a copy of
+ * the leader's reply. A waiter that can't be parked (too many waiters) or
+ * that has been waiting for longer than `waitTimeout` sends its own request
+ * to the child.
+ *
+ * Only McGetRequest is coalesced. Lease-gets hand out per-client lease
+ * tokens and must never share a reply, so they (together with every other
+ * operation) are forwarded to the child unchanged.
+ *
+ * @param child         Child route handle.
+ * @param maxWaiters    Max number of requests parked behind one leader.
+ * @param waitTimeout   Max time a parked request waits for the leader's reply.
+ *                      Zero means waiting for as long as the leader does.
+ */
+class CoalescingRoute {
+ public:
+  CoalescingRoute(
+      std::shared_ptr<MemcacheRouteHandleIf> child,
+      size_t maxWaiters,
+      std::chrono::milliseconds waitTimeout)
+      : child_(std::move(child)),
+        maxWaiters_(maxWaiters),
+        waitTimeout_(waitTimeout) {
+    assert(child_ != nullptr);
+  }
+
+  std::string routeName() const;
+
+  template <class Request>
+  bool traverse(
+      const Request& req,
+      const RouteHandleTraverser<MemcacheRouteHandleIf>& t) const {
+    return t(*child_, req);
+  }
+
+  McGetReply route(const McGetRequest& req);
+
+  template <class Request>
+  ReplyT<Request> route(const Request& req) {
+    return child_->route(req);
+  }
+
+ private:
+  struct InflightGet {
+    // Set by the leader before waking up the waiters. Stays empty if the
+    // leader failed to get a reply, in which case waiters route on their own.
+    folly::Optional<McGetReply> reply;
+    std::list<folly::fibers::Baton*> waiters;
+  };
+
+  const std::shared_ptr<MemcacheRouteHandleIf> child_;
+  const size_t maxWaiters_;
+  const std::chrono::milliseconds waitTimeout_;
+
+  // Route handles are owned by a single proxy, so no locking is needed.
+  std::unordered_map<std::string, std::shared_ptr<InflightGet>> inflight_;
+
+  McGetReply routeLeader(const McGetRequest& req, std::string key);
+  folly::Optional<McGetReply> waitForLeader(InflightGet& inflight);
+};
+
+/**
+ * Creates a CoalescingRoute from a json config.
+ *
+ * Sample json:
+ * {
+ *   "type": "CoalescingRoute",
+ *   "child": "PoolRoute|pool_name",
+ *   "max_waiters": 1000,
+ *   "wait_timeout_ms": 100
+ * }
+ */
+std::shared_ptr<MemcacheRouteHandleIf> makeCoalescingRoute(
+    RouteHandleFactory<MemcacheRouteHandleIf>& factory,
+    const folly::dynamic& json);
+
+} // namespace mcrouter
+} // namespace memcache
+} // namespace facebook
@@ -7,6 +7,9 @@
 
 #pragma once
 
+#include <algorithm>
+#include <chrono>
+#include <memory>
 #include <string>
 
 #include <folly/Format.h>
@@ -43,6 +46,51 @@ class RouteHandleFactory;
 
 namespace mcrouter {
 
+namespace detail {
+
+/**
+ * Adjusts a request for the next hop, copying it only if it has to change:
+ * strips its routing prefix, tags it as a failover and passes on the
+ * remaining time budget, as needed.
+ *
+ * @param newReq           Where the copy is made, if any.
+ * @param deadlineTimeout  Budget to pass on, if the request has a deadline.
+ *                         The request is not copied if it already carries
+ *                         that budget.
+ * @return  The request to send: either req itself or the copy in newReq.
+ */
+template <class Request>
+const Request& prepareDestinationRequest(
+    const Request& req,
+    folly::Optional<Request>& newReq,
+    bool keepRoutingPrefix,
+    bool failoverTag,
+    folly::Optional<std::chrono::milliseconds> deadlineTimeout) {
+  if (!keepRoutingPrefix && !req.key().routingPrefix().empty()) {
+    newReq.emplace(req);
+    newReq->key().stripRoutingPrefix();
+  }
+
+  if (failoverTag) {
+    if (!newReq) {
+      newReq.emplace(req);
+    }
+    carbon::detail::setRequestFailover(*newReq);
+  }
+
+  if (deadlineTimeout &&
+      req.timeoutMs() != static_cast<uint64_t>(deadlineTimeout->count())) {
+    if (!newReq) {
+      newReq.emplace(req);
+    }
+    newReq->setTimeoutMs(deadlineTimeout->count());
+  }
+
+  return newReq ? *newReq : req;
+}
+
+} // namespace detail
+
 /**
  * Routes a request to a single ProxyDestination.
  * This is the lowest level in Mcrouter's RouteHandle tree.
@@ -108,6 +156,85 @@ class DestinationRoute {
     return routeWithDestination(req);
   }
 
+  /**
+   * Same as route(req) for a request routed with default fiber locals (see
+   * ProxyRoute::routeDirectAsync()), without a fiber: req is sent with
+   * ProxyDestination::sendAsync(). Such requests are never spooled to the
+   * asynclog, no AsynclogRoute set its name.
+   *
+   * @param callback  void(ReplyT<Request>&&), called from the EventBase loop,
+   *                  or before routeAsync() returns if req is not sent.
+   *                  req and ctx must stay alive until then.
+   */
+  template <class Request, class F>
+  void routeAsync(
+      const Request& req,
+      ProxyRequestContextWithInfo<RouterInfo>& ctx,
+      F&& callback) const {
+    const RequestClass requestClass;
+    auto timeout = timeout_;
+    if (auto reply = checkBeforeSend(req, ctx, requestClass, timeout)) {
+      reply->setDestination(destination_->accessPoint());
+      callback(std::move(*reply));
+      return;
+    }
+
+    DestinationRequestCtx dctx(nowUs());
+    dctx.timeoutShortened = timeout < timeout_;
+    folly::Optional<Request> newReq;
+    folly::StringPiece strippedRoutingPrefix;
+    if (!keepRoutingPrefix_) {
+      strippedRoutingPrefix = req.key().routingPrefix();
+    }
+    detail::prepareDestinationRequest(
+        req,
+        newReq,
+        keepRoutingPrefix_,
+        false /* failoverTag */,
+        ctx.hasDeadline() ? folly::make_optional(timeout) : folly::none);
+    // The request sent has to outlive the send.
+    std::unique_ptr<const Request> ownedReq;
+    if (newReq) {
+      ownedReq = std::make_unique<const Request>(std::move(*newReq));
+    }
+    const auto& reqToSend = ownedReq ? *ownedReq : req;
+    ctx.onBeforeRequestSent(
+        poolName_,
+        *destination_->accessPoint(),
+        strippedRoutingPrefix,
+        reqToSend,
+        requestClass,
+        dctx.startTime);
+    destination_->sendAsync(
+        reqToSend,
+        dctx,
+        timeout,
+        [this,
+         &ctx,
+         sentReq = &reqToSend,
+         ownedReq = std::move(ownedReq),
+         strippedRoutingPrefix,
+         requestClass,
+         callback = std::forward<F>(callback)](
+            ReplyT<Request>&& reply,
+            DestinationRequestCtx& dctx,
+            RpcStatsContext& rpcContext) mutable {
+          ctx.onReplyReceived(
+              poolName_,
+              *destination_->accessPoint(),
+              strippedRoutingPrefix,
+              *sentReq,
+              reply,
+              requestClass,
+              dctx.startTime,
+              dctx.endTime,
+              poolStatIndex_,
+              rpcContext);
+          reply.setDestination(destination_->accessPoint());
+          callback(std::move(reply));
+        });
+  }
+
  private:
   const std::shared_ptr<ProxyDestination<Transport>> destination_;
   const folly::StringPiece poolName_;
@@ -126,36 +253,19 @@ class DestinationRoute {
 
   template <class Request>
   ReplyT<Request> checkAndRoute(const Request& req) const {
-    auto& ctx = fiber_local<RouterInfo>::getSharedCtx();
-    carbon::Result tkoReason;
-    if (!destination_->maySend(tkoReason)) {
-      return constructAndLog(
-          req,
-          *ctx,
-          TkoReply,
-          folly::to<std::string>(
-              "Server unavailable. Reason: ",
-              carbon::resultToString(tkoReason)));
-    }
-
-    if (poolStatIndex_ >= 0) {
-      ctx->setPoolStatsIndex(poolStatIndex_);
-    }
+    auto& ctx = *fiber_local<RouterInfo>::getSharedCtx();
     auto requestClass = fiber_local<RouterInfo>::getRequestClass();
-    if (ctx->recording()) {
-      bool isShadow = requestClass.is(RequestClass::kShadow);
-      ctx->recordDestination(
-          PoolContext{poolName_, indexInPool_, isShadow},
-          *destination_->accessPoint());
-      return constructAndLog(req, *ctx, DefaultReply, req);
+    auto timeout = timeout_;
+    if (auto reply = checkBeforeSend(req, ctx, requestClass, timeout)) {
+      return std::move(*reply);
     }
 
-    auto proxy = &ctx->proxy();
+    auto proxy = &ctx.proxy();
     if (requestClass.is(RequestClass::kShadow)) {
       if (proxy->router().opts().target_max_shadow_requests > 0 &&
           pendingShadowReqs_ >=
               proxy->router().opts().target_max_shadow_requests) {
-        return constructAndLog(req, *ctx, ErrorReply);
+        return constructAndLog(req, ctx, requestClass, ErrorReply);
       }
       auto& mutableCounter = const_cast<size_t&>(pendingShadowReqs_);
       ++mutableCounter;
@@ -168,13 +278,69 @@ class DestinationRoute {
       }
     };
 
-    return doRoute(req, *ctx);
+    return doRoute(req, ctx, timeout);
+  }
+
+  /**
+   * Checks whether req may be sent to the destination.
+   *
+   * @param timeout  In: the timeout of the destination. Out: the one to send
+   *                 req with, to fit within the request deadline.
+   * @return  The reply to req if it must not be sent, none otherwise.
+   */
+  template <class Request>
+  folly::Optional<ReplyT<Request>> checkBeforeSend(
+      const Request& req,
+      ProxyRequestContextWithInfo<RouterInfo>& ctx,
+      RequestClass requestClass,
+      std::chrono::milliseconds& timeout) const {
+    carbon::Result tkoReason;
+    if (!destination_->maySend(tkoReason)) {
+      return constructAndLog(
+          req,
+          ctx,
+          requestClass,
+          TkoReply,
+          folly::to<std::string>(
+              "Server unavailable. Reason: ",
+              carbon::resultToString(tkoReason)));
+    }
+
+    // Don't bother the destination if the client already gave up, and don't
+    // wait on it for longer than the client is willing to.
+    if (ctx.hasDeadline()) {
+      auto remaining = ctx.remainingTime();
+      if (remaining.count() == 0) {
+        ctx.proxy().stats().increment(destination_deadline_expired_stat);
+        return constructAndLog(
+            req,
+            ctx,
+            requestClass,
+            ErrorReply,
+            carbon::Result::TIMEOUT,
+            "Request deadline exceeded");
+      }
+      timeout = std::min(timeout, remaining);
+    }
+
+    if (poolStatIndex_ >= 0) {
+      ctx.setPoolStatsIndex(poolStatIndex_);
+    }
+    if (ctx.recording()) {
+      bool isShadow = requestClass.is(RequestClass::kShadow);
+      ctx.recordDestination(
+          PoolContext{poolName_, indexInPool_, isShadow},
+          *destination_->accessPoint());
+      return constructAndLog(req, ctx, requestClass, DefaultReply, req);
+    }
+    return folly::none;
   }
 
   template <class Request, class... Args>
   ReplyT<Request> constructAndLog(
       const Request& req,
       ProxyRequestContextWithInfo<RouterInfo>& ctx,
+      RequestClass requestClass,
       Args&&... args) const {
     auto now = nowUs();
     auto reply = createReply<Request>(std::forward<Args>(args)...);
@@ -184,7 +350,7 @@ class DestinationRoute {
         *destination_->accessPoint(),
         folly::StringPiece(),
         req,
-        fiber_local<RouterInfo>::getRequestClass(),
+        requestClass,
         now);
     ctx.onReplyReceived(
         poolName_,
@@ -192,7 +358,7 @@ class DestinationRoute {
         folly::StringPiece(),
         req,
         reply,
-        fiber_local<RouterInfo>::getRequestClass(),
+        requestClass,
         now,
         now,
         poolStatIndex_,
@@ -203,24 +369,21 @@ class DestinationRoute {
   template <class Request>
   ReplyT<Request> doRoute(
       const Request& req,
-      ProxyRequestContextWithInfo<RouterInfo>& ctx) const {
+      ProxyRequestContextWithInfo<RouterInfo>& ctx,
+      std::chrono::milliseconds timeout) const {
     DestinationRequestCtx dctx(nowUs());
+    dctx.timeoutShortened = timeout < timeout_;
     folly::Optional<Request> newReq;
     folly::StringPiece strippedRoutingPrefix;
-    if (!keepRoutingPrefix_ && !req.key().routingPrefix().empty()) {
-      newReq.emplace(req);
-      newReq->key().stripRoutingPrefix();
+    if (!keepRoutingPrefix_) {
       strippedRoutingPrefix = req.key().routingPrefix();
     }
-
-    if (fiber_local<RouterInfo>::getFailoverTag()) {
-      if (!newReq) {
-        newReq.emplace(req);
-      }
-      carbon::detail::setRequestFailover(*newReq);
-    }
-
-    const auto& reqToSend = newReq ? *newReq : req;
+    const auto& reqToSend = detail::prepareDestinationRequest(
+        req,
+        newReq,
+        keepRoutingPrefix_,
+        fiber_local<RouterInfo>::getFailoverTag(),
+        ctx.hasDeadline() ? folly::make_optional(timeout) : folly::none);
     ctx.onBeforeRequestSent(
         poolName_,
         *destination_->accessPoint(),
@@ -229,7 +392,7 @@ class DestinationRoute {
         fiber_local<RouterInfo>::getRequestClass(),
         dctx.startTime);
     RpcStatsContext rpcContext;
-    auto reply = destination_->send(reqToSend, dctx, timeout_, rpcContext);
+    auto reply = destination_->send(reqToSend, dctx, timeout, rpcContext);
     ctx.onReplyReceived(
         poolName_,
         *destination_->accessPoint(),
@@ -305,6 +468,100 @@ std::shared_ptr<typename RouterInfo::RouteHandleIf> makeDestinationRoute(
       keepRoutingPrefix);
 }
 
+/**
+ * Routes through a DestinationRoute that the router can also reach without
+ * going through RouteHandleIf, see AsyncDestinationMap.
+ */
+template <class RouterInfo, class Transport>
+class SharedDestinationRoute {
+ public:
+  std::string routeName() const {
+    return route_->routeName();
+  }
+
+  explicit SharedDestinationRoute(
+      std::shared_ptr<const DestinationRoute<RouterInfo, Transport>> route)
+      : route_(std::move(route)) {}
+
+  template <class Request>
+  bool traverse(
+      const Request& req,
+      const RouteHandleTraverser<typename RouterInfo::RouteHandleIf>& t) const {
+    return route_->traverse(req, t);
+  }
+
+  template <class Request>
+  ReplyT<Request> route(const Request& req) const {
+    return route_->route(req);
+  }
+
+ private:
+  const std::shared_ptr<const DestinationRoute<RouterInfo, Transport>> route_;
+};
+
+/**
+ * Same as makeDestinationRoute() above, with the route handle wrapped by
+ * wrap(). Transports other than AsyncMcClient are only sent to from fibers.
+ */
+template <class RouterInfo, class Transport, class Wrap>
+std::shared_ptr<typename RouterInfo::RouteHandleIf> makeDestinationRoute(
+    std::shared_ptr<ProxyDestination<Transport>> destination,
+    folly::StringPiece poolName,
+    size_t indexInPool,
+    int32_t poolStatsIndex,
+    std::chrono::milliseconds timeout,
+    bool keepRoutingPrefix,
+    Wrap&& wrap,
+    AsyncDestinationMap<RouterInfo>* /* asyncDestinations */) {
+  return wrap(makeDestinationRoute<RouterInfo, Transport>(
+      std::move(destination),
+      poolName,
+      indexInPool,
+      poolStatsIndex,
+      timeout,
+      keepRoutingPrefix));
+}
+
+/**
+ * Same as makeDestinationRoute() above. If asyncDestinations is set, the
+ * DestinationRoute is also added to it, keyed by the (wrapped) route handle
+ * returned.
+ */
+template <class RouterInfo, class Wrap>
+std::shared_ptr<typename RouterInfo::RouteHandleIf> makeDestinationRoute(
+    std::shared_ptr<ProxyDestination<AsyncMcClient>> destination,
+    folly::StringPiece poolName,
+    size_t indexInPool,
+    int32_t poolStatsIndex,
+    std::chrono::milliseconds timeout,
+    bool keepRoutingPrefix,
+    Wrap&& wrap,
+    AsyncDestinationMap<RouterInfo>* asyncDestinations) {
+  if (!asyncDestinations) {
+    return wrap(makeDestinationRoute<RouterInfo, AsyncMcClient>(
+        std::move(destination),
+        poolName,
+        indexInPool,
+        poolStatsIndex,
+        timeout,
+        keepRoutingPrefix));
+  }
+  auto route =
+      std::make_shared<const DestinationRoute<RouterInfo, AsyncMcClient>>(
+          std::move(destination),
+          poolName,
+          indexInPool,
+          poolStatsIndex,
+          timeout,
+          keepRoutingPrefix);
+  auto rh = wrap(makeRouteHandleWithInfo<
+                 RouterInfo,
+                 SharedDestinationRoute,
+                 AsyncMcClient>(route));
+  asyncDestinations->emplace(rh.get(), std::move(route));
+  return rh;
+}
+
 } // namespace mcrouter
 } // namespace memcache
 } // namespace facebook
@@ -0,0 +1,86 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include "FailoverHedgePolicy.h"
+
+#include <algorithm>
+
+#include <folly/dynamic.h>
+
+#include "mcrouter/lib/fbi/cpp/ParsingUtil.h"
+#include "mcrouter/lib/fbi/cpp/util.h"
+
+namespace facebook {
+namespace memcache {
+namespace mcrouter {
+
+FailoverHedgePolicy::FailoverHedgePolicy(const folly::dynamic& json) {
+  checkLogic(json.isObject(), "Failover: hedging is not an object");
+
+  if (auto jDelay = json.get_ptr("delay_ms")) {
+    checkLogic(
+        json.get_ptr("percentile") == nullptr,
+        "Failover: hedging can't have both delay_ms and percentile");
+    delay_ = parseTimeout(*jDelay, "delay_ms");
+    return;
+  }
+
+  auto jPercentile = json.get_ptr("percentile");
+  checkLogic(
+      jPercentile != nullptr,
+      "Failover: hedging needs either delay_ms or percentile");
+  checkLogic(
+      jPercentile->isNumber(), "Failover: hedging percentile is not a number");
+  percentile_ = jPercentile->asDouble();
+  checkLogic(
+      percentile_ > 0 && percentile_ < 100,
+      "Failover: hedging percentile must be in (0, 100)");
+
+  auto jMaxDelay = json.get_ptr("max_delay_ms");
+  checkLogic(
+      jMaxDelay != nullptr,
+      "Failover: hedging max_delay_ms is required with percentile");
+  maxDelay_ = parseTimeout(*jMaxDelay, "max_delay_ms");
+  if (auto jMinDelay = json.get_ptr("min_delay_ms")) {
+    minDelay_ = parseTimeout(*jMinDelay, "min_delay_ms");
+  }
+  checkLogic(
+      minDelay_ <= maxDelay_,
+      "Failover: hedging min_delay_ms is greater than max_delay_ms");
+
+  delay_ = maxDelay_;
+  samples_.reserve(kMaxSamples);
+}
+
+void FailoverHedgePolicy::recordLatency(std::chrono::microseconds latency) {
+  if (percentile_ == 0.0) {
+    return;
+  }
+  if (samples_.size() < kMaxSamples) {
+    samples_.push_back(latency.count());
+  } else {
+    samples_[nextSample_] = latency.count();
+    nextSample_ = (nextSample_ + 1) % kMaxSamples;
+  }
+  if (++numNewSamples_ >= kRecomputeInterval) {
+    numNewSamples_ = 0;
+    recompute();
+  }
+}
+
+void FailoverHedgePolicy::recompute() {
+  scratch_ = samples_;
+  auto nth = scratch_.begin() +
+      static_cast<size_t>(percentile_ / 100 * (scratch_.size() - 1));
+  std::nth_element(scratch_.begin(), nth, scratch_.end());
+  delay_ = std::min(
+      std::max(std::chrono::microseconds(*nth), minDelay_), maxDelay_);
+}
+
+} // namespace mcrouter
+} // namespace memcache
+} // namespace facebook
@@ -0,0 +1,84 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+namespace folly {
+struct dynamic;
+} // folly
+
+namespace facebook {
+namespace memcache {
+namespace mcrouter {
+
+/**
+ * Decides after how long FailoverRoute should give up waiting on the normal
+ * destination alone and send a hedged copy of the request to the next one.
+ *
+ * The delay is either fixed, or tracks a percentile of the latencies recently
+ * observed from the normal destination, so that only the slowest requests
+ * are hedged.
+ *
+ * Not thread-safe, each route has its own instance.
+ */
+class FailoverHedgePolicy {
+ public:
+  /**
+   * @param json  Hedging configuration; must be an object. Format:
+   *                {
+   *                  "delay_ms": [0..INF]
+   *                }
+   *              to hedge after a fixed delay, or
+   *                {
+   *                  "percentile": (0..100),
+   *                  "min_delay_ms": [0..INF],
+   *                  "max_delay_ms": [min_delay_ms..INF]
+   *                }
+   *              to hedge after the given percentile of recent latencies,
+   *              clamped to [min_delay_ms, max_delay_ms]. Until enough
+   *              latencies were observed, max_delay_ms is used.
+   */
+  explicit FailoverHedgePolicy(const folly::dynamic& json);
+
+  /**
+   * @return  For how long to wait on the normal destination before hedging.
+   */
+  std::chrono::microseconds delay() const {
+    return delay_;
+  }
+
+  /**
+   * Records the latency of a request sent to the normal destination.
+   */
+  void recordLatency(std::chrono::microseconds latency);
+
+ private:
+  static constexpr size_t kMaxSamples = 256;
+  // Recompute the percentile once every that many samples.
+  static constexpr size_t kRecomputeInterval = 64;
+
+  // Zero means fixed delay.
+  double percentile_{0.0};
+  std::chrono::microseconds minDelay_{0};
+  std::chrono::microseconds maxDelay_{0};
+  std::chrono::microseconds delay_{0};
+
+  std::vector<int64_t> samples_;
+  std::vector<int64_t> scratch_;
+  size_t nextSample_{0};
+  size_t numNewSamples_{0};
+
+  void recompute();
+};
+
+} // namespace mcrouter
+} // namespace memcache
+} // namespace facebook
@@ -85,6 +85,7 @@ makeFailoverRouteWithPolicyAndFailoverError(
   }
 
   std::unique_ptr<FailoverRateLimiter> rateLimiter;
+  std::unique_ptr<FailoverHedgePolicy> hedgePolicy;
   bool failoverTagging = false;
   bool enableLeasePairing = false;
   std::string name;
@@ -110,6 +111,9 @@ makeFailoverRouteWithPolicyAndFailoverError(
     if (auto jFailoverLimit = json.get_ptr("failover_limit")) {
       rateLimiter = std::make_unique<FailoverRateLimiter>(*jFailoverLimit);
     }
+    if (auto jHedging = json.get_ptr("hedging")) {
+      hedgePolicy = std::make_unique<FailoverHedgePolicy>(*jHedging);
+    }
   }
 
   return makeRouteHandleWithInfo<
@@ -124,6 +128,7 @@ makeFailoverRouteWithPolicyAndFailoverError(
       enableLeasePairing,
       std::move(name),
       policyConfig,
+      std::move(hedgePolicy),
       std::forward<Args>(args)...);
 }
 
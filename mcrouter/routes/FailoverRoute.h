@@ -7,10 +7,18 @@
 
 #pragma once
 
+#include <chrono>
 #include <memory>
 #include <string>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
+#include <folly/Optional.h>
+#include <folly/fibers/Baton.h>
+#include <folly/fibers/FiberManager.h>
+#include <folly/io/async/AsyncTimeout.h>
+
 #include "mcrouter/CarbonRouterInstanceBase.h"
 #include "mcrouter/LeaseTokenMap.h"
 #include "mcrouter/McrouterFiberContext.h"
@@ -21,6 +29,7 @@
 #include "mcrouter/lib/Reply.h"
 #include "mcrouter/lib/RouteHandleTraverser.h"
 #include "mcrouter/lib/network/gen/MemcacheMessages.h"
+#include "mcrouter/routes/FailoverHedgePolicy.h"
 #include "mcrouter/routes/FailoverPolicy.h"
 #include "mcrouter/routes/FailoverRateLimiter.h"
 
@@ -49,12 +58,33 @@ inline std::string getFailoverRouteName(std::string name, size_t numTargets) {
       std::move(name), ":failover_targets=", numTargets);
 }
 
+// Timeout running a function owned by the caller, who must outlive it.
+template <class F>
+class FailoverHedgeTimeout : public folly::AsyncTimeout {
+ public:
+  FailoverHedgeTimeout(folly::TimeoutManager& timeoutManager, F& func)
+      : folly::AsyncTimeout(&timeoutManager), func_(func) {}
+
+  void timeoutExpired() noexcept final {
+    func_();
+  }
+
+ private:
+  F& func_;
+};
+
 } // namespace detail
 
 /**
  * Sends the same request sequentially to each destination in the list in order,
  * until the first non-error reply.  If all replies result in errors, returns
  * the last destination's reply.
+ *
+ * If hedging is configured, a get request that is still waiting on the normal
+ * destination after the hedge delay is also sent to the next destination
+ * (within the proxy-wide hedge budget), and the first of the two replies that
+ * is not an error is returned once the normal destination replied. If both
+ * fail, failover continues after the hedge destination.
  */
 template <
     class RouterInfo,
@@ -103,14 +133,16 @@ class FailoverRoute {
       bool failoverTagging,
       bool enableLeasePairing,
       std::string name,
-      const folly::dynamic& policyConfig)
+      const folly::dynamic& policyConfig,
+      std::unique_ptr<FailoverHedgePolicy> hedgePolicy = nullptr)
       : name_(detail::getFailoverRouteName(std::move(name), targets.size())),
         targets_(std::move(targets)),
         failoverErrors_(std::move(failoverErrors)),
         rateLimiter_(std::move(rateLimiter)),
         failoverTagging_(failoverTagging),
         failoverPolicy_(targets_, policyConfig),
-        enableLeasePairing_(enableLeasePairing) {
+        enableLeasePairing_(enableLeasePairing),
+        hedgePolicy_(std::move(hedgePolicy)) {
     assert(!targets_.empty());
     assert(!enableLeasePairing_ || !name_.empty());
   }
@@ -182,6 +214,14 @@ class FailoverRoute {
   const bool failoverTagging_{false};
   FailoverPolicyT failoverPolicy_;
   const bool enableLeasePairing_{false};
+  std::unique_ptr<FailoverHedgePolicy> hedgePolicy_;
+
+  // Lease gets are not hedged: both destinations would hand out a lease.
+  template <class Request>
+  static constexpr bool canHedge() {
+    return carbon::GetLike<Request>::value &&
+        !std::is_same<Request, McLeaseGetRequest>::value;
+  }
 
   template <class Request>
   inline ReplyT<Request> doRoute(const Request& req) {
@@ -203,7 +243,13 @@ class FailoverRoute {
 
     auto policyCtx = failoverPolicy_.context(req);
     auto iter = failoverPolicy_.begin(req);
-    auto normalReply = iter->route(req, policyCtx);
+    bool hedged = false;
+    auto normalReply = canHedge<Request>() && hedgePolicy_
+        ? routeHedged(req, iter, policyCtx, childIndex, hedged)
+        : iter->route(req, policyCtx);
+    if (hedged && !isErrorResult(normalReply.result())) {
+      return normalReply;
+    }
     if (isErrorResult(normalReply.result())) {
       if (!isTkoOrHardTkoResult(normalReply.result())) {
         proxy.stats().increment(failover_policy_result_error_stat);
@@ -212,6 +258,10 @@ class FailoverRoute {
       }
     }
     ++iter;
+    if (hedged) {
+      // Both the normal and the hedge destinations failed already.
+      ++iter;
+    }
     if (iter == failoverPolicy_.end(req)) {
       if (isErrorResult(normalReply.result())) {
         proxy.stats().increment(failover_all_failed_stat);
@@ -235,6 +285,10 @@ class FailoverRoute {
       default:
         break;
     }
+    if (fiber_local<RouterInfo>::getSharedCtx()->deadlineExpired()) {
+      proxy.stats().increment(failover_deadline_expired_stat);
+      return normalReply;
+    }
 
     proxy.stats().increment(failover_all_stat);
     proxy.stats().increment(failoverPolicy_.getFailoverStat());
@@ -249,6 +303,12 @@ class FailoverRoute {
     if (!isTkoOrHardTkoResult(normalReply.result())) {
       ++policyCtx.numTries_;
     }
+    if (hedged && policyCtx.numTries_ >= failoverPolicy_.maxErrorTries()) {
+      // The normal and hedge destinations used up all the tries.
+      proxy.stats().increment(failover_all_failed_stat);
+      proxy.stats().increment(failoverPolicy_.getFailoverFailedStat());
+      return normalReply;
+    }
 
     // Failover
     return fiber_local<RouterInfo>::runWithLocals([this,
@@ -303,6 +363,10 @@ class FailoverRoute {
           default:
             break;
         }
+        if (fiber_local<RouterInfo>::getSharedCtx()->deadlineExpired()) {
+          proxy.stats().increment(failover_deadline_expired_stat);
+          return failoverReply;
+        }
         if (rateLimiter_ && !isTkoOrHardTkoResult(failoverReply.result()) &&
             !rateLimiter_->failoverAllowed()) {
           proxy.stats().increment(failover_rate_limited_stat);
@@ -332,6 +396,142 @@ class FailoverRoute {
     });
   }
 
+  /**
+   * Routes to the normal destination and, if it doesn't reply within the
+   * hedge delay, to the next destination as well. The normal destination is
+   * routed on the calling fiber: the request is only copied, and a fiber
+   * started, once the hedge is actually sent. The first of the two replies
+   * that is not an error is returned, once the normal destination replied.
+   *
+   * @param hedged  Set to true if the request was sent to both destinations.
+   *                If the hedge replied first without an error, or the normal
+   *                destination failed, the hedge reply is returned, marked as
+   *                a failover, and childIndex is set to the hedge destination
+   *                (unless the hedge failed too, in which case the normal
+   *                reply is returned).
+   */
+  template <class Request, class Iterator>
+  ReplyT<Request> routeHedged(
+      const Request& req,
+      const Iterator& iter,
+      FailoverPolicyContext& policyCtx,
+      size_t& childIndex,
+      bool& hedged) {
+    using Clock = std::chrono::steady_clock;
+
+    auto hedgeIter = iter;
+    ++hedgeIter;
+    const auto& sharedCtx = fiber_local<RouterInfo>::getSharedCtx();
+    if (hedgeIter == failoverPolicy_.end(req) ||
+        sharedCtx->failoverDisabled()) {
+      return iter->route(req, policyCtx);
+    }
+    auto& proxy = sharedCtx->proxy();
+    proxy.hedgeBudget().onRequest();
+    childIndex = 0;
+
+    // The hedge keeps running after this call returns if the normal
+    // destination replied first, so everything it touches is owned by the
+    // shared state. The request context (and so the config owning this
+    // route) is kept alive by the task.
+    struct HedgeState {
+      HedgeState(const Request& r, const FailoverPolicyContext& ctx)
+          : req(r), policyCtx(ctx) {}
+
+      const Request req;
+      FailoverPolicyContext policyCtx;
+      folly::Optional<ReplyT<Request>> reply;
+      folly::fibers::Baton baton;
+    };
+    // Only allocated when the hedge is sent.
+    std::shared_ptr<HedgeState> hedge;
+
+    auto& fm = folly::fibers::FiberManager::getFiberManager();
+    const auto requestClass = fiber_local<RouterInfo>::getRequestClass();
+    auto sendHedge = [&]() {
+      if (!proxy.hedgeBudget().tryConsume()) {
+        proxy.stats().increment(failover_hedges_budget_limited_stat);
+        return;
+      }
+      proxy.stats().increment(failover_hedges_sent_stat);
+      hedge = std::make_shared<HedgeState>(req, policyCtx);
+      // Runs from the event base when the delay is over: locals are set
+      // explicitly, as for a failover.
+      fm.addTask([this,
+                  hedge,
+                  ctx = sharedCtx,
+                  requestClass,
+                  child = *hedgeIter]() mutable {
+        fiber_local<RouterInfo>::setSharedCtx(std::move(ctx));
+        fiber_local<RouterInfo>::addRequestClass(requestClass);
+        fiber_local<RouterInfo>::addRequestClass(RequestClass::kFailover);
+        fiber_local<RouterInfo>::setFailoverTag(failoverTagging_);
+        hedge->reply = child.route(hedge->req, hedge->policyCtx);
+        hedge->baton.post();
+      });
+    };
+
+    detail::FailoverHedgeTimeout<decltype(sendHedge)> timeout(
+        proxy.eventBase(), sendHedge);
+    // Timeouts have a millisecond resolution, round up.
+    const auto delayMs = (hedgePolicy_->delay().count() + 999) / 1000;
+    if (delayMs > 0) {
+      timeout.scheduleTimeout(static_cast<uint32_t>(delayMs));
+    } else {
+      sendHedge();
+    }
+
+    const auto start = Clock::now();
+    auto normalReply = iter->route(req, policyCtx);
+    hedgePolicy_->recordLatency(
+        std::chrono::duration_cast<std::chrono::microseconds>(
+            Clock::now() - start));
+    timeout.cancelTimeout();
+    if (!hedge) {
+      return normalReply;
+    }
+    hedged = true;
+
+    const bool normalFailed = isErrorResult(normalReply.result()) &&
+        shouldFailover(normalReply, req) !=
+            FailoverErrorsSettingsBase::FailoverType::NONE;
+    // The first good reply wins: if the hedge already replied without an
+    // error, it came first.
+    const bool hedgeWon =
+        hedge->reply && !isErrorResult(hedge->reply->result());
+    if (!hedgeWon) {
+      if (!normalFailed) {
+        return normalReply;
+      }
+      hedge->baton.wait();
+    }
+
+    auto& hedgeReply = *hedge->reply;
+    if (normalFailed) {
+      FailoverContext failoverContext(
+          hedgeIter.getTrueIndex(),
+          targets_.size() - 1,
+          req,
+          normalReply,
+          hedgeReply);
+      logFailover(proxy, failoverContext);
+    }
+    carbon::setIsFailoverIfPresent(hedgeReply, true);
+    if (!isErrorResult(hedgeReply.result())) {
+      proxy.stats().increment(failover_hedges_won_stat);
+      childIndex = hedgeIter.getTrueIndex();
+      return std::move(hedgeReply);
+    }
+    if (!isTkoOrHardTkoResult(hedgeReply.result())) {
+      proxy.stats().increment(failover_policy_result_error_stat);
+      // The hedge counts as a try, just like the normal destination.
+      ++policyCtx.numTries_;
+    } else {
+      proxy.stats().increment(failover_policy_tko_error_stat);
+    }
+    return normalReply;
+  }
+
   template <class Request>
   FailoverErrorsSettingsBase::FailoverType shouldFailover(
       const ReplyT<Request>& reply,
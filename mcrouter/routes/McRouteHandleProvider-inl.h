@@ -31,6 +31,7 @@
 #include "mcrouter/routes/FailoverRoute.h"
 #include "mcrouter/routes/HashRouteFactory.h"
 #include "mcrouter/routes/PoolRouteUtils.h"
+#include "mcrouter/routes/ProfileRoute.h"
 #include "mcrouter/routes/RateLimitRoute.h"
 #include "mcrouter/routes/RateLimiter.h"
 #include "mcrouter/routes/ShadowRoute.h"
@@ -173,6 +174,11 @@ McRouteHandleProvider<RouterInfo>::makePool(
       enableCompression = parseBool(*jCompression, "enable_compression");
     }
 
+    bool useIoUring = false;
+    if (auto jUseIoUring = json.get_ptr("use_io_uring")) {
+      useIoUring = parseBool(*jUseIoUring, "use_io_uring");
+    }
+
     bool keepRoutingPrefix = false;
     if (auto jKeepRoutingPrefix = json.get_ptr("keep_routing_prefix")) {
       keepRoutingPrefix = parseBool(*jKeepRoutingPrefix, "keep_routing_prefix");
@@ -284,6 +290,8 @@ McRouteHandleProvider<RouterInfo>::makePool(
         }
       }
 
+      ap->setUseIoUring(useIoUring);
+
       if (ap->compressed() && proxy_.router().getCodecManager() == nullptr) {
         if (!initCompression(proxy_.router())) {
           MC_LOG_FAILURE(
@@ -364,13 +372,18 @@ McRouteHandleProvider<RouterInfo>::createDestinationRoute(
       std::move(ap), timeout, qosClass, qosPath);
   pdstn->updateShortestTimeout(connectTimeout, timeout);
 
-  return makeDestinationRoute<RouterInfo, Transport>(
+  // Direct routing sends to destinations through the route handles routed
+  // to, i.e. the profiled ones if any (sampled requests are not sent
+  // directly).
+  return makeDestinationRoute<RouterInfo>(
       std::move(pdstn),
       poolName,
       indexInPool,
       poolStatIndex,
       timeout,
-      keepRoutingPrefix);
+      keepRoutingPrefix,
+      [this](RouteHandlePtr rh) { return profile(std::move(rh)); },
+      proxy_.router().opts().direct_routing ? &asyncDestinations_ : nullptr);
 }
 
 template <class RouterInfo>
@@ -426,19 +439,20 @@ McRouteHandleProvider<RouterInfo>::makePoolRoute(
         }
       }
     }
-    auto route = createHashRoute<RouterInfo>(
-        jhashWithWeights, std::move(destinations), factory.getThreadId());
+    auto route = profile(createHashRoute<RouterInfo>(
+        jhashWithWeights, std::move(destinations), factory.getThreadId()));
 
     auto asynclogName = poolJson.name;
     bool needAsynclog = true;
     if (json.isObject()) {
       if (auto jrates = json.get_ptr("rates")) {
-        route = createRateLimitRoute(std::move(route), RateLimiter(*jrates));
+        route = profile(
+            createRateLimitRoute(std::move(route), RateLimiter(*jrates)));
       }
       if (!(proxy_.router().opts().disable_shard_split_route)) {
         if (auto jsplits = json.get_ptr("shard_splits")) {
-          route = makeShardSplitRoute<RouterInfo>(
-              std::move(route), ShardSplitter(*jsplits));
+          route = profile(makeShardSplitRoute<RouterInfo>(
+              std::move(route), ShardSplitter(*jsplits)));
         }
       }
       if (auto jasynclog = json.get_ptr("asynclog")) {
@@ -449,7 +463,8 @@ McRouteHandleProvider<RouterInfo>::makePoolRoute(
       }
     }
     if (needAsynclog) {
-      route = createAsynclogRoute(std::move(route), asynclogName.str());
+      route = profile(
+          createAsynclogRoute(std::move(route), asynclogName.str()));
     }
 
     return route;
@@ -502,6 +517,28 @@ McRouteHandleProvider<RouterInfo>::create(
     RouteHandleFactory<RouteHandleIf>& factory,
     folly::StringPiece type,
     const folly::dynamic& json) {
+  auto routes = createRoutes(factory, type, json);
+  for (auto& route : routes) {
+    route = profile(std::move(route));
+  }
+  return routes;
+}
+
+template <class RouterInfo>
+typename McRouteHandleProvider<RouterInfo>::RouteHandlePtr
+McRouteHandleProvider<RouterInfo>::profile(RouteHandlePtr route) {
+  if (!proxy_.routeProfiler()) {
+    return route;
+  }
+  return makeProfileRoute<RouterInfo>(std::move(route));
+}
+
+template <class RouterInfo>
+std::vector<std::shared_ptr<typename RouterInfo::RouteHandleIf>>
+McRouteHandleProvider<RouterInfo>::createRoutes(
+    RouteHandleFactory<RouteHandleIf>& factory,
+    folly::StringPiece type,
+    const folly::dynamic& json) {
   if (type == "Pool") {
     return makePool(factory, poolFactory_.parsePool(json));
   } else if (type == "ShadowRoute") {
@@ -16,6 +16,7 @@
 #include "mcrouter/routes/AllSyncRouteFactory.h"
 #include "mcrouter/routes/BlackholeRoute.h"
 #include "mcrouter/routes/CarbonLookasideRoute.h"
+#include "mcrouter/routes/CoalescingRoute.h"
 #include "mcrouter/routes/DevNullRoute.h"
 #include "mcrouter/routes/ErrorRoute.h"
 #include "mcrouter/routes/FailoverRoute.h"
@@ -112,6 +113,7 @@ McRouteHandleProvider<MemcacheRouterInfo>::buildRouteMap() {
        &createCarbonLookasideRoute<
            MemcacheRouterInfo,
            MemcacheCarbonLookasideHelper>},
+      {"CoalescingRoute", &makeCoalescingRoute},
       {"DevNullRoute", &makeDevNullRoute<MemcacheRouterInfo>},
       {"ErrorRoute", &makeErrorRoute<MemcacheRouterInfo>},
       {"FailoverWithExptimeRoute",
@@ -74,6 +74,10 @@ class McRouteHandleProvider
     return std::move(accessPoints_);
   }
 
+  AsyncDestinationMap<RouterInfo> releaseAsyncDestinations() {
+    return std::move(asyncDestinations_);
+  }
+
   ~McRouteHandleProvider() override;
 
  private:
@@ -92,8 +96,22 @@ class McRouteHandleProvider
       std::vector<std::shared_ptr<const AccessPoint>>>
       accessPoints_;
 
+  // Destination route handles -> DestinationRoute, for AsyncMcClient
+  // destinations when direct_routing is set
+  AsyncDestinationMap<RouterInfo> asyncDestinations_;
+
   const RouteHandleFactoryMap routeMap_;
 
+  std::vector<RouteHandlePtr> createRoutes(
+      RouteHandleFactory<RouteHandleIf>& factory,
+      folly::StringPiece type,
+      const folly::dynamic& json);
+
+  /**
+   * Wraps route in a ProfileRoute if route_profile_sample_rate is set.
+   */
+  RouteHandlePtr profile(RouteHandlePtr route);
+
   const std::vector<RouteHandlePtr>& makePool(
       RouteHandleFactory<RouteHandleIf>& factory,
       const PoolFactory::PoolJson& json);
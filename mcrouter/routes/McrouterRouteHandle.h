@@ -8,13 +8,20 @@
 #pragma once
 
 #include <memory>
+#include <unordered_map>
 
 #include "mcrouter/lib/network/gen/MemcacheRouterInfo.h"
 
 namespace facebook {
 namespace memcache {
+
+class AsyncMcClient;
+
 namespace mcrouter {
 
+template <class RouterInfo, class Transport>
+class DestinationRoute;
+
 template <class Route>
 using McrouterRouteHandle = MemcacheRouteHandle<Route>;
 
@@ -24,6 +31,15 @@ using McrouterRouteHandlePtr = std::shared_ptr<McrouterRouteHandleIf>;
 
 using McrouterRouterInfo = MemcacheRouterInfo;
 
+/**
+ * DestinationRoutes sending with AsyncMcClient, by their route handle. They
+ * can be sent to without a fiber, see DestinationRoute::routeAsync().
+ */
+template <class RouterInfo>
+using AsyncDestinationMap = std::unordered_map<
+    const typename RouterInfo::RouteHandleIf*,
+    std::shared_ptr<const DestinationRoute<RouterInfo, AsyncMcClient>>>;
+
 } // namespace mcrouter
 } // namespace memcache
 } // namespace facebook
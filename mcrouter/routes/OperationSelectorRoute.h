@@ -52,11 +52,12 @@ class OperationSelectorRoute {
   bool traverse(
       const Request& req,
       const RouteHandleTraverser<RouteHandleIf>& t) const {
+    // route() sends the request as is to the policy of its operation.
     if (const auto& rh =
             operationPolicies_.template getByRequestType<Request>()) {
-      return t(*rh, req);
+      return t.forward(*rh, req);
     } else if (defaultPolicy_) {
-      return t(*defaultPolicy_, req);
+      return t.forward(*defaultPolicy_, req);
     }
     return false;
   }
@@ -7,8 +7,10 @@
 
 #pragma once
 
+#include <chrono>
 #include <list>
 #include <memory>
+#include <unordered_map>
 #include <vector>
 
 #include <folly/Conv.h>
@@ -24,6 +26,7 @@
 #include "mcrouter/lib/carbon/RoutingGroups.h"
 #include "mcrouter/lib/config/RouteHandleBuilder.h"
 #include "mcrouter/options.h"
+#include "mcrouter/routes/AdaptiveConcurrencyLimit.h"
 
 namespace folly {
 struct dynamic;
@@ -41,6 +44,10 @@ namespace mcrouter {
  * No more than N requests will be allowed to be concurrently processed by child
  * route. All blocked requests will be sent one request per sender id in
  * round-robin fashion to guarantee fairness.
+ *
+ * N is either fixed, or adapted to the latency of the child (see
+ * AdaptiveConcurrencyLimit). Optionally, requests that were blocked for longer
+ * than maxQueueWait are failed with a BUSY reply instead of waiting further.
  */
 template <class RouterInfo>
 class OutstandingLimitRoute {
@@ -49,6 +56,10 @@ class OutstandingLimitRoute {
 
  public:
   std::string routeName() const {
+    if (adaptiveLimit_) {
+      return folly::to<std::string>(
+          "outstanding-limit|adaptive|limit=", limit());
+    }
     return folly::to<std::string>("outstanding-limit|limit=", maxOutstanding_);
   }
 
@@ -61,13 +72,27 @@ class OutstandingLimitRoute {
 
   OutstandingLimitRoute(
       std::shared_ptr<RouteHandleIf> target,
-      size_t maxOutstanding)
-      : target_(std::move(target)), maxOutstanding_(maxOutstanding) {}
+      size_t maxOutstanding,
+      std::chrono::milliseconds maxQueueWait = std::chrono::milliseconds(0))
+      : target_(std::move(target)),
+        maxOutstanding_(maxOutstanding),
+        maxQueueWait_(maxQueueWait) {}
+
+  OutstandingLimitRoute(
+      std::shared_ptr<RouteHandleIf> target,
+      std::unique_ptr<AdaptiveConcurrencyLimit> adaptiveLimit,
+      std::chrono::milliseconds maxQueueWait = std::chrono::milliseconds(0))
+      : target_(std::move(target)),
+        maxOutstanding_(0),
+        maxQueueWait_(maxQueueWait),
+        adaptiveLimit_(std::move(adaptiveLimit)) {
+    assert(adaptiveLimit_);
+  }
 
   template <class Request>
   ReplyT<Request> route(const Request& req) {
-    if (outstanding_ == maxOutstanding_) {
-      auto& ctx = fiber_local<RouterInfo>::getSharedCtx();
+    auto& ctx = fiber_local<RouterInfo>::getSharedCtx();
+    if (outstanding_ >= limit()) {
       auto senderId = ctx->senderId();
       auto& entry = [&]() -> QueueEntry& {
         auto entry_it = senderIdToEntry_.find(senderId);
@@ -82,7 +107,7 @@ class OutstandingLimitRoute {
       }();
 
       auto& stats = ctx->proxy().stats();
-      folly::fibers::Baton baton;
+      Waiter waiter;
       int64_t waitingSince = 0;
       if (carbon::GetLike<Request>::value) {
         ++currentGetReqsWaiting_;
@@ -91,8 +116,12 @@ class OutstandingLimitRoute {
         ++currentUpdateReqsWaiting_;
         waitingSince = nowUs();
       }
-      entry.batons.push_back(&baton);
-      baton.wait();
+      entry.waiters.push_back(&waiter);
+      if (maxQueueWait_.count() > 0) {
+        waiter.baton.try_wait_for(maxQueueWait_);
+      } else {
+        waiter.baton.wait();
+      }
       if (waitingSince > 0) {
         if (carbon::GetLike<Request>::value) {
           stats.increment(
@@ -114,60 +143,158 @@ class OutstandingLimitRoute {
           stats.increment(outstanding_route_update_reqs_queued_stat, 1);
         }
       }
+      // A waiter that timed out may still have been handed a slot before its
+      // fiber got to run: it then goes on as if it had been woken up.
+      if (!waiter.granted) {
+        removeBlocked(senderId, &waiter);
+        stats.increment(outstanding_route_reqs_shed_stat);
+        return createReply<Request>(
+            ErrorReply,
+            carbon::Result::BUSY,
+            "Request waited too long in outstanding limit queue");
+      }
     } else {
       outstanding_++;
-      assert(outstanding_ <= maxOutstanding_);
     }
 
     SCOPE_EXIT {
-      if (!blockedRequests_.empty()) {
-        auto entry = std::move(blockedRequests_.front());
-        blockedRequests_.pop_front();
-
-        assert(!entry->batons.empty());
-
-        entry->batons.front()->post();
-        entry->batons.pop_front();
-
-        if (!entry->batons.empty()) {
-          blockedRequests_.push_back(std::move(entry));
-        } else {
-          senderIdToEntry_.erase(entry->senderId);
-        }
-      } else {
-        outstanding_--;
-      }
+      releaseSlot();
     };
 
-    return target_->route(req);
+    if (!adaptiveLimit_) {
+      return target_->route(req);
+    }
+
+    const auto inflight = outstanding_;
+    const auto start = nowUs();
+    auto reply = target_->route(req);
+    if (reply.result() == carbon::Result::TIMEOUT ||
+        reply.result() == carbon::Result::BUSY) {
+      adaptiveLimit_->onDrop();
+    } else {
+      adaptiveLimit_->onSample(
+          std::chrono::microseconds(nowUs() - start), inflight);
+    }
+    auto& stats = ctx->proxy().stats();
+    stats.increment(outstanding_route_adaptive_limit_sum_stat, limit());
+    stats.increment(outstanding_route_adaptive_limit_samples_stat);
+    return reply;
   }
 
  private:
   const std::shared_ptr<RouteHandleIf> target_;
   const size_t maxOutstanding_;
+  const std::chrono::milliseconds maxQueueWait_;
+  const std::unique_ptr<AdaptiveConcurrencyLimit> adaptiveLimit_;
   size_t outstanding_{0};
   size_t currentGetReqsWaiting_{0};
   size_t currentUpdateReqsWaiting_{0};
 
+  struct Waiter {
+    folly::fibers::Baton baton;
+    // Set when the waiter is handed a slot. Its baton may have timed out
+    // already, in which case the post is a no-op.
+    bool granted{false};
+  };
+
   struct QueueEntry {
     QueueEntry(QueueEntry&&) = delete;
     QueueEntry& operator=(QueueEntry&&) = delete;
 
     explicit QueueEntry(size_t senderId_) : senderId(senderId_) {}
     size_t senderId;
-    std::list<folly::fibers::Baton*> batons;
+    std::list<Waiter*> waiters;
   };
 
   std::list<std::unique_ptr<QueueEntry>> blockedRequests_;
   std::unordered_map<size_t, QueueEntry*> senderIdToEntry_;
+
+  size_t limit() const {
+    return adaptiveLimit_ ? adaptiveLimit_->limit() : maxOutstanding_;
+  }
+
+  /**
+   * Hands the slot of a completed request over to the next blocked request,
+   * and wakes up more of them if the limit went up.
+   */
+  void releaseSlot() {
+    if (outstanding_ > limit() || blockedRequests_.empty()) {
+      outstanding_--;
+    } else {
+      wakeNext();
+    }
+    while (outstanding_ < limit() && !blockedRequests_.empty()) {
+      outstanding_++;
+      wakeNext();
+    }
+  }
+
+  void wakeNext() {
+    auto entry = std::move(blockedRequests_.front());
+    blockedRequests_.pop_front();
+
+    assert(!entry->waiters.empty());
+
+    auto* waiter = entry->waiters.front();
+    entry->waiters.pop_front();
+    waiter->granted = true;
+    waiter->baton.post();
+
+    if (!entry->waiters.empty()) {
+      blockedRequests_.push_back(std::move(entry));
+    } else {
+      senderIdToEntry_.erase(entry->senderId);
+    }
+  }
+
+  /**
+   * Removes a waiter that timed out before being granted a slot. Its entry
+   * may have been moved around (or, for other waiters of the same sender,
+   * emptied and recreated) while it was waiting, so it is looked up again.
+   */
+  void removeBlocked(size_t senderId, Waiter* waiter) {
+    auto it = blockedRequests_.begin();
+    if (senderId) {
+      auto entryIt = senderIdToEntry_.find(senderId);
+      assert(entryIt != senderIdToEntry_.end());
+      auto& waiters = entryIt->second->waiters;
+      waiters.remove(waiter);
+      if (!waiters.empty()) {
+        return;
+      }
+      senderIdToEntry_.erase(entryIt);
+      while (it->get()->senderId != senderId) {
+        ++it;
+      }
+    } else {
+      // Requests without a sender id get an entry of their own.
+      while (it->get()->waiters.front() != waiter) {
+        ++it;
+      }
+    }
+    blockedRequests_.erase(it);
+  }
 };
 
 template <class RouterInfo>
 std::shared_ptr<typename RouterInfo::RouteHandleIf> makeOutstandingLimitRoute(
     std::shared_ptr<typename RouterInfo::RouteHandleIf> normalRoute,
-    size_t maxOutstanding) {
+    size_t maxOutstanding,
+    std::chrono::milliseconds maxQueueWait = std::chrono::milliseconds(0)) {
+  return makeRouteHandleWithInfo<RouterInfo, OutstandingLimitRoute>(
+      std::move(normalRoute), maxOutstanding, maxQueueWait);
+}
+
+template <class RouterInfo>
+std::shared_ptr<typename RouterInfo::RouteHandleIf>
+makeAdaptiveOutstandingLimitRoute(
+    std::shared_ptr<typename RouterInfo::RouteHandleIf> normalRoute,
+    const AdaptiveConcurrencyLimit& adaptiveLimit,
+    std::chrono::milliseconds maxQueueWait = std::chrono::milliseconds(0)) {
   return makeRouteHandleWithInfo<RouterInfo, OutstandingLimitRoute>(
-      std::move(normalRoute), maxOutstanding);
+      std::move(normalRoute),
+      std::make_unique<AdaptiveConcurrencyLimit>(adaptiveLimit),
+      maxQueueWait);
 }
 
 } // mcrouter
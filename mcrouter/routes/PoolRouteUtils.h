@@ -7,6 +7,7 @@
 
 #pragma once
 
+#include <chrono>
 #include <memory>
 #include <vector>
 
@@ -35,6 +36,8 @@ class ExtraRouteHandleProviderIf;
  * @param poolName        The name of the pool that "destinations" belong to.
  * @param json            Json containing basic PoolRoute settings:
  *                           - "max_outstanding" (optional),
+ *                           - "adaptive_outstanding" (optional),
+ *                           - "max_outstanding_queue_wait_ms" (optional),
  *                           - "slow_warmup" (optional),
  *                           - "shadows", "shadow_policy" (optional)
  * @param proxy           Instance of ProxyBase.
@@ -54,12 +57,31 @@ std::vector<typename RouterInfo::RouteHandlePtr> wrapPoolDestinations(
     ExtraRouteHandleProviderIf<RouterInfo>& extraProvider) {
   try {
     if (json.isObject()) {
+      std::chrono::milliseconds maxQueueWait(0);
+      if (auto maxQueueWaitJson =
+              json.get_ptr("max_outstanding_queue_wait_ms")) {
+        maxQueueWait =
+            parseTimeout(*maxQueueWaitJson, "max_outstanding_queue_wait_ms");
+      }
+      if (auto adaptiveJson = json.get_ptr("adaptive_outstanding")) {
+        checkLogic(
+            !json.count("max_outstanding"),
+            "max_outstanding and adaptive_outstanding are mutually exclusive");
+        checkLogic(
+            adaptiveJson->isObject(),
+            "adaptive_outstanding must be a json object");
+        AdaptiveConcurrencyLimit adaptiveLimit(*adaptiveJson);
+        for (auto& destination : destinations) {
+          destination = makeAdaptiveOutstandingLimitRoute<RouterInfo>(
+              std::move(destination), adaptiveLimit, maxQueueWait);
+        }
+      }
       if (auto maxOutstandingJson = json.get_ptr("max_outstanding")) {
         auto v = parseInt(*maxOutstandingJson, "max_outstanding", 0, 1000000);
         if (v) {
           for (auto& destination : destinations) {
             destination = makeOutstandingLimitRoute<RouterInfo>(
-                std::move(destination), v);
+                std::move(destination), v, maxQueueWait);
           }
         }
       }
@@ -9,6 +9,7 @@
 
 #include <algorithm>
 #include <memory>
+#include <string>
 #include <utility>
 #include <vector>
 
@@ -16,7 +17,7 @@
 #include <folly/dynamic.h>
 
 #include "mcrouter/lib/config/RouteHandleFactory.h"
-#include "mcrouter/lib/fbi/cpp/Trie.h"
+#include "mcrouter/lib/fbi/cpp/CompactTrie.h"
 #include "mcrouter/lib/fbi/cpp/util.h"
 
 namespace facebook {
@@ -31,7 +32,7 @@ template <class RouteHandleIf>
 class PrefixSelectorRoute {
  public:
   /// Trie that acts like map from key prefix to corresponding RouteHandle.
-  Trie<std::shared_ptr<RouteHandleIf>> policies;
+  CompactTrie<std::shared_ptr<RouteHandleIf>> policies;
   /// Used when no RouteHandle found in policies
   std::shared_ptr<RouteHandleIf> wildcard;
 
@@ -64,9 +65,14 @@ class PrefixSelectorRoute {
       }
       // order is important
       std::sort(items.begin(), items.end());
+      std::vector<std::pair<std::string, std::shared_ptr<RouteHandleIf>>>
+          created;
+      created.reserve(items.size());
       for (const auto& it : items) {
-        policies.emplace(it.first, factory.create(*it.second));
+        created.emplace_back(it.first.str(), factory.create(*it.second));
       }
+      policies =
+          CompactTrie<std::shared_ptr<RouteHandleIf>>(std::move(created));
     }
 
     if (jWildcard) {
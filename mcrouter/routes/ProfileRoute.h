@@ -0,0 +1,102 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <string>
+
+#include <folly/Likely.h>
+#include <folly/ScopeGuard.h>
+
+#include "mcrouter/McrouterFiberContext.h"
+#include "mcrouter/ProxyRequestContext.h"
+#include "mcrouter/RouteProfiler.h"
+#include "mcrouter/lib/RouteHandleTraverser.h"
+#include "mcrouter/routes/McRouteHandleBuilder.h"
+
+namespace facebook {
+namespace memcache {
+namespace mcrouter {
+
+/**
+ * Transparent wrapper recording the time spent in its child for requests
+ * sampled by the RouteProfiler of the proxy. Other requests only pay for
+ * a check of the request context.
+ *
+ * Only created when route_profile_sample_rate is set, see
+ * makeProfileRoute().
+ */
+template <class RouterInfo>
+class ProfileRoute {
+ public:
+  using RouteHandleIf = typename RouterInfo::RouteHandleIf;
+  using RouteHandlePtr = typename RouterInfo::RouteHandlePtr;
+
+  explicit ProfileRoute(RouteHandlePtr rh)
+      : rh_(std::move(rh)), name_(rh_->routeName()) {
+    assert(rh_);
+    // ';' separates frames and ' ' the value in folded stacks.
+    std::replace(name_.begin(), name_.end(), ';', ',');
+    std::replace(name_.begin(), name_.end(), ' ', '_');
+  }
+
+  std::string routeName() const {
+    return rh_->routeName();
+  }
+
+  template <class Request>
+  bool traverse(
+      const Request& req,
+      const RouteHandleTraverser<RouteHandleIf>& t) const {
+    return rh_->traverse(req, t);
+  }
+
+  template <class Request>
+  ReplyT<Request> route(const Request& req) const {
+    const auto& ctx = fiber_local<RouterInfo>::getSharedCtx();
+    if (LIKELY(!ctx || !ctx->routeProfileTrace())) {
+      return rh_->route(req);
+    }
+
+    // Keeps the trace alive even if a child replaces the context.
+    auto sampledCtx = ctx;
+    auto& trace = *sampledCtx->routeProfileTrace();
+    const auto parent = fiber_local<RouterInfo>::getRouteProfileFrame();
+    const auto frame = trace.enter(
+        name_, parent, fiber_local<RouterInfo>::getContextId());
+    fiber_local<RouterInfo>::setRouteProfileFrame(frame);
+    SCOPE_EXIT {
+      trace.exit(frame);
+      fiber_local<RouterInfo>::setRouteProfileFrame(parent);
+    };
+    return rh_->route(req);
+  }
+
+ private:
+  const RouteHandlePtr rh_;
+  std::string name_;
+};
+
+/**
+ * Wraps rh in a ProfileRoute, unless it already is one.
+ */
+template <class RouterInfo>
+typename RouterInfo::RouteHandlePtr makeProfileRoute(
+    typename RouterInfo::RouteHandlePtr rh) {
+  using ProfileRouteHandle = typename RouterInfo::RouteHandleIf::template Impl<
+      ProfileRoute<RouterInfo>>;
+  if (!rh || dynamic_cast<const ProfileRouteHandle*>(rh.get())) {
+    return rh;
+  }
+  return makeRouteHandleWithInfo<RouterInfo, ProfileRoute>(std::move(rh));
+}
+
+} // namespace mcrouter
+} // namespace memcache
+} // namespace facebook
@@ -11,7 +11,9 @@
 
 #include "mcrouter/Proxy.h"
 #include "mcrouter/lib/config/RouteHandleBuilder.h"
+#include "mcrouter/lib/network/AsyncMcClient.h"
 #include "mcrouter/lib/network/gen/MemcacheRouteHandleIf.h"
+#include "mcrouter/routes/DestinationRoute.h"
 #include "mcrouter/routes/LoggingRoute.h"
 #include "mcrouter/routes/McRouteHandleBuilder.h"
 #include "mcrouter/routes/RootRoute.h"
@@ -53,11 +55,15 @@ wrapWithBigValueRoute(
 template <class RouterInfo>
 ProxyRoute<RouterInfo>::ProxyRoute(
     Proxy<RouterInfo>& proxy,
-    const RouteSelectorMap<typename RouterInfo::RouteHandleIf>& routeSelectors)
+    const RouteSelectorMap<typename RouterInfo::RouteHandleIf>& routeSelectors,
+    AsyncDestinationMap<RouterInfo> asyncDestinations)
     : proxy_(proxy),
       root_(makeRouteHandle<typename RouterInfo::RouteHandleIf, RootRoute>(
           proxy_,
-          routeSelectors)) {
+          routeSelectors,
+          typename RouterInfo::RoutableRequests())),
+      asyncDestinations_(std::move(asyncDestinations)) {
+  auto unwrappedRoot = root_.get();
   if (proxy_.getRouterOptions().big_value_split_threshold != 0) {
     root_ = detail::wrapWithBigValueRoute(
         std::move(root_), proxy_.getRouterOptions());
@@ -65,6 +71,72 @@ ProxyRoute<RouterInfo>::ProxyRoute(
   if (proxy_.getRouterOptions().enable_logging_route) {
     root_ = createLoggingRoute<RouterInfo>(std::move(root_));
   }
+  directRouting_ = proxy_.getRouterOptions().direct_routing &&
+      root_.get() == unwrappedRoot;
+}
+
+template <class RouterInfo>
+template <class Request>
+typename RouterInfo::RouteHandleIf* ProxyRoute<RouterInfo>::directTarget(
+    const Request& req) const {
+  using RouteHandleIf = typename RouterInfo::RouteHandleIf;
+
+  if (!directRouting_) {
+    return nullptr;
+  }
+
+  // RootRoute decided when the config was loaded whether the target of req
+  // is the head of a forward chain. Down the chain, route handles only
+  // select the child they forward req to.
+  RouteHandleIf* target = nullptr;
+  RouteHandleTraverser<RouteHandleIf> t(
+      nullptr, nullptr, nullptr, [&target](RouteHandleIf& child) {
+        target = &child;
+      });
+  t.options().setForwardOnly(true);
+  try {
+    root_->traverse(req, t);
+  } catch (const std::exception&) {
+    return nullptr;
+  }
+  return target;
+}
+
+template <class RouterInfo>
+template <class Request>
+ReplyT<Request> ProxyRoute<RouterInfo>::routeDirect(
+    typename RouterInfo::RouteHandleIf& target,
+    const Request& req) const {
+  return finishRoute(RootRoute<typename RouterInfo::RouteHandleIf>::routeDirect(
+      proxy_.getRouterOptions(), target, req));
+}
+
+template <class RouterInfo>
+template <class Request, class F>
+bool ProxyRoute<RouterInfo>::routeDirectAsync(
+    typename RouterInfo::RouteHandleIf& target,
+    const Request& req,
+    std::shared_ptr<ProxyRequestContextWithInfo<RouterInfo>> ctx,
+    F&& callback) const {
+  using Root = RootRoute<typename RouterInfo::RouteHandleIf>;
+
+  auto it = asyncDestinations_.find(&target);
+  if (it == asyncDestinations_.end() ||
+      !Root::mayRoute(proxy_.getRouterOptions(), req)) {
+    return false;
+  }
+  auto& ctxRef = *ctx;
+  it->second->routeAsync(
+      req,
+      ctxRef,
+      [this, &req, ctx = std::move(ctx), callback = std::forward<F>(callback)](
+          ReplyT<Request>&& reply) mutable {
+        callback(finishRoute(
+            Root::processDirectReply(
+                proxy_.getRouterOptions(), req, std::move(reply)),
+            *ctx));
+      });
+  return true;
 }
 
 template <class RouterInfo>
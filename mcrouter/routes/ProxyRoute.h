@@ -20,6 +20,7 @@
 #include "mcrouter/lib/network/gen/MemcacheMessages.h"
 #include "mcrouter/lib/routes/AllSyncRoute.h"
 #include "mcrouter/routes/BigValueRouteIf.h"
+#include "mcrouter/routes/McrouterRouteHandle.h"
 #include "mcrouter/routes/RouteSelectorMap.h"
 #include "mcrouter/stats.h"
 
@@ -43,7 +44,9 @@ class ProxyRoute {
   ProxyRoute(
       Proxy<RouterInfo>& proxy,
       const RouteSelectorMap<typename RouterInfo::RouteHandleIf>&
-          routeSelectors);
+          routeSelectors,
+      AsyncDestinationMap<RouterInfo> asyncDestinations =
+          AsyncDestinationMap<RouterInfo>());
 
   template <class Request>
   bool traverse(
@@ -54,16 +57,7 @@ class ProxyRoute {
 
   template <class Request>
   ReplyT<Request> route(const Request& req) const {
-    auto reply = root_->route(req);
-
-    auto& requestContext = fiber_local<RouterInfo>::getSharedCtx();
-    requestContext->setFinalResult(reply.result());
-
-    if (isErrorResult(reply.result())) {
-      proxy_.stats().increment(final_result_error_stat);
-    }
-
-    return reply;
+    return finishRoute(root_->route(req));
   }
 
   McFlushAllReply route(const McFlushAllRequest& req) const {
@@ -73,9 +67,76 @@ class ProxyRoute {
         .route(req);
   }
 
+  /**
+   * If direct_routing is enabled, finds the route handle the tree routes req
+   * to, when the tree is a chain of route handles forwarding req as is (see
+   * RouteHandleTraverser::forward()) down to a single destination. Which
+   * targets of the route handle map start such a chain is decided when the
+   * config is loaded: per request, only the selectors of the chain run. Does
+   * not need to run on a fiber.
+   *
+   * @return  The route handle to pass to routeDirect(), or nullptr if req
+   *          must go through route().
+   */
+  template <class Request>
+  typename RouterInfo::RouteHandleIf* directTarget(const Request& req) const;
+
+  typename RouterInfo::RouteHandleIf* directTarget(
+      const McFlushAllRequest&) const {
+    return nullptr;
+  }
+
+  /**
+   * Same as route(req), given target = directTarget(req).
+   */
+  template <class Request>
+  ReplyT<Request> routeDirect(
+      typename RouterInfo::RouteHandleIf& target,
+      const Request& req) const;
+
+  /**
+   * Same as routeDirect(target, req), without a fiber, if the destination
+   * target routes to is sent to with AsyncMcClient (see
+   * DestinationRoute::routeAsync()): the whole route then runs in the main
+   * context, with no fiber locals.
+   *
+   * @param callback  void(ReplyT<Request>&&), called with the reply from the
+   *                  EventBase loop (or before routeDirectAsync() returns, if
+   *                  req is not sent). req must stay alive until then.
+   * @return  False if req needs a fiber, nothing is done in that case.
+   */
+  template <class Request, class F>
+  bool routeDirectAsync(
+      typename RouterInfo::RouteHandleIf& target,
+      const Request& req,
+      std::shared_ptr<ProxyRequestContextWithInfo<RouterInfo>> ctx,
+      F&& callback) const;
+
  private:
   Proxy<RouterInfo>& proxy_;
   std::shared_ptr<typename RouterInfo::RouteHandleIf> root_;
+  // root_ is a RootRoute (not wrapped) and direct_routing is enabled.
+  bool directRouting_{false};
+  const AsyncDestinationMap<RouterInfo> asyncDestinations_;
+
+  template <class Reply>
+  Reply finishRoute(Reply reply) const {
+    return finishRoute(
+        std::move(reply), *fiber_local<RouterInfo>::getSharedCtx());
+  }
+
+  template <class Reply>
+  Reply finishRoute(
+      Reply reply,
+      ProxyRequestContextWithInfo<RouterInfo>& requestContext) const {
+    requestContext.setFinalResult(reply.result());
+
+    if (isErrorResult(reply.result())) {
+      proxy_.stats().increment(final_result_error_stat);
+    }
+
+    return reply;
+  }
 
   std::vector<std::shared_ptr<typename RouterInfo::RouteHandleIf>>
   getAllDestinations() const;
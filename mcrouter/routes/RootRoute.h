@@ -7,8 +7,11 @@
 
 #pragma once
 
+#include <algorithm>
 #include <memory>
 #include <string>
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 #include <folly/Likely.h>
@@ -20,7 +23,9 @@
 #include "mcrouter/lib/carbon/RequestReplyUtil.h"
 #include "mcrouter/lib/carbon/RoutingGroups.h"
 #include "mcrouter/lib/mc/msg.h"
+#include "mcrouter/routes/PrefixSelectorRoute.h"
 #include "mcrouter/routes/RouteHandleMap.h"
+#include "mcrouter/routes/RouteSelectorMap.h"
 
 namespace facebook {
 namespace memcache {
@@ -42,12 +47,37 @@ class RootRoute {
             opts_.default_route,
             opts_.send_invalid_route_to_default) {}
 
+  /**
+   * If direct_routing is enabled, also finds which route handles of the map
+   * are the head of a forward chain for each of requests, see
+   * ProxyRoute::directTarget().
+   */
+  template <class RequestList>
+  RootRoute(
+      ProxyBase& proxy,
+      const RouteSelectorMap<RouteHandleIf>& routeSelectors,
+      RequestList requests)
+      : RootRoute(proxy, routeSelectors) {
+    if (opts_.direct_routing) {
+      cacheForwardChains(routeSelectors, requests);
+    }
+  }
+
   template <class Request>
   bool traverse(
       const Request& req,
       const RouteHandleTraverser<RouteHandleIf>& t) const {
     const auto* rhPtr = rhMap_.getTargetsForKeyFast(
         req.key().routingPrefix(), req.key().routingKey());
+    if (UNLIKELY(t.options().getForwardOnly())) {
+      // Only the single target of a forward chain is walked down. Other
+      // targets are left to route().
+      if (rhPtr != nullptr && rhPtr->size() == 1 &&
+          isForwardChainHead<Request>(*(*rhPtr)[0])) {
+        return (*rhPtr)[0]->traverse(req, t);
+      }
+      return false;
+    }
     if (LIKELY(rhPtr != nullptr)) {
       for (const auto& rh : *rhPtr) {
         if (t(*rh, req)) {
@@ -76,33 +106,195 @@ class RootRoute {
     const auto* rhPtr = rhMap_.getTargetsForKeyFast(
         req.key().routingPrefix(), req.key().routingKey());
 
-    auto reply = UNLIKELY(rhPtr == nullptr)
-        ? routeImpl(
+    return UNLIKELY(rhPtr == nullptr)
+        ? routeTargets(
+              opts_,
               rhMap_.getTargetsForKeySlow(
                   req.key().routingPrefix(), req.key().routingKey()),
               req)
-        : routeImpl(*rhPtr, req);
+        : routeTargets(opts_, *rhPtr, req);
+  }
 
-    if (isErrorResult(reply.result()) && opts_.group_remote_errors) {
-      reply = ReplyT<Request>(carbon::Result::REMOTE_ERROR);
-    }
+  /**
+   * Routes req to target, that the only route handle for the key of req
+   * forwards req to (maybe through others), processing the reply the same
+   * way route() does. See ProxyRoute::directTarget().
+   */
+  template <class Request>
+  static ReplyT<Request> routeDirect(
+      const McrouterOptions& opts,
+      RouteHandleIf& target,
+      const Request& req) {
+    return routeAndProcess(
+        opts, req, true /* hasTargets */, [&target, &req]() {
+          return target.route(req);
+        });
+  }
 
-    return reply;
+  /**
+   * @return  False iff requests like req are not routed at all, but replied
+   *          with a default reply (allow_only_gets).
+   */
+  template <class Request>
+  static bool mayRoute(const McrouterOptions& opts, const Request&) {
+    return !opts.allow_only_gets || carbon::GetLike<Request>::value;
+  }
+
+  /**
+   * Processes the reply of target (see routeDirect()) to req, which is
+   * routed, see mayRoute().
+   */
+  template <class Request>
+  static ReplyT<Request> processDirectReply(
+      const McrouterOptions& opts,
+      const Request& req,
+      ReplyT<Request> reply) {
+    return processReply(opts, req, true /* hasTargets */, std::move(reply));
   }
 
  private:
   const McrouterOptions& opts_;
   RouteHandleMap<RouteHandleIf> rhMap_;
+  // Route handles of rhMap_ that are the head of a forward chain, with
+  // whether they are one for requests of each type id.
+  std::unordered_map<const RouteHandleIf*, std::vector<bool>> forwardChains_;
 
   template <class Request>
-  ReplyT<Request> routeImpl(
+  bool isForwardChainHead(const RouteHandleIf& rh) const {
+    auto it = forwardChains_.find(&rh);
+    return it != forwardChains_.end() &&
+        Request::typeId < it->second.size() && it->second[Request::typeId];
+  }
+
+  template <class RequestList>
+  void cacheForwardChains(
+      const RouteSelectorMap<RouteHandleIf>& routeSelectors,
+      RequestList requests) {
+    std::unordered_set<RouteHandleIf*> heads;
+    for (const auto& it : routeSelectors) {
+      if (it.second->wildcard) {
+        heads.insert(it.second->wildcard.get());
+      }
+      for (const auto& policy : it.second->policies) {
+        heads.insert(policy.second.get());
+      }
+    }
+    for (auto head : heads) {
+      std::vector<bool> chains(
+          carbon::RequestListLimits<RequestList>::maxTypeId + 1);
+      checkForwardChains(*head, chains, requests);
+      if (std::find(chains.begin(), chains.end(), true) != chains.end()) {
+        forwardChains_.emplace(head, std::move(chains));
+      }
+    }
+  }
+
+  static void checkForwardChains(
+      RouteHandleIf& /* head */,
+      std::vector<bool>& /* chains */,
+      carbon::List<>) {}
+
+  template <class Request, class... Requests>
+  static void checkForwardChains(
+      RouteHandleIf& head,
+      std::vector<bool>& chains,
+      carbon::List<Request, Requests...>) {
+    chains[Request::typeId] = isForwardChain(head, Request());
+    checkForwardChains(head, chains, carbon::List<Requests...>());
+  }
+
+  /**
+   * @return  True iff head forwards requests like req (see
+   *          RouteHandleTraverser::forward()), and so does every route handle
+   *          below it down to a single destination, whatever child route
+   *          handles select for the key of the request.
+   */
+  template <class Request>
+  static bool isForwardChain(RouteHandleIf& head, const Request& req) {
+    struct Node {
+      size_t forwards{0};
+      size_t destinations{0};
+    };
+    std::vector<Node> nodes(1);
+    bool forwarded = false;
+    bool chain = true;
+    RouteHandleTraverser<RouteHandleIf> t(
+        [&](const RouteHandleIf&) {
+          chain = chain && forwarded;
+          forwarded = false;
+          nodes.emplace_back();
+        },
+        [&]() {
+          const auto node = nodes.back();
+          nodes.pop_back();
+          chain = chain &&
+              (node.forwards == 0 ? node.destinations == 1
+                                  : node.destinations == 0);
+        },
+        [&nodes](const AccessPoint&, const PoolContext&) {
+          ++nodes.back().destinations;
+          return false;
+        },
+        [&](RouteHandleIf&) {
+          forwarded = true;
+          ++nodes.back().forwards;
+        });
+    t.options().setForwardAll(true);
+    try {
+      head.traverse(req, t);
+    } catch (const std::exception&) {
+      return false;
+    }
+    return chain && nodes.back().forwards != 0 &&
+        nodes.back().destinations == 0;
+  }
+
+  template <class Request>
+  static ReplyT<Request> routeTargets(
+      const McrouterOptions& opts,
       const std::vector<std::shared_ptr<RouteHandleIf>>& rh,
+      const Request& req) {
+    return routeAndProcess(
+        opts, req, !rh.empty(), [&rh, &req]() { return doRoute(rh, req); });
+  }
+
+  template <class Request, class RouteFn>
+  static ReplyT<Request> routeAndProcess(
+      const McrouterOptions& opts,
       const Request& req,
-      carbon::GetLikeT<Request> = 0) const {
-    auto reply = doRoute(rh, req);
-    if (isErrorResult(reply.result()) && opts_.miss_on_get_errors &&
-        !rh.empty()) {
-      /* rh.empty() case: for backwards compatibility,
+      bool hasTargets,
+      RouteFn&& routeFn) {
+    if (!mayRoute(opts, req)) {
+      return createReply(DefaultReply, req);
+    }
+    return processReply(opts, req, hasTargets, routeFn());
+  }
+
+  template <class Request>
+  static ReplyT<Request> processReply(
+      const McrouterOptions& opts,
+      const Request& req,
+      bool hasTargets,
+      ReplyT<Request> reply) {
+    reply = processReplyImpl(opts, req, hasTargets, std::move(reply));
+
+    if (isErrorResult(reply.result()) && opts.group_remote_errors) {
+      reply = ReplyT<Request>(carbon::Result::REMOTE_ERROR);
+    }
+
+    return reply;
+  }
+
+  template <class Request>
+  static ReplyT<Request> processReplyImpl(
+      const McrouterOptions& opts,
+      const Request& req,
+      bool hasTargets,
+      ReplyT<Request> reply,
+      carbon::GetLikeT<Request> = 0) {
+    if (isErrorResult(reply.result()) && opts.miss_on_get_errors &&
+        hasTargets) {
+      /* !hasTargets case: for backwards compatibility,
          always surface invalid routing errors */
       auto originalResult = reply.result();
       reply = createReply(DefaultReply, req);
@@ -117,12 +309,12 @@ class RootRoute {
   }
 
   template <class Request>
-  ReplyT<Request> routeImpl(
-      const std::vector<std::shared_ptr<RouteHandleIf>>& rh,
+  static ReplyT<Request> processReplyImpl(
+      const McrouterOptions& /* opts */,
       const Request& req,
-      carbon::ArithmeticLikeT<Request> = 0) const {
-    auto reply = opts_.allow_only_gets ? createReply(DefaultReply, req)
-                                       : doRoute(rh, req);
+      bool /* hasTargets */,
+      ReplyT<Request> reply,
+      carbon::ArithmeticLikeT<Request> = 0) {
     if (isErrorResult(reply.result())) {
       reply = createReply(DefaultReply, req);
     }
@@ -130,22 +322,20 @@ class RootRoute {
   }
 
   template <class Request>
-  ReplyT<Request> routeImpl(
-      const std::vector<std::shared_ptr<RouteHandleIf>>& rh,
-      const Request& req,
+  static ReplyT<Request> processReplyImpl(
+      const McrouterOptions& /* opts */,
+      const Request& /* req */,
+      bool /* hasTargets */,
+      ReplyT<Request> reply,
       carbon::OtherThanT<Request, carbon::GetLike<>, carbon::ArithmeticLike<>> =
-          0) const {
-    if (!opts_.allow_only_gets) {
-      return doRoute(rh, req);
-    }
-
-    return createReply(DefaultReply, req);
+          0) {
+    return reply;
   }
 
   template <class Request>
-  ReplyT<Request> doRoute(
+  static ReplyT<Request> doRoute(
       const std::vector<std::shared_ptr<RouteHandleIf>>& rh,
-      const Request& req) const {
+      const Request& req) {
     if (!rh.empty()) {
       if (rh.size() > 1) {
         auto reqCopy = std::make_shared<const Request>(req);
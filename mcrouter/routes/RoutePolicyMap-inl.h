@@ -8,9 +8,11 @@
 #pragma once
 
 #include <algorithm>
+#include <string>
 #include <unordered_set>
 #include <utility>
 
+#include "mcrouter/lib/fbi/cpp/Trie.h"
 #include "mcrouter/routes/PrefixSelectorRoute.h"
 
 namespace facebook {
@@ -72,18 +74,23 @@ RoutePolicyMap<RouteHandleIf>::RoutePolicyMap(
     }
   }
 
-  ut_.emplace("", std::move(wildcards));
+  Trie<std::vector<std::shared_ptr<RouteHandleIf>>> ut;
+  ut.emplace("", std::move(wildcards));
   // we iterate over keys in lexicographic order, so all prefixes of key will go
   // before key itself
   for (auto& it : t) {
-    auto existing = ut_.findPrefix(it.first);
+    auto existing = ut.findPrefix(it.first);
     // at least empty string should be there
-    assert(existing != ut_.end());
-    ut_.emplace(it.first, detail::overrideItems(existing->second, it.second));
+    assert(existing != ut.end());
+    ut.emplace(it.first, detail::overrideItems(existing->second, it.second));
   }
-  for (auto& it : ut_) {
-    it.second = detail::orderedUnique(it.second);
+
+  using TargetsTrie = CompactTrie<std::vector<std::shared_ptr<RouteHandleIf>>>;
+  std::vector<typename TargetsTrie::value_type> targets;
+  for (auto& it : ut) {
+    targets.emplace_back(it.first, detail::orderedUnique(it.second));
   }
+  ut_ = TargetsTrie(std::move(targets));
 }
 
 template <class RouteHandleIf>
@@ -12,7 +12,7 @@
 
 #include <folly/Range.h>
 
-#include "mcrouter/lib/fbi/cpp/Trie.h"
+#include "mcrouter/lib/fbi/cpp/CompactTrie.h"
 
 namespace facebook {
 namespace memcache {
@@ -61,12 +61,13 @@ class RoutePolicyMap {
  private:
   const std::vector<std::shared_ptr<RouteHandleIf>> emptyV_;
   /**
-   * This Trie contains targets for each key prefix. It is built like this:
+   * This trie contains targets for each key prefix. It is built like this:
    * 1) targets for empty string are wildcards.
    * 2) targets for string of length n+1 S[0..n] are targets for S[0..n-1] with
    *    OperationSelectorRoutes for key prefix == S[0..n] overridden.
+   * It is looked up on every request and never modified after construction.
    */
-  Trie<std::vector<std::shared_ptr<RouteHandleIf>>> ut_;
+  CompactTrie<std::vector<std::shared_ptr<RouteHandleIf>>> ut_;
 };
 }
 }
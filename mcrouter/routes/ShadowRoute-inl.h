@@ -7,10 +7,14 @@
 
 #pragma once
 
+#include <functional>
 #include <memory>
 #include <utility>
+#include <vector>
 
+#include <folly/ScopeGuard.h>
 #include <folly/fibers/FiberManager.h>
+#include <folly/fibers/WhenN.h>
 
 namespace facebook {
 namespace memcache {
@@ -18,22 +22,53 @@ namespace mcrouter {
 
 template <class RouterInfo, class ShadowPolicy>
 template <class Request>
-void ShadowRoute<RouterInfo, ShadowPolicy>::dispatchShadowRequest(
-    std::shared_ptr<typename RouterInfo::RouteHandleIf> shadow,
-    std::shared_ptr<Request> adjustedReq,
-    folly::Function<void(const ReplyT<Request>&)> postShadowReplyFn) const {
-  folly::fibers::addTask(
-      [shadow = std::move(shadow),
-       adjustedReq = std::move(adjustedReq),
-       postShadowReplyFn = std::move(postShadowReplyFn)]() mutable {
-        // we don't want to spool shadow requests
-        fiber_local<RouterInfo>::clearAsynclogName();
-        fiber_local<RouterInfo>::addRequestClass(RequestClass::kShadow);
-        const auto shadowReply = shadow->route(*adjustedReq);
-        if (postShadowReplyFn) {
-          postShadowReplyFn(shadowReply);
-        }
-      });
+void ShadowRoute<RouterInfo, ShadowPolicy>::dispatchShadowRequests(
+    ShadowBatch<Request> batch,
+    ProxyBase* proxy,
+    size_t shadowBytes) const {
+  auto routeShadow = [](ShadowRequest<Request>& shadow) {
+    // we don't want to spool shadow requests
+    fiber_local<RouterInfo>::clearAsynclogName();
+    fiber_local<RouterInfo>::addRequestClass(RequestClass::kShadow);
+    const auto shadowReply = shadow.route->route(*shadow.request);
+    if (shadow.postShadowReplyFn) {
+      shadow.postShadowReplyFn(shadowReply);
+    }
+  };
+
+  if (proxy && batch.size() > 1) {
+    proxy->stats().increment(shadow_requests_batched_stat, batch.size());
+  }
+  folly::fibers::addTask([batch = std::move(batch),
+                          proxy,
+                          shadowBytes,
+                          routeShadow]() mutable {
+    SCOPE_EXIT {
+      releaseShadowBytes(proxy, shadowBytes);
+    };
+    if (batch.size() == 1) {
+      routeShadow(batch[0]);
+      return;
+    }
+    // Shadows are still sent concurrently, so that a slow shadow doesn't
+    // delay the others: collectAll() runs each of them on a fiber of its own.
+    std::vector<std::function<void()>> fs;
+    fs.reserve(batch.size());
+    for (auto& shadow : batch) {
+      fs.push_back([&shadow, &routeShadow]() { routeShadow(shadow); });
+    }
+    folly::fibers::collectAll(fs.begin(), fs.end());
+  });
+}
+
+template <class RouterInfo, class ShadowPolicy>
+void ShadowRoute<RouterInfo, ShadowPolicy>::releaseShadowBytes(
+    ProxyBase* proxy,
+    size_t shadowBytes) {
+  if (proxy) {
+    proxy->shadowBudget().release(shadowBytes);
+    proxy->stats().decrement(shadow_bytes_outstanding_stat, shadowBytes);
+  }
 }
 
 template <class RouterInfo>
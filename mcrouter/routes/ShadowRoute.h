@@ -15,12 +15,15 @@
 
 #include <folly/Function.h>
 #include <folly/Optional.h>
+#include <folly/ScopeGuard.h>
+#include <folly/small_vector.h>
 
 #include "mcrouter/McrouterFiberContext.h"
 #include "mcrouter/McrouterLogFailure.h"
 #include "mcrouter/ProxyBase.h"
 #include "mcrouter/lib/Reply.h"
 #include "mcrouter/lib/RouteHandleTraverser.h"
+#include "mcrouter/lib/carbon/RequestReplyUtil.h"
 #include "mcrouter/routes/DefaultShadowPolicy.h"
 #include "mcrouter/routes/McRouteHandleBuilder.h"
 #include "mcrouter/routes/ShadowRouteIf.h"
@@ -46,6 +49,8 @@ namespace mcrouter {
  * hash is within settings range
  * Key range might be updated at runtime.
  * We can shadow to multiple shadow destinations for a given normal route.
+ * Shadow requests share the buffers of the normal request and are not sent
+ * while the proxy is over proxy_max_shadow_bytes.
  */
 template <class RouterInfo, class ShadowPolicy>
 class ShadowRoute {
@@ -87,6 +92,12 @@ class ShadowRoute {
   ReplyT<Request> route(const Request& req) const {
     std::shared_ptr<const Request> adjustedNormalReq;
     folly::Optional<ReplyT<Request>> normalReply;
+    ShadowBatch<Request> batch;
+    ProxyBase* proxy = nullptr;
+    size_t shadowBytes = 0;
+    // Until the batch is handed over to the shadow fibers.
+    auto releaseGuard =
+        folly::makeGuard([&] { releaseShadowBytes(proxy, shadowBytes); });
     for (const auto& iter : shadowData_) {
       if (shouldShadow(req, iter.second.get())) {
         auto shadow = iter.first;
@@ -101,6 +112,22 @@ class ShadowRoute {
         }
 
         if (!adjustedNormalReq) {
+          // All shadows share the key and value buffers of the request, so
+          // the budget is charged once, before anything is copied.
+          if (auto& reqCtx = fiber_local<RouterInfo>::getSharedCtx()) {
+            auto& reqProxy = reqCtx->proxy();
+            size_t bytes = carbon::getFullKey(req).size();
+            if (auto value = carbon::valuePtrUnsafe(req)) {
+              bytes += value->computeChainDataLength();
+            }
+            if (!reqProxy.shadowBudget().tryAcquire(bytes)) {
+              reqProxy.stats().increment(shadow_budget_limited_stat);
+              break;
+            }
+            reqProxy.stats().increment(shadow_bytes_outstanding_stat, bytes);
+            proxy = &reqProxy;
+            shadowBytes = bytes;
+          }
           adjustedNormalReq = shadowPolicy_.makeAdjustedNormalRequest(req);
           assert(adjustedNormalReq);
         }
@@ -110,14 +137,19 @@ class ShadowRoute {
           normalReply = normal_->route(*adjustedNormalReq);
         }
 
-        dispatchShadowRequest(
+        batch.push_back(ShadowRequest<Request>{
             std::move(shadow),
             shadowPolicy_.makeShadowRequest(adjustedNormalReq),
             normalReply ? shadowPolicy_.makePostShadowReplyFn(*normalReply)
-                        : nullptr);
+                        : nullptr});
       }
     }
 
+    releaseGuard.dismiss();
+    if (!batch.empty()) {
+      dispatchShadowRequests(std::move(batch), proxy, shadowBytes);
+    }
+
     return normalReply
         ? std::move(*normalReply)
         : normal_->route(adjustedNormalReq ? *adjustedNormalReq : req);
@@ -154,10 +186,32 @@ class ShadowRoute {
   }
 
   template <class Request>
-  void dispatchShadowRequest(
-      std::shared_ptr<RouteHandleIf> shadow,
-      std::shared_ptr<Request> adjustedReq,
-      folly::Function<void(const ReplyT<Request>&)> postShadowReplyFn) const;
+  struct ShadowRequest {
+    std::shared_ptr<RouteHandleIf> route;
+    decltype(std::declval<const ShadowPolicy&>().makeShadowRequest(
+        std::declval<const std::shared_ptr<const Request>&>())) request;
+    folly::Function<void(const ReplyT<Request>&)> postShadowReplyFn;
+  };
+
+  // Most routes have a single shadow.
+  template <class Request>
+  using ShadowBatch = folly::small_vector<ShadowRequest<Request>, 1>;
+
+  /**
+   * Sends all the shadow requests of a request from a single fiber task,
+   * which owns the batch. Shadows of a batch are routed concurrently, each
+   * on its own fiber, so that a slow shadow doesn't delay the others.
+   *
+   * @param proxy        Proxy charged for shadowBytes, nullptr if none was.
+   * @param shadowBytes  Released once every shadow replied (or threw).
+   */
+  template <class Request>
+  void dispatchShadowRequests(
+      ShadowBatch<Request> batch,
+      ProxyBase* proxy,
+      size_t shadowBytes) const;
+
+  static void releaseShadowBytes(ProxyBase* proxy, size_t shadowBytes);
 };
 
 template <class RouterInfo>
@@ -0,0 +1,68 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <gtest/gtest.h>
+
+#include <folly/dynamic.h>
+
+#include "mcrouter/routes/AdaptiveConcurrencyLimit.h"
+
+using namespace facebook::memcache::mcrouter;
+
+using std::chrono::microseconds;
+
+TEST(adaptiveConcurrencyLimitTest, growsWhileLatencyIsFlat) {
+  AdaptiveConcurrencyLimit limit(10, 1, 100, 2.0);
+  for (int i = 0; i < 100; ++i) {
+    limit.onSample(microseconds(100), limit.limit());
+  }
+  EXPECT_EQ(100, limit.limit());
+}
+
+TEST(adaptiveConcurrencyLimitTest, doesNotGrowWhenUnused) {
+  AdaptiveConcurrencyLimit limit(10, 1, 100, 2.0);
+  for (int i = 0; i < 100; ++i) {
+    limit.onSample(microseconds(100), 1);
+  }
+  EXPECT_EQ(10, limit.limit());
+}
+
+TEST(adaptiveConcurrencyLimitTest, shrinksWhenLatencyRises) {
+  AdaptiveConcurrencyLimit limit(50, 1, 100, 2.0);
+  for (int i = 0; i < 10; ++i) {
+    limit.onSample(microseconds(100), limit.limit());
+  }
+  auto before = limit.limit();
+  for (int i = 0; i < 100; ++i) {
+    limit.onSample(microseconds(1000), limit.limit());
+  }
+  EXPECT_LT(limit.limit(), before);
+  EXPECT_GE(limit.limit(), 1);
+}
+
+TEST(adaptiveConcurrencyLimitTest, backsOffOnDrops) {
+  AdaptiveConcurrencyLimit limit(100, 5, 100, 2.0);
+  limit.onDrop();
+  EXPECT_EQ(90, limit.limit());
+  for (int i = 0; i < 100; ++i) {
+    limit.onDrop();
+  }
+  EXPECT_EQ(5, limit.limit());
+}
+
+TEST(adaptiveConcurrencyLimitTest, json) {
+  AdaptiveConcurrencyLimit limit(folly::dynamic::object("initial_limit", 7)(
+      "min_limit", 2)("max_limit", 8)("tolerance", 1.5));
+  EXPECT_EQ(7, limit.limit());
+
+  auto check = [](folly::dynamic json) {
+    EXPECT_ANY_THROW({ AdaptiveConcurrencyLimit invalid(json); });
+  };
+  check(folly::dynamic::object("min_limit", 10)("max_limit", 5));
+  check(folly::dynamic::object("initial_limit", 2000));
+  check(folly::dynamic::object("tolerance", 0.5));
+}
@@ -0,0 +1,210 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "mcrouter/ProxyBase.h"
+#include "mcrouter/lib/network/gen/MemcacheMessages.h"
+#include "mcrouter/routes/CoalescingRoute.h"
+#include "mcrouter/routes/test/RouteHandleTestUtil.h"
+#include "mcrouter/stats.h"
+
+using namespace facebook::memcache;
+using namespace facebook::memcache::mcrouter;
+
+namespace {
+
+using RouteHandle = McrouterRouteHandle<CoalescingRoute>;
+
+template <class Request>
+void sendRequest(
+    folly::fibers::FiberManager& fm,
+    McrouterRouteHandleIf& rh,
+    std::string key,
+    std::vector<ReplyT<Request>>& replies) {
+  fm.addTask([&rh, key = std::move(key), &replies]() {
+    mockFiberContext();
+    replies.push_back(rh.route(Request(key)));
+  });
+}
+
+uint64_t rateStat(stat_name_t name) {
+  // Stats go to proxy 0 of the test router, shared by all tests.
+  // Rate stats are moved to the moving window every second.
+  const auto& stats = getTestRouter()->getProxy(0)->stats();
+  auto lock = stats.lock();
+  return stats.getValue(name) + stats.getStatValueWithinWindow(name);
+}
+
+} // anonymous namespace
+
+TEST(coalescingRouteTest, coalescesConcurrentGets) {
+  auto handle = std::make_shared<TestHandle>(
+      GetRouteTestData(carbon::Result::FOUND, "a"));
+  auto rh = std::make_shared<RouteHandle>(
+      handle->rh, 100, std::chrono::milliseconds(0));
+
+  TestFiberManager testfm{
+      typename fiber_local<MemcacheRouterInfo>::ContextTypeTag()};
+  auto& fm = testfm.getFiberManager();
+
+  handle->pause();
+  std::vector<McGetReply> replies;
+  for (size_t i = 0; i < 5; ++i) {
+    sendRequest<McGetRequest>(fm, *rh, "key", replies);
+  }
+  sendRequest<McGetRequest>(fm, *rh, "other", replies);
+  runUnpaused(fm, *handle);
+
+  ASSERT_EQ(6, replies.size());
+  for (const auto& reply : replies) {
+    EXPECT_EQ(carbon::Result::FOUND, reply.result());
+    EXPECT_EQ("a", carbon::valueRangeSlow(reply).str());
+  }
+  EXPECT_EQ((std::vector<std::string>{"key", "other"}), handle->saw_keys);
+}
+
+TEST(coalescingRouteTest, leaseGetsAreNotCoalesced) {
+  auto handle = std::make_shared<TestHandle>(
+      GetRouteTestData(carbon::Result::FOUND, "a"));
+  auto rh = std::make_shared<RouteHandle>(
+      handle->rh, 100, std::chrono::milliseconds(0));
+
+  TestFiberManager testfm{
+      typename fiber_local<MemcacheRouterInfo>::ContextTypeTag()};
+  auto& fm = testfm.getFiberManager();
+
+  handle->pause();
+  std::vector<McLeaseGetReply> replies;
+  for (size_t i = 0; i < 3; ++i) {
+    sendRequest<McLeaseGetRequest>(fm, *rh, "key", replies);
+  }
+  runUnpaused(fm, *handle);
+
+  EXPECT_EQ(3, replies.size());
+  EXPECT_EQ(3, handle->saw_keys.size());
+}
+
+TEST(coalescingRouteTest, maxWaiters) {
+  auto handle = std::make_shared<TestHandle>(
+      GetRouteTestData(carbon::Result::FOUND, "a"));
+  auto rh = std::make_shared<RouteHandle>(
+      handle->rh, 2, std::chrono::milliseconds(0));
+
+  TestFiberManager testfm{
+      typename fiber_local<MemcacheRouterInfo>::ContextTypeTag()};
+  auto& fm = testfm.getFiberManager();
+
+  handle->pause();
+  std::vector<McGetReply> replies;
+  for (size_t i = 0; i < 5; ++i) {
+    sendRequest<McGetRequest>(fm, *rh, "key", replies);
+  }
+  runUnpaused(fm, *handle);
+
+  // One leader, two waiters and two requests that had to go to the child.
+  EXPECT_EQ(5, replies.size());
+  EXPECT_EQ(3, handle->saw_keys.size());
+}
+
+TEST(coalescingRouteTest, sequentialGetsAreNotCoalesced) {
+  auto handle = std::make_shared<TestHandle>(
+      GetRouteTestData(carbon::Result::FOUND, "a"));
+  auto rh = std::make_shared<RouteHandle>(
+      handle->rh, 100, std::chrono::milliseconds(0));
+
+  TestFiberManager fm{
+      typename fiber_local<MemcacheRouterInfo>::ContextTypeTag()};
+  fm.run([&]() {
+    mockFiberContext();
+    for (size_t i = 0; i < 3; ++i) {
+      auto reply = rh->route(McGetRequest("key"));
+      EXPECT_EQ(carbon::Result::FOUND, reply.result());
+    }
+  });
+
+  EXPECT_EQ(3, handle->saw_keys.size());
+}
+
+TEST(coalescingRouteTest, coalescedRequestsStat) {
+  auto handle = std::make_shared<TestHandle>(
+      GetRouteTestData(carbon::Result::FOUND, "a"));
+  auto rh = std::make_shared<RouteHandle>(
+      handle->rh, 100, std::chrono::milliseconds(0));
+
+  TestFiberManager testfm{
+      typename fiber_local<MemcacheRouterInfo>::ContextTypeTag()};
+  auto& fm = testfm.getFiberManager();
+
+  const auto coalescedBefore = rateStat(coalescing_route_reqs_coalesced_stat);
+  constexpr size_t kNumGets = 10;
+  handle->pause();
+  std::vector<McGetReply> replies;
+  for (size_t i = 0; i < kNumGets; ++i) {
+    sendRequest<McGetRequest>(fm, *rh, "key", replies);
+  }
+  runUnpaused(fm, *handle);
+
+  EXPECT_EQ(kNumGets, replies.size());
+  EXPECT_EQ(1, handle->saw_keys.size());
+  // Every get but the leader's was saved a request to the child.
+  EXPECT_EQ(
+      kNumGets - 1,
+      rateStat(coalescing_route_reqs_coalesced_stat) - coalescedBefore);
+}
+
+TEST(coalescingRouteTest, waitTimeout) {
+  auto handle = std::make_shared<TestHandle>(
+      GetRouteTestData(carbon::Result::FOUND, "a"));
+  auto rh = std::make_shared<RouteHandle>(
+      handle->rh, 100, std::chrono::milliseconds(10));
+
+  TestFiberManager testfm{
+      typename fiber_local<MemcacheRouterInfo>::ContextTypeTag()};
+  auto& fm = testfm.getFiberManager();
+
+  const auto timeoutsBefore = rateStat(coalescing_route_wait_timeouts_stat);
+  const auto coalescedBefore = rateStat(coalescing_route_reqs_coalesced_stat);
+  handle->pause();
+  std::vector<McGetReply> replies;
+  sendRequest<McGetRequest>(fm, *rh, "key", replies);
+  sendRequest<McGetRequest>(fm, *rh, "key", replies);
+
+  // The leader is held by the child until the waiter gives up on it.
+  const auto deadline =
+      std::chrono::steady_clock::now() + std::chrono::seconds(5);
+  bool unpaused = false;
+  auto& loopController =
+      dynamic_cast<folly::fibers::SimpleLoopController&>(fm.loopController());
+  loopController.loop([&]() {
+    if (!unpaused &&
+        (rateStat(coalescing_route_wait_timeouts_stat) != timeoutsBefore ||
+         std::chrono::steady_clock::now() > deadline)) {
+      unpaused = true;
+      fm.addTask([&]() { handle->unpause(); });
+    }
+    if (replies.size() == 2) {
+      loopController.stop();
+    }
+  });
+
+  // The waiter sent its own request to the child.
+  ASSERT_EQ(2, replies.size());
+  for (const auto& reply : replies) {
+    EXPECT_EQ(carbon::Result::FOUND, reply.result());
+    EXPECT_EQ("a", carbon::valueRangeSlow(reply).str());
+  }
+  EXPECT_EQ((std::vector<std::string>{"key", "key"}), handle->saw_keys);
+  EXPECT_EQ(1, rateStat(coalescing_route_wait_timeouts_stat) - timeoutsBefore);
+  EXPECT_EQ(
+      0, rateStat(coalescing_route_reqs_coalesced_stat) - coalescedBefore);
+}
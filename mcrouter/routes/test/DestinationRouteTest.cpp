@@ -0,0 +1,80 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <chrono>
+
+#include <gtest/gtest.h>
+
+#include <folly/Optional.h>
+
+#include "mcrouter/lib/network/gen/MemcacheMessages.h"
+#include "mcrouter/routes/DestinationRoute.h"
+
+using namespace facebook::memcache;
+using namespace facebook::memcache::mcrouter;
+
+TEST(destinationRouteTest, requestWithoutDeadlineNotCopied) {
+  McGetRequest req("key");
+  folly::Optional<McGetRequest> newReq;
+  const auto& reqToSend = detail::prepareDestinationRequest(
+      req,
+      newReq,
+      /* keepRoutingPrefix */ false,
+      /* failoverTag */ false,
+      folly::none);
+
+  EXPECT_EQ(&req, &reqToSend);
+  EXPECT_FALSE(newReq.hasValue());
+  EXPECT_EQ(0, reqToSend.timeoutMs());
+}
+
+TEST(destinationRouteTest, requestWithSameBudgetNotCopied) {
+  McGetRequest req("key");
+  req.setTimeoutMs(200);
+  folly::Optional<McGetRequest> newReq;
+  const auto& reqToSend = detail::prepareDestinationRequest(
+      req,
+      newReq,
+      /* keepRoutingPrefix */ false,
+      /* failoverTag */ false,
+      folly::make_optional(std::chrono::milliseconds(200)));
+
+  EXPECT_EQ(&req, &reqToSend);
+  EXPECT_FALSE(newReq.hasValue());
+}
+
+TEST(destinationRouteTest, requestWithShorterBudgetCopied) {
+  McGetRequest req("key");
+  req.setTimeoutMs(200);
+  folly::Optional<McGetRequest> newReq;
+  const auto& reqToSend = detail::prepareDestinationRequest(
+      req,
+      newReq,
+      /* keepRoutingPrefix */ false,
+      /* failoverTag */ false,
+      folly::make_optional(std::chrono::milliseconds(150)));
+
+  ASSERT_TRUE(newReq.hasValue());
+  EXPECT_EQ(&*newReq, &reqToSend);
+  EXPECT_EQ(150, reqToSend.timeoutMs());
+  EXPECT_EQ(200, req.timeoutMs());
+}
+
+TEST(destinationRouteTest, routingPrefixStripped) {
+  McGetRequest req("/a/b/key");
+  folly::Optional<McGetRequest> newReq;
+  const auto& reqToSend = detail::prepareDestinationRequest(
+      req,
+      newReq,
+      /* keepRoutingPrefix */ false,
+      /* failoverTag */ false,
+      folly::none);
+
+  ASSERT_TRUE(newReq.hasValue());
+  EXPECT_EQ("key", reqToSend.key().fullKey());
+  EXPECT_EQ("/a/b/key", req.key().fullKey());
+}
@@ -0,0 +1,90 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <gtest/gtest.h>
+
+#include <folly/dynamic.h>
+
+#include "mcrouter/HedgeBudget.h"
+#include "mcrouter/routes/FailoverHedgePolicy.h"
+
+using namespace facebook::memcache::mcrouter;
+
+using std::chrono::microseconds;
+using std::chrono::milliseconds;
+
+TEST(failoverHedgePolicyTest, fixedDelay) {
+  FailoverHedgePolicy policy(folly::dynamic::object("delay_ms", 5));
+  EXPECT_EQ(milliseconds(5), policy.delay());
+
+  for (int i = 0; i < 1000; ++i) {
+    policy.recordLatency(milliseconds(1));
+  }
+  EXPECT_EQ(milliseconds(5), policy.delay());
+}
+
+TEST(failoverHedgePolicyTest, percentile) {
+  FailoverHedgePolicy policy(folly::dynamic::object("percentile", 90)(
+      "min_delay_ms", 1)("max_delay_ms", 50));
+  // Not enough samples yet.
+  EXPECT_EQ(milliseconds(50), policy.delay());
+
+  for (int round = 0; round < 3; ++round) {
+    for (int i = 1; i <= 100; ++i) {
+      policy.recordLatency(microseconds(i * 100));
+    }
+  }
+  EXPECT_GE(policy.delay(), microseconds(8500));
+  EXPECT_LE(policy.delay(), microseconds(9500));
+}
+
+TEST(failoverHedgePolicyTest, percentileClamped) {
+  FailoverHedgePolicy policy(folly::dynamic::object("percentile", 99)(
+      "min_delay_ms", 2)("max_delay_ms", 10));
+  for (int i = 0; i < 256; ++i) {
+    policy.recordLatency(microseconds(10));
+  }
+  EXPECT_EQ(milliseconds(2), policy.delay());
+
+  for (int i = 0; i < 256; ++i) {
+    policy.recordLatency(milliseconds(100));
+  }
+  EXPECT_EQ(milliseconds(10), policy.delay());
+}
+
+TEST(failoverHedgePolicyTest, invalidConfig) {
+  auto check = [](folly::dynamic json) {
+    EXPECT_ANY_THROW({ FailoverHedgePolicy policy(json); });
+  };
+  check(folly::dynamic::object());
+  check(folly::dynamic::object("delay_ms", 1)("percentile", 99));
+  check(folly::dynamic::object("percentile", 99));
+  check(folly::dynamic::object("percentile", 100)("max_delay_ms", 1));
+  check(folly::dynamic::object("percentile", 50)("min_delay_ms", 10)(
+      "max_delay_ms", 1));
+}
+
+TEST(failoverHedgePolicyTest, budget) {
+  HedgeBudget budget(0.1, /* burst */ 2);
+  EXPECT_TRUE(budget.tryConsume());
+  EXPECT_TRUE(budget.tryConsume());
+  EXPECT_FALSE(budget.tryConsume());
+
+  size_t numHedges = 0;
+  for (int i = 0; i < 1000; ++i) {
+    budget.onRequest();
+    if (budget.tryConsume()) {
+      ++numHedges;
+    }
+  }
+  EXPECT_GE(numHedges, 99);
+  EXPECT_LE(numHedges, 100);
+
+  HedgeBudget disabled(0);
+  disabled.onRequest();
+  EXPECT_FALSE(disabled.tryConsume());
+}
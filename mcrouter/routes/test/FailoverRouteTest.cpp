@@ -6,6 +6,7 @@
  */
 
 #include <memory>
+#include <string>
 #include <vector>
 
 #include <gtest/gtest.h>
@@ -651,3 +652,158 @@ TEST(failoverRouteTest, ignoreTkoAndHardTko) {
   // trying 3 of the 4 retry destinations, bounded by max_tries = 3
   EXPECT_EQ(3, numRetries);
 }
+
+TEST(failoverRouteTest, hedgeWins) {
+  std::vector<std::shared_ptr<TestHandle>> test_handles{
+      make_shared<TestHandle>(GetRouteTestData(carbon::Result::TIMEOUT, "a")),
+      make_shared<TestHandle>(GetRouteTestData(carbon::Result::FOUND, "b")),
+      make_shared<TestHandle>(GetRouteTestData(carbon::Result::FOUND, "c"))};
+
+  folly::dynamic json = folly::dynamic::object(
+      "hedging", folly::dynamic::object("delay_ms", 0));
+  auto rh = makeFailoverRouteDefault<McrouterRouterInfo, FailoverRoute>(
+      json, get_route_handles(test_handles));
+
+  TestFiberManager testfm{
+      typename fiber_local<McrouterRouterInfo>::ContextTypeTag()};
+  auto& fm = testfm.getFiberManager();
+
+  test_handles[0]->pause();
+  McGetReply reply;
+  fm.addTask([&]() {
+    mockFiberContext();
+    reply = rh->route(McGetRequest("0"));
+  });
+  runUnpaused(fm, *test_handles[0]);
+
+  EXPECT_EQ("b", carbon::valueRangeSlow(reply).str());
+  EXPECT_TRUE(test_handles[2]->saw_keys.empty());
+}
+
+TEST(failoverRouteTest, hedgeLoses) {
+  std::vector<std::shared_ptr<TestHandle>> test_handles{
+      make_shared<TestHandle>(GetRouteTestData(carbon::Result::FOUND, "a")),
+      make_shared<TestHandle>(GetRouteTestData(carbon::Result::FOUND, "b"))};
+
+  folly::dynamic json = folly::dynamic::object(
+      "hedging", folly::dynamic::object("delay_ms", 0));
+  auto rh = makeFailoverRouteDefault<McrouterRouterInfo, FailoverRoute>(
+      json, get_route_handles(test_handles));
+
+  TestFiberManager testfm{
+      typename fiber_local<McrouterRouterInfo>::ContextTypeTag()};
+  auto& fm = testfm.getFiberManager();
+
+  test_handles[1]->pause();
+  McGetReply reply;
+  fm.addTask([&]() {
+    mockFiberContext();
+    reply = rh->route(McGetRequest("0"));
+  });
+  fm.loopUntilNoReady();
+
+  // The hedge was sent, but the normal destination replied first.
+  EXPECT_EQ("a", carbon::valueRangeSlow(reply).str());
+
+  // Paused destinations only record keys once unpaused.
+  runUnpaused(fm, *test_handles[1]);
+  EXPECT_EQ(std::vector<std::string>{"0"}, test_handles[1]->saw_keys);
+  EXPECT_EQ("a", carbon::valueRangeSlow(reply).str());
+}
+
+TEST(failoverRouteTest, hedgeWinsOverSlowNormal) {
+  std::vector<std::shared_ptr<TestHandle>> test_handles{
+      make_shared<TestHandle>(GetRouteTestData(carbon::Result::FOUND, "a")),
+      make_shared<TestHandle>(GetRouteTestData(carbon::Result::FOUND, "b"))};
+
+  folly::dynamic json = folly::dynamic::object(
+      "hedging", folly::dynamic::object("delay_ms", 0));
+  auto rh = makeFailoverRouteDefault<McrouterRouterInfo, FailoverRoute>(
+      json, get_route_handles(test_handles));
+
+  TestFiberManager testfm{
+      typename fiber_local<McrouterRouterInfo>::ContextTypeTag()};
+  auto& fm = testfm.getFiberManager();
+
+  test_handles[0]->pause();
+  McGetReply reply;
+  bool replied = false;
+  fm.addTask([&]() {
+    mockFiberContext();
+    reply = rh->route(McGetRequest("0"));
+    replied = true;
+  });
+  fm.loopUntilNoReady();
+
+  // The normal destination is routed from the calling fiber, which waits for
+  // it even though the hedge already replied.
+  EXPECT_FALSE(replied);
+  EXPECT_EQ(std::vector<std::string>{"0"}, test_handles[1]->saw_keys);
+
+  // The normal destination succeeds, but the hedge replied first.
+  runUnpaused(fm, *test_handles[0]);
+  EXPECT_TRUE(replied);
+  EXPECT_EQ(std::vector<std::string>{"0"}, test_handles[0]->saw_keys);
+  EXPECT_EQ("b", carbon::valueRangeSlow(reply).str());
+}
+
+TEST(failoverRouteTest, hedgeCountsAsTry) {
+  std::vector<std::shared_ptr<TestHandle>> test_handles;
+  for (const char* value : {"a", "b", "c", "d", "e"}) {
+    test_handles.push_back(make_shared<TestHandle>(
+        GetRouteTestData(carbon::Result::TIMEOUT, value)));
+  }
+
+  folly::dynamic policyJson = folly::dynamic::object(
+      "type", "DeterministicOrderPolicy")("max_tries", 4)("max_error_tries", 2);
+  folly::dynamic json = folly::dynamic::object("failover_policy", policyJson)(
+      "hedging", folly::dynamic::object("delay_ms", 0));
+  auto rh = makeFailoverRouteDefault<McrouterRouterInfo, FailoverRoute>(
+      json, get_route_handles(test_handles));
+
+  TestFiberManager testfm{
+      typename fiber_local<McrouterRouterInfo>::ContextTypeTag()};
+  auto& fm = testfm.getFiberManager();
+
+  fm.addTask([&]() {
+    mockFiberContext();
+    rh->route(McGetRequest("0"));
+  });
+  fm.loopUntilNoReady();
+
+  // The normal and hedge destinations used up max_error_tries.
+  int numTries = 0;
+  for (auto testHdl : test_handles) {
+    if (!testHdl->saw_keys.empty()) {
+      ++numTries;
+    }
+  }
+  EXPECT_EQ(2, numTries);
+}
+
+TEST(failoverRouteTest, hedgeLeaseGet) {
+  std::vector<std::shared_ptr<TestHandle>> test_handles{
+      make_shared<TestHandle>(GetRouteTestData(carbon::Result::FOUND, "a")),
+      make_shared<TestHandle>(GetRouteTestData(carbon::Result::FOUND, "b"))};
+
+  folly::dynamic json = folly::dynamic::object(
+      "hedging", folly::dynamic::object("delay_ms", 0));
+  auto rh = makeFailoverRouteDefault<McrouterRouterInfo, FailoverRoute>(
+      json, get_route_handles(test_handles));
+
+  TestFiberManager testfm{
+      typename fiber_local<McrouterRouterInfo>::ContextTypeTag()};
+  auto& fm = testfm.getFiberManager();
+
+  test_handles[0]->pause();
+  McLeaseGetReply reply;
+  fm.addTask([&]() {
+    mockFiberContext();
+    reply = rh->route(McLeaseGetRequest("0"));
+  });
+  runUnpaused(fm, *test_handles[0]);
+
+  // Lease gets are never hedged.
+  EXPECT_EQ("a", carbon::valueRangeSlow(reply).str());
+  EXPECT_TRUE(test_handles[1]->saw_keys.empty());
+}
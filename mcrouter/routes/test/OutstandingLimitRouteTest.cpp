@@ -5,6 +5,7 @@
  * LICENSE file in the root directory of this source tree.
  */
 
+#include <chrono>
 #include <memory>
 #include <random>
 #include <vector>
@@ -96,3 +97,61 @@ TEST(oustandingLimitRouteTest, basic) {
   EXPECT_EQ(makeKey(13), replyOrder[12]);
   EXPECT_EQ(makeKey(7), replyOrder[13]);
 }
+
+TEST(oustandingLimitRouteTest, queueTimeoutRacesWithRelease) {
+  auto normalHandle = std::make_shared<TestHandle>(
+      GetRouteTestData(carbon::Result::FOUND, "a"));
+
+  McrouterRouteHandle<OutstandingLimitRoute<McrouterRouterInfo>> rh(
+      normalHandle->rh, 1, std::chrono::milliseconds(10));
+
+  TestFiberManager testfm{
+      typename fiber_local<MemcacheRouterInfo>::ContextTypeTag()};
+  auto& fm = testfm.getFiberManager();
+
+  normalHandle->pause();
+  std::vector<McGetReply> replies;
+  for (size_t senderId : {1, 2}) {
+    auto context = getTestContext();
+    context->setSenderIdForTest(senderId);
+    fm.addTask([&rh, &replies, context = std::move(context)]() mutable {
+      fiber_local<MemcacheRouterInfo>::setSharedCtx(std::move(context));
+      replies.push_back(rh.route(McGetRequest("key")));
+    });
+  }
+
+  // The first request only completes once the queued one timed out, so that
+  // its slot is released while the timed out fiber is still to be resumed.
+  const auto start = std::chrono::steady_clock::now();
+  bool unpaused = false;
+  auto& loopController =
+      dynamic_cast<folly::fibers::SimpleLoopController&>(fm.loopController());
+  loopController.loop([&]() {
+    if (!unpaused &&
+        std::chrono::steady_clock::now() - start >
+            std::chrono::milliseconds(20)) {
+      unpaused = true;
+      fm.addTask([&]() { normalHandle->unpause(); });
+    }
+    if (replies.size() == 2) {
+      loopController.stop();
+    }
+  });
+
+  ASSERT_EQ(2, replies.size());
+  EXPECT_EQ(carbon::Result::FOUND, replies[0].result());
+  // Depending on which came first, the queued request was either shed, or
+  // handed the slot and routed.
+  EXPECT_TRUE(
+      replies[1].result() == carbon::Result::FOUND ||
+      replies[1].result() == carbon::Result::BUSY);
+
+  // No slot was lost: a new request is routed without being queued.
+  fm.addTask([&]() {
+    mockFiberContext();
+    replies.push_back(rh.route(McGetRequest("key")));
+  });
+  loopController.loop([&]() { loopController.stop(); });
+  ASSERT_EQ(3, replies.size());
+  EXPECT_EQ(carbon::Result::FOUND, replies[2].result());
+}
@@ -9,6 +9,9 @@
 
 #include <memory>
 
+#include <folly/fibers/FiberManager.h>
+#include <folly/fibers/SimpleLoopController.h>
+
 #include "mcrouter/CarbonRouterInstance.h"
 #include "mcrouter/McrouterFiberContext.h"
 #include "mcrouter/ProxyRequestContext.h"
@@ -53,6 +56,19 @@ inline void mockFiberContext() {
       [&ctx]() { ctx = getTestContext<RouterInfo>(); });
   fiber_local<RouterInfo>::setSharedCtx(std::move(ctx));
 }
+
+/**
+ * Unpause the handle and run the fibers of fm (which must use a
+ * SimpleLoopController) until they are all done or blocked.
+ */
+inline void runUnpaused(folly::fibers::FiberManager& fm, TestHandle& handle) {
+  auto& loopController =
+      dynamic_cast<folly::fibers::SimpleLoopController&>(fm.loopController());
+  loopController.loop([&]() {
+    fm.addTask([&]() { handle.unpause(); });
+    loopController.stop();
+  });
+}
 }
 }
 } // facebook::memcache::mcrouter
@@ -12,12 +12,17 @@
 #include <gtest/gtest.h>
 
 #include <folly/dynamic.h>
+#include <folly/fibers/SimpleLoopController.h>
 
+#include "mcrouter/CarbonRouterInstance.h"
+#include "mcrouter/ProxyBase.h"
+#include "mcrouter/ShadowBudget.h"
 #include "mcrouter/lib/network/gen/MemcacheMessages.h"
 #include "mcrouter/routes/DefaultShadowPolicy.h"
 #include "mcrouter/routes/ShadowRoute.h"
 #include "mcrouter/routes/ShadowRouteIf.h"
 #include "mcrouter/routes/test/RouteHandleTestUtil.h"
+#include "mcrouter/stats.h"
 
 using namespace facebook::memcache;
 using namespace facebook::memcache::mcrouter;
@@ -26,6 +31,36 @@ using std::make_shared;
 using std::string;
 using std::vector;
 
+namespace {
+
+uint64_t rateStat(const ProxyBase& proxy, stat_name_t name) {
+  // Rate stats are moved to the moving window every second.
+  const auto& stats = proxy.stats();
+  auto lock = stats.lock();
+  return stats.getValue(name) + stats.getStatValueWithinWindow(name);
+}
+
+/**
+ * Routes every key from its own fiber, with a context on proxy 0 of router.
+ */
+void routeAll(
+    folly::fibers::FiberManager& fm,
+    CarbonRouterInstance<McrouterRouterInfo>& router,
+    McrouterRouteHandleIf& rh,
+    const vector<string>& keys,
+    vector<McGetReply>& replies) {
+  for (const auto& key : keys) {
+    auto ctx = ProxyRequestContextWithInfo<McrouterRouterInfo>::createRecording(
+        *router.getProxy(0), nullptr);
+    fm.addTask([&rh, &replies, key, ctx = std::move(ctx)]() mutable {
+      fiber_local<McrouterRouterInfo>::setSharedCtx(std::move(ctx));
+      replies.push_back(rh.route(McGetRequest(key)));
+    });
+  }
+}
+
+} // anonymous namespace
+
 TEST(shadowRouteTest, defaultPolicy) {
   vector<std::shared_ptr<TestHandle>> normalHandle{
       make_shared<TestHandle>(GetRouteTestData(carbon::Result::FOUND, "a")),
@@ -74,3 +109,143 @@ TEST(shadowRouteTest, defaultPolicy) {
   EXPECT_EQ(shadowHandles[0]->saw_keys, vector<string>{"key"});
   EXPECT_EQ(shadowHandles[1]->saw_keys, vector<string>{"key"});
 }
+
+TEST(shadowRouteTest, shadowBudget) {
+  ShadowBudget budget(100);
+  EXPECT_TRUE(budget.tryAcquire(60));
+  EXPECT_FALSE(budget.tryAcquire(50));
+  EXPECT_TRUE(budget.tryAcquire(40));
+  EXPECT_EQ(100, budget.outstanding());
+  budget.release(60);
+  EXPECT_TRUE(budget.tryAcquire(50));
+  EXPECT_EQ(90, budget.outstanding());
+
+  ShadowBudget unlimited(0);
+  EXPECT_TRUE(unlimited.tryAcquire(1UL << 40));
+}
+
+TEST(shadowRouteTest, shadowsSentConcurrently) {
+  auto opts = defaultTestOptions();
+  opts.config = "{ \"route\": \"NullRoute\" }";
+  auto router = CarbonRouterInstance<McrouterRouterInfo>::init(
+      "shadowRouteTest_shadowsSentConcurrently", opts);
+  ASSERT_NE(nullptr, router);
+  auto& proxy = *router->getProxy(0);
+
+  vector<std::shared_ptr<TestHandle>> normalHandle{
+      make_shared<TestHandle>(GetRouteTestData(carbon::Result::FOUND, "a")),
+  };
+  vector<std::shared_ptr<TestHandle>> shadowHandles{
+      make_shared<TestHandle>(GetRouteTestData(carbon::Result::FOUND, "b")),
+      make_shared<TestHandle>(GetRouteTestData(carbon::Result::FOUND, "c")),
+  };
+  auto settings = ShadowSettings::create(
+      folly::dynamic::object("index_range", folly::dynamic::array(0, 1)),
+      *router);
+  settings->setKeyRange(0, 1);
+  auto shadowRhs = get_route_handles(shadowHandles);
+  McrouterShadowData shadowData{
+      {std::move(shadowRhs[0]), settings}, {std::move(shadowRhs[1]), settings},
+  };
+  McrouterRouteHandle<ShadowRoute<McrouterRouterInfo, DefaultShadowPolicy>> rh(
+      get_route_handles(normalHandle)[0],
+      std::move(shadowData),
+      DefaultShadowPolicy());
+
+  TestFiberManager testfm{fiber_local<McrouterRouterInfo>::ContextTypeTag()};
+  auto& fm = testfm.getFiberManager();
+  shadowHandles[0]->pause();
+
+  vector<McGetReply> replies;
+  routeAll(fm, *router, rh, {"key"}, replies);
+
+  bool checked = false;
+  auto& loopController =
+      dynamic_cast<folly::fibers::SimpleLoopController&>(fm.loopController());
+  loopController.loop([&]() {
+    if (checked || replies.empty()) {
+      return;
+    }
+    checked = true;
+    // Neither the normal reply nor the second shadow waits for the first
+    // shadow, which still holds the budget charge.
+    EXPECT_EQ("a", carbon::valueRangeSlow(replies[0]).str());
+    EXPECT_TRUE(shadowHandles[0]->saw_keys.empty());
+    EXPECT_EQ(shadowHandles[1]->saw_keys, vector<string>{"key"});
+    EXPECT_EQ(3, proxy.stats().getValue(shadow_bytes_outstanding_stat));
+    fm.addTask([&]() { shadowHandles[0]->unpause(); });
+    loopController.stop();
+  });
+
+  EXPECT_TRUE(checked);
+  EXPECT_EQ(shadowHandles[0]->saw_keys, vector<string>{"key"});
+  EXPECT_EQ(shadowHandles[1]->saw_keys, vector<string>{"key"});
+  EXPECT_EQ(2, rateStat(proxy, shadow_requests_batched_stat));
+  EXPECT_EQ(0, proxy.stats().getValue(shadow_bytes_outstanding_stat));
+
+  router->shutdown();
+}
+
+TEST(shadowRouteTest, shadowsSkippedOverBudget) {
+  auto opts = defaultTestOptions();
+  opts.config = "{ \"route\": \"NullRoute\" }";
+  // Room for the shadows of one 4 byte key at a time.
+  opts.proxy_max_shadow_bytes = 6;
+  auto router = CarbonRouterInstance<McrouterRouterInfo>::init(
+      "shadowRouteTest_shadowsSkippedOverBudget", opts);
+  ASSERT_NE(nullptr, router);
+  auto& proxy = *router->getProxy(0);
+
+  vector<std::shared_ptr<TestHandle>> normalHandle{
+      make_shared<TestHandle>(GetRouteTestData(carbon::Result::FOUND, "a")),
+  };
+  vector<std::shared_ptr<TestHandle>> shadowHandles{
+      make_shared<TestHandle>(GetRouteTestData(carbon::Result::FOUND, "b")),
+  };
+  auto settings = ShadowSettings::create(
+      folly::dynamic::object("index_range", folly::dynamic::array(0, 1)),
+      *router);
+  settings->setKeyRange(0, 1);
+  McrouterShadowData shadowData{
+      {get_route_handles(shadowHandles)[0], settings},
+  };
+  McrouterRouteHandle<ShadowRoute<McrouterRouterInfo, DefaultShadowPolicy>> rh(
+      get_route_handles(normalHandle)[0],
+      std::move(shadowData),
+      DefaultShadowPolicy());
+
+  TestFiberManager testfm{fiber_local<McrouterRouterInfo>::ContextTypeTag()};
+  auto& fm = testfm.getFiberManager();
+  shadowHandles[0]->pause();
+
+  vector<McGetReply> replies;
+  routeAll(fm, *router, rh, {"key1", "key2"}, replies);
+
+  bool checked = false;
+  auto& loopController =
+      dynamic_cast<folly::fibers::SimpleLoopController&>(fm.loopController());
+  loopController.loop([&]() {
+    if (checked || replies.size() < 2) {
+      return;
+    }
+    checked = true;
+    // key1 is held by its paused shadow, so key2 is not shadowed.
+    EXPECT_EQ(4, proxy.shadowBudget().outstanding());
+    EXPECT_EQ(4, proxy.stats().getValue(shadow_bytes_outstanding_stat));
+    EXPECT_EQ(1, rateStat(proxy, shadow_budget_limited_stat));
+    fm.addTask([&]() { shadowHandles[0]->unpause(); });
+    loopController.stop();
+  });
+
+  EXPECT_TRUE(checked);
+  for (const auto& reply : replies) {
+    EXPECT_EQ(carbon::Result::FOUND, reply.result());
+    EXPECT_EQ("a", carbon::valueRangeSlow(reply).str());
+  }
+  EXPECT_EQ(normalHandle[0]->saw_keys, (vector<string>{"key1", "key2"}));
+  EXPECT_EQ(shadowHandles[0]->saw_keys, vector<string>{"key1"});
+  EXPECT_EQ(0, proxy.shadowBudget().outstanding());
+  EXPECT_EQ(0, proxy.stats().getValue(shadow_bytes_outstanding_stat));
+
+  router->shutdown();
+}
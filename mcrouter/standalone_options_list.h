@@ -101,6 +101,38 @@ MCROUTER_OPTION_INTEGER(
     no_short,
     "Listen socket to take over")
 
+MCROUTER_OPTION_STRING(
+    takeover_socket_path,
+    "",
+    "takeover-socket-path",
+    no_short,
+    "Unix domain socket used for zero-downtime restarts. On startup, listening"
+    " sockets and destination TKO state are taken over from the mcrouter"
+    " serving this path, if any, which then shuts down. This mcrouter then"
+    " serves the path for the next one. Only used when listening on ports.")
+
+MCROUTER_OPTION_INTEGER(
+    unsigned int,
+    takeover_timeout_ms,
+    5000,
+    "takeover-timeout-ms",
+    no_short,
+    "How long an mcrouter handing its sockets over waits for the new one to"
+    " start serving before it resumes accepting itself")
+
+MCROUTER_OPTION_INTEGER(
+    int,
+    go_away_timeout_ms,
+    -1,
+    "go-away-timeout-ms",
+    no_short,
+    "If positive, on shutdown caret protocol clients are asked (with GoAway)"
+    " to move their requests to new connections, and their connections are"
+    " closed after this many milliseconds at the latest. If zero, connections"
+    " are closed right away. If negative, 1000 if --takeover-socket-path is"
+    " set (so that the connections of an mcrouter taken over are drained),"
+    " zero otherwise.")
+
 MCROUTER_OPTION_STRING(
     unix_domain_sock,
     "",
@@ -134,6 +166,25 @@ MCROUTER_OPTION_INTEGER(
     no_short,
     "Maximum requests outstanding per client (0 to disable)")
 
+MCROUTER_OPTION_INTEGER(
+    size_t,
+    max_client_queued_reply_bytes,
+    0,
+    "max-client-queued-reply-bytes",
+    no_short,
+    "Stop reading from a client once its replies waiting to be reordered or"
+    " written out take this many bytes (0 to disable)")
+
+MCROUTER_OPTION_INTEGER(
+    size_t,
+    client_queued_reply_bytes_low_watermark,
+    0,
+    "client-queued-reply-bytes-low-watermark",
+    no_short,
+    "Resume reading from a client paused by max-client-queued-reply-bytes once"
+    " its queued replies drop to this many bytes (0 means half of"
+    " max-client-queued-reply-bytes)")
+
 MCROUTER_OPTION_INTEGER(
     size_t,
     requests_per_read,
@@ -175,6 +226,17 @@ MCROUTER_OPTION_INTEGER(
     "How often to collect server load data. "
     "(0 to disable exposing server load)")
 
+MCROUTER_OPTION_INTEGER(
+    uint32_t,
+    server_cpu_shed_target_percent,
+    0,
+    "server-cpu-shed-target-percent",
+    no_short,
+    "Only active if server-load-interval-ms is non-zero. Once CPU utilization"
+    " exceeds this percentage, reject new client requests with BUSY with a"
+    " probability growing up to 1 at 100% CPU, starting with the clients"
+    " that have the most requests in flight. (0 to disable)")
+
 MCROUTER_OPTION_INTEGER(
     uint32_t,
     tfo_queue_size,
@@ -202,6 +264,16 @@ MCROUTER_OPTION_INTEGER(
     " use the zero copy optimization on TX."
     " If 0, the tcp zero copy optimization will not be applied.")
 
+MCROUTER_OPTION_TOGGLE(
+    server_use_io_uring,
+    false,
+    "server-use-io-uring",
+    no_short,
+    "Drive server threads with io_uring instead of epoll and move accepted"
+    " plaintext connections to io_uring sockets. Falls back to epoll if"
+    " io_uring is not available. Pools that set \"use_io_uring\" will also"
+    " use io_uring when proxies share the server threads.")
+
 MCROUTER_OPTION_TOGGLE(
     acl_checker_enable,
     false,
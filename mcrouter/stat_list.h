@@ -27,6 +27,10 @@ STUI(uptime, 0, 0)
  */
 #define GROUP ods_stats | detailed_stats
 STUI(num_client_connections, 0, 1)
+// bytes of replies waiting to be reordered or written to clients
+STUI(server_queued_reply_bytes, 0, 1)
+// requests rejected because the server was over its CPU target
+STUIR(server_cpu_shed_requests, 0, 1)
 #undef GROUP
 
 
@@ -50,6 +54,10 @@ STUI(num_suspect_servers, 0, 1)
 // Running total of connection opens/closes
 STUI(num_connections_opened, 0, 1)
 STUI(num_connections_closed, 0, 1)
+// Running total of connections successfully warmed up before the first
+// request, and of warm-ups that failed
+STUI(destination_warmup_connects, 0, 1)
+STUI(destination_warmup_failures, 0, 1)
 // Running total of connection not authorized
 STUI(num_authorization_failures, 0, 1)
 // Running total of connection authorized
@@ -60,6 +68,11 @@ STUI(num_ssl_connections_closed, 0, 1)
 // Running total of successful SSL connection attempts/successes
 STUI(num_ssl_resumption_attempts, 0, 1)
 STUI(num_ssl_resumption_successes, 0, 1)
+// Process-wide client TLS session cache, shared by all proxies
+STUI(ssl_session_cache_lookups, 0, 0)
+STUI(ssl_session_cache_hits, 0, 0)
+STUI(ssl_session_cache_evictions, 0, 0)
+STUI(ssl_session_cache_entries, 0, 0)
 // Running total of tls to plain connections and resumption stats
 STUI(num_tls_to_plain_fallback_failures, 0, 1)
 STUI(num_tls_to_plain_connections_opened, 0, 1)
@@ -90,6 +103,8 @@ STUI(retrans_closed_connections, 0, 1)
 // Number of requests/second that couldn't be processed immediately in OLR
 STUI(outstanding_route_get_reqs_queued, 0, 1)
 STUI(outstanding_route_update_reqs_queued, 0, 1)
+// Number of requests/second failed after waiting too long in OLR
+STUI(outstanding_route_reqs_shed, 0, 1)
 #undef GROUP
 #define GROUP ods_stats | basic_stats
 // Average number of requests waiting in OLR at any given time
@@ -98,6 +113,8 @@ STAT(outstanding_route_update_avg_queue_size, stat_double, 0, .dbl = 0.0)
 // Average time a request had to wait in OLR
 STAT(outstanding_route_get_avg_wait_time_sec, stat_double, 0, .dbl = 0.0)
 STAT(outstanding_route_update_avg_wait_time_sec, stat_double, 0, .dbl = 0.0)
+// Average limit of adaptive OLRs, weighted by number of requests
+STAT(outstanding_route_adaptive_avg_limit, stat_double, 0, .dbl = 0.0)
 #undef GROUP
 #define GROUP rate_stats
 // OutstandingLimitRoute queue-related helper stats
@@ -105,12 +122,28 @@ STUI(outstanding_route_get_reqs_queued_helper, 0, 0)
 STUI(outstanding_route_update_reqs_queued_helper, 0, 0)
 STUI(outstanding_route_get_wait_time_sum_us, 0, 0)
 STUI(outstanding_route_update_wait_time_sum_us, 0, 0)
+STUI(outstanding_route_adaptive_limit_sum, 0, 0)
+STUI(outstanding_route_adaptive_limit_samples, 0, 0)
 // Retransmission per byte helper stats
 STUI(retrans_per_kbyte_sum, 0, 0)
 STUI(retrans_num_total, 0, 0)
 #undef GROUP
 
 
+/**
+ * CoalescingRoute stats.
+ */
+#define GROUP ods_stats | detailed_stats | rate_stats
+// Gets answered with the reply of an in-flight get for the same key, i.e.
+// requests that were not sent to the backend.
+STUIR(coalescing_route_reqs_coalesced, 0, 1)
+// Gets sent to the backend because too many requests were already waiting.
+STUIR(coalescing_route_waiters_limited, 0, 1)
+// Gets sent to the backend after waiting too long for the in-flight get.
+STUIR(coalescing_route_wait_timeouts, 0, 1)
+#undef GROUP
+
+
 /**
  * Stats about the process
  */
@@ -138,6 +171,23 @@ STUI(fibers_stack_high_watermark, 0, 0)
 #undef GROUP
 
 
+/**
+ * Stats about the auxiliary CPU thread pool, shared by all proxies
+ */
+#define GROUP ods_stats | basic_stats
+// Large payloads being (de)compressed on the pool.
+STUI(aux_cpu_pool_queue_depth, 0, 0)
+// Running totals of payloads (de)compressed on the pool, of payloads
+// (de)compressed inline because the pool was saturated, and of payloads
+// (de)compressed inline because there was no fiber to preempt.
+STUI(aux_cpu_pool_offloaded, 0, 0)
+STUI(aux_cpu_pool_inline_fallbacks, 0, 0)
+STUI(aux_cpu_pool_inline_not_on_fiber, 0, 0)
+// Avg time from submission to completion of offloaded payloads.
+STAT(aux_cpu_pool_avg_latency_us, stat_double, 0, .dbl = 0.0)
+#undef GROUP
+
+
 /**
  * Stats about routing
  */
@@ -152,6 +202,8 @@ STAT(asynclog_duration_us, stat_double, 0, .dbl = 0.0)
 STUI(proxy_reqs_processing, 0, 1)
 // Proxy requests queued up and not routed yet
 STUI(proxy_reqs_waiting, 0, 1)
+// Bytes (keys and values) of shadow requests not completed yet.
+STUI(shadow_bytes_outstanding, 0, 1)
 STAT(client_queue_notify_period, stat_double, 0, .dbl = 0.0)
 #undef GROUP
 #define GROUP ods_stats | detailed_stats
@@ -163,6 +215,10 @@ STUI(dev_null_requests, 0, 1)
 #define GROUP ods_stats | detailed_stats | count_stats
 STUI(rate_limited_log_count, 0, 1)
 STUI(load_balancer_load_reset_count, 0, 1)
+// Requests routed directly to their destination, see direct_routing.
+STUI(direct_routed_requests_count, 0, 1)
+// Direct routed requests sent to their destination without a fiber.
+STUI(direct_routed_inline_requests_count, 0, 1)
 #undef GROUP
 #define GROUP count_stats
 STUI(request_sent_count, 0, 1)
@@ -175,6 +231,9 @@ STUIR(request_sent, 0, 1)
 STUIR(request_error, 0, 1)
 STUIR(request_success, 0, 1)
 STUIR(request_replied, 0, 1)
+STUIR(request_deadline_expired, 0, 1)
+STUIR(destination_deadline_expired, 0, 1)
+STUIR(failover_deadline_expired, 0, 1)
 STUIR(client_queue_notifications, 0, 1)
 STUIR(failover_all, 0, 1)
 STUIR(failover_conditional, 0, 1)
@@ -193,6 +252,18 @@ STUIR(failover_custom_limit_reached, 0, 1)
 STUIR(failover_custom_master_region, 0, 1)
 STUIR(failover_custom_master_region_skipped, 0, 1)
 STUIR(failover_custom_master_region_invalid, 0, 1)
+STUIR(failover_hedges_sent, 0, 1)
+STUIR(failover_hedges_won, 0, 1)
+STUIR(failover_hedges_budget_limited, 0, 1)
+// Requests not shadowed because of proxy_max_shadow_bytes.
+STUIR(shadow_budget_limited, 0, 1)
+// Shadow requests dispatched from one task along with other shadows of the
+// same request, sharing one batch and one shadow budget charge. Each of them
+// is still routed on a fiber of its own: this is not a count of saved
+// allocations.
+STUIR(shadow_requests_batched, 0, 1)
+// Route profile frames not recorded because the profiler queue was full.
+STUIR(route_profile_frames_dropped, 0, 1)
 STUIR(custom_policy_large_assoc_reqs, 0, 1)
 #undef GROUP
 #define GROUP ods_stats | count_stats
@@ -255,6 +326,9 @@ STUIR(result_remote_error_all, 0, 1)
 #define GROUP basic_stats | rate_stats
 STUI(destination_batches_sum, 0, 1)
 STUI(destination_requests_sum, 0, 1)
+// batches held back by adaptive batching and the latency this added
+STUI(destination_batches_delayed_sum, 0, 1)
+STUI(destination_batch_delay_us_sum, 0, 1)
 #undef GROUP
 #define GROUP basic_stats | detailed_stats
 // count the dirty requests (i.e. requests that needed reserialization)
@@ -270,6 +344,8 @@ STUI(destination_pending_reqs, 0, 1)
 // Total reqs waiting for reply from server.
 STUI(destination_inflight_reqs, 0, 1)
 STAT(destination_batch_size, stat_double, 0, .dbl = 0.0)
+// average latency added to batches held back by adaptive batching
+STAT(destination_batch_delay_us, stat_double, 0, .dbl = 0.0)
 STAT(destination_reqs_dirty_buffer_ratio, stat_double, 0, .dbl = 0.0)
 // duration of the rpc call
 STAT(duration_us, stat_double, 0, .dbl = 0.0)
@@ -313,4 +389,7 @@ STUI(config_last_attempt, 0, 0)
 STUI(config_last_success, 0, 0)
 STUI(config_failures, 0, 0)
 STUI(configs_from_disk, 0, 0)
+// time from startup until every proxy had a config and finished warming up
+// its destinations, 0 until then
+STUI(startup_to_ready_ms, 0, 0)
 #undef GROUP
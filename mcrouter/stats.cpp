@@ -21,13 +21,16 @@
 #include <folly/json.h>
 
 #include "mcrouter/CarbonRouterInstanceBase.h"
+#include "mcrouter/KeyPrefixStats.h"
 #include "mcrouter/McrouterLogFailure.h"
 #include "mcrouter/ProxyBase.h"
 #include "mcrouter/ProxyDestination.h"
 #include "mcrouter/ProxyDestinationMap.h"
 #include "mcrouter/config.h"
+#include "mcrouter/lib/AuxiliaryCPUThreadPool.h"
 #include "mcrouter/lib/StatsReply.h"
 #include "mcrouter/lib/fbi/cpp/util.h"
+#include "mcrouter/lib/network/TlsSessionCache.h"
 #include "mcrouter/lib/network/gen/MemcacheMessages.h"
 
 /**                             .__
@@ -367,18 +370,46 @@ void append_pool_stats(
   }
 }
 
+std::vector<stat_t> prepare_aggregated_stats(
+    CarbonRouterInstanceBase& router) {
+  std::vector<stat_t> stats(num_stats);
+  prepare_stats(router, stats.data());
+  append_pool_stats(router, stats);
+
+  for (int i = 0; i < num_stats; ++i) {
+    if (stats[i].group & rate_stats) {
+      stats[i].type = stat_double;
+      stats[i].data.dbl = stats_aggregate_rate_value(router, i);
+    } else if (stats[i].group & max_stats) {
+      stats[i].type = stat_uint64;
+      stats[i].data.uint64 = stats_aggregate_max_value(router, i);
+    } else if (stats[i].group & max_max_stats) {
+      stats[i].type = stat_uint64;
+      stats[i].data.uint64 = stats_aggregate_max_max_value(router, i);
+    }
+  }
+  return stats;
+}
+
 void prepare_stats(CarbonRouterInstanceBase& router, stat_t* stats) {
   init_stats(stats);
 
   uint64_t config_last_success = 0;
+  // max over proxies, 0 if any of them isn't ready yet
+  uint64_t startupToReadyMs = 0;
+  bool allProxiesReady = true;
   uint64_t destinationBatchesSum = 0;
   uint64_t destinationRequestsSum = 0;
+  uint64_t destinationBatchesDelayedSum = 0;
+  uint64_t destinationBatchDelayUsSum = 0;
   uint64_t outstandingGetReqsTotal = 0;
   uint64_t outstandingGetReqsHelper = 0;
   uint64_t outstandingGetWaitTimeSumUs = 0;
   uint64_t outstandingUpdateReqsTotal = 0;
   uint64_t outstandingUpdateReqsHelper = 0;
   uint64_t outstandingUpdateWaitTimeSumUs = 0;
+  uint64_t outstandingAdaptiveLimitSum = 0;
+  uint64_t outstandingAdaptiveLimitSamples = 0;
   uint64_t retransPerKByteSum = 0;
   uint64_t retransNumTotal = 0;
   uint64_t destinationRequestsDirtyBufferSum = 0;
@@ -388,10 +419,17 @@ void prepare_stats(CarbonRouterInstanceBase& router, stat_t* stats) {
     auto proxy = router.getProxyBase(i);
     config_last_success = std::max(
         config_last_success, proxy->stats().getValue(config_last_success_stat));
+    const auto readyMs = proxy->stats().getValue(startup_to_ready_ms_stat);
+    allProxiesReady = allProxiesReady && readyMs != 0;
+    startupToReadyMs = std::max(startupToReadyMs, readyMs);
     destinationBatchesSum +=
         proxy->stats().getStatValueWithinWindow(destination_batches_sum_stat);
     destinationRequestsSum +=
         proxy->stats().getStatValueWithinWindow(destination_requests_sum_stat);
+    destinationBatchesDelayedSum += proxy->stats().getStatValueWithinWindow(
+        destination_batches_delayed_sum_stat);
+    destinationBatchDelayUsSum += proxy->stats().getStatValueWithinWindow(
+        destination_batch_delay_us_sum_stat);
 
     outstandingGetReqsTotal += proxy->stats().getStatValueWithinWindow(
         outstanding_route_get_reqs_queued_stat);
@@ -405,6 +443,10 @@ void prepare_stats(CarbonRouterInstanceBase& router, stat_t* stats) {
         outstanding_route_update_reqs_queued_helper_stat);
     outstandingUpdateWaitTimeSumUs += proxy->stats().getStatValueWithinWindow(
         outstanding_route_update_wait_time_sum_us_stat);
+    outstandingAdaptiveLimitSum += proxy->stats().getStatValueWithinWindow(
+        outstanding_route_adaptive_limit_sum_stat);
+    outstandingAdaptiveLimitSamples += proxy->stats().getStatValueWithinWindow(
+        outstanding_route_adaptive_limit_samples_stat);
 
     retransPerKByteSum +=
         proxy->stats().getStatValueWithinWindow(retrans_per_kbyte_sum_stat);
@@ -429,6 +471,13 @@ void prepare_stats(CarbonRouterInstanceBase& router, stat_t* stats) {
   }
   stats[destination_batch_size_stat].data.dbl = avgBatchSize;
 
+  double avgBatchDelayUs = 0.0;
+  if (destinationBatchesDelayedSum != 0) {
+    avgBatchDelayUs =
+        destinationBatchDelayUsSum / (double)destinationBatchesDelayedSum;
+  }
+  stats[destination_batch_delay_us_stat].data.dbl = avgBatchDelayUs;
+
   double avgRetransPerKByte = 0.0;
   if (retransNumTotal != 0) {
     avgRetransPerKByte = retransPerKByteSum / (double)retransNumTotal;
@@ -462,6 +511,12 @@ void prepare_stats(CarbonRouterInstanceBase& router, stat_t* stats) {
         (1000000.0 * outstandingUpdateReqsTotal);
   }
 
+  stats[outstanding_route_adaptive_avg_limit_stat].data.dbl = 0.0;
+  if (outstandingAdaptiveLimitSamples > 0) {
+    stats[outstanding_route_adaptive_avg_limit_stat].data.dbl =
+        outstandingAdaptiveLimitSum / (double)outstandingAdaptiveLimitSamples;
+  }
+
   stats[commandargs_stat].data.string = gStandaloneArgs;
 
   uint64_t now = time(nullptr);
@@ -472,11 +527,36 @@ void prepare_stats(CarbonRouterInstanceBase& router, stat_t* stats) {
 
   stats[config_age_stat].data.uint64 = now - config_last_success;
   stats[config_last_success_stat].data.uint64 = config_last_success;
+  stats[startup_to_ready_ms_stat].data.uint64 =
+      allProxiesReady ? startupToReadyMs : 0;
   stats[config_last_attempt_stat].data.uint64 = router.lastConfigAttempt();
   stats[config_failures_stat].data.uint64 = router.configFailures();
   stats[configs_from_disk_stat].data.uint64 =
       static_cast<uint64_t>(router.configuredFromDisk());
 
+  const auto sessionCacheStats = getTlsSessionCacheStats();
+  stats[ssl_session_cache_lookups_stat].data.uint64 =
+      sessionCacheStats.lookups;
+  stats[ssl_session_cache_hits_stat].data.uint64 = sessionCacheStats.hits;
+  stats[ssl_session_cache_evictions_stat].data.uint64 =
+      sessionCacheStats.evictions;
+  stats[ssl_session_cache_entries_stat].data.uint64 = sessionCacheStats.size;
+
+  if (auto auxPool = AuxiliaryCPUThreadPoolSingleton::try_get_fast()) {
+    const auto auxPoolStats = auxPool->getStats();
+    stats[aux_cpu_pool_queue_depth_stat].data.uint64 = auxPoolStats.queueDepth;
+    stats[aux_cpu_pool_offloaded_stat].data.uint64 = auxPoolStats.offloaded;
+    stats[aux_cpu_pool_inline_fallbacks_stat].data.uint64 =
+        auxPoolStats.inlineFallbacks;
+    stats[aux_cpu_pool_inline_not_on_fiber_stat].data.uint64 =
+        auxPoolStats.inlineNotOnFiber;
+    stats[aux_cpu_pool_avg_latency_us_stat].data.dbl =
+        auxPoolStats.offloaded == 0
+        ? 0.0
+        : static_cast<double>(auxPoolStats.totalLatencyUs) /
+            auxPoolStats.offloaded;
+  }
+
   stats[pid_stat].data.int64 = getpid();
   stats[parent_pid_stat].data.int64 = getppid();
 
@@ -502,13 +582,14 @@ void prepare_stats(CarbonRouterInstanceBase& router, stat_t* stats) {
   stats[fibers_stack_high_watermark_stat].data.uint64 = 0;
   for (size_t i = 0; i < router.opts().num_proxies; ++i) {
     auto pr = router.getProxyBase(i);
-    stats[fibers_allocated_stat].data.uint64 +=
-        pr->fiberManager().fibersAllocated();
-    stats[fibers_pool_size_stat].data.uint64 +=
-        pr->fiberManager().fibersPoolSize();
-    stats[fibers_stack_high_watermark_stat].data.uint64 = std::max(
-        stats[fibers_stack_high_watermark_stat].data.uint64,
-        pr->fiberManager().stackHighWatermark());
+    pr->fiberStackTiers().forEachTier(
+        [stats](folly::fibers::FiberManager& fm) {
+          stats[fibers_allocated_stat].data.uint64 += fm.fibersAllocated();
+          stats[fibers_pool_size_stat].data.uint64 += fm.fibersPoolSize();
+          stats[fibers_stack_high_watermark_stat].data.uint64 = std::max(
+              stats[fibers_stack_high_watermark_stat].data.uint64,
+              fm.stackHighWatermark());
+        });
     stats[duration_us_stat].data.dbl += pr->stats().durationUs().value();
     stats[duration_get_us_stat].data.dbl += pr->stats().durationGetUs().value();
     stats[duration_update_us_stat].data.dbl +=
@@ -581,6 +662,8 @@ static stat_group_t stat_parse_group_str(folly::StringPiece str) {
     return server_stats;
   } else if (str == "suspect_servers") {
     return suspect_server_stats;
+  } else if (str == "key_prefixes") {
+    return key_prefix_stats;
   } else if (str == "count") {
     return count_stats;
   } else if (str.empty()) {
@@ -711,6 +794,36 @@ McStatsReply stats_reply(ProxyBase* proxy, folly::StringPiece group_str) {
     }
   }
 
+  if (groups & key_prefix_stats) {
+    auto& router = proxy->router();
+    std::vector<std::vector<KeyPrefixStats::Entry>> entries;
+    for (size_t i = 0; i < router.opts().num_proxies; ++i) {
+      if (auto keyPrefixStats = router.getProxyBase(i)->keyPrefixStats()) {
+        entries.push_back(keyPrefixStats->getEntries());
+      }
+    }
+    const auto merged = KeyPrefixStats::merge(
+        entries, router.opts().key_prefix_stats_capacity);
+    for (const auto& entry : merged) {
+      const auto& counters = entry.counters;
+      reply.addStat(
+          folly::to<std::string>(entry.poolName, ":", entry.prefix),
+          folly::format(
+              "requests:{} bytes_out:{} bytes_in:{} errors:{} "
+              "avg_latency_us:{:.3f} max_undercount:{}",
+              counters.requests,
+              counters.bytesOut,
+              counters.bytesIn,
+              counters.errors,
+              counters.requests == 0
+                  ? 0.0
+                  : static_cast<double>(counters.totalDurationUs) /
+                      counters.requests,
+              entry.maxUndercount)
+              .str());
+    }
+  }
+
   return reply.getReply();
 }
 
@@ -9,6 +9,7 @@
 
 #include <string>
 #include <unordered_map>
+#include <vector>
 
 #include <folly/Range.h>
 
@@ -72,6 +73,7 @@ enum stat_group_t {
   all_stats = 0xffff,
   server_stats = 0x10000,
   suspect_server_stats = 0x40000,
+  key_prefix_stats = 0x80000,
   unknown_stats = 0x10000000,
 };
 
@@ -134,6 +136,11 @@ void prepare_stats(CarbonRouterInstanceBase& router, stat_t* stats);
 void append_pool_stats(
     CarbonRouterInstanceBase& router,
     std::vector<stat_t>& stats);
+/**
+ * prepare_stats() followed by append_pool_stats(), with rate and max stats
+ * resolved to their current aggregated values.
+ */
+std::vector<stat_t> prepare_aggregated_stats(CarbonRouterInstanceBase& router);
 
 void set_standalone_args(folly::StringPiece args);
 
@@ -968,3 +968,39 @@ class Mcpiper(ProcessBase):
 
     def contains(self, needle):
         return needle in self.output()
+
+
+class Mcreplay(ProcessBase):
+    def __init__(self, trace, extra_args=None):
+        base_dir = BaseDirectory('mcreplay')
+        args = [McrouterGlobals.binPath('mcreplay')]
+
+        if extra_args:
+            args.extend(extra_args)
+        args.append(trace)
+
+        super().__init__(args, base_dir)
+
+    def output(self, timeout=30):
+        if not hasattr(self, 'stdout'):
+            stdout, _ = self.proc.communicate(timeout=timeout)
+            self.stdout = stdout.decode('ascii', errors='ignore')
+        return self.stdout
+
+
+class Mcstats(ProcessBase):
+    def __init__(self, path, extra_args=None):
+        base_dir = BaseDirectory('mcstats')
+        args = [McrouterGlobals.binPath('mcstats')]
+
+        if extra_args:
+            args.extend(extra_args)
+        args.append(path)
+
+        super().__init__(args, base_dir)
+
+    def output(self, timeout=30):
+        if not hasattr(self, 'stdout'):
+            stdout, _ = self.proc.communicate(timeout=timeout)
+            self.stdout = stdout.decode('ascii', errors='ignore')
+        return self.stdout
@@ -0,0 +1,135 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "mcrouter/FairRequestQueue.h"
+
+using namespace facebook::memcache::mcrouter;
+
+namespace {
+
+struct TestEntry : public FairRequestQueueEntry {
+  explicit TestEntry(std::string t) : tenant(std::move(t)) {}
+  std::string tenant;
+};
+
+void push(FairRequestQueue& queue, const std::string& tenant, size_t n) {
+  for (size_t i = 0; i < n; ++i) {
+    queue.push(tenant, std::make_unique<TestEntry>(tenant), 0);
+  }
+}
+
+std::vector<std::string> popAll(FairRequestQueue& queue) {
+  std::vector<std::string> result;
+  while (!queue.empty()) {
+    auto entry = queue.pop(0);
+    result.push_back(static_cast<TestEntry&>(*entry).tenant);
+  }
+  return result;
+}
+
+} // anonymous namespace
+
+TEST(FairRequestQueue, singleTenantIsFifo) {
+  FairRequestQueue queue;
+  for (int i = 0; i < 5; ++i) {
+    queue.push("", std::make_unique<TestEntry>(std::to_string(i)), 0);
+  }
+  EXPECT_EQ(5, queue.size());
+  EXPECT_EQ(
+      std::vector<std::string>({"0", "1", "2", "3", "4"}), popAll(queue));
+}
+
+TEST(FairRequestQueue, roundRobin) {
+  FairRequestQueue queue;
+  push(queue, "a", 4);
+  push(queue, "b", 2);
+
+  EXPECT_EQ(
+      std::vector<std::string>({"a", "b", "a", "b", "a", "a"}),
+      popAll(queue));
+}
+
+TEST(FairRequestQueue, weights) {
+  FairRequestQueue queue({{"a", 3}});
+  push(queue, "a", 6);
+  push(queue, "b", 3);
+
+  EXPECT_EQ(
+      std::vector<std::string>({"a", "a", "a", "b", "a", "a", "a", "b", "b"}),
+      popAll(queue));
+}
+
+TEST(FairRequestQueue, lateTenantGoesLast) {
+  FairRequestQueue queue;
+  push(queue, "a", 2);
+  push(queue, "b", 2);
+  EXPECT_EQ("a", static_cast<TestEntry&>(*queue.pop(0)).tenant);
+  push(queue, "c", 1);
+
+  EXPECT_EQ(std::vector<std::string>({"b", "a", "c", "b"}), popAll(queue));
+}
+
+TEST(FairRequestQueue, overflowTenant) {
+  FairRequestQueue queue({}, 2);
+  push(queue, "a", 1);
+  push(queue, "b", 1);
+  push(queue, "c", 1);
+  push(queue, "d", 1);
+
+  auto stats = queue.dumpTenantStats();
+  EXPECT_EQ(3, stats.size());
+  EXPECT_EQ(2, stats[FairRequestQueue::kOverflowTenant.str()]["depth"].asInt());
+  EXPECT_EQ(4, popAll(queue).size());
+}
+
+TEST(FairRequestQueue, stats) {
+  FairRequestQueue queue({{"a", 2}});
+  queue.push("a", std::make_unique<TestEntry>("a"), 100);
+  queue.push("a", std::make_unique<TestEntry>("a"), 200);
+
+  auto stats = queue.dumpTenantStats();
+  EXPECT_EQ(2, stats["a"]["weight"].asInt());
+  EXPECT_EQ(2, stats["a"]["depth"].asInt());
+
+  queue.pop(300);
+  queue.pop(1200);
+  stats = queue.dumpTenantStats();
+  EXPECT_EQ(0, stats["a"]["depth"].asInt());
+  EXPECT_EQ(2, stats["a"]["dequeued"].asInt());
+  EXPECT_EQ(600, stats["a"]["avg_wait_us"].asInt());
+  EXPECT_EQ(1000, stats["a"]["max_wait_us"].asInt());
+}
+
+TEST(FairRequestQueue, evictIdleTenants) {
+  FairRequestQueue queue({}, 2);
+  push(queue, "a", 1);
+  push(queue, "b", 1);
+  popAll(queue);
+
+  // "a" has been idle for the longest time.
+  push(queue, "c", 1);
+  auto stats = queue.dumpTenantStats();
+  EXPECT_EQ(2, stats.size());
+  EXPECT_EQ(0, stats.count("a"));
+  EXPECT_EQ(1, stats["b"]["dequeued"].asInt());
+  EXPECT_EQ(1, stats["c"]["depth"].asInt());
+
+  // Only "b" is idle; once it's gone too, new tenants overflow.
+  push(queue, "d", 1);
+  push(queue, "e", 1);
+  stats = queue.dumpTenantStats();
+  EXPECT_EQ(0, stats.count("b"));
+  EXPECT_EQ(1, stats["d"]["depth"].asInt());
+  EXPECT_EQ(1, stats[FairRequestQueue::kOverflowTenant.str()]["depth"].asInt());
+  EXPECT_EQ(std::vector<std::string>({"c", "d", "e"}), popAll(queue));
+}
@@ -0,0 +1,230 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <alloca.h>
+
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <folly/fibers/FiberManager.h>
+#include <folly/fibers/SimpleLoopController.h>
+
+#include "mcrouter/FiberStackTiers.h"
+
+using namespace facebook::memcache::mcrouter;
+
+using folly::fibers::FiberManager;
+
+namespace {
+
+constexpr size_t kSmallStackSize = 32 * 1024;
+constexpr size_t kMediumStackSize = 128 * 1024;
+constexpr size_t kLargeStackSize = 512 * 1024;
+
+FiberManager::Options largeOptions() {
+  FiberManager::Options options;
+  options.stackSize = kLargeStackSize;
+  return options;
+}
+
+std::unique_ptr<FiberManager> makeFiberManager(
+    const FiberManager::Options& options) {
+  return std::make_unique<FiberManager>(
+      std::make_unique<folly::fibers::SimpleLoopController>(), options);
+}
+
+std::unique_ptr<FiberStackTiers> makeTiers(
+    FiberManager& large,
+    size_t smallStackSize,
+    size_t mediumStackSize,
+    size_t probeEvery) {
+  return std::make_unique<FiberStackTiers>(
+      large,
+      largeOptions(),
+      smallStackSize,
+      mediumStackSize,
+      probeEvery,
+      &makeFiberManager);
+}
+
+// Runs one request of the given type, using about stackBytes of stack.
+void runRequest(FiberStackTiers& tiers, size_t typeId, size_t stackBytes) {
+  auto& fm = tiers.fiberManagerFor(typeId);
+  fm.addTask([stackBytes]() {
+    auto buf = static_cast<char*>(alloca(stackBytes));
+    std::memset(buf, 1, stackBytes);
+    asm volatile("" : : "r"(buf) : "memory");
+  });
+  fm.loopUntilNoReady();
+}
+
+size_t numTiers(const FiberStackTiers& tiers) {
+  size_t num = 0;
+  tiers.forEachTier([&num](FiberManager&) { ++num; });
+  return num;
+}
+
+// forEachTier() goes from the large tier to the small one, then the medium.
+FiberManager& smallTier(const FiberStackTiers& tiers) {
+  std::vector<FiberManager*> fms;
+  tiers.forEachTier([&fms](FiberManager& fm) { fms.push_back(&fm); });
+  return *fms.at(FiberStackTiers::kSmall + 1);
+}
+
+} // anonymous namespace
+
+TEST(FiberStackTiers, disabled) {
+  auto large = makeFiberManager(largeOptions());
+  auto tiers = makeTiers(*large, 0, 0, 1);
+  EXPECT_FALSE(tiers->enabled());
+  EXPECT_EQ(1, numTiers(*tiers));
+  for (size_t i = 0; i < 2 * FiberStackTiers::kMinProbes; ++i) {
+    EXPECT_EQ(large.get(), &tiers->fiberManagerFor(1));
+  }
+  EXPECT_EQ(FiberStackTiers::kLarge, tiers->tierFor(1));
+
+  // Tiers not smaller than the large one are of no use.
+  auto tooLarge = makeTiers(*large, kLargeStackSize, 0, 1);
+  EXPECT_FALSE(tooLarge->enabled());
+}
+
+TEST(FiberStackTiers, tierStackSizeFloor) {
+  FiberManager::Options options;
+  options.stackSize = FiberStackTiers::kMinTierStackSize;
+  auto large = makeFiberManager(options);
+  // A small tier is raised to the floor, i.e. to the large tier's size.
+  FiberStackTiers tiers(*large, options, 4 * 1024, 0, 1, &makeFiberManager);
+  EXPECT_FALSE(tiers.enabled());
+}
+
+TEST(FiberStackTiers, disabledTierFallsBack) {
+  auto large = makeFiberManager(largeOptions());
+  auto tiers = makeTiers(*large, 0, kMediumStackSize, 1);
+  EXPECT_TRUE(tiers->enabled());
+  EXPECT_EQ(2, numTiers(*tiers));
+
+  // Small tier is disabled: shallow requests go to the medium one.
+  for (size_t i = 0; i <= FiberStackTiers::kMinProbes; ++i) {
+    runRequest(*tiers, 1, 1024);
+  }
+  EXPECT_EQ(FiberStackTiers::kMedium, tiers->tierFor(1));
+}
+
+TEST(FiberStackTiers, pickTierFromProbes) {
+  auto large = makeFiberManager(largeOptions());
+  auto tiers = makeTiers(*large, kSmallStackSize, kMediumStackSize, 2);
+  EXPECT_TRUE(tiers->enabled());
+  EXPECT_EQ(3, numTiers(*tiers));
+
+  // Types start on the large tier, until enough probes ran.
+  EXPECT_EQ(FiberStackTiers::kLarge, tiers->tierFor(1));
+  EXPECT_EQ(large.get(), &tiers->fiberManagerFor(1));
+  for (size_t i = 0; i < 2 * FiberStackTiers::kMinProbes + 2; ++i) {
+    runRequest(*tiers, 1, 1024);
+    runRequest(*tiers, 2, 40 * 1024);
+    runRequest(*tiers, 3, 100 * 1024);
+  }
+  EXPECT_EQ(FiberStackTiers::kSmall, tiers->tierFor(1));
+  EXPECT_EQ(FiberStackTiers::kMedium, tiers->tierFor(2));
+  EXPECT_EQ(FiberStackTiers::kLarge, tiers->tierFor(3));
+  EXPECT_EQ(0, tiers->runQueueSize());
+
+  // Types out of range always use the large tier.
+  EXPECT_EQ(
+      large.get(), &tiers->fiberManagerFor(FiberStackTiers::kMaxTypeId));
+}
+
+TEST(FiberStackTiers, promoteAfterDeeperProbe) {
+  auto large = makeFiberManager(largeOptions());
+  auto tiers = makeTiers(*large, kSmallStackSize, kMediumStackSize, 1);
+  for (size_t i = 0; i <= FiberStackTiers::kMinProbes; ++i) {
+    runRequest(*tiers, 1, 1024);
+  }
+  EXPECT_EQ(FiberStackTiers::kSmall, tiers->tierFor(1));
+
+  // The tier is picked by the next probe, from all the previous ones.
+  runRequest(*tiers, 1, 40 * 1024);
+  EXPECT_EQ(FiberStackTiers::kSmall, tiers->tierFor(1));
+  runRequest(*tiers, 1, 1024);
+  EXPECT_EQ(FiberStackTiers::kMedium, tiers->tierFor(1));
+
+  // Watermarks never go down.
+  for (size_t i = 0; i <= FiberStackTiers::kMinProbes; ++i) {
+    runRequest(*tiers, 1, 1024);
+  }
+  EXPECT_EQ(FiberStackTiers::kMedium, tiers->tierFor(1));
+}
+
+TEST(FiberStackTiers, retireTierNearStackSize) {
+  auto large = makeFiberManager(largeOptions());
+  auto tiers = makeTiers(*large, kSmallStackSize, kMediumStackSize, 2);
+  for (size_t i = 0; i < 2 * FiberStackTiers::kMinProbes + 2; ++i) {
+    runRequest(*tiers, 1, 1024);
+    runRequest(*tiers, 2, 1024);
+  }
+  EXPECT_EQ(FiberStackTiers::kSmall, tiers->tierFor(1));
+  EXPECT_EQ(FiberStackTiers::kSmall, tiers->tierFor(2));
+
+  // Requests deeper than any probe saw, on the small tier. One fiber out of
+  // probeEvery records its stack.
+  auto& small = smallTier(*tiers);
+  for (size_t i = 0; i < 2; ++i) {
+    small.addTask([]() {
+      constexpr size_t kStackBytes = 28 * 1024;
+      auto buf = static_cast<char*>(alloca(kStackBytes));
+      std::memset(buf, 1, kStackBytes);
+      asm volatile("" : : "r"(buf) : "memory");
+    });
+    small.loopUntilNoReady();
+  }
+  EXPECT_GT(small.stackHighWatermark(), kSmallStackSize * 3 / 4);
+
+  // The next probe moves every type off the small tier, for good.
+  runRequest(*tiers, 1, 1024);
+  runRequest(*tiers, 1, 1024);
+  EXPECT_EQ(FiberStackTiers::kMedium, tiers->tierFor(1));
+  EXPECT_EQ(FiberStackTiers::kMedium, tiers->tierFor(2));
+  for (size_t i = 0; i < 2 * FiberStackTiers::kMinProbes + 2; ++i) {
+    runRequest(*tiers, 3, 1024);
+  }
+  EXPECT_EQ(FiberStackTiers::kMedium, tiers->tierFor(3));
+}
+
+TEST(FiberStackTiers, resetOnReconfigure) {
+  auto large = makeFiberManager(largeOptions());
+  auto tiers = makeTiers(*large, kSmallStackSize, kMediumStackSize, 1);
+  for (size_t i = 0; i <= FiberStackTiers::kMinProbes; ++i) {
+    runRequest(*tiers, 1, 40 * 1024);
+    runRequest(*tiers, 2, 1024);
+  }
+  EXPECT_EQ(FiberStackTiers::kMedium, tiers->tierFor(1));
+  EXPECT_EQ(FiberStackTiers::kSmall, tiers->tierFor(2));
+
+  // As done when a new config is swapped in: every type is back on the
+  // large tier before the next request.
+  tiers->requestReset();
+  runRequest(*tiers, 3, 1024);
+  EXPECT_EQ(FiberStackTiers::kLarge, tiers->tierFor(1));
+  EXPECT_EQ(FiberStackTiers::kLarge, tiers->tierFor(2));
+
+  // Probes start over: the deeper requests of the old config are forgotten,
+  // and the new ones are seen before any type leaves the large tier.
+  for (size_t i = 0; i < FiberStackTiers::kMinProbes; ++i) {
+    runRequest(*tiers, 1, 1024);
+    runRequest(*tiers, 2, 40 * 1024);
+    EXPECT_EQ(FiberStackTiers::kLarge, tiers->tierFor(1));
+    EXPECT_EQ(FiberStackTiers::kLarge, tiers->tierFor(2));
+  }
+  runRequest(*tiers, 1, 1024);
+  runRequest(*tiers, 2, 40 * 1024);
+  EXPECT_EQ(FiberStackTiers::kSmall, tiers->tierFor(1));
+  EXPECT_EQ(FiberStackTiers::kMedium, tiers->tierFor(2));
+  EXPECT_EQ(0, tiers->runQueueSize());
+}
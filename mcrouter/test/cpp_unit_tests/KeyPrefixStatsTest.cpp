@@ -0,0 +1,179 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <folly/Conv.h>
+
+#include "mcrouter/KeyPrefixStats.h"
+
+using namespace facebook::memcache::mcrouter;
+
+namespace {
+
+const KeyPrefixStats::Entry* find(
+    const std::vector<KeyPrefixStats::Entry>& entries,
+    folly::StringPiece poolName,
+    folly::StringPiece prefix) {
+  for (const auto& entry : entries) {
+    if (entry.poolName == poolName && entry.prefix == prefix) {
+      return &entry;
+    }
+  }
+  return nullptr;
+}
+
+} // anonymous namespace
+
+TEST(KeyPrefixStats, extractPrefixDelimiter) {
+  KeyPrefixStats stats(64, ':', 2);
+  EXPECT_EQ("a:b", stats.extractPrefix("a:b:c:d"));
+  EXPECT_EQ("a:b", stats.extractPrefix("a:b:"));
+  // Fewer components than depth.
+  EXPECT_EQ("a", stats.extractPrefix("a:b"));
+  EXPECT_EQ("", stats.extractPrefix("abc"));
+  EXPECT_EQ("", stats.extractPrefix(""));
+  EXPECT_EQ("", stats.extractPrefix(":a"));
+
+  // Truncated.
+  const std::string longKey = std::string(100, 'x') + ":y:z";
+  EXPECT_EQ(
+      std::string(KeyPrefixStats::kMaxPrefixSize, 'x'),
+      stats.extractPrefix(longKey));
+}
+
+TEST(KeyPrefixStats, extractPrefixBytes) {
+  KeyPrefixStats stats(64, '\0', 3);
+  EXPECT_EQ("abc", stats.extractPrefix("abcdef"));
+  EXPECT_EQ("ab", stats.extractPrefix("ab"));
+}
+
+TEST(KeyPrefixStats, record) {
+  KeyPrefixStats stats(64, ':', 1);
+  stats.record("pool", "user:1", 10, 100, false, 5);
+  stats.record("pool", "user:2", 10, 200, true, 15);
+  stats.record("pool", "feed:1", 20, 0, false, 1);
+  stats.record("other", "user:1", 1, 1, false, 1);
+
+  const auto entries = stats.getEntries();
+  EXPECT_EQ(3, entries.size());
+
+  auto user = find(entries, "pool", "user");
+  ASSERT_NE(nullptr, user);
+  EXPECT_EQ(2, user->counters.requests);
+  EXPECT_EQ(20, user->counters.bytesOut);
+  EXPECT_EQ(300, user->counters.bytesIn);
+  EXPECT_EQ(1, user->counters.errors);
+  EXPECT_EQ(20, user->counters.totalDurationUs);
+  EXPECT_EQ(0, user->maxUndercount);
+
+  auto feed = find(entries, "pool", "feed");
+  ASSERT_NE(nullptr, feed);
+  EXPECT_EQ(1, feed->counters.requests);
+
+  auto otherUser = find(entries, "other", "user");
+  ASSERT_NE(nullptr, otherUser);
+  EXPECT_EQ(1, otherUser->counters.requests);
+}
+
+TEST(KeyPrefixStats, poolNameReused) {
+  KeyPrefixStats stats(64, ':', 1);
+  // A new pool name at the address of the previous one, e.g. after a
+  // reconfigure.
+  std::string poolName = "pool1";
+  stats.record(poolName, "user:1", 1, 1, false, 1);
+  poolName[4] = '2';
+  stats.record(poolName, "user:1", 1, 1, false, 1);
+
+  const auto entries = stats.getEntries();
+  EXPECT_EQ(2, entries.size());
+  auto pool1 = find(entries, "pool1", "user");
+  ASSERT_NE(nullptr, pool1);
+  EXPECT_EQ(1, pool1->counters.requests);
+  auto pool2 = find(entries, "pool2", "user");
+  ASSERT_NE(nullptr, pool2);
+  EXPECT_EQ(1, pool2->counters.requests);
+}
+
+TEST(KeyPrefixStats, boundedCardinality) {
+  KeyPrefixStats stats(64, ':', 1);
+  EXPECT_EQ(64, stats.capacity());
+
+  for (size_t i = 0; i < 100000; ++i) {
+    // One heavy hitter among lots of one-off prefixes.
+    stats.record("pool", "hot:key", 1, 1, false, 1);
+    stats.record("pool", folly::to<std::string>(i, ":key"), 1, 1, false, 1);
+  }
+
+  const auto entries = stats.getEntries();
+  EXPECT_LE(entries.size(), stats.capacity());
+  auto hot = find(entries, "pool", "hot");
+  ASSERT_NE(nullptr, hot);
+  EXPECT_EQ(100000, hot->counters.requests + hot->maxUndercount);
+  EXPECT_GT(hot->counters.requests, 90000);
+}
+
+TEST(KeyPrefixStats, merge) {
+  KeyPrefixStats stats1(64, ':', 1);
+  KeyPrefixStats stats2(64, ':', 1);
+  stats1.record("pool", "a:1", 1, 2, false, 3);
+  stats1.record("pool", "b:1", 1, 2, false, 3);
+  stats2.record("pool", "a:1", 1, 2, true, 3);
+  stats2.record("pool", "a:2", 1, 2, false, 3);
+
+  const auto merged =
+      KeyPrefixStats::merge({stats1.getEntries(), stats2.getEntries()}, 1);
+  ASSERT_EQ(1, merged.size());
+  EXPECT_EQ("pool", merged[0].poolName);
+  EXPECT_EQ("a", merged[0].prefix);
+  EXPECT_EQ(3, merged[0].counters.requests);
+  EXPECT_EQ(3, merged[0].counters.bytesOut);
+  EXPECT_EQ(6, merged[0].counters.bytesIn);
+  EXPECT_EQ(1, merged[0].counters.errors);
+  EXPECT_EQ(9, merged[0].counters.totalDurationUs);
+}
+
+TEST(KeyPrefixStats, getEntriesWhileRecording) {
+  // Small enough for prefixes to keep replacing each other.
+  KeyPrefixStats stats(8, ':', 1);
+  std::atomic<bool> done{false};
+  std::thread proxyThread([&]() {
+    for (size_t i = 0; i < 1000000; ++i) {
+      // Every counter of a prefix is a multiple of its requests.
+      const auto n = i % 32 + 1;
+      stats.record(
+          folly::to<std::string>("pool", n),
+          folly::to<std::string>(n, ":key"),
+          n,
+          2 * n,
+          true,
+          3 * n);
+    }
+    done = true;
+  });
+
+  size_t numEntries = 0;
+  while (!done) {
+    for (const auto& entry : stats.getEntries()) {
+      const auto n = folly::to<uint64_t>(entry.prefix);
+      EXPECT_EQ(folly::to<std::string>("pool", n), entry.poolName);
+      const auto& counters = entry.counters;
+      EXPECT_EQ(n * counters.requests, counters.bytesOut);
+      EXPECT_EQ(2 * n * counters.requests, counters.bytesIn);
+      EXPECT_EQ(counters.requests, counters.errors);
+      EXPECT_EQ(3 * n * counters.requests, counters.totalDurationUs);
+      ++numEntries;
+    }
+  }
+  proxyThread.join();
+  EXPECT_GT(numEntries, 0);
+}
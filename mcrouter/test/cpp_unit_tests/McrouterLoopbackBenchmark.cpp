@@ -0,0 +1,615 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <sys/resource.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gflags/gflags.h>
+
+#include <folly/Conv.h>
+#include <folly/FileUtil.h>
+#include <folly/Format.h>
+#include <folly/String.h>
+#include <folly/fibers/EventBaseLoopController.h>
+#include <folly/fibers/FiberManager.h>
+#include <folly/init/Init.h>
+#include <folly/io/async/EventBase.h>
+
+#include "mcrouter/CarbonRouterInstance.h"
+#include "mcrouter/Server.h"
+#include "mcrouter/config.h"
+#include "mcrouter/lib/McResUtil.h"
+#include "mcrouter/lib/network/AsyncMcClient.h"
+#include "mcrouter/lib/network/AsyncMcServer.h"
+#include "mcrouter/lib/network/AsyncMcServerWorker.h"
+#include "mcrouter/lib/network/IoUringUtil.h"
+#include "mcrouter/lib/network/gen/MemcacheMessages.h"
+#include "mcrouter/lib/network/gen/MemcacheRouterInfo.h"
+#include "mcrouter/lib/network/gen/MemcacheServer.h"
+#include "mcrouter/lib/network/test/ListenSocket.h"
+#include "mcrouter/lib/network/test/MockMcOnRequest.h"
+#include "mcrouter/standalone_options.h"
+
+/**
+ * End-to-end loopback benchmark.
+ *
+ * Starts a number of MockMc backends (AsyncMcServer + MockMcOnRequest) and a
+ * full mcrouter (CarbonRouterInstance behind an AsyncMcServer, wired the same
+ * way as the standalone server) in-process, then drives it with AsyncMcClient
+ * load generators over loopback. For every combination of protocol, route
+ * shape and value size it reports QPS, p50/p99/p999 latency and CPU time per
+ * request.
+ *
+ * The io_uring transport only applies to mcrouter itself (its server threads,
+ * which are shared with the proxies, and its connections to the backends);
+ * the load generators and the mock backends always use epoll.
+ *
+ * CPU per request is measured with getrusage() for the whole process, so it
+ * includes the load generators and the mock backends. It is meant to be
+ * compared between builds, not to be read as the cost of mcrouter alone.
+ *
+ * RSS is the growth of the resident set of the process between the start of
+ * mcrouter and the end of the measured period, at the fixed concurrency set
+ * by the load generator flags. Comparing fiber stack tiers off/on shows how
+ * much fiber stack memory mcrouter touches. Like CPU, it is a whole process
+ * figure: only compare runs with the same load.
+ *
+ * Direct routing off/on compares routing simple trees (e.g. the single and
+ * hash route shapes) through the whole route handle tree on a fiber, with
+ * resolving them before the fiber starts (see the direct_routing option).
+ *
+ * Usage:
+ *   $ mcrouter_loopback_benchmark --protocols=caret --value_sizes=100,10000
+ *   $ mcrouter_loopback_benchmark --transports=epoll,io_uring
+ *   $ mcrouter_loopback_benchmark --fiber_stack_tiers=off,on --concurrency=64
+ *   $ mcrouter_loopback_benchmark --routes=hash --direct_routing=off,on
+ *   $ mcrouter_loopback_benchmark --config_file=my_config.json
+ */
+
+DEFINE_string(
+    protocols,
+    "ascii,caret",
+    "Comma separated list of protocols to benchmark (ascii, caret)");
+DEFINE_string(
+    routes,
+    "single,hash,failover,all_sync",
+    "Comma separated list of route shapes to benchmark "
+    "(single, hash, failover, all_sync)");
+DEFINE_string(
+    transports,
+    "epoll",
+    "Comma separated list of mcrouter transports to benchmark "
+    "(epoll, io_uring)");
+DEFINE_string(
+    value_sizes,
+    "10,1000,100000",
+    "Comma separated list of value sizes (bytes) to benchmark");
+DEFINE_string(
+    config_file,
+    "",
+    "Benchmark this mcrouter config instead of the built-in route shapes. "
+    "Occurrences of '%BACKENDS%' are replaced with a JSON list of backend "
+    "addresses, '%PROTOCOL%' with the protocol being benchmarked and "
+    "'%USE_IO_URING%' with true/false depending on the transport.");
+DEFINE_string(
+    fiber_stack_tiers,
+    "off",
+    "Comma separated list of fiber stack tier settings to benchmark (off, on)");
+DEFINE_string(
+    direct_routing,
+    "off",
+    "Comma separated list of direct routing settings to benchmark (off, on)");
+DEFINE_uint64(
+    fibers_small_stack_size,
+    16 * 1024,
+    "Small fiber stack size used when fiber stack tiers are on");
+DEFINE_uint64(
+    fibers_medium_stack_size,
+    32 * 1024,
+    "Medium fiber stack size used when fiber stack tiers are on");
+DEFINE_int32(num_proxies, 2, "Number of mcrouter proxy threads");
+DEFINE_int32(num_backends, 4, "Number of mock memcached backends");
+DEFINE_int32(num_client_threads, 2, "Number of load generator threads");
+DEFINE_int32(
+    num_connections,
+    4,
+    "Number of connections to mcrouter per load generator thread");
+DEFINE_int32(concurrency, 16, "Number of outstanding requests per connection");
+DEFINE_int32(num_keys, 10000, "Size of the keyspace");
+DEFINE_double(get_ratio, 0.9, "Fraction of requests that are gets");
+DEFINE_int32(warmup_ms, 500, "Warm up duration for every run (not measured)");
+DEFINE_int32(duration_ms, 3000, "Measured duration of every run");
+DEFINE_int32(timeout_ms, 1000, "Client request timeout");
+
+using namespace facebook::memcache;
+using namespace facebook::memcache::mcrouter;
+
+namespace {
+
+constexpr folly::StringPiece kSingleConfig = R"(
+{
+  "pools": {
+    "A": { "servers": [ %BACKEND0% ], "protocol": "%PROTOCOL%",
+           "use_io_uring": %USE_IO_URING% }
+  },
+  "route": "PoolRoute|A"
+})";
+
+constexpr folly::StringPiece kHashConfig = R"(
+{
+  "pools": {
+    "A": { "servers": %BACKENDS%, "protocol": "%PROTOCOL%",
+           "use_io_uring": %USE_IO_URING% }
+  },
+  "route": "PoolRoute|A"
+})";
+
+constexpr folly::StringPiece kFailoverConfig = R"(
+{
+  "pools": {
+    "A": { "servers": %BACKENDS%, "protocol": "%PROTOCOL%",
+           "use_io_uring": %USE_IO_URING% },
+    "B": { "servers": %BACKENDS%, "protocol": "%PROTOCOL%",
+           "use_io_uring": %USE_IO_URING% }
+  },
+  "route": {
+    "type": "FailoverRoute",
+    "children": [ "PoolRoute|A", "PoolRoute|B" ]
+  }
+})";
+
+constexpr folly::StringPiece kAllSyncConfig = R"(
+{
+  "pools": {
+    "A": { "servers": %BACKENDS%, "protocol": "%PROTOCOL%",
+           "use_io_uring": %USE_IO_URING% },
+    "B": { "servers": %BACKENDS%, "protocol": "%PROTOCOL%",
+           "use_io_uring": %USE_IO_URING% }
+  },
+  "route": {
+    "type": "OperationSelectorRoute",
+    "default_policy": "PoolRoute|A",
+    "operation_policies": {
+      "set": {
+        "type": "AllSyncRoute",
+        "children": [ "PoolRoute|A", "PoolRoute|B" ]
+      }
+    }
+  }
+})";
+
+folly::StringPiece routeTemplate(folly::StringPiece route) {
+  if (route == "single") {
+    return kSingleConfig;
+  } else if (route == "hash") {
+    return kHashConfig;
+  } else if (route == "failover") {
+    return kFailoverConfig;
+  } else if (route == "all_sync") {
+    return kAllSyncConfig;
+  }
+  throw std::invalid_argument(folly::sformat("Unknown route shape {}", route));
+}
+
+mc_protocol_t parseProtocol(folly::StringPiece protocol) {
+  if (protocol == "ascii") {
+    return mc_ascii_protocol;
+  } else if (protocol == "caret") {
+    return mc_caret_protocol;
+  }
+  throw std::invalid_argument(folly::sformat("Unknown protocol {}", protocol));
+}
+
+bool parseTransport(folly::StringPiece transport) {
+  if (transport == "epoll") {
+    return false;
+  } else if (transport == "io_uring") {
+    if (!IoUringUtil::isAvailable()) {
+      LOG(WARNING) << "io_uring is not available, io_uring runs use epoll";
+    }
+    return true;
+  }
+  throw std::invalid_argument(
+      folly::sformat("Unknown transport {}", transport));
+}
+
+bool parseOnOff(folly::StringPiece flag, folly::StringPiece value) {
+  if (value == "off") {
+    return false;
+  } else if (value == "on") {
+    return true;
+  }
+  throw std::invalid_argument(folly::sformat("Unknown {} {}", flag, value));
+}
+
+std::vector<std::string> splitList(folly::StringPiece list) {
+  std::vector<std::string> result;
+  folly::split(',', list, result, true /* ignoreEmpty */);
+  return result;
+}
+
+double cpuTimeSec() {
+  struct rusage usage;
+  ::getrusage(RUSAGE_SELF, &usage);
+  return usage.ru_utime.tv_sec + usage.ru_utime.tv_usec / 1e6 +
+      usage.ru_stime.tv_sec + usage.ru_stime.tv_usec / 1e6;
+}
+
+size_t rssKb() {
+  std::string statm;
+  if (!folly::readFile("/proc/self/statm", statm)) {
+    return 0;
+  }
+  std::vector<folly::StringPiece> fields;
+  folly::split(' ', statm, fields);
+  if (fields.size() < 2) {
+    return 0;
+  }
+  return folly::to<size_t>(fields[1]) * ::sysconf(_SC_PAGESIZE) / 1024;
+}
+
+/**
+ * Mock memcached servers, each one listening on its own loopback port.
+ */
+class MockBackends {
+ public:
+  explicit MockBackends(size_t numBackends) {
+    for (size_t i = 0; i < numBackends; ++i) {
+      ListenSocket socket;
+      ports_.push_back(socket.getPort());
+
+      AsyncMcServer::Options opts;
+      opts.existingSocketFd = socket.releaseSocketFd();
+      opts.numThreads = 1;
+      opts.worker.versionString = "MockMcServer-1.0";
+
+      auto server = std::make_unique<AsyncMcServer>(opts);
+      server->spawn([](size_t /* threadId */,
+                       folly::EventBase& evb,
+                       AsyncMcServerWorker& worker) {
+        worker.setOnRequest(MemcacheRequestHandler<MockMcOnRequest>());
+        evb.loop();
+      });
+      servers_.push_back(std::move(server));
+    }
+  }
+
+  ~MockBackends() {
+    for (auto& server : servers_) {
+      server->shutdown();
+      server->join();
+    }
+  }
+
+  const std::vector<uint16_t>& ports() const {
+    return ports_;
+  }
+
+ private:
+  std::vector<uint16_t> ports_;
+  std::vector<std::unique_ptr<AsyncMcServer>> servers_;
+};
+
+struct RouterSettings {
+  bool useIoUring{false};
+  bool fiberStackTiers{false};
+  bool directRouting{false};
+};
+
+/**
+ * mcrouter listening on a loopback port, set up like the standalone server.
+ */
+class LoopbackRouter {
+ public:
+  LoopbackRouter(std::string config, const RouterSettings& settings) {
+    ListenSocket socket;
+    port_ = socket.getPort();
+
+    AsyncMcServer::Options serverOpts;
+    serverOpts.existingSocketFd = socket.releaseSocketFd();
+    serverOpts.numThreads = FLAGS_num_proxies;
+    serverOpts.worker.defaultVersionHandler = false;
+    serverOpts.worker.maxReadsPerEvent = 1;
+    serverOpts.worker.useIoUring = settings.useIoUring;
+    server_ = std::make_unique<AsyncMcServer>(serverOpts);
+
+    auto opts = defaultTestOptions();
+    opts.num_proxies = FLAGS_num_proxies;
+    opts.config_str = std::move(config);
+    opts.asynclog_disable = true;
+    if (settings.fiberStackTiers) {
+      opts.fibers_small_stack_size = FLAGS_fibers_small_stack_size;
+      opts.fibers_medium_stack_size = FLAGS_fibers_medium_stack_size;
+    }
+    opts.direct_routing = settings.directRouting;
+    router_ = CarbonRouterInstance<MemcacheRouterInfo>::init(
+        folly::sformat("loopback_benchmark_{}", port_),
+        opts,
+        server_->eventBases());
+    if (router_ == nullptr) {
+      throw std::runtime_error("Failed to initialize mcrouter");
+    }
+
+    server_->spawn([router = router_, &standaloneOpts = standaloneOpts_](
+                       size_t threadId,
+                       folly::EventBase& evb,
+                       AsyncMcServerWorker& worker) {
+      detail::serverLoop<MemcacheRouterInfo, MemcacheRequestHandler>(
+          *router, threadId, evb, worker, standaloneOpts);
+    });
+  }
+
+  ~LoopbackRouter() {
+    server_->shutdown();
+    router_->shutdown();
+    server_->join();
+  }
+
+  uint16_t port() const {
+    return port_;
+  }
+
+ private:
+  uint16_t port_{0};
+  McrouterStandaloneOptions standaloneOpts_;
+  std::unique_ptr<AsyncMcServer> server_;
+  CarbonRouterInstance<MemcacheRouterInfo>* router_{nullptr};
+};
+
+struct RunResult {
+  uint64_t requests{0};
+  uint64_t errors{0};
+  std::vector<uint32_t> latenciesUs;
+};
+
+/**
+ * One load generator thread: owns an EventBase, a FiberManager and a number
+ * of AsyncMcClient connections with `concurrency` sender fibers each.
+ */
+class LoadGenerator {
+ public:
+  LoadGenerator(uint16_t port, mc_protocol_t protocol, size_t valueSize)
+      : port_(port), protocol_(protocol), value_(valueSize, 'v') {}
+
+  void run(
+      std::atomic<bool>& measuring,
+      std::atomic<bool>& stop,
+      RunResult& result) {
+    folly::EventBase evb;
+    folly::fibers::FiberManager fm(
+        std::make_unique<folly::fibers::EventBaseLoopController>());
+    dynamic_cast<folly::fibers::EventBaseLoopController&>(fm.loopController())
+        .attachEventBase(evb);
+
+    std::vector<std::unique_ptr<AsyncMcClient>> clients;
+    for (int i = 0; i < FLAGS_num_connections; ++i) {
+      ConnectionOptions opts("localhost", port_, protocol_);
+      opts.connectTimeout = std::chrono::milliseconds(FLAGS_timeout_ms);
+      opts.writeTimeout = std::chrono::milliseconds(FLAGS_timeout_ms);
+      clients.push_back(std::make_unique<AsyncMcClient>(evb, opts));
+    }
+
+    const std::chrono::milliseconds timeout(FLAGS_timeout_ms);
+    for (auto& client : clients) {
+      for (int i = 0; i < FLAGS_concurrency; ++i) {
+        fm.addTask([&, &mcClient = *client, seed = rng_()]() {
+          std::mt19937 rng(seed);
+          std::uniform_int_distribution<int> keyDist(0, FLAGS_num_keys - 1);
+          std::bernoulli_distribution isGet(FLAGS_get_ratio);
+          while (!stop.load(std::memory_order_relaxed)) {
+            // Backends are shared by all runs: keys are namespaced by value
+            // size, so that gets only find values of the size measured.
+            auto key = folly::to<std::string>(
+                "key:", value_.size(), ":", keyDist(rng));
+            auto start = std::chrono::steady_clock::now();
+            bool error;
+            if (isGet(rng)) {
+              McGetRequest req(std::move(key));
+              auto reply = mcClient.sendSync(req, timeout);
+              error = isErrorResult(reply.result());
+            } else {
+              McSetRequest req(std::move(key));
+              req.value() = folly::IOBuf::wrapBufferAsValue(
+                  value_.data(), value_.size());
+              auto reply = mcClient.sendSync(req, timeout);
+              error = isErrorResult(reply.result());
+            }
+            if (!measuring.load(std::memory_order_relaxed)) {
+              continue;
+            }
+            auto latency =
+                std::chrono::duration_cast<std::chrono::microseconds>(
+                    std::chrono::steady_clock::now() - start);
+            ++result.requests;
+            result.errors += error ? 1 : 0;
+            result.latenciesUs.push_back(latency.count());
+          }
+        });
+      }
+    }
+
+    while (fm.hasTasks()) {
+      evb.loopOnce();
+    }
+    for (auto& client : clients) {
+      client->closeNow();
+    }
+    evb.loop();
+  }
+
+ private:
+  const uint16_t port_;
+  const mc_protocol_t protocol_;
+  const std::string value_;
+  std::mt19937 rng_{std::random_device()()};
+};
+
+uint32_t percentile(const std::vector<uint32_t>& sorted, double p) {
+  if (sorted.empty()) {
+    return 0;
+  }
+  auto idx = static_cast<size_t>(p * (sorted.size() - 1));
+  return sorted[idx];
+}
+
+void runOne(
+    const std::string& label,
+    const std::string& config,
+    const RouterSettings& settings,
+    mc_protocol_t protocol,
+    size_t valueSize) {
+  const auto rssStart = rssKb();
+  LoopbackRouter router(config, settings);
+
+  std::atomic<bool> measuring{false};
+  std::atomic<bool> stop{false};
+  std::vector<RunResult> results(FLAGS_num_client_threads);
+  std::vector<std::thread> threads;
+  for (int i = 0; i < FLAGS_num_client_threads; ++i) {
+    threads.emplace_back([&, i]() {
+      LoadGenerator(router.port(), protocol, valueSize)
+          .run(measuring, stop, results[i]);
+    });
+  }
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(FLAGS_warmup_ms));
+  auto cpuStart = cpuTimeSec();
+  auto start = std::chrono::steady_clock::now();
+  measuring = true;
+  std::this_thread::sleep_for(std::chrono::milliseconds(FLAGS_duration_ms));
+  measuring = false;
+  const auto rssEnd = rssKb();
+  auto elapsed = std::chrono::duration<double>(
+                     std::chrono::steady_clock::now() - start)
+                     .count();
+  auto cpu = cpuTimeSec() - cpuStart;
+  stop = true;
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  RunResult total;
+  for (auto& result : results) {
+    total.requests += result.requests;
+    total.errors += result.errors;
+    total.latenciesUs.insert(
+        total.latenciesUs.end(),
+        result.latenciesUs.begin(),
+        result.latenciesUs.end());
+  }
+  std::sort(total.latenciesUs.begin(), total.latenciesUs.end());
+
+  std::cout << folly::sformat(
+                   "{:<52} {:>8} {:>12.0f} {:>8} {:>8} {:>8} {:>10.2f} {:>10} "
+                   "{:>8}",
+                   label,
+                   valueSize,
+                   total.requests / elapsed,
+                   percentile(total.latenciesUs, 0.5),
+                   percentile(total.latenciesUs, 0.99),
+                   percentile(total.latenciesUs, 0.999),
+                   total.requests ? cpu * 1e6 / total.requests : 0.0,
+                   rssEnd > rssStart ? rssEnd - rssStart : 0,
+                   total.errors)
+            << std::endl;
+}
+
+std::string makeConfig(
+    folly::StringPiece configTemplate,
+    const std::vector<uint16_t>& ports,
+    folly::StringPiece protocol,
+    bool useIoUring) {
+  std::vector<std::string> backends;
+  for (auto port : ports) {
+    backends.push_back(folly::sformat("\"127.0.0.1:{}\"", port));
+  }
+  auto config = configTemplate.str();
+  folly::replaceAll(
+      config, "%BACKENDS%", folly::sformat("[{}]", folly::join(",", backends)));
+  folly::replaceAll(config, "%BACKEND0%", backends.front());
+  folly::replaceAll(config, "%PROTOCOL%", protocol);
+  folly::replaceAll(config, "%USE_IO_URING%", useIoUring ? "true" : "false");
+  return config;
+}
+
+} // anonymous namespace
+
+int main(int argc, char** argv) {
+  folly::init(&argc, &argv);
+
+  std::string customConfig;
+  if (!FLAGS_config_file.empty()) {
+    if (!folly::readFile(FLAGS_config_file.c_str(), customConfig)) {
+      LOG(ERROR) << "Can not read config file " << FLAGS_config_file;
+      return 1;
+    }
+  }
+
+  MockBackends backends(std::max(FLAGS_num_backends, 1));
+
+  std::cout << folly::sformat(
+                   "{:<52} {:>8} {:>12} {:>8} {:>8} {:>8} {:>10} {:>10} {:>8}",
+                   "transport/protocol/route/stack_tiers/direct",
+                   "value",
+                   "qps",
+                   "p50_us",
+                   "p99_us",
+                   "p999_us",
+                   "cpu_us/req",
+                   "rss_kb",
+                   "errors")
+            << std::endl;
+
+  auto routes =
+      customConfig.empty() ? splitList(FLAGS_routes) : splitList("custom");
+  RouterSettings settings;
+  for (const auto& transport : splitList(FLAGS_transports)) {
+    settings.useIoUring = parseTransport(transport);
+    for (const auto& protocol : splitList(FLAGS_protocols)) {
+      for (const auto& route : routes) {
+        auto config = makeConfig(
+            customConfig.empty() ? routeTemplate(route) : customConfig,
+            backends.ports(),
+            protocol,
+            settings.useIoUring);
+        for (const auto& tiers : splitList(FLAGS_fiber_stack_tiers)) {
+          settings.fiberStackTiers = parseOnOff("fiber stack tiers", tiers);
+          for (const auto& direct : splitList(FLAGS_direct_routing)) {
+            settings.directRouting = parseOnOff("direct routing", direct);
+            for (const auto& valueSize : splitList(FLAGS_value_sizes)) {
+              runOne(
+                  folly::sformat(
+                      "{}/{}/{}/{}/{}",
+                      transport,
+                      protocol,
+                      route,
+                      tiers,
+                      direct),
+                  config,
+                  settings,
+                  parseProtocol(protocol),
+                  folly::to<size_t>(valueSize));
+            }
+          }
+        }
+      }
+    }
+  }
+
+  freeAllRouters();
+  return 0;
+}
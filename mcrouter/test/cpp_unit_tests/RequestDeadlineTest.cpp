@@ -0,0 +1,130 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <chrono>
+#include <memory>
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include <folly/Format.h>
+#include <folly/fibers/Baton.h>
+
+#include "mcrouter/CarbonRouterClient.h"
+#include "mcrouter/CarbonRouterInstance.h"
+#include "mcrouter/ProxyBase.h"
+#include "mcrouter/config.h"
+#include "mcrouter/lib/network/gen/MemcacheRouterInfo.h"
+#include "mcrouter/lib/network/test/TestClientServerUtil.h"
+#include "mcrouter/stats.h"
+
+using namespace facebook::memcache;
+using namespace facebook::memcache::mcrouter;
+
+using facebook::memcache::test::TestServer;
+
+namespace {
+
+// The test server only replies to "sleep" after a second.
+constexpr std::chrono::milliseconds kServerTimeout{5000};
+constexpr std::chrono::milliseconds kRequestTimeout{200};
+
+std::unique_ptr<TestServer> createServer() {
+  TestServer::Config config;
+  config.useSsl = false;
+  return TestServer::create(std::move(config));
+}
+
+McrouterOptions routerOptions(const std::string& route, uint16_t port) {
+  auto opts = defaultTestOptions();
+  opts.num_proxies = 1;
+  opts.server_timeout_ms = kServerTimeout.count();
+  opts.config_str = folly::sformat(
+      R"({{
+        "pools": {{
+          "A": {{ "servers": [ "localhost:{0}" ] }},
+          "B": {{ "servers": [ "localhost:{0}" ] }}
+        }},
+        "route": {1}
+      }})",
+      port,
+      route);
+  return opts;
+}
+
+McGetReply sendGet(
+    CarbonRouterInstance<MemcacheRouterInfo>& router,
+    const std::string& key) {
+  auto client = router.createClient(0 /* max_outstanding_requests */);
+  client->setRequestTimeout(kRequestTimeout);
+
+  const McGetRequest req(key);
+  McGetReply result;
+  folly::fibers::Baton baton;
+  client->send(req, [&](const McGetRequest&, McGetReply&& reply) {
+    result = std::move(reply);
+    baton.post();
+  });
+  baton.wait();
+  return result;
+}
+
+uint64_t destinationDeadlineExpired(
+    CarbonRouterInstance<MemcacheRouterInfo>& router) {
+  // Rate stats are moved to the moving window every second.
+  const auto& stats = router.getProxyBase(0)->stats();
+  auto lock = stats.lock();
+  return stats.getValue(destination_deadline_expired_stat) +
+      stats.getStatValueWithinWindow(destination_deadline_expired_stat);
+}
+
+} // anonymous namespace
+
+TEST(RequestDeadline, destinationTimeoutCappedToDeadline) {
+  auto server = createServer();
+  auto router = CarbonRouterInstance<MemcacheRouterInfo>::init(
+      "destinationTimeoutCappedToDeadline",
+      routerOptions(R"("PoolRoute|A")", server->getListenPort()));
+  ASSERT_NE(nullptr, router);
+
+  const auto start = std::chrono::steady_clock::now();
+  auto reply = sendGet(*router, "sleep");
+  const auto elapsed = std::chrono::steady_clock::now() - start;
+
+  // The destination was only given what was left of the budget, instead of
+  // the server timeout (or the second the server takes to reply).
+  EXPECT_EQ(carbon::Result::TIMEOUT, reply.result());
+  EXPECT_GE(elapsed, kRequestTimeout);
+  EXPECT_LT(elapsed, std::chrono::milliseconds(900));
+  EXPECT_EQ(0, destinationDeadlineExpired(*router));
+
+  router->shutdown();
+}
+
+TEST(RequestDeadline, destinationSkippedOnceDeadlinePassed) {
+  auto server = createServer();
+  // B is only tried after A timed out, i.e. at the deadline.
+  auto router = CarbonRouterInstance<MemcacheRouterInfo>::init(
+      "destinationSkippedOnceDeadlinePassed",
+      routerOptions(
+          R"({ "type": "MissFailoverRoute",
+               "children": [ "PoolRoute|A", "PoolRoute|B" ] })",
+          server->getListenPort()));
+  ASSERT_NE(nullptr, router);
+
+  const auto start = std::chrono::steady_clock::now();
+  auto reply = sendGet(*router, "sleep");
+  const auto elapsed = std::chrono::steady_clock::now() - start;
+
+  // A was given the whole budget, B was never sent anything.
+  EXPECT_EQ(carbon::Result::TIMEOUT, reply.result());
+  EXPECT_EQ("Request deadline exceeded", reply.message());
+  EXPECT_GE(elapsed, kRequestTimeout);
+  EXPECT_EQ(1, destinationDeadlineExpired(*router));
+
+  router->shutdown();
+}
@@ -0,0 +1,74 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include "mcrouter/RouteProfiler.h"
+
+using namespace facebook::memcache::mcrouter;
+
+TEST(RouteProfiler, shouldSample) {
+  RouteProfiler profiler(3);
+  size_t sampled = 0;
+  for (size_t i = 0; i < 30; ++i) {
+    sampled += profiler.shouldSample() ? 1 : 0;
+  }
+  EXPECT_EQ(10, sampled);
+}
+
+TEST(RouteProfiler, folding) {
+  RouteProfiler profiler(1);
+  const int fiber = 0;
+  const int otherFiber = 0;
+
+  for (size_t i = 0; i < 2; ++i) {
+    RouteProfileTrace trace;
+    auto root = trace.enter("failover", -1, &fiber);
+    auto child = trace.enter("pool", root, &fiber);
+    auto leaf = trace.enter("host", child, &fiber);
+    trace.exit(leaf);
+    trace.exit(child);
+    // Shadow running in another fiber.
+    auto shadow = trace.enter("shadow", root, &otherFiber);
+    trace.exit(root);
+    trace.exit(shadow);
+    EXPECT_EQ(0, profiler.submit(trace));
+  }
+
+  auto profile = profiler.collect();
+  ASSERT_EQ(4, profile.size());
+  for (const auto& stack :
+       {"failover", "failover;pool", "failover;pool;host", "failover;shadow"}) {
+    ASSERT_EQ(1, profile.count(stack)) << stack;
+    const auto& totals = profile[stack];
+    EXPECT_EQ(2, totals.samples);
+    EXPECT_LE(totals.selfNs, totals.totalNs);
+  }
+  EXPECT_GE(
+      profile["failover"].totalNs,
+      profile["failover;pool"].totalNs + profile["failover"].selfNs);
+
+  // Totals accumulate across calls.
+  EXPECT_EQ(2, profiler.collect()["failover;pool"].samples);
+
+  const auto folded = RouteProfiler::toFolded(profile);
+  EXPECT_NE(std::string::npos, folded.find("failover;pool;host "));
+}
+
+TEST(RouteProfiler, queueFull) {
+  RouteProfiler profiler(1, /* queueSize */ 3);
+  RouteProfileTrace trace;
+  const int fiber = 0;
+  for (int32_t i = 0; i < 4; ++i) {
+    trace.exit(trace.enter("route", i - 1, &fiber));
+  }
+  // The queue holds queueSize - 1 samples.
+  EXPECT_EQ(2, profiler.submit(trace));
+  EXPECT_EQ(2, profiler.collect().size());
+}
@@ -0,0 +1,185 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <chrono>
+#include <limits>
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+#include <gtest/gtest.h>
+
+#include <folly/Format.h>
+#include <folly/fibers/EventBaseLoopController.h>
+#include <folly/fibers/FiberManager.h>
+#include <folly/io/async/EventBase.h>
+
+#include "mcrouter/CarbonRouterInstance.h"
+#include "mcrouter/Server.h"
+#include "mcrouter/config.h"
+#include "mcrouter/lib/AuxiliaryCPUThreadPool.h"
+#include "mcrouter/lib/CompressionCodecManager.h"
+#include "mcrouter/lib/network/AsyncMcClient.h"
+#include "mcrouter/lib/network/AsyncMcServer.h"
+#include "mcrouter/lib/network/AsyncMcServerWorker.h"
+#include "mcrouter/lib/network/gen/MemcacheRouterInfo.h"
+#include "mcrouter/lib/network/gen/MemcacheServer.h"
+#include "mcrouter/lib/network/test/ListenSocket.h"
+#include "mcrouter/lib/network/test/TestClientServerUtil.h"
+#include "mcrouter/standalone_options.h"
+
+using namespace facebook::memcache;
+using namespace facebook::memcache::mcrouter;
+
+using facebook::memcache::test::TestServer;
+
+namespace {
+
+constexpr size_t kOffloadThreshold = 16 * 1024;
+const std::chrono::milliseconds kTimeout{5000};
+
+std::unordered_map<uint32_t, CodecConfigPtr> codecConfigs() {
+  std::unordered_map<uint32_t, CodecConfigPtr> configs;
+  configs.emplace(
+      1,
+      std::make_unique<CodecConfig>(
+          1 /* id */,
+          CompressionCodecType::LZ4,
+          std::string(1024, 'd') /* dictionary */,
+          FilteringOptions(
+              1024 /* minCompressionThreshold */,
+              std::numeric_limits<uint32_t>::max(),
+              0 /* typeId */,
+              true /* isEnabled */)));
+  return configs;
+}
+
+/**
+ * mcrouter listening on a loopback port, wired like the standalone server,
+ * that compresses replies of at least kOffloadThreshold on the auxiliary CPU
+ * thread pool.
+ */
+class CompressingRouter {
+ public:
+  explicit CompressingRouter(uint16_t backendPort) {
+    ListenSocket socket;
+    port_ = socket.getPort();
+
+    AsyncMcServer::Options serverOpts;
+    serverOpts.existingSocketFd = socket.releaseSocketFd();
+    serverOpts.numThreads = 1;
+    serverOpts.worker.defaultVersionHandler = false;
+    serverOpts.worker.compressionOffloadThresholdBytes = kOffloadThreshold;
+    server_ = std::make_unique<AsyncMcServer>(serverOpts);
+
+    auto opts = defaultTestOptions();
+    opts.num_proxies = 1;
+    opts.server_timeout_ms = kTimeout.count();
+    opts.config_str = folly::sformat(
+        R"({{
+          "pools": {{ "A": {{ "servers": [ "localhost:{}" ] }} }},
+          "route": "PoolRoute|A"
+        }})",
+        backendPort);
+    router_ = CarbonRouterInstance<MemcacheRouterInfo>::init(
+        folly::sformat("compression_offload_{}", port_),
+        opts,
+        server_->eventBases());
+    if (router_ == nullptr) {
+      throw std::runtime_error("Failed to initialize mcrouter");
+    }
+    // Read by serverLoop(), to compress replies to clients.
+    router_->setUpCompressionDictionaries(codecConfigs());
+
+    server_->spawn([router = router_, &standaloneOpts = standaloneOpts_](
+                       size_t threadId,
+                       folly::EventBase& evb,
+                       AsyncMcServerWorker& worker) {
+      detail::serverLoop<MemcacheRouterInfo, MemcacheRequestHandler>(
+          *router, threadId, evb, worker, standaloneOpts);
+    });
+  }
+
+  ~CompressingRouter() {
+    server_->shutdown();
+    router_->shutdown();
+    server_->join();
+  }
+
+  uint16_t port() const {
+    return port_;
+  }
+
+  const CompressionCodecMap* codecMap() const {
+    return router_->getCodecManager()->getCodecMap();
+  }
+
+ private:
+  uint16_t port_{0};
+  McrouterStandaloneOptions standaloneOpts_;
+  std::unique_ptr<AsyncMcServer> server_;
+  CarbonRouterInstance<MemcacheRouterInfo>* router_{nullptr};
+};
+
+McGetReply sendGet(
+    uint16_t port,
+    const CompressionCodecMap* codecMap,
+    const std::string& key) {
+  folly::EventBase evb;
+  folly::fibers::FiberManager fm(
+      std::make_unique<folly::fibers::EventBaseLoopController>());
+  dynamic_cast<folly::fibers::EventBaseLoopController&>(fm.loopController())
+      .attachEventBase(evb);
+
+  ConnectionOptions connOpts("localhost", port, mc_caret_protocol);
+  // Tells the server which codecs the client supports. Replies are
+  // uncompressed inline.
+  connOpts.compressionCodecMap = codecMap;
+  AsyncMcClient client(evb, connOpts);
+
+  McGetReply reply;
+  fm.addTask([&]() { reply = client.sendSync(McGetRequest(key), kTimeout); });
+  while (fm.hasTasks()) {
+    evb.loopOnce();
+  }
+  client.closeNow();
+  evb.loop();
+  return reply;
+}
+
+} // anonymous namespace
+
+TEST(ServerCompressionOffload, bigReplyCompressedOnPool) {
+  TestServer::Config backendConfig;
+  backendConfig.useSsl = false;
+  auto backend = TestServer::create(std::move(backendConfig));
+  CompressingRouter router(backend->getListenPort());
+
+  auto pool = AuxiliaryCPUThreadPoolSingleton::try_get();
+  ASSERT_NE(nullptr, pool);
+  const auto before = pool->getStats();
+
+  // The reply is sent from the finally function of the routing fiber, i.e.
+  // from the main context of the server thread.
+  constexpr size_t kValueSize = 4 * kOffloadThreshold;
+  const auto codecMap = router.codecMap();
+  auto reply = sendGet(
+      router.port(), codecMap, folly::sformat("value_size:{}", kValueSize));
+  ASSERT_EQ(carbon::Result::FOUND, reply.result());
+  EXPECT_EQ(std::string(kValueSize, 'a'), carbon::valueRangeSlow(reply).str());
+
+  const auto after = pool->getStats();
+  EXPECT_EQ(before.offloaded + 1, after.offloaded);
+  EXPECT_EQ(before.inlineFallbacks, after.inlineFallbacks);
+  EXPECT_EQ(before.inlineNotOnFiber, after.inlineNotOnFiber);
+
+  // Small replies are still compressed (or not) inline.
+  reply = sendGet(router.port(), codecMap, "value_size:2048");
+  ASSERT_EQ(carbon::Result::FOUND, reply.result());
+  EXPECT_EQ(std::string(2048, 'a'), carbon::valueRangeSlow(reply).str());
+  EXPECT_EQ(after.offloaded, pool->getStats().offloaded);
+}
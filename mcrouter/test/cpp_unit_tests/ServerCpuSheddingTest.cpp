@@ -0,0 +1,204 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <chrono>
+#include <memory>
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include <folly/Format.h>
+#include <folly/fibers/EventBaseLoopController.h>
+#include <folly/fibers/FiberManager.h>
+#include <folly/io/async/EventBase.h>
+
+#include "mcrouter/CarbonRouterInstance.h"
+#include "mcrouter/ProxyBase.h"
+#include "mcrouter/Server.h"
+#include "mcrouter/config.h"
+#include "mcrouter/lib/network/AsyncMcClient.h"
+#include "mcrouter/lib/network/AsyncMcServer.h"
+#include "mcrouter/lib/network/AsyncMcServerWorker.h"
+#include "mcrouter/lib/network/CpuController.h"
+#include "mcrouter/lib/network/gen/MemcacheRouterInfo.h"
+#include "mcrouter/lib/network/gen/MemcacheServer.h"
+#include "mcrouter/lib/network/test/ListenSocket.h"
+#include "mcrouter/lib/network/test/TestClientServerUtil.h"
+#include "mcrouter/standalone_options.h"
+#include "mcrouter/stats.h"
+
+using namespace facebook::memcache;
+using namespace facebook::memcache::mcrouter;
+
+using facebook::memcache::test::TestServer;
+
+namespace {
+
+constexpr uint32_t kCpuShedTargetPercent = 50;
+constexpr size_t kNumRequests = 10;
+const std::chrono::milliseconds kTimeout{5000};
+
+/**
+ * mcrouter listening on a loopback port, wired like the standalone server,
+ * with a CPU controller reporting whatever load the test sets.
+ */
+class ShedRouter {
+ public:
+  explicit ShedRouter(uint16_t backendPort) {
+    ListenSocket socket;
+    port_ = socket.getPort();
+
+    CpuControllerOptions cpuOpts;
+    cpuOpts.dataCollectionInterval = std::chrono::milliseconds(1000);
+    // Never started, so the load only changes when the test sets it.
+    cpuController_ = std::make_shared<CpuController>(cpuOpts, cpuEvb_);
+
+    AsyncMcServer::Options serverOpts;
+    serverOpts.existingSocketFd = socket.releaseSocketFd();
+    serverOpts.numThreads = 1;
+    serverOpts.worker.defaultVersionHandler = false;
+    serverOpts.worker.cpuController = cpuController_;
+    serverOpts.worker.cpuShedTargetPercent = kCpuShedTargetPercent;
+    server_ = std::make_unique<AsyncMcServer>(serverOpts);
+
+    auto opts = defaultTestOptions();
+    opts.num_proxies = 1;
+    opts.server_timeout_ms = kTimeout.count();
+    opts.config_str = folly::sformat(
+        R"({{
+          "pools": {{ "A": {{ "servers": [ "localhost:{}" ] }} }},
+          "route": "PoolRoute|A"
+        }})",
+        backendPort);
+    router_ = CarbonRouterInstance<MemcacheRouterInfo>::init(
+        folly::sformat("cpu_shedding_{}", port_), opts, server_->eventBases());
+    if (router_ == nullptr) {
+      throw std::runtime_error("Failed to initialize mcrouter");
+    }
+
+    server_->spawn([router = router_, &standaloneOpts = standaloneOpts_](
+                       size_t threadId,
+                       folly::EventBase& evb,
+                       AsyncMcServerWorker& worker) {
+      detail::serverLoop<MemcacheRouterInfo, MemcacheRequestHandler>(
+          *router, threadId, evb, worker, standaloneOpts);
+    });
+  }
+
+  ~ShedRouter() {
+    server_->shutdown();
+    router_->shutdown();
+    server_->join();
+  }
+
+  uint16_t port() const {
+    return port_;
+  }
+
+  CpuController& cpuController() {
+    return *cpuController_;
+  }
+
+  uint64_t numShedRequests() {
+    // Rate stats are moved to the moving window every second.
+    const auto& stats = router_->getProxyBase(0)->stats();
+    auto lock = stats.lock();
+    return stats.getValue(server_cpu_shed_requests_stat) +
+        stats.getStatValueWithinWindow(server_cpu_shed_requests_stat);
+  }
+
+ private:
+  uint16_t port_{0};
+  McrouterStandaloneOptions standaloneOpts_;
+  folly::EventBase cpuEvb_;
+  std::shared_ptr<CpuController> cpuController_;
+  std::unique_ptr<AsyncMcServer> server_;
+  CarbonRouterInstance<MemcacheRouterInfo>* router_{nullptr};
+};
+
+struct Replies {
+  carbon::Result slow{carbon::Result::UNKNOWN};
+  size_t busy{0};
+  size_t other{0};
+};
+
+/**
+ * Keeps "sleep" (answered by the backend after a second) in flight on one
+ * connection while sending kNumRequests more gets on it. A connection with
+ * nothing in flight is never shed, so only the latter can be.
+ */
+Replies sendWithOneInFlight(uint16_t port) {
+  folly::EventBase evb;
+  folly::fibers::FiberManager fm(
+      std::make_unique<folly::fibers::EventBaseLoopController>());
+  dynamic_cast<folly::fibers::EventBaseLoopController&>(fm.loopController())
+      .attachEventBase(evb);
+
+  ConnectionOptions connOpts("localhost", port, mc_caret_protocol);
+  AsyncMcClient client(evb, connOpts);
+
+  Replies replies;
+  bool slowSent = false;
+  fm.addTask([&]() {
+    slowSent = true;
+    replies.slow = client.sendSync(McGetRequest("sleep"), kTimeout).result();
+  });
+  fm.addTask([&]() {
+    EXPECT_TRUE(slowSent);
+    for (size_t i = 0; i < kNumRequests; ++i) {
+      auto reply = client.sendSync(McGetRequest("key"), kTimeout);
+      if (reply.result() == carbon::Result::BUSY) {
+        ++replies.busy;
+      } else {
+        ++replies.other;
+      }
+    }
+  });
+
+  while (fm.hasTasks()) {
+    evb.loopOnce();
+  }
+  client.closeNow();
+  evb.loop();
+  return replies;
+}
+
+std::unique_ptr<TestServer> createBackend() {
+  TestServer::Config config;
+  config.useSsl = false;
+  return TestServer::create(std::move(config));
+}
+
+} // anonymous namespace
+
+TEST(ServerCpuShedding, shedsAboveTarget) {
+  auto backend = createBackend();
+  ShedRouter router(backend->getListenPort());
+  router.cpuController().setPercentLoadForTest(100.0);
+
+  auto replies = sendWithOneInFlight(router.port());
+
+  // At 100% CPU, a connection with as many requests in flight as the
+  // average one is always shed. The request already in flight is not.
+  EXPECT_EQ(kNumRequests, replies.busy);
+  EXPECT_EQ(0, replies.other);
+  EXPECT_EQ(carbon::Result::NOTFOUND, replies.slow);
+  EXPECT_EQ(kNumRequests, router.numShedRequests());
+}
+
+TEST(ServerCpuShedding, servesBelowTarget) {
+  auto backend = createBackend();
+  ShedRouter router(backend->getListenPort());
+  router.cpuController().setPercentLoadForTest(kCpuShedTargetPercent - 10);
+
+  auto replies = sendWithOneInFlight(router.port());
+
+  EXPECT_EQ(0, replies.busy);
+  EXPECT_EQ(kNumRequests, replies.other);
+  EXPECT_EQ(carbon::Result::NOTFOUND, replies.slow);
+  EXPECT_EQ(0, router.numShedRequests());
+}
@@ -0,0 +1,207 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <unistd.h>
+
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+
+#include <gtest/gtest.h>
+
+#include <folly/Format.h>
+#include <folly/experimental/TestUtil.h>
+#include <folly/fibers/Baton.h>
+#include <folly/fibers/EventBaseLoopController.h>
+#include <folly/fibers/FiberManager.h>
+#include <folly/io/async/EventBase.h>
+
+#include "mcrouter/CarbonRouterInstance.h"
+#include "mcrouter/Server.h"
+#include "mcrouter/ServerTakeover.h"
+#include "mcrouter/config.h"
+#include "mcrouter/lib/network/AsyncMcClient.h"
+#include "mcrouter/lib/network/AsyncMcServer.h"
+#include "mcrouter/lib/network/AsyncMcServerWorker.h"
+#include "mcrouter/lib/network/gen/MemcacheRouterInfo.h"
+#include "mcrouter/lib/network/gen/MemcacheServer.h"
+#include "mcrouter/lib/network/test/ListenSocket.h"
+#include "mcrouter/lib/network/test/TestClientServerUtil.h"
+#include "mcrouter/standalone_options.h"
+
+using namespace facebook::memcache;
+using namespace facebook::memcache::mcrouter;
+
+using facebook::memcache::test::TestServer;
+
+namespace {
+
+const std::chrono::milliseconds kTimeout{5000};
+
+/**
+ * mcrouter listening on a loopback port and serving a takeover socket, wired
+ * like the standalone server.
+ */
+class TakeoverRouter {
+ public:
+  TakeoverRouter(
+      uint16_t backendPort,
+      const McrouterStandaloneOptions& standaloneOpts)
+      : standaloneOpts_(standaloneOpts) {
+    ListenSocket socket;
+    port_ = socket.getPort();
+
+    AsyncMcServer::Options serverOpts;
+    serverOpts.existingSocketFd = socket.releaseSocketFd();
+    serverOpts.numThreads = 1;
+    serverOpts.worker.defaultVersionHandler = false;
+    serverOpts.worker.goAwayTimeout = detail::getGoAwayTimeout(standaloneOpts);
+    server_ = std::make_unique<AsyncMcServer>(serverOpts);
+
+    auto opts = defaultTestOptions();
+    opts.num_proxies = 1;
+    opts.server_timeout_ms = kTimeout.count();
+    opts.config_str = folly::sformat(
+        R"({{
+          "pools": {{ "A": {{ "servers": [ "localhost:{}" ] }} }},
+          "route": "PoolRoute|A"
+        }})",
+        backendPort);
+    router_ = CarbonRouterInstance<MemcacheRouterInfo>::init(
+        folly::sformat("takeover_{}", port_), opts, server_->eventBases());
+    if (router_ == nullptr) {
+      throw std::runtime_error("Failed to initialize mcrouter");
+    }
+
+    server_->spawn([router = router_, &opts = standaloneOpts_](
+                       size_t threadId,
+                       folly::EventBase& evb,
+                       AsyncMcServerWorker& worker) {
+      detail::serverLoop<MemcacheRouterInfo, MemcacheRequestHandler>(
+          *router, threadId, evb, worker, opts);
+    });
+
+    takeoverServer_ = std::make_unique<TakeoverServer>(
+        standaloneOpts_.takeover_socket_path,
+        *server_,
+        router_->tkoTrackerMap(),
+        std::chrono::milliseconds(standaloneOpts_.takeover_timeout_ms),
+        [server = server_.get()]() { server->shutdown(); });
+  }
+
+  ~TakeoverRouter() {
+    takeoverServer_.reset();
+    server_->shutdown();
+    router_->shutdown();
+    server_->join();
+  }
+
+  uint16_t port() const {
+    return port_;
+  }
+
+ private:
+  uint16_t port_{0};
+  const McrouterStandaloneOptions standaloneOpts_;
+  std::unique_ptr<AsyncMcServer> server_;
+  CarbonRouterInstance<MemcacheRouterInfo>* router_{nullptr};
+  std::unique_ptr<TakeoverServer> takeoverServer_;
+};
+
+void closeFds(const TakeoverState& state) {
+  for (auto fd : state.sockets.fds) {
+    ::close(fd);
+  }
+  for (auto fd : state.sockets.sslFds) {
+    ::close(fd);
+  }
+}
+
+} // anonymous namespace
+
+TEST(ServerTakeover, goAwayTimeoutDefault) {
+  McrouterStandaloneOptions opts;
+  EXPECT_EQ(0, detail::getGoAwayTimeout(opts).count());
+
+  opts.takeover_socket_path = "/tmp/takeover.sock";
+  EXPECT_EQ(1000, detail::getGoAwayTimeout(opts).count());
+
+  opts.go_away_timeout_ms = 0;
+  EXPECT_EQ(0, detail::getGoAwayTimeout(opts).count());
+
+  opts.go_away_timeout_ms = 200;
+  EXPECT_EQ(200, detail::getGoAwayTimeout(opts).count());
+}
+
+TEST(ServerTakeover, drainsConnectionsWithGoAway) {
+  TestServer::Config backendConfig;
+  backendConfig.useSsl = false;
+  auto backend = TestServer::create(std::move(backendConfig));
+
+  folly::test::TemporaryDirectory dir("server_takeover_test");
+  McrouterStandaloneOptions standaloneOpts;
+  // go_away_timeout_ms is left at its default.
+  standaloneOpts.takeover_socket_path = (dir.path() / "takeover.sock").string();
+  TakeoverRouter router(backend->getListenPort(), standaloneOpts);
+
+  folly::EventBase evb;
+  folly::fibers::FiberManager fm(
+      std::make_unique<folly::fibers::EventBaseLoopController>());
+  dynamic_cast<folly::fibers::EventBaseLoopController&>(fm.loopController())
+      .attachEventBase(evb);
+
+  ConnectionOptions connOpts("localhost", router.port(), mc_caret_protocol);
+  AsyncMcClient client(evb, connOpts);
+  bool goneAway = false;
+  client.setConnectionStatusCallbacks(
+      {nullptr, [&goneAway](ConnectionDownReason reason, size_t) {
+         if (reason == ConnectionDownReason::SERVER_GONE_AWAY) {
+           goneAway = true;
+         }
+       }});
+
+  folly::fibers::Baton connected;
+  carbon::Result slowResult = carbon::Result::UNKNOWN;
+  std::unique_ptr<TakeoverClient> takeover;
+  fm.addTask([&]() {
+    EXPECT_EQ(
+        carbon::Result::FOUND,
+        client.sendSync(McGetRequest("key"), kTimeout).result());
+    connected.post();
+    // The backend replies to "sleep" after a second, so it is still in
+    // flight in the old process when it is taken over.
+    slowResult = client.sendSync(McGetRequest("sleep"), kTimeout).result();
+  });
+  // What a new mcrouter started with the same takeover socket path does.
+  std::thread newProcess([&]() {
+    connected.wait();
+    /* sleep override */
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    takeover = TakeoverClient::connect(
+        standaloneOpts.takeover_socket_path, kTimeout);
+    ASSERT_NE(nullptr, takeover);
+    EXPECT_EQ(1, takeover->state().sockets.fds.size());
+    takeover->confirm();
+  });
+
+  while (fm.hasTasks()) {
+    evb.loopOnce();
+  }
+  newProcess.join();
+
+  // The old process asked the client to move, and still answered the request
+  // in flight instead of dropping the connection.
+  EXPECT_TRUE(goneAway);
+  EXPECT_EQ(carbon::Result::NOTFOUND, slowResult);
+
+  client.closeNow();
+  evb.loop();
+  if (takeover) {
+    closeFds(takeover->state());
+  }
+}
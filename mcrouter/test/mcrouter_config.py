@@ -10,6 +10,8 @@ class McrouterGlobals:
         bins = {
             'mcrouter': './mcrouter/mcrouter',
             'mcpiper': './mcrouter/tools/mcpiper/mcpiper',
+            'mcreplay': './mcrouter/tools/mcreplay/mcreplay',
+            'mcstats': './mcrouter/tools/mcstats/mcstats',
             'mockmc': './mcrouter/lib/network/mock_mc_server',
             'prodmc': './mcrouter/lib/network/mock_mc_server',
         }
@@ -0,0 +1,50 @@
+#!/usr/bin/env python3
+# Copyright (c) Facebook, Inc. and its affiliates.
+#
+# This source code is licensed under the MIT license found in the
+# LICENSE file in the root directory of this source tree.
+
+import time
+
+from mcrouter.test.MCProcess import Memcached
+from mcrouter.test.McrouterTestCase import McrouterTestCase
+
+class TestDestinationWarmup(McrouterTestCase):
+    config = './mcrouter/test/mcrouter_test_basic_1_1_1.json'
+    extra_args = ['--num-proxies', '2',
+                  '--destination-warmup-timeout-ms', '5000']
+
+    def setUp(self):
+        self.mc = self.add_server(Memcached())
+
+    def wait_until_ready(self, mcr):
+        for _ in range(50):
+            stats = mcr.stats()
+            if int(stats['startup_to_ready_ms']) > 0:
+                return stats
+            time.sleep(0.1)
+        self.fail('mcrouter did not become ready')
+
+    def test_destination_warmup(self):
+        mcr = self.add_mcrouter(self.config, extra_args=self.extra_args)
+        stats = self.wait_until_ready(mcr)
+
+        # each proxy connected to the server before the first request
+        self.assertEqual(stats['destination_warmup_connects'], '2')
+        self.assertEqual(stats['destination_warmup_failures'], '0')
+        self.assertEqual(stats['num_servers_up'], '2')
+
+        self.assertTrue(mcr.set('key', 'value'))
+        self.assertEqual(mcr.get('key'), 'value')
+        stats = mcr.stats()
+        self.assertEqual(stats['destination_warmup_connects'], '2')
+
+    def test_destination_warmup_failure(self):
+        self.mc.terminate()
+        mcr = self.add_mcrouter(self.config, extra_args=self.extra_args)
+        stats = self.wait_until_ready(mcr)
+
+        # failed warm-ups are not counted as connects
+        self.assertEqual(stats['destination_warmup_connects'], '0')
+        self.assertEqual(stats['destination_warmup_failures'], '2')
+        self.assertIsNone(mcr.get('key'))
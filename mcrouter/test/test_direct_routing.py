@@ -0,0 +1,80 @@
+#!/usr/bin/env python3
+# Copyright (c) Facebook, Inc. and its affiliates.
+#
+# This source code is licensed under the MIT license found in the
+# LICENSE file in the root directory of this source tree.
+
+from mcrouter.test.MCProcess import Memcached
+from mcrouter.test.McrouterTestCase import McrouterTestCase
+
+
+class TestDirectRouting(McrouterTestCase):
+    config = './mcrouter/test/test_direct_routing.json'
+    extra_args = ['--direct-routing']
+
+    def setUp(self):
+        self.mc_a = [self.add_server(Memcached()) for _ in range(2)]
+        self.mc_b = self.add_server(Memcached())
+
+    def get_mcrouter(self, extra_args):
+        return self.add_mcrouter(
+            self.config, route='/a/a/', extra_args=extra_args)
+
+    def direct_routed(self, mcr):
+        return int(mcr.stats('all')['direct_routed_requests_count'])
+
+    def direct_routed_inline(self, mcr):
+        return int(mcr.stats('all')['direct_routed_inline_requests_count'])
+
+    def test_same_destinations(self):
+        keys = ['key{}'.format(i) for i in range(20)]
+        mcr = self.get_mcrouter([])
+        for key in keys:
+            self.assertTrue(mcr.set(key, 'tree'))
+        placement = {key: [mc.get(key) for mc in self.mc_a] for key in keys}
+
+        # Keys land on the same servers of the pool, whether requests go
+        # through the whole tree or straight to their destination.
+        mcr = self.get_mcrouter(self.extra_args)
+        for key in keys:
+            self.assertEqual(mcr.get(key), 'tree')
+            self.assertTrue(mcr.set(key, 'direct'))
+            self.assertEqual(
+                [mc.get(key) for mc in self.mc_a],
+                ['direct' if v is not None else None for v in placement[key]])
+        self.assertEqual(self.direct_routed(mcr), 2 * len(keys))
+        # Memcached destinations are sent to without a fiber.
+        self.assertEqual(self.direct_routed_inline(mcr), 2 * len(keys))
+
+    def test_fallback(self):
+        mcr = self.get_mcrouter(self.extra_args)
+        # Failover routes do more than forwarding requests: requests go
+        # through the whole tree.
+        self.assertTrue(mcr.set('/b/b/key', 'value'))
+        self.assertEqual(self.mc_b.get('key'), 'value')
+        self.assertEqual(mcr.get('/b/b/key'), 'value')
+        self.assertEqual(self.direct_routed(mcr), 0)
+        self.assertTrue(mcr.set('key', 'value'))
+        self.assertEqual(self.direct_routed(mcr), 1)
+
+    def test_miss_on_get_errors(self):
+        mcr = self.get_mcrouter(self.extra_args)
+        for mc in self.mc_a:
+            mc.terminate()
+        # Replies of direct routed requests are processed like the ones of
+        # the whole tree.
+        self.assertIsNone(mcr.get('key'))
+        self.assertEqual(self.direct_routed(mcr), 1)
+        self.assertEqual(self.direct_routed_inline(mcr), 1)
+
+    def test_route_profiling(self):
+        # Destinations wrapped for route profiling are still sent to without
+        # a fiber, except for the (here, first) sampled request.
+        mcr = self.get_mcrouter(
+            self.extra_args + ['--route-profile-sample-rate', '1000000'])
+        keys = ['key{}'.format(i) for i in range(10)]
+        for key in keys:
+            self.assertTrue(mcr.set(key, 'value'))
+        sampled = len(keys) - self.direct_routed(mcr)
+        self.assertLessEqual(sampled, 1)
+        self.assertEqual(self.direct_routed_inline(mcr), len(keys) - sampled)
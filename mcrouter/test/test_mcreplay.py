@@ -0,0 +1,74 @@
+#!/usr/bin/env python3
+# Copyright (c) Facebook, Inc. and its affiliates.
+#
+# This source code is licensed under the MIT license found in the
+# LICENSE file in the root directory of this source tree.
+
+
+import os
+import time
+
+from mcrouter.test.MCProcess import (
+    BaseDirectory,
+    Memcached,
+    Mcpiper,
+    Mcreplay,
+)
+from mcrouter.test.McrouterTestCase import McrouterTestCase
+
+
+class TestMcreplay(McrouterTestCase):
+    config = './mcrouter/test/mcrouter_test_basic_1_1_1.json'
+    extra_args = ['--debug-fifo-root', BaseDirectory('mcrouter').path]
+
+    def setUp(self):
+        self.memcached = self.add_server(Memcached())
+        self.mcrouter = self.add_mcrouter(
+            self.config, extra_args=self.extra_args)
+        self.trace = os.path.join(BaseDirectory('trace').path, 'trace')
+
+    def record(self, num_requests, extra_args=None):
+        args = ['--record', self.trace, '--filename-pattern', 'server',
+                '--key-pattern', '^replay',
+                '--max-messages', str(num_requests)]
+        if extra_args:
+            args.extend(extra_args)
+        mcpiper = Mcpiper(self.mcrouter.debug_fifo_root, args)
+
+        # Make sure mcrouter creates fifos and start replicating data to them.
+        self.mcrouter.set('abc', '123')
+        self.mcrouter.delete('abc')
+        time.sleep(3)
+
+        for i in range(num_requests):
+            self.assertTrue(self.mcrouter.set('replay{}'.format(i), str(i)))
+
+        # mcpiper exits once num_requests requests are recorded.
+        mcpiper.proc.wait(timeout=10)
+
+    def replay(self):
+        return Mcreplay(self.trace, ['--port', str(self.memcached.getport()),
+                                     '--speed', '0'])
+
+    def test_record_replay(self):
+        self.record(10)
+
+        for i in range(10):
+            self.assertTrue(self.memcached.delete('replay{}'.format(i)))
+
+        mcreplay = self.replay()
+        self.assertIn('Replayed 10 requests', mcreplay.output())
+        self.assertEqual(0, mcreplay.proc.returncode)
+
+        for i in range(10):
+            self.assertEqual(str(i), self.memcached.get('replay{}'.format(i)))
+
+    def test_record_anonymized(self):
+        self.record(1, ['--anonymize'])
+        self.assertTrue(self.memcached.delete('replay0'))
+
+        mcreplay = self.replay()
+        self.assertIn('Replayed 1 requests', mcreplay.output())
+
+        # Keys are hashed: the original key isn't set again.
+        self.assertIsNone(self.memcached.get('replay0'))
@@ -0,0 +1,54 @@
+#!/usr/bin/env python3
+# Copyright (c) Facebook, Inc. and its affiliates.
+#
+# This source code is licensed under the MIT license found in the
+# LICENSE file in the root directory of this source tree.
+
+
+import json
+import os
+import time
+
+from mcrouter.test.MCProcess import BaseDirectory, Memcached, Mcstats
+from mcrouter.test.McrouterTestCase import McrouterTestCase
+
+
+class TestMcstats(McrouterTestCase):
+    config = './mcrouter/test/mcrouter_test_basic_1_1_1.json'
+
+    def setUp(self):
+        self.path = os.path.join(BaseDirectory('stats_shm').path, 'stats')
+        self.add_server(Memcached())
+        self.mcrouter = self.add_mcrouter(
+            self.config, extra_args=['--stats-shm-path', self.path])
+
+    def read(self, extra_args=None):
+        args = ['--json']
+        if extra_args:
+            args.extend(extra_args)
+        mcstats = Mcstats(self.path, args)
+        output = mcstats.output()
+        self.assertEqual(0, mcstats.proc.returncode)
+        return json.loads(output)
+
+    def test_stats(self):
+        for i in range(10):
+            self.assertTrue(self.mcrouter.set('key{}'.format(i), 'value'))
+        # Stats are published every second.
+        time.sleep(2.5)
+
+        stats = self.read()
+        self.assertEqual(int(self.mcrouter.stats()['pid']), stats['pid'])
+        self.assertGreater(stats['version'], 0)
+        self.assertGreaterEqual(stats['request_sent_count'], 10)
+        self.assertIn('uptime', stats)
+
+        version = stats['version']
+        time.sleep(1.5)
+        self.assertGreater(self.read()['version'], version)
+
+    def test_filter(self):
+        time.sleep(2)
+        stats = self.read(['--filter', 'request_'])
+        self.assertIn('request_sent_count', stats)
+        self.assertNotIn('uptime', stats)
@@ -45,3 +45,38 @@ class TestServiceInfo(McrouterTestCase):
         self._check_route_handles("get")
         self._check_route_handles("set")
         self._check_route_handles("delete")
+
+    def test_route_profile_disabled(self):
+        profile = self.mcrouter.get("__mcrouter__.route_profile")
+        self.assertTrue(profile.startswith("ERROR"))
+
+
+class TestRouteProfile(McrouterTestCase):
+    config = './mcrouter/test/test_service_info.json'
+    extra_args = ['--route-profile-sample-rate', '1']
+
+    def setUp(self):
+        self.mc1 = self.add_server(Memcached())
+        self.mc2 = self.add_server(Memcached())
+        self.mcrouter = self.add_mcrouter(
+            self.config, extra_args=self.extra_args)
+
+    def test_route_profile(self):
+        for i in range(10):
+            self.assertTrue(self.mcrouter.set("key{}".format(i), "value"))
+            self.assertEqual(self.mcrouter.get("key{}".format(i)), "value")
+
+        stacks = {}
+        for line in self.mcrouter.get("__mcrouter__.route_profile").split(
+                "\n"):
+            stack, value = line.rsplit(" ", 1)
+            stacks[stack] = int(value)
+        self.assertTrue(any(
+            stack.count(";") > 0 and str(port) in stack
+            for stack in stacks
+            for port in [self.mc1.port, self.mc2.port]))
+
+    def test_route_handles_unchanged(self):
+        rh = self.mcrouter.get("__mcrouter__.route_handles(get,abc)")
+        self.assertEqual(rh.count(str(self.mc1.port)), 1)
+        self.assertEqual(rh.count(str(self.mc2.port)), 1)
@@ -5,6 +5,7 @@
 # LICENSE file in the root directory of this source tree.
 
 
+from mcrouter.test.MCProcess import Memcached
 from mcrouter.test.McrouterTestCase import McrouterTestCase
 from mcrouter.test.mock_servers import CustomErrorServer
 from mcrouter.test.mock_servers import SleepServer
@@ -76,3 +77,33 @@ class TestErrorStatsRequests(McrouterTestCase):
         stats = self.mcrouter.stats('all')
         self.assertEqual(1, int(stats['result_remote_error_count']))
         self.assertEqual(1, int(stats['result_error_count']))
+
+
+class TestKeyPrefixStats(McrouterTestCase):
+    config = './mcrouter/test/mcrouter_test_basic_1_1_1.json'
+    extra_args = ['--key-prefix-stats-depth', '1']
+
+    def setUp(self):
+        self.add_server(Memcached())
+        self.mcrouter = self.add_mcrouter(
+            self.config, extra_args=self.extra_args
+        )
+
+    def parse(self, stat_value):
+        return dict(part.split(':') for part in stat_value.split(' '))
+
+    def test_key_prefix_stats(self):
+        for i in range(3):
+            self.assertTrue(self.mcrouter.set('user:{}'.format(i), 'value'))
+        self.assertEqual('value', self.mcrouter.get('user:0'))
+        self.assertTrue(self.mcrouter.set('feed:0', 'value'))
+        self.assertTrue(self.mcrouter.set('nodelimiter', 'value'))
+
+        stats = self.mcrouter.stats('key_prefixes')
+        self.assertEqual({'foo:user', 'foo:feed', 'foo:'}, set(stats.keys()))
+        user = self.parse(stats['foo:user'])
+        self.assertEqual('4', user['requests'])
+        self.assertEqual('0', user['errors'])
+        self.assertEqual('0', user['max_undercount'])
+        self.assertEqual('1', self.parse(stats['foo:feed'])['requests'])
+        self.assertEqual('1', self.parse(stats['foo:'])['requests'])
@@ -0,0 +1,52 @@
+#!/usr/bin/env python3
+# Copyright (c) Facebook, Inc. and its affiliates.
+#
+# This source code is licensed under the MIT license found in the
+# LICENSE file in the root directory of this source tree.
+
+import os
+import time
+
+from mcrouter.test.MCProcess import BaseDirectory, Mcrouter, Memcached
+from mcrouter.test.McrouterTestCase import McrouterTestCase
+
+class TestTakeover(McrouterTestCase):
+    config = './mcrouter/test/mcrouter_test_basic_1_1_1.json'
+
+    def setUp(self):
+        self.mc = self.add_server(Memcached())
+        self.takeover_dir = BaseDirectory('takeover')
+        self.extra_args = [
+            '--takeover-socket-path',
+            os.path.join(self.takeover_dir.path, 'takeover.sock')]
+
+    def wait_for_exit(self, mcr):
+        for _ in range(100):
+            if not mcr.is_alive():
+                return
+            time.sleep(0.1)
+        self.fail('mcrouter did not exit after being taken over')
+
+    def test_takeover(self):
+        old = self.add_mcrouter(self.config, extra_args=self.extra_args)
+        self.assertTrue(old.set('key', 'value'))
+        old_pid = old.stats()['pid']
+
+        new = Mcrouter(old.config, port=old.getport(),
+                       extra_args=self.extra_args)
+        self.open_mcrouters.append(new)
+
+        # the old process hands its listening socket over, then drains
+        self.wait_for_exit(old)
+
+        new.ensure_connected()
+        self.assertEqual(new.get('key'), 'value')
+        self.assertNotEqual(new.stats()['pid'], old_pid)
+
+        # the new process serves the takeover socket in turn
+        newer = Mcrouter(old.config, port=old.getport(),
+                         extra_args=self.extra_args)
+        self.open_mcrouters.append(newer)
+        self.wait_for_exit(new)
+        newer.ensure_connected()
+        self.assertEqual(newer.get('key'), 'value')
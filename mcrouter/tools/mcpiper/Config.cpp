@@ -13,6 +13,7 @@
 #include "mcrouter/lib/network/gen/MemcacheServer.h"
 #include "mcrouter/tools/mcpiper/MessagePrinter.h"
 #include "mcrouter/tools/mcpiper/SnifferParser.h"
+#include "mcrouter/tools/mcpiper/TraceRecorder.h"
 
 namespace facebook {
 namespace memcache {
@@ -68,5 +69,24 @@ addCarbonSnifferParser(
       .first;
 }
 
+std::unordered_map<
+    uint64_t,
+    std::unique_ptr<SnifferParserBase<TraceRecorder>>>::iterator
+addCarbonSnifferParser(
+    std::string /* routerName */,
+    std::unordered_map<
+        uint64_t,
+        std::unique_ptr<SnifferParserBase<TraceRecorder>>>& parserMap,
+    uint64_t connectionId,
+    TraceRecorder& recorder) {
+  return parserMap
+      .emplace(
+          connectionId,
+          std::make_unique<SnifferParser<
+              TraceRecorder,
+              memcache::detail::MemcacheRequestList>>(recorder))
+      .first;
+}
+
 } // memcache
 } // facebook
@@ -17,6 +17,7 @@ namespace memcache {
 
 class CompressionCodecMap;
 class MessagePrinter;
+class TraceRecorder;
 template <class T>
 class SnifferParserBase;
 
@@ -68,5 +69,19 @@ addCarbonSnifferParser(
         std::unique_ptr<SnifferParserBase<MessagePrinter>>>& parserMap,
     uint64_t connectionId,
     MessagePrinter& printer);
+
+/**
+ * Adds SnifferParser feeding the trace recorder to the parser map
+ */
+std::unordered_map<
+    uint64_t,
+    std::unique_ptr<SnifferParserBase<TraceRecorder>>>::iterator
+addCarbonSnifferParser(
+    std::string name,
+    std::unordered_map<
+        uint64_t,
+        std::unique_ptr<SnifferParserBase<TraceRecorder>>>& parserMap,
+    uint64_t connectionId,
+    TraceRecorder& recorder);
 }
 } // facebook::memcache
@@ -8,6 +8,7 @@
 #include "FifoReader.h"
 
 #include <fcntl.h>
+#include <sys/stat.h>
 
 #include <algorithm>
 #include <cstring>
@@ -189,6 +190,18 @@ void FifoReadCallback::forwardMessage(
   }
 }
 
+void FifoReadCallback::feed(folly::ByteRange data) noexcept {
+  while (!data.empty()) {
+    void* buf;
+    size_t len;
+    getReadBuffer(&buf, &len);
+    len = std::min(len, data.size());
+    std::memcpy(buf, data.data(), len);
+    readDataAvailable(len);
+    data.advance(len);
+  }
+}
+
 void FifoReadCallback::readEOF() noexcept {
   LOG(INFO) << "Fifo \"" << fifoName_ << "\" disconnected";
 }
@@ -201,12 +214,19 @@ FifoReaderManager::FifoReaderManager(
     folly::EventBase& evb,
     MessageReadyFn messageReady,
     std::string dir,
-    std::unique_ptr<boost::regex> filenamePattern)
+    std::unique_ptr<boost::regex> filenamePattern,
+    ShmRing::Filter ringFilter)
     : evb_(evb),
       messageReady_(std::move(messageReady)),
       directory_(std::move(dir)),
-      filenamePattern_(std::move(filenamePattern)) {
+      filenamePattern_(std::move(filenamePattern)),
+      ringFilter_(ringFilter) {
   runScanDirectory();
+  runReadRings();
+}
+
+FifoReaderManager::~FifoReaderManager() {
+  detachRings();
 }
 
 std::vector<std::string> FifoReaderManager::getMatchedFiles() const {
@@ -240,9 +260,36 @@ std::vector<std::string> FifoReaderManager::getMatchedFiles() const {
 }
 
 void FifoReaderManager::runScanDirectory() {
+  // Forget rings that are gone, or were replaced.
+  for (auto it = ringReaders_.begin(); it != ringReaders_.end();) {
+    struct stat st;
+    if (::stat(it->second.ring->path().c_str(), &st) != 0 ||
+        st.st_ino != it->second.inode) {
+      it->second.ring->detach();
+      it = ringReaders_.erase(it);
+      continue;
+    }
+    auto drops = it->second.ring->drops();
+    if (drops > it->second.drops) {
+      LOG(WARNING) << drops - it->second.drops
+                   << " packets dropped by mcrouter, because ring \""
+                   << it->second.ring->path() << "\" was full.";
+      it->second.drops = drops;
+    }
+    ++it;
+  }
+
   auto fifos = getMatchedFiles();
+  // Rings go first: a fifo that has a ring is read through it.
+  for (const auto& fifo : fifos) {
+    if (folly::StringPiece(fifo).endsWith(kFifoRingSuffix)) {
+      addRingReader(fifo);
+    }
+  }
   for (const auto& fifo : fifos) {
-    if (fifoReaders_.find(fifo) != fifoReaders_.end()) {
+    if (folly::StringPiece(fifo).endsWith(kFifoRingSuffix) ||
+        fifoReaders_.find(fifo) != fifoReaders_.end() ||
+        ringReaders_.find(fifo) != ringReaders_.end()) {
       continue;
     }
     auto fd = ::open(fifo.c_str(), O_RDONLY | O_NONBLOCK);
@@ -262,10 +309,61 @@ void FifoReaderManager::runScanDirectory() {
       [this]() { runScanDirectory(); }, kPollDirectoryIntervalMs);
 }
 
+void FifoReaderManager::addRingReader(const std::string& ringPath) {
+  auto fifoPath = ringPath.substr(0, ringPath.size() - kFifoRingSuffix.size());
+  if (ringReaders_.find(fifoPath) != ringReaders_.end()) {
+    return;
+  }
+
+  RingReader reader;
+  try {
+    struct stat st;
+    if (::stat(ringPath.c_str(), &st) != 0) {
+      return;
+    }
+    reader.inode = st.st_ino;
+    reader.ring = ShmRing::open(ringPath);
+  } catch (const std::exception& ex) {
+    LOG(WARNING) << "Error opening ring \"" << ringPath << "\": " << ex.what();
+    return;
+  }
+  if (!reader.ring->attach(ringFilter_)) {
+    VLOG(1) << "Ring \"" << ringPath << "\" is read by another process.";
+    return;
+  }
+  reader.drops = reader.ring->drops();
+  reader.callback = std::make_unique<FifoReadCallback>(fifoPath, messageReady_);
+
+  // Nothing is written to the fifo while its ring is read.
+  fifoReaders_.erase(fifoPath);
+  ringReaders_.emplace(std::move(fifoPath), std::move(reader));
+}
+
+void FifoReaderManager::runReadRings() {
+  if (!readingRings_) {
+    return;
+  }
+  for (auto& it : ringReaders_) {
+    auto& callback = *it.second.callback;
+    it.second.ring->read(
+        [&callback](folly::ByteRange data) { callback.feed(data); });
+  }
+
+  evb_.runAfterDelay([this]() { runReadRings(); }, kPollRingsIntervalMs);
+}
+
+void FifoReaderManager::detachRings() {
+  readingRings_ = false;
+  for (auto& it : ringReaders_) {
+    it.second.ring->detach();
+  }
+}
+
 void FifoReaderManager::unregisterCallbacks() {
   for (auto& fifoReader : fifoReaders_) {
     fifoReader.second.first->setReadCB(nullptr);
   }
+  detachRings();
 }
 
 } // memcache
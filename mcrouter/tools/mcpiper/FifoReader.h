@@ -21,6 +21,7 @@
 #include <folly/io/async/AsyncSocketException.h>
 
 #include "mcrouter/lib/debug/ConnectionFifoProtocol.h"
+#include "mcrouter/lib/debug/ShmRing.h"
 #include "mcrouter/lib/network/gen/MemcacheRouterInfo.h"
 
 namespace folly {
@@ -65,6 +66,11 @@ class FifoReadCallback : public folly::AsyncReader::ReadCallback {
   void readEOF() noexcept final;
   void readErr(const folly::AsyncSocketException& ex) noexcept final;
 
+  /**
+   * Feeds data read from somewhere else than a pipe (i.e. a ring).
+   */
+  void feed(folly::ByteRange data) noexcept;
+
  private:
   static constexpr uint64_t kMinSize{256};
   folly::IOBufQueue readBuffer_{folly::IOBufQueue::cacheChainLength()};
@@ -102,6 +108,7 @@ class FifoReaderManager {
    * that match "filenamePattern".
    * If a fifo with a name that matches "filenamePattern" is found, a
    * folly:AsyncPipeReader for it is created and scheduled in "evb".
+   * If the fifo has a ring (see Fifo), the ring is read instead of the fifo.
    *
    * @param evb             EventBase to run FifoReaderManager and
    *                        its FifoReaders.
@@ -109,12 +116,16 @@ class FifoReaderManager {
    *                        read from the fifo.
    * @param dir             Directory to watch.
    * @param filenamePattern Regex that file names must match.
+   * @param ringFilter      Filter applied by mcrouter before writing to rings.
    */
   FifoReaderManager(
       folly::EventBase& evb,
       MessageReadyFn messageReady,
       std::string dir,
-      std::unique_ptr<boost::regex> filenamePattern);
+      std::unique_ptr<boost::regex> filenamePattern,
+      ShmRing::Filter ringFilter = ShmRing::Filter());
+
+  ~FifoReaderManager();
 
   // non-copyable
   FifoReaderManager(const FifoReaderManager&) = delete;
@@ -130,15 +141,36 @@ class FifoReaderManager {
       folly::AsyncPipeReader::UniquePtr,
       std::unique_ptr<FifoReadCallback>>;
 
+  struct RingReader {
+    std::unique_ptr<ShmRing> ring;
+    std::unique_ptr<FifoReadCallback> callback;
+    // Identifies the ring file, which is replaced if its fifo is recreated.
+    ino_t inode{0};
+    uint64_t drops{0};
+  };
+
   static constexpr size_t kPollDirectoryIntervalMs = 1000;
+  // Rings must be large enough to hold this much traffic.
+  static constexpr size_t kPollRingsIntervalMs = 10;
   folly::EventBase& evb_;
   MessageReadyFn messageReady_;
   const std::string directory_;
   const std::unique_ptr<boost::regex> filenamePattern_;
+  const ShmRing::Filter ringFilter_;
   std::unordered_map<std::string, FifoReader> fifoReaders_;
+  // Keyed by the path of the fifo the ring belongs to.
+  std::unordered_map<std::string, RingReader> ringReaders_;
+  bool readingRings_{true};
 
   std::vector<std::string> getMatchedFiles() const;
   void runScanDirectory();
+  void runReadRings();
+  void detachRings();
+
+  /**
+   * Starts reading the ring at the given path, if possible.
+   */
+  void addRingReader(const std::string& ringPath);
 };
 } // memcache
 } // facebook
@@ -7,11 +7,17 @@
 
 #include "McPiper.h"
 
+#include <algorithm>
+#include <cstring>
+#include <unordered_map>
 #include <unordered_set>
 
+#include <folly/hash/Hash.h>
+
 #include "mcrouter/lib/network/CarbonMessageList.h"
 #include "mcrouter/tools/mcpiper/FifoReader.h"
 #include "mcrouter/tools/mcpiper/MessagePrinter.h"
+#include "mcrouter/tools/mcpiper/TraceRecorder.h"
 
 using namespace facebook::memcache::mcpiper;
 
@@ -99,6 +105,11 @@ MessagePrinter::Filter getFilter(const Settings& settings) {
     }
   }
 
+  filter.keyPattern = buildRegex(settings.keyPattern, settings.ignoreCase);
+  if (filter.keyPattern) {
+    std::cerr << "Key pattern: " << *filter.keyPattern << std::endl;
+  }
+
   // Builds data pattern
   filter.pattern = buildRegex(settings.matchExpression, settings.ignoreCase);
   if (filter.pattern) {
@@ -113,6 +124,74 @@ MessagePrinter::Filter getFilter(const Settings& settings) {
   return filter;
 }
 
+/**
+ * Filter that mcrouter applies before writing to debug fifo rings, so that
+ * most of what we would discard is never captured.
+ */
+ShmRing::Filter getRingFilter(const Settings& settings) {
+  ShmRing::Filter filter;
+  filter.sampleRate = settings.sampleRate;
+  filter.minValueSize = settings.valueMinSize;
+  filter.minLatencyUs = std::max<int64_t>(settings.minLatencyUs, 0);
+  if (settings.keyPattern.size() < ShmRing::kMaxKeyPatternSize) {
+    std::memcpy(
+        filter.keyPattern,
+        settings.keyPattern.data(),
+        settings.keyPattern.size());
+    filter.keyPattern[settings.keyPattern.size()] = '\0';
+    filter.keyPatternIgnoreCase = settings.ignoreCase;
+  } else {
+    LOG(WARNING) << "Key pattern is too long to be applied by mcrouter.";
+  }
+  return filter;
+}
+
+TraceRecorder::Options getRecorderOptions(
+    const Settings& settings,
+    McPiper* mcpiper) {
+  TraceRecorder::Options options;
+  options.anonymize = settings.anonymize;
+  options.keyPattern = buildRegex(settings.keyPattern, settings.ignoreCase);
+  options.maxRequests = settings.maxMessages;
+  options.stopRunningFn = [mcpiper]() { mcpiper->stop(); };
+  return options;
+}
+
+template <class Callback>
+void feedParser(
+    std::unordered_map<uint64_t, std::unique_ptr<SnifferParserBase<Callback>>>&
+        parserMap,
+    Callback& callback,
+    uint64_t connectionId,
+    uint64_t packetId,
+    folly::SocketAddress from,
+    folly::SocketAddress to,
+    uint32_t typeId,
+    uint64_t msgStartTime,
+    std::string routerName,
+    folly::ByteRange data) {
+  auto it = parserMap.find(connectionId);
+  if (it == parserMap.end()) {
+    it = addCarbonSnifferParser(
+        std::move(routerName), parserMap, connectionId, callback);
+  }
+  auto& snifferParser = it->second;
+
+  if (packetId == 0) {
+    snifferParser->resetParser();
+  }
+
+  snifferParser->setAddresses(std::move(from), std::move(to));
+  snifferParser->setCurrentMsgStartTime(msgStartTime);
+  snifferParser->parse(data, typeId, packetId == 0 /* isFirstPacket */);
+}
+
+bool isSampled(const Settings& settings, uint64_t connectionId) {
+  // Same sampling as mcrouter's (see CaptureFilter).
+  return settings.sampleRate <= 1 ||
+      folly::hash::twang_mix64(connectionId) % settings.sampleRate == 0;
+}
+
 } // anonymous
 
 void McPiper::stop() {
@@ -144,8 +223,22 @@ void McPiper::run(Settings settings, std::ostream& targetOut) {
       std::unique_ptr<SnifferParserBase<MessagePrinter>>>
       parserMap;
 
+  std::unordered_map<
+      uint64_t,
+      std::unique_ptr<SnifferParserBase<TraceRecorder>>>
+      recorderParserMap;
+  if (!settings.recordPath.empty()) {
+    traceRecorder_ = std::make_unique<TraceRecorder>(
+        settings.recordPath, getRecorderOptions(settings, this));
+    std::cerr << "Recording requests to: " << settings.recordPath
+              << std::endl;
+  }
+
   // Callback from fifoManager. Read the data and feed the correct parser.
-  auto fifoReaderCallback = [&parserMap, this](
+  auto fifoReaderCallback = [&parserMap,
+                             &recorderParserMap,
+                             &settings,
+                             this](
       uint64_t connectionId,
       uint64_t packetId,
       folly::SocketAddress from,
@@ -160,20 +253,35 @@ void McPiper::run(Settings settings, std::ostream& targetOut) {
     if (kNotSupporttedTypes.find(typeId) != kNotSupporttedTypes.end()) {
       return;
     }
-    auto it = parserMap.find(connectionId);
-    if (it == parserMap.end()) {
-      it = addCarbonSnifferParser(
-          routerName, parserMap, connectionId, *messagePrinter_);
+    if (!isSampled(settings, connectionId)) {
+      return;
     }
-    auto& snifferParser = it->second;
-
-    if (packetId == 0) {
-      snifferParser->resetParser();
+    if (traceRecorder_) {
+      traceRecorder_->setCurrentMessage(connectionId, msgStartTime);
+      feedParser(
+          recorderParserMap,
+          *traceRecorder_,
+          connectionId,
+          packetId,
+          std::move(from),
+          std::move(to),
+          typeId,
+          msgStartTime,
+          std::move(routerName),
+          data);
+    } else {
+      feedParser(
+          parserMap,
+          *messagePrinter_,
+          connectionId,
+          packetId,
+          std::move(from),
+          std::move(to),
+          typeId,
+          msgStartTime,
+          std::move(routerName),
+          data);
     }
-
-    snifferParser->setAddresses(std::move(from), std::move(to));
-    snifferParser->setCurrentMsgStartTime(msgStartTime);
-    snifferParser->parse(data, typeId, packetId == 0 /* isFirstPacket */);
   };
 
   initCompression();
@@ -182,13 +290,17 @@ void McPiper::run(Settings settings, std::ostream& targetOut) {
       eventBase_,
       fifoReaderCallback,
       settings.fifoRoot,
-      std::move(filenamePattern));
+      std::move(filenamePattern),
+      getRingFilter(settings));
 
   while (running_) {
     eventBase_.loopOnce();
   }
 
   fifoReaderManager_.reset();
+  if (traceRecorder_) {
+    traceRecorder_->flush();
+  }
 }
 
 } // mcpiper namespace
@@ -15,6 +15,7 @@
 #include "mcrouter/tools/mcpiper/Config.h"
 #include "mcrouter/tools/mcpiper/FifoReader.h"
 #include "mcrouter/tools/mcpiper/MessagePrinter.h"
+#include "mcrouter/tools/mcpiper/TraceRecorder.h"
 
 namespace facebook {
 namespace memcache {
@@ -29,6 +30,7 @@ struct Settings {
   std::string filenamePattern;
   std::string host;
   bool ignoreCase{false};
+  std::string keyPattern;
   bool invertMatch{false};
   uint32_t maxMessages{0};
   uint32_t numAfterMatch{0};
@@ -38,10 +40,13 @@ struct Settings {
   uint32_t valueMinSize{0};
   uint32_t valueMaxSize{std::numeric_limits<uint32_t>::max()};
   int64_t minLatencyUs{0};
+  uint32_t sampleRate{0};
   size_t verboseLevel{0};
   std::string protocol;
   bool raw{false};
   bool script{false};
+  std::string recordPath;
+  bool anonymize{false};
 };
 
 class McPiper {
@@ -54,9 +59,21 @@ class McPiper {
     return messagePrinter_->stats();
   }
 
+  /**
+   * Whether requests are recorded to a trace file instead of printed.
+   */
+  bool recording() const noexcept {
+    return traceRecorder_ != nullptr;
+  }
+
+  uint64_t recordedRequests() const noexcept {
+    return traceRecorder_ ? traceRecorder_->recordedRequests() : 0;
+  }
+
  private:
   folly::EventBase eventBase_;
   std::unique_ptr<MessagePrinter> messagePrinter_;
+  std::unique_ptr<TraceRecorder> traceRecorder_;
   std::unique_ptr<FifoReaderManager> fifoReaderManager_;
   std::atomic<bool> running_{false};
 };
@@ -151,6 +151,10 @@ folly::Optional<StyledString> MessagePrinter::filterAndBuildOutput(
   if (filter_.protocol.hasValue() && filter_.protocol.value() != protocol) {
     return folly::none;
   }
+  if (filter_.keyPattern &&
+      !boost::regex_search(key, *filter_.keyPattern)) {
+    return folly::none;
+  }
 
   auto value = carbon::valueRangeSlow(const_cast<Message&>(message));
   if (value.size() < filter_.valueMinSize ||
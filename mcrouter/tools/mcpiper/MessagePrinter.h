@@ -77,6 +77,7 @@ class MessagePrinter {
     uint32_t valueMaxSize{std::numeric_limits<uint32_t>::max()};
     int64_t minLatencyUs{0}; // 0 means include all messages
     std::unique_ptr<boost::regex> pattern;
+    std::unique_ptr<boost::regex> keyPattern;
     bool invertMatch{false};
     folly::Optional<mc_protocol_t> protocol;
   };
@@ -0,0 +1,72 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <cstring>
+
+#include <folly/io/IOBuf.h>
+
+#include "mcrouter/lib/carbon/CarbonProtocolWriter.h"
+#include "mcrouter/lib/carbon/CarbonQueueAppender.h"
+#include "mcrouter/lib/carbon/RequestReplyUtil.h"
+
+namespace facebook {
+namespace memcache {
+
+namespace detail {
+
+template <class Request>
+typename std::enable_if<Request::hasKey>::type anonymizeKey(Request& request) {
+  const auto& key = request.key();
+  request.key() = anonymizeKey(
+      key.routingPrefix(), key.keyWithoutRoute(), key.routingKey());
+}
+template <class Request>
+typename std::enable_if<!Request::hasKey>::type anonymizeKey(
+    Request& /* request */) {}
+
+} // detail
+
+template <class Request>
+void TraceRecorder::requestReady(
+    uint64_t /* msgId */,
+    Request&& request,
+    const folly::SocketAddress& /* from */,
+    const folly::SocketAddress& /* to */,
+    mc_protocol_t /* protocol */) {
+  if (options_.keyPattern &&
+      !boost::regex_search(
+          carbon::getFullKey(request).str(), *options_.keyPattern)) {
+    return;
+  }
+
+  if (options_.anonymize) {
+    anonymize(request);
+  }
+
+  carbon::CarbonQueueAppenderStorage storage;
+  carbon::CarbonProtocolWriter writer(storage);
+  request.serialize(writer);
+  const auto iovs = storage.getIovecs();
+  record(Request::typeId, iovs.first, iovs.second);
+}
+
+template <class Request>
+void TraceRecorder::anonymize(Request& request) {
+  detail::anonymizeKey(request);
+  if (auto value = carbon::valuePtrUnsafe(request)) {
+    const auto size = value->computeChainDataLength();
+    folly::IOBuf zeros(folly::IOBuf::CREATE, size);
+    std::memset(zeros.writableData(), 0, size);
+    zeros.append(size);
+    *value = std::move(zeros);
+  }
+}
+
+} // memcache
+} // facebook
@@ -0,0 +1,79 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include "TraceRecorder.h"
+
+#include <folly/Format.h>
+#include <folly/hash/Hash.h>
+
+namespace facebook {
+namespace memcache {
+
+namespace {
+
+// Separator of the routing key and the rest of the key (see carbon::Keys).
+constexpr folly::StringPiece kHashStop{"|#|"};
+
+void appendHashed(std::string& out, folly::StringPiece piece) {
+  const auto end = out.size() + piece.size();
+  auto hash =
+      folly::hash::SpookyHashV2::Hash64(piece.data(), piece.size(), 0);
+  while (out.size() < end) {
+    out.append(folly::sformat("{:016x}", hash));
+    hash = folly::hash::twang_mix64(hash);
+  }
+  out.resize(end);
+}
+
+TraceFileHeader makeHeader(const TraceRecorder::Options& options) {
+  TraceFileHeader header;
+  if (options.anonymize) {
+    header.flags |= TraceFileHeader::kAnonymized;
+  }
+  return header;
+}
+
+} // anonymous namespace
+
+std::string anonymizeKey(
+    folly::StringPiece routingPrefix,
+    folly::StringPiece keyWithoutRoute,
+    folly::StringPiece routingKey) {
+  std::string out;
+  out.reserve(routingPrefix.size() + keyWithoutRoute.size());
+  out.append(routingPrefix.begin(), routingPrefix.end());
+  appendHashed(out, routingKey);
+  auto rest = keyWithoutRoute.subpiece(routingKey.size());
+  if (rest.removePrefix(kHashStop)) {
+    out.append(kHashStop.begin(), kHashStop.end());
+    appendHashed(out, rest);
+  }
+  return out;
+}
+
+TraceRecorder::TraceRecorder(const std::string& path, Options options)
+    : options_(std::move(options)), writer_(path, makeHeader(options_)) {}
+
+void TraceRecorder::record(
+    uint32_t typeId,
+    const struct iovec* iov,
+    size_t iovcnt) {
+  TraceRecord record;
+  record.timeUs = timeUs_;
+  record.connectionId = connectionId_;
+  record.typeId = typeId;
+  writer_.write(record, iov, iovcnt);
+
+  ++recordedRequests_;
+  if (options_.maxRequests > 0 &&
+      recordedRequests_ >= options_.maxRequests) {
+    options_.stopRunningFn();
+  }
+}
+
+} // memcache
+} // facebook
@@ -0,0 +1,114 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <string>
+
+#include <boost/regex.hpp>
+#include <folly/SocketAddress.h>
+
+#include "mcrouter/lib/debug/TraceFile.h"
+#include "mcrouter/tools/mcpiper/SnifferParser.h"
+
+namespace facebook {
+namespace memcache {
+
+/**
+ * Records the requests sniffed from mcrouter's debug fifos to a trace file
+ * (see TraceFile.h), to be replayed later by mcreplay.
+ */
+class TraceRecorder {
+ public:
+  struct Options {
+    // Hash keys (keeping their routing prefix and length) and replace values
+    // by zeros.
+    bool anonymize{false};
+
+    // Record only requests whose key contains a match of this regex.
+    std::unique_ptr<boost::regex> keyPattern;
+
+    // Number of requests to record before calling stopRunningFn.
+    // 0 to disable.
+    uint32_t maxRequests{0};
+
+    std::function<void()> stopRunningFn = []() { exit(0); };
+  };
+
+  /**
+   * @throw std::system_error  If the trace file can't be created.
+   */
+  TraceRecorder(const std::string& path, Options options);
+
+  /**
+   * Sets the connection and time of the message about to be parsed.
+   */
+  void setCurrentMessage(uint64_t connectionId, uint64_t timeUs) {
+    connectionId_ = connectionId;
+    timeUs_ = timeUs;
+  }
+
+  uint64_t recordedRequests() const noexcept {
+    return recordedRequests_;
+  }
+
+  void flush() {
+    writer_.flush();
+  }
+
+ private:
+  const Options options_;
+  TraceWriter writer_;
+  uint64_t connectionId_{0};
+  uint64_t timeUs_{0};
+  std::atomic<uint64_t> recordedRequests_{0};
+
+  // SnifferParser Callbacks
+  template <class Request>
+  void requestReady(
+      uint64_t msgId,
+      Request&& request,
+      const folly::SocketAddress& from,
+      const folly::SocketAddress& to,
+      mc_protocol_t protocol);
+
+  template <class Reply>
+  void replyReady(
+      uint64_t /* msgId */,
+      Reply&& /* reply */,
+      std::string /* key */,
+      const folly::SocketAddress& /* from */,
+      const folly::SocketAddress& /* to */,
+      mc_protocol_t /* protocol */,
+      int64_t /* latencyUs */,
+      RpcStatsContext /* rpcStatsContext */) {}
+
+  template <class Request>
+  void anonymize(Request& request);
+
+  void record(uint32_t typeId, const struct iovec* iov, size_t iovcnt);
+
+  friend class SnifferParserBase<TraceRecorder>;
+};
+
+/**
+ * Anonymizes a key: the routing prefix is kept, the rest is replaced by a
+ * hash of the same length. Equal keys give equal hashes, and keys sharing
+ * a routing key (see carbon::Keys) still do.
+ */
+std::string anonymizeKey(
+    folly::StringPiece routingPrefix,
+    folly::StringPiece keyWithoutRoute,
+    folly::StringPiece routingKey);
+
+} // memcache
+} // facebook
+
+#include "TraceRecorder-inl.h"
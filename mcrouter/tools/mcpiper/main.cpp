@@ -27,7 +27,11 @@ std::unique_ptr<McPiper> gMcpiper;
     signal(sig, SIG_IGN);
   }
 
-  if (status >= 0) {
+  if (status >= 0 && gMcpiper->recording()) {
+    std::cerr << "exit" << std::endl
+              << gMcpiper->recordedRequests() << " requests recorded."
+              << std::endl;
+  } else if (status >= 0) {
     std::cerr << "exit" << std::endl
               << gMcpiper->stats().totalMessages.load()
               << " messages received, "
@@ -76,6 +80,10 @@ Settings parseOptions(int argc, char** argv) {
       "ignore-case,i",
       po::bool_switch(&settings.ignoreCase)->default_value(false),
       "Ignore case on search patterns")(
+      "key-pattern,k",
+      po::value<std::string>(&settings.keyPattern),
+      "Basic regular expression (BRE) that keys of messages to display "
+      "must match.")(
       "invert-match,v",
       po::bool_switch(&settings.invertMatch)->default_value(false),
       "Invert match")(
@@ -104,6 +112,9 @@ Settings parseOptions(int argc, char** argv) {
       "min-latency-us,l",
       po::value<int64_t>(&settings.minLatencyUs),
       "Minimum latency in micros of messages to display")(
+      "sample-rate",
+      po::value<uint32_t>(&settings.sampleRate),
+      "Display only messages of 1 out of <arg> connections.")(
       "protocol",
       po::value<std::string>(&settings.protocol),
       "Show only data transmitted in the provided protocol; "
@@ -117,7 +128,17 @@ Settings parseOptions(int argc, char** argv) {
       "ASCII protocol is not supported")(
       "script",
       po::bool_switch(&settings.script)->default_value(false),
-      "Machine-readable JSON output (useful for post-processing).");
+      "Machine-readable JSON output (useful for post-processing).")(
+      "record",
+      po::value<std::string>(&settings.recordPath),
+      "Record requests to the trace file <arg> (to be replayed with "
+      "mcreplay) instead of printing messages. Only --filename-pattern, "
+      "--key-pattern, --sample-rate and --max-messages apply. Use "
+      "'-P server' to record only the requests mcrouter received.")(
+      "anonymize",
+      po::bool_switch(&settings.anonymize)->default_value(false),
+      "When recording, hash keys (keeping routing prefixes and lengths) "
+      "and replace values by zeros.");
 
   // Positional arguments - hidden from the help message
   po::options_description hiddenOpts("Hidden options");
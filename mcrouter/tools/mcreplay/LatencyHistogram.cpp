@@ -0,0 +1,114 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include "LatencyHistogram.h"
+
+#include <algorithm>
+#include <cmath>
+#include <string>
+
+#include <folly/Format.h>
+
+namespace facebook {
+namespace memcache {
+namespace mcreplay {
+
+namespace {
+
+constexpr size_t kMaxBarWidth = 40;
+
+} // anonymous namespace
+
+size_t LatencyHistogram::bucketIndex(uint64_t value) noexcept {
+  if (value < kSubBuckets) {
+    return value;
+  }
+  const size_t exponent = 63 - __builtin_clzll(value);
+  const size_t sub = (value >> (exponent - kSubBucketBits)) & (kSubBuckets - 1);
+  return (exponent - kSubBucketBits + 1) * kSubBuckets + sub;
+}
+
+uint64_t LatencyHistogram::bucketLowerBound(size_t index) noexcept {
+  if (index < kSubBuckets) {
+    return index;
+  }
+  const size_t exponent = index / kSubBuckets + kSubBucketBits - 1;
+  const uint64_t sub = index % kSubBuckets;
+  return (kSubBuckets + sub) << (exponent - kSubBucketBits);
+}
+
+void LatencyHistogram::add(uint64_t latencyUs) noexcept {
+  ++buckets_[bucketIndex(latencyUs)];
+  ++count_;
+  sum_ += latencyUs;
+  max_ = std::max(max_, latencyUs);
+}
+
+void LatencyHistogram::merge(const LatencyHistogram& other) noexcept {
+  for (size_t i = 0; i < kNumBuckets; ++i) {
+    buckets_[i] += other.buckets_[i];
+  }
+  count_ += other.count_;
+  sum_ += other.sum_;
+  max_ = std::max(max_, other.max_);
+}
+
+uint64_t LatencyHistogram::percentile(double p) const noexcept {
+  if (count_ == 0) {
+    return 0;
+  }
+  const auto rank = std::max<uint64_t>(
+      1, static_cast<uint64_t>(std::ceil(p / 100.0 * count_)));
+  uint64_t seen = 0;
+  for (size_t i = 0; i < kNumBuckets; ++i) {
+    seen += buckets_[i];
+    if (seen >= rank) {
+      if (i + 1 == kNumBuckets) {
+        return max_;
+      }
+      return std::min(bucketLowerBound(i + 1) - 1, max_);
+    }
+  }
+  return max_;
+}
+
+void LatencyHistogram::print(std::ostream& out) const {
+  if (count_ == 0) {
+    return;
+  }
+  // Group sub-buckets by power of two.
+  std::array<uint64_t, kNumBuckets / kSubBuckets> rows{};
+  for (size_t i = 0; i < kNumBuckets; ++i) {
+    rows[i / kSubBuckets] += buckets_[i];
+  }
+  const auto maxRow = *std::max_element(rows.begin(), rows.end());
+
+  uint64_t seen = 0;
+  for (size_t row = 0; row < rows.size(); ++row) {
+    if (rows[row] == 0) {
+      continue;
+    }
+    seen += rows[row];
+    const auto lower = bucketLowerBound(row * kSubBuckets);
+    const auto upper = row + 1 < rows.size()
+        ? bucketLowerBound((row + 1) * kSubBuckets)
+        : max_ + 1;
+    out << folly::sformat(
+               "  {:>10} - {:<10} {:>12} {:>7.3f}% {:>8.3f}% {}",
+               lower,
+               upper - 1,
+               rows[row],
+               100.0 * rows[row] / count_,
+               100.0 * seen / count_,
+               std::string(rows[row] * kMaxBarWidth / maxRow, '#'))
+        << std::endl;
+  }
+}
+
+} // mcreplay
+} // memcache
+} // facebook
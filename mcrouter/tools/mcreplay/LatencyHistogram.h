@@ -0,0 +1,70 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <ostream>
+
+namespace facebook {
+namespace memcache {
+namespace mcreplay {
+
+/**
+ * Histogram of latencies in microseconds, with log-linear buckets: every
+ * power of two is split in kSubBuckets buckets, so that percentiles are
+ * precise to ~6% whatever the latency.
+ *
+ * Not thread safe.
+ */
+class LatencyHistogram {
+ public:
+  void add(uint64_t latencyUs) noexcept;
+
+  void merge(const LatencyHistogram& other) noexcept;
+
+  uint64_t count() const noexcept {
+    return count_;
+  }
+
+  uint64_t max() const noexcept {
+    return max_;
+  }
+
+  double mean() const noexcept {
+    return count_ ? static_cast<double>(sum_) / count_ : 0.0;
+  }
+
+  /**
+   * @param p  Percentile, between 0 and 100.
+   * @return   Upper bound of the bucket the percentile falls in.
+   */
+  uint64_t percentile(double p) const noexcept;
+
+  /**
+   * Prints one line per power of two that has samples.
+   */
+  void print(std::ostream& out) const;
+
+ private:
+  static constexpr size_t kSubBucketBits = 4;
+  static constexpr size_t kSubBuckets = 1 << kSubBucketBits;
+  static constexpr size_t kNumBuckets = (64 - kSubBucketBits + 1) * kSubBuckets;
+
+  std::array<uint64_t, kNumBuckets> buckets_{};
+  uint64_t count_{0};
+  uint64_t sum_{0};
+  uint64_t max_{0};
+
+  static size_t bucketIndex(uint64_t value) noexcept;
+  static uint64_t bucketLowerBound(size_t index) noexcept;
+};
+
+} // mcreplay
+} // memcache
+} // facebook
@@ -0,0 +1,526 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include "Replayer.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <exception>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include <folly/Format.h>
+#include <folly/ProducerConsumerQueue.h>
+#include <folly/ScopeGuard.h>
+#include <folly/fibers/Baton.h>
+#include <folly/fibers/FiberManagerMap.h>
+#include <folly/fibers/Semaphore.h>
+#include <folly/hash/Hash.h>
+#include <folly/io/IOBuf.h>
+#include <folly/io/async/EventBase.h>
+#include <folly/synchronization/Baton.h>
+#include <glog/logging.h>
+
+#include "mcrouter/CarbonRouterClient.h"
+#include "mcrouter/CarbonRouterInstance.h"
+#include "mcrouter/lib/McResUtil.h"
+#include "mcrouter/lib/carbon/CarbonProtocolReader.h"
+#include "mcrouter/lib/debug/TraceFile.h"
+#include "mcrouter/lib/mc/protocol.h"
+#include "mcrouter/lib/network/AsyncMcClient.h"
+#include "mcrouter/lib/network/TypedMsg.h"
+#include "mcrouter/lib/network/gen/MemcacheRouterInfo.h"
+
+namespace facebook {
+namespace memcache {
+namespace mcreplay {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+using Router = mcrouter::CarbonRouterInstance<MemcacheRouterInfo>;
+using RouterClient = mcrouter::CarbonRouterClient<MemcacheRouterInfo>;
+
+// Requests due sooner than this are sent right away.
+constexpr std::chrono::microseconds kMinPacingSleep{1000};
+// Records read ahead of each thread.
+constexpr uint32_t kQueueSize = 4096;
+// How long the reader sleeps when the queue of a thread is full.
+constexpr std::chrono::microseconds kQueueFullSleep{100};
+
+/**
+ * A trace record handed over by the reader to a replay thread.
+ */
+struct QueuedRecord {
+  uint64_t timeUs{0};
+  uint32_t typeId{0};
+  size_t connection{0};
+  std::unique_ptr<folly::IOBuf> body;
+};
+
+/**
+ * A replay thread: owns an EventBase (the one of a proxy, when routing with
+ * an embedded mcrouter) and the connections of its share of the trace.
+ *
+ * Its records are read from the trace by Replayer::run() and handed over
+ * through a single producer, single consumer queue.
+ */
+class Worker {
+ public:
+  Worker(
+      const Settings& settings,
+      size_t index,
+      uint64_t firstTimeUs,
+      const std::atomic<bool>& stopping)
+      : settings_(settings),
+        index_(index),
+        firstTimeUs_(firstTimeUs),
+        stopping_(stopping),
+        queue_(kQueueSize),
+        outstanding_(settings.maxOutstanding),
+        thread_([this]() { evb_.loopForever(); }) {
+    evb_.waitUntilRunning();
+  }
+
+  ~Worker() {
+    evb_.terminateLoopSoon();
+    thread_.join();
+  }
+
+  folly::EventBase& eventBase() {
+    return evb_;
+  }
+
+  /**
+   * Creates the clients of this thread. Must be called from the thread.
+   */
+  void connect(Router* router) {
+    for (size_t i = 0; i < settings_.numConnections; ++i) {
+      if (router) {
+        routerClients_.push_back(
+            router->createSameThreadClient(0 /* maxOutstanding */));
+        routerClients_.back()->setProxyIndex(index_);
+      } else {
+        ConnectionOptions options(
+            settings_.host,
+            settings_.port,
+            mc_string_to_protocol(settings_.protocol.c_str()));
+        options.connectTimeout = std::chrono::milliseconds(settings_.timeoutMs);
+        options.writeTimeout = std::chrono::milliseconds(settings_.timeoutMs);
+        asyncClients_.push_back(std::make_unique<AsyncMcClient>(evb_, options));
+      }
+    }
+  }
+
+  /**
+   * Starts replaying, from the start time on.
+   */
+  void start(Clock::time_point startTime) {
+    evb_.runInEventBaseThread([this, startTime]() {
+      startTime_ = startTime;
+      folly::fibers::getFiberManager(evb_).addTask([this]() {
+        try {
+          replay();
+        } catch (...) {
+          error_ = std::current_exception();
+        }
+        // Waits for outstanding requests.
+        for (size_t i = 0; i < settings_.maxOutstanding; ++i) {
+          outstanding_.wait();
+        }
+        stats_.elapsedSec =
+            std::chrono::duration<double>(Clock::now() - startTime_).count();
+        folly::fibers::runInMainContext([this]() {
+          for (auto& client : asyncClients_) {
+            client->closeNow();
+          }
+          asyncClients_.clear();
+        });
+        done_.post();
+      });
+    });
+  }
+
+  /**
+   * Hands a record over to this thread. Called from the reader thread only,
+   * waits while the queue is full.
+   *
+   * @return  False if the record was dropped because the replay stopped.
+   */
+  bool enqueue(QueuedRecord&& record) {
+    while (!queue_.write(std::move(record))) {
+      if (stopping_.load(std::memory_order_relaxed) ||
+          replayDone_.load(std::memory_order_acquire)) {
+        return false;
+      }
+      /* sleep override */
+      std::this_thread::sleep_for(kQueueFullSleep);
+    }
+    wakeUp();
+    return true;
+  }
+
+  /**
+   * Tells this thread no more records are coming. Called from the reader
+   * thread only.
+   */
+  void finishQueue() {
+    readerDone_.store(true, std::memory_order_release);
+    wakeUp();
+  }
+
+  /**
+   * Waits for the end of the replay, rethrowing what it failed with.
+   */
+  const ReplayStats& wait() {
+    done_.wait();
+    if (error_) {
+      std::rethrow_exception(error_);
+    }
+    return stats_;
+  }
+
+  template <class Request>
+  static void
+  processMsg(Worker& me, const QueuedRecord& record, size_t connection) {
+    carbon::CarbonProtocolReader reader(
+        carbon::CarbonCursor(record.body.get()));
+    Request request;
+    request.deserialize(reader);
+    me.send(std::move(request), connection);
+  }
+
+ private:
+  const Settings& settings_;
+  const size_t index_;
+  const uint64_t firstTimeUs_;
+  const std::atomic<bool>& stopping_;
+  Clock::time_point startTime_;
+
+  folly::ProducerConsumerQueue<QueuedRecord> queue_;
+  std::atomic<bool> readerDone_{false};
+  // Set when the replay fiber waits for the queue.
+  std::atomic<bool> waiting_{false};
+  folly::fibers::Baton queueBaton_;
+  // Set once the replay fiber stopped reading the queue.
+  std::atomic<bool> replayDone_{false};
+
+  folly::EventBase evb_;
+  std::vector<std::unique_ptr<AsyncMcClient>> asyncClients_;
+  std::vector<RouterClient::Pointer> routerClients_;
+  folly::fibers::Semaphore outstanding_;
+  CallDispatcher<
+      MemcacheRouterInfo::RoutableRequests,
+      Worker,
+      const QueuedRecord&,
+      size_t>
+      dispatcher_;
+
+  ReplayStats stats_;
+  std::exception_ptr error_;
+  folly::Baton<> done_;
+  std::thread thread_;
+
+  void wakeUp() {
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (waiting_.exchange(false)) {
+      queueBaton_.post();
+    }
+  }
+
+  /**
+   * Waits for the next record from the reader.
+   *
+   * @return  False once the reader is done and the queue is drained.
+   */
+  bool nextRecord(QueuedRecord& record) {
+    while (!queue_.read(record)) {
+      if (readerDone_.load(std::memory_order_acquire)) {
+        // Whatever the reader wrote before it was done is visible now.
+        return queue_.read(record);
+      }
+      waiting_.store(true);
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      if (queue_.isEmpty() && !readerDone_.load(std::memory_order_acquire)) {
+        queueBaton_.wait();
+        queueBaton_.reset();
+      } else if (!waiting_.exchange(false)) {
+        // The reader already took the wake-up, consume it.
+        queueBaton_.wait();
+        queueBaton_.reset();
+      }
+    }
+    return true;
+  }
+
+  void replay() {
+    SCOPE_EXIT {
+      replayDone_.store(true, std::memory_order_release);
+    };
+    QueuedRecord record;
+    while (!stopping_.load(std::memory_order_relaxed) && nextRecord(record)) {
+      const size_t connection = record.connection;
+
+      if (settings_.speed > 0) {
+        waitUntil(dueTime(record.timeUs));
+      }
+      outstanding_.wait();
+      bool dispatched = false;
+      try {
+        dispatched =
+            dispatcher_.dispatch(record.typeId, *this, record, connection);
+      } catch (const std::exception& ex) {
+        LOG_FIRST_N(ERROR, 10) << "Failed to deserialize request of type "
+                               << record.typeId << ": " << ex.what();
+      }
+      if (!dispatched) {
+        ++stats_.skipped;
+        outstanding_.signal();
+      }
+    }
+  }
+
+  Clock::time_point dueTime(uint64_t timeUs) const {
+    // Records of different fifos are interleaved, time can go backwards.
+    const auto offsetUs = static_cast<int64_t>(timeUs - firstTimeUs_);
+    return startTime_ +
+        std::chrono::microseconds(std::llround(offsetUs / settings_.speed));
+  }
+
+  void waitUntil(Clock::time_point due) {
+    const auto delay = std::chrono::duration_cast<std::chrono::microseconds>(
+        due - Clock::now());
+    if (delay >= kMinPacingSleep) {
+      folly::fibers::Baton baton;
+      baton.try_wait_for(delay);
+    }
+  }
+
+  template <class Request>
+  void send(Request&& request, size_t connection) {
+    const auto start = Clock::now();
+    if (!routerClients_.empty()) {
+      // Callbacks must be copyable.
+      auto req = std::make_shared<Request>(std::move(request));
+      bool sent = false;
+      folly::fibers::runInMainContext([&]() {
+        sent = routerClients_[connection]->send(
+            *req, [this, start, req](const Request&, ReplyT<Request>&& reply) {
+              onReply(Request::name, start, reply.result());
+            });
+      });
+      if (!sent) {
+        onReply(Request::name, start, carbon::Result::LOCAL_ERROR);
+      }
+      return;
+    }
+
+    auto& client = *asyncClients_[connection];
+    folly::fibers::getFiberManager(evb_).addTask(
+        [this, &client, start, req = std::move(request)]() {
+          auto reply = client.sendSync(
+              req, std::chrono::milliseconds(settings_.timeoutMs));
+          onReply(Request::name, start, reply.result());
+        });
+  }
+
+  void
+  onReply(const char* name, Clock::time_point start, carbon::Result result) {
+    const uint64_t latencyUs =
+        std::chrono::duration_cast<std::chrono::microseconds>(
+            Clock::now() - start)
+            .count();
+    ++stats_.requests;
+    if (isErrorResult(result)) {
+      ++stats_.errors;
+    }
+    stats_.latency.add(latencyUs);
+    stats_.latencyByRequest[name].add(latencyUs);
+    outstanding_.signal();
+  }
+};
+
+std::shared_ptr<Router> createRouter(
+    const Settings& settings,
+    const std::vector<folly::EventBase*>& evbs) {
+  McrouterOptions options;
+  // Replays are not production traffic, unless asked otherwise.
+  options.asynclog_disable = true;
+  options.stats_logging_interval = 0;
+  auto errors = options.updateFromDict(settings.mcrouterOptions);
+  for (const auto& error : errors) {
+    throw std::invalid_argument(folly::sformat(
+        "Invalid mcrouter option {}={}: {}",
+        error.requestedName,
+        error.requestedValue,
+        error.errorMsg));
+  }
+  options.config = settings.config;
+  options.num_proxies = evbs.size();
+  auto router = Router::create(std::move(options), evbs);
+  if (!router) {
+    throw std::runtime_error("Failed to create mcrouter, see logs");
+  }
+  return router;
+}
+
+} // anonymous namespace
+
+void ReplayStats::merge(const ReplayStats& other) {
+  requests += other.requests;
+  errors += other.errors;
+  skipped += other.skipped;
+  elapsedSec = std::max(elapsedSec, other.elapsedSec);
+  latency.merge(other.latency);
+  for (const auto& it : other.latencyByRequest) {
+    latencyByRequest[it.first].merge(it.second);
+  }
+}
+
+Replayer::Replayer(Settings settings) : settings_(std::move(settings)) {
+  if (settings_.numThreads == 0 || settings_.numConnections == 0 ||
+      settings_.maxOutstanding == 0) {
+    throw std::invalid_argument(
+        "Threads, connections and outstanding requests must be positive");
+  }
+  if (settings_.speed < 0) {
+    throw std::invalid_argument("Speed can't be negative");
+  }
+}
+
+ReplayStats Replayer::run() {
+  // The trace is read (and its framing decoded) once, here, and each
+  // record is handed over to the thread replaying its connection. All
+  // threads pace their requests relative to the first one.
+  TraceReader reader(settings_.tracePath);
+  TraceRecord record;
+  if (!reader.next(record)) {
+    return ReplayStats();
+  }
+  const auto firstTimeUs = record.timeUs;
+  if (reader.header().flags & TraceFileHeader::kAnonymized) {
+    LOG(INFO) << "Trace is anonymized: values are zeros.";
+  }
+
+  std::vector<std::unique_ptr<Worker>> workers;
+  std::vector<folly::EventBase*> evbs;
+  for (size_t i = 0; i < settings_.numThreads; ++i) {
+    workers.push_back(
+        std::make_unique<Worker>(settings_, i, firstTimeUs, stopping_));
+    evbs.push_back(&workers.back()->eventBase());
+  }
+
+  std::shared_ptr<Router> router;
+  if (!settings_.config.empty()) {
+    router = createRouter(settings_, evbs);
+  }
+  for (auto& worker : workers) {
+    worker->eventBase().runInEventBaseThreadAndWait(
+        [&worker, &router]() { worker->connect(router.get()); });
+  }
+
+  const auto startTime = Clock::now();
+  for (auto& worker : workers) {
+    worker->start(startTime);
+  }
+
+  std::exception_ptr error;
+  try {
+    do {
+      const auto hash = folly::hash::twang_mix64(record.connectionId);
+      QueuedRecord queued;
+      queued.timeUs = record.timeUs;
+      queued.typeId = record.typeId;
+      queued.connection =
+          (hash / settings_.numThreads) % settings_.numConnections;
+      // The body is only valid until the next record is read.
+      queued.body =
+          folly::IOBuf::copyBuffer(record.body.data(), record.body.size());
+      workers[hash % settings_.numThreads]->enqueue(std::move(queued));
+    } while (!stopping_.load(std::memory_order_relaxed) &&
+             reader.next(record));
+  } catch (...) {
+    error = std::current_exception();
+  }
+  for (auto& worker : workers) {
+    worker->finishQueue();
+  }
+
+  ReplayStats stats;
+  for (auto& worker : workers) {
+    try {
+      stats.merge(worker->wait());
+    } catch (...) {
+      error = std::current_exception();
+    }
+  }
+  if (router) {
+    router->shutdown();
+  }
+  workers.clear();
+  if (error) {
+    std::rethrow_exception(error);
+  }
+  return stats;
+}
+
+void printStats(const ReplayStats& stats, std::ostream& out) {
+  out << folly::sformat(
+             "Replayed {} requests in {:.3f}s: {:.0f} requests/s, {} errors, "
+             "{} skipped",
+             stats.requests,
+             stats.elapsedSec,
+             stats.elapsedSec > 0 ? stats.requests / stats.elapsedSec : 0.0,
+             stats.errors,
+             stats.skipped)
+      << std::endl;
+  if (stats.requests == 0) {
+    return;
+  }
+
+  const auto printLine = [&out](
+                             folly::StringPiece name,
+                             const LatencyHistogram& latency) {
+    out << folly::sformat(
+               "{:<24} {:>12} {:>10.1f} {:>8} {:>8} {:>8} {:>8} {:>8}",
+               name,
+               latency.count(),
+               latency.mean(),
+               latency.percentile(50),
+               latency.percentile(90),
+               latency.percentile(99),
+               latency.percentile(99.9),
+               latency.max())
+        << std::endl;
+  };
+  out << std::endl
+      << folly::sformat(
+             "{:<24} {:>12} {:>10} {:>8} {:>8} {:>8} {:>8} {:>8}",
+             "latency (us)",
+             "count",
+             "mean",
+             "p50",
+             "p90",
+             "p99",
+             "p99.9",
+             "max")
+      << std::endl;
+  printLine("all", stats.latency);
+  for (const auto& it : stats.latencyByRequest) {
+    printLine(it.first, it.second);
+  }
+
+  out << std::endl << "Latency histogram (us):" << std::endl;
+  stats.latency.print(out);
+}
+
+} // mcreplay
+} // memcache
+} // facebook
@@ -0,0 +1,99 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <map>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+
+#include "mcrouter/tools/mcreplay/LatencyHistogram.h"
+
+namespace facebook {
+namespace memcache {
+namespace mcreplay {
+
+struct Settings {
+  std::string tracePath;
+
+  // Send requests to host:port with AsyncMcClient...
+  std::string host{"localhost"};
+  uint16_t port{0};
+  std::string protocol{"caret"};
+
+  // ... or route them with an embedded mcrouter (CarbonRouterClient), when
+  // config is set.
+  std::string config;
+  std::unordered_map<std::string, std::string> mcrouterOptions;
+
+  // Replay speed relative to the recording: 2 replays twice as fast.
+  // 0 replays as fast as possible.
+  double speed{1.0};
+  uint32_t numThreads{1};
+  // Connections (or CarbonRouterClients) per thread.
+  uint32_t numConnections{1};
+  // Maximum outstanding requests per thread.
+  uint32_t maxOutstanding{1000};
+  uint32_t timeoutMs{1000};
+};
+
+struct ReplayStats {
+  // Requests replied to (or timed out).
+  uint64_t requests{0};
+  uint64_t errors{0};
+  // Requests of a type that can't be replayed.
+  uint64_t skipped{0};
+  double elapsedSec{0};
+  // Latency of all requests, and by request name.
+  LatencyHistogram latency;
+  std::map<std::string, LatencyHistogram> latencyByRequest;
+
+  void merge(const ReplayStats& other);
+};
+
+/**
+ * Replays a trace recorded by mcpiper --record.
+ *
+ * Requests are spread over threads and connections by their recorded
+ * connection id, so that requests of a recorded connection are sent, in
+ * order, on the same connection. The trace is read once, by the thread
+ * calling run(), which hands each record over to its replay thread.
+ */
+class Replayer {
+ public:
+  explicit Replayer(Settings settings);
+
+  /**
+   * Replays the whole trace (or until stop() is called).
+   *
+   * @throw std::exception  If the trace can't be read or mcrouter can't be
+   *                        set up.
+   */
+  ReplayStats run();
+
+  /**
+   * Stops replaying. Can be called from any thread.
+   */
+  void stop() {
+    stopping_ = true;
+  }
+
+ private:
+  const Settings settings_;
+  std::atomic<bool> stopping_{false};
+};
+
+/**
+ * Prints throughput and latency histograms.
+ */
+void printStats(const ReplayStats& stats, std::ostream& out);
+
+} // mcreplay
+} // memcache
+} // facebook
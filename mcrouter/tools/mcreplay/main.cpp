@@ -0,0 +1,171 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <signal.h>
+
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <boost/program_options.hpp>
+
+#include <folly/Format.h>
+#include <folly/String.h>
+#include <folly/init/Init.h>
+#include <folly/logging/Init.h>
+#include <glog/logging.h>
+
+#include "mcrouter/tools/mcreplay/Replayer.h"
+
+using namespace facebook::memcache::mcreplay;
+
+namespace {
+
+std::unique_ptr<Replayer> gReplayer;
+
+void stopReplay(int /* sig */) {
+  gReplayer->stop();
+}
+
+std::string getUsage(const char* binaryName) {
+  return folly::sformat(
+      "Usage: {} [OPTION]... TRACE\n"
+      "Replays TRACE, recorded with 'mcpiper --record', against a memcache "
+      "server (or mcrouter) at HOST:PORT, or through an embedded mcrouter "
+      "when --config is provided.\n"
+      "Requests of a recorded connection are sent, in order, on the same "
+      "connection.\n",
+      binaryName);
+}
+
+Settings parseOptions(int argc, char** argv) {
+  Settings settings;
+  std::vector<std::string> mcrouterOptions;
+
+  namespace po = boost::program_options;
+
+  // Named options
+  po::options_description namedOpts("Allowed options");
+  namedOpts.add_options()("help,h", "Print this help message.")(
+      "host,H",
+      po::value<std::string>(&settings.host),
+      "Host to send requests to.")(
+      "port,p",
+      po::value<uint16_t>(&settings.port),
+      "Port to send requests to.")(
+      "protocol",
+      po::value<std::string>(&settings.protocol),
+      "Protocol to send requests with; ARG is \"ascii\" or \"caret\".")(
+      "config",
+      po::value<std::string>(&settings.config),
+      "Route requests with an embedded mcrouter using this config, instead "
+      "of sending them to HOST:PORT. ARG is file:<path> or a JSON string.")(
+      "mcrouter-option,o",
+      po::value<std::vector<std::string>>(&mcrouterOptions),
+      "Option of the embedded mcrouter, as <name>=<value> "
+      "(e.g. num_proxies is ignored, see --threads).")(
+      "speed,s",
+      po::value<double>(&settings.speed),
+      "Replay speed relative to the recording: 1 replays at the original "
+      "pace, 2 twice as fast, 0 as fast as possible.")(
+      "threads,t",
+      po::value<uint32_t>(&settings.numThreads),
+      "Number of threads (proxies, with --config).")(
+      "connections,c",
+      po::value<uint32_t>(&settings.numConnections),
+      "Number of connections (clients, with --config) per thread.")(
+      "max-outstanding",
+      po::value<uint32_t>(&settings.maxOutstanding),
+      "Maximum number of outstanding requests per thread.")(
+      "timeout-ms",
+      po::value<uint32_t>(&settings.timeoutMs),
+      "Request timeout, in milliseconds.");
+
+  // Positional arguments - hidden from the help message
+  po::options_description hiddenOpts("Hidden options");
+  hiddenOpts.add_options()(
+      "trace", po::value<std::string>(&settings.tracePath), "Trace file");
+  po::positional_options_description posArgs;
+  posArgs.add("trace", 1);
+
+  // Parse command line
+  po::variables_map vm;
+  try {
+    po::options_description allOpts;
+    allOpts.add(namedOpts).add(hiddenOpts);
+    po::store(
+        po::command_line_parser(argc, argv)
+            .options(allOpts)
+            .positional(posArgs)
+            .run(),
+        vm);
+    po::notify(vm);
+  } catch (po::error& ex) {
+    LOG(ERROR) << ex.what();
+    exit(1);
+  }
+
+  if (vm.count("help")) {
+    std::cerr << getUsage(argv[0]) << std::endl;
+    namedOpts.print(std::cerr);
+    exit(0);
+  }
+
+  for (const auto& option : mcrouterOptions) {
+    std::string name;
+    std::string value;
+    if (!folly::split('=', option, name, value)) {
+      LOG(ERROR) << "Invalid mcrouter option (<name>=<value> expected): "
+                 << option;
+      exit(1);
+    }
+    settings.mcrouterOptions[name] = value;
+  }
+
+  // Handles constraints
+  CHECK(!settings.tracePath.empty()) << "A trace file must be provided";
+  CHECK(!settings.config.empty() || settings.port != 0)
+      << "Either --port or --config must be provided";
+
+  return settings;
+}
+
+} // anonymous namespace
+
+// Configure folly to enable INFO+ messages, and everything else to
+// enable WARNING+.
+FOLLY_INIT_LOGGING_CONFIG(".=WARNING,folly=INFO");
+
+int main(int argc, char** argv) {
+  // Just give the binary name to folly::init() because we use
+  // boost::program_options instead of gflags.
+  int tempArgc = 1;
+  folly::init(&tempArgc, &argv, false);
+
+  auto settings = parseOptions(argc, argv);
+  try {
+    gReplayer = std::make_unique<Replayer>(std::move(settings));
+  } catch (const std::exception& ex) {
+    LOG(ERROR) << ex.what();
+    return 1;
+  }
+
+  struct sigaction sa;
+  memset(&sa, 0, sizeof(struct sigaction));
+  sa.sa_handler = stopReplay;
+  sigaction(SIGINT, &sa, nullptr);
+  signal(SIGPIPE, SIG_IGN);
+
+  try {
+    printStats(gReplayer->run(), std::cout);
+  } catch (const std::exception& ex) {
+    LOG(ERROR) << "Replay failed: " << ex.what();
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,199 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+
+#include <boost/program_options.hpp>
+
+#include <folly/Format.h>
+#include <folly/dynamic.h>
+#include <folly/init/Init.h>
+#include <folly/json.h>
+#include <glog/logging.h>
+
+#include "mcrouter/lib/debug/ShmStats.h"
+
+using facebook::memcache::ShmStats;
+
+namespace {
+
+struct Settings {
+  std::string path;
+  // Only print stats whose name contains this.
+  std::string filter;
+  // Print a snapshot every intervalSec seconds, 0 to print just one.
+  uint32_t intervalSec{0};
+  bool json{false};
+};
+
+std::string getUsage(const char* binaryName) {
+  return folly::sformat(
+      "Usage: {} [OPTION]... PATH\n"
+      "Prints the stats that mcrouter publishes to PATH, its "
+      "--stats-shm-path. Reading them doesn't involve mcrouter at all.\n",
+      binaryName);
+}
+
+Settings parseOptions(int argc, char** argv) {
+  Settings settings;
+
+  namespace po = boost::program_options;
+
+  // Named options
+  po::options_description namedOpts("Allowed options");
+  namedOpts.add_options()("help,h", "Print this help message.")(
+      "filter,f",
+      po::value<std::string>(&settings.filter),
+      "Only print stats whose name contains ARG.")(
+      "interval,i",
+      po::value<uint32_t>(&settings.intervalSec),
+      "Print stats every ARG seconds, until interrupted.")(
+      "json,j", po::bool_switch(&settings.json), "Print stats as JSON.");
+
+  // Positional arguments - hidden from the help message
+  po::options_description hiddenOpts("Hidden options");
+  hiddenOpts.add_options()(
+      "path", po::value<std::string>(&settings.path), "Stats file");
+  po::positional_options_description posArgs;
+  posArgs.add("path", 1);
+
+  // Parse command line
+  po::variables_map vm;
+  try {
+    po::options_description allOpts;
+    allOpts.add(namedOpts).add(hiddenOpts);
+    po::store(
+        po::command_line_parser(argc, argv)
+            .options(allOpts)
+            .positional(posArgs)
+            .run(),
+        vm);
+    po::notify(vm);
+  } catch (po::error& ex) {
+    LOG(ERROR) << ex.what();
+    exit(1);
+  }
+
+  if (vm.count("help")) {
+    std::cerr << getUsage(argv[0]) << std::endl;
+    namedOpts.print(std::cerr);
+    exit(0);
+  }
+
+  // Handles constraints
+  CHECK(!settings.path.empty()) << "A stats file must be provided";
+
+  return settings;
+}
+
+/**
+ * Reads a snapshot, reopening the file if mcrouter moved to a new region.
+ * Waits up to a second for a consistent snapshot.
+ */
+bool readSnapshot(
+    const std::string& path,
+    std::unique_ptr<ShmStats>& region,
+    ShmStats::Snapshot& snapshot) {
+  for (size_t attempt = 0; attempt < 100; ++attempt) {
+    if (attempt > 0) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    try {
+      if (!region || region->retired()) {
+        region = ShmStats::open(path);
+      }
+    } catch (const std::exception& ex) {
+      LOG(ERROR) << ex.what();
+      region.reset();
+      continue;
+    }
+    if (region->read(snapshot)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+void printSnapshot(const Settings& settings, ShmStats::Snapshot& snapshot) {
+  std::sort(
+      snapshot.entries.begin(),
+      snapshot.entries.end(),
+      [](const ShmStats::Entry& a, const ShmStats::Entry& b) {
+        return std::strcmp(a.name, b.name) < 0;
+      });
+
+  folly::dynamic json = folly::dynamic::object;
+  if (!settings.json) {
+    std::cout << folly::sformat(
+        "# pid {}, version {}, timestamp_ms {}\n",
+        snapshot.pid,
+        snapshot.version,
+        snapshot.timestampMs);
+  }
+  for (const auto& entry : snapshot.entries) {
+    if (!settings.filter.empty() &&
+        std::strstr(entry.name, settings.filter.c_str()) == nullptr) {
+      continue;
+    }
+    folly::dynamic value;
+    switch (entry.type) {
+      case ShmStats::Type::Uint64:
+        value = entry.value.uint64;
+        break;
+      case ShmStats::Type::Int64:
+        value = entry.value.int64;
+        break;
+      case ShmStats::Type::Double:
+        value = entry.value.dbl;
+        break;
+      default:
+        continue;
+    }
+    if (settings.json) {
+      json[entry.name] = std::move(value);
+    } else {
+      std::cout << entry.name << " " << folly::toJson(value) << "\n";
+    }
+  }
+  if (settings.json) {
+    json["pid"] = snapshot.pid;
+    json["version"] = snapshot.version;
+    json["timestamp_ms"] = snapshot.timestampMs;
+    std::cout << folly::toJson(json) << "\n";
+  }
+  std::cout << std::flush;
+}
+
+} // anonymous namespace
+
+int main(int argc, char** argv) {
+  // Just give the binary name to folly::init() because we use
+  // boost::program_options instead of gflags.
+  int tempArgc = 1;
+  folly::init(&tempArgc, &argv, false);
+
+  const auto settings = parseOptions(argc, argv);
+  std::unique_ptr<ShmStats> region;
+  ShmStats::Snapshot snapshot;
+  while (true) {
+    if (!readSnapshot(settings.path, region, snapshot)) {
+      LOG(ERROR) << "No stats published to " << settings.path;
+      return 1;
+    }
+    printSnapshot(settings, snapshot);
+    if (settings.intervalSec == 0) {
+      return 0;
+    }
+    std::this_thread::sleep_for(std::chrono::seconds(settings.intervalSec));
+  }
+}